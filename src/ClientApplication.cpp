@@ -6,6 +6,7 @@
 #include "DX12Engine/Resources/Mesh.h"
 #include "DX12Engine/Entity/RenderComponent.h"
 #include "DX12Engine/IO/TextureLoader.h"
+#include "DX12Engine/IO/MaterialLoader.h"
 #include "DX12Engine/Resources/Texture.h"
 #include "DX12Engine/Rendering/GPUUploader.h"
 #include "DX12Engine/Resources/Materials/BasicMaterial.h"
@@ -34,13 +35,13 @@ void ClientApplication::Init(std::shared_ptr<DX12Engine::RenderContext> renderCo
 	m_RenderContext = renderContext;
 	m_Renderer = std::make_unique<DX12Engine::Renderer>(m_RenderContext);
 
-	DX12Engine::ModelLoader modelLoader;
-	DX12Engine::Mesh mesh = modelLoader.LoadObj(DX12Engine::ResourceManager::GetModelPath("cube.obj"));
-	DX12Engine::Mesh mesh2 = modelLoader.LoadObj(DX12Engine::ResourceManager::GetModelPath("sphere.obj"));
-	DX12Engine::Mesh floorMesh = modelLoader.LoadObj(DX12Engine::ResourceManager::GetModelPath("floor.obj"));
+	DX12Engine::ResourceManager& resourceManager = DX12Engine::ResourceManager::GetInstance();
+	auto mesh = resourceManager.LoadMesh(DX12Engine::ResourceManager::GetModelPath("cube.obj"));
+	auto mesh2 = resourceManager.LoadMesh(DX12Engine::ResourceManager::GetModelPath("sphere.obj"));
+	auto floorMesh = resourceManager.LoadMesh(DX12Engine::ResourceManager::GetModelPath("floor.obj"));
 
 	DX12Engine::TextureLoader textureLoader;
-	DX12Engine::GPUUploader uploader = m_RenderContext->GetUploader();
+	DX12Engine::GPUUploader& uploader = m_RenderContext->GetUploader();
 	std::vector<DX12Engine::Texture*> textures;
 
 	std::shared_ptr<DX12Engine::Texture> skyboxCube = textureLoader.LoadCubemapDDS(DX12Engine::ResourceManager::GetMaterialPath("skybox/skybox_cubemap.dds"));
@@ -48,14 +49,17 @@ void ClientApplication::Init(std::shared_ptr<DX12Engine::RenderContext> renderCo
 	textures = { skyboxCube.get(), skyboxIrradiance.get() };
 	uploader.UploadTextureBatch(textures);
 
-	auto brickTextures = textureLoader.LoadMaterial(DX12Engine::ResourceManager::GetMaterialPath("dark-worn-stone-ue"));
-	uploader.UploadTextureBatch(DX12Engine::TextureLoader::GetTextureArray(brickTextures));
-	auto goldTextures = textureLoader.LoadMaterial(DX12Engine::ResourceManager::GetMaterialPath("hammered-gold-ue"));
-	uploader.UploadTextureBatch(DX12Engine::TextureLoader::GetTextureArray(goldTextures));
-	auto concreteTextures = textureLoader.LoadMaterial(DX12Engine::ResourceManager::GetMaterialPath("clean-concrete-ue"));
-	uploader.UploadTextureBatch(DX12Engine::TextureLoader::GetTextureArray(concreteTextures));
-	auto wornMetalTextures = textureLoader.LoadMaterial(DX12Engine::ResourceManager::GetMaterialPath("worn-shiny-metal-ue"));
-	uploader.UploadTextureBatch(DX12Engine::TextureLoader::GetTextureArray(wornMetalTextures));
+	// All maps of all materials decode concurrently and upload in batches
+	DX12Engine::MaterialLoader materialLoader;
+	size_t brickIndex = materialLoader.Request(DX12Engine::ResourceManager::GetMaterialPath("dark-worn-stone-ue"));
+	size_t goldIndex = materialLoader.Request(DX12Engine::ResourceManager::GetMaterialPath("hammered-gold-ue"));
+	size_t concreteIndex = materialLoader.Request(DX12Engine::ResourceManager::GetMaterialPath("clean-concrete-ue"));
+	size_t wornMetalIndex = materialLoader.Request(DX12Engine::ResourceManager::GetMaterialPath("worn-shiny-metal-ue"));
+	std::vector<DX12Engine::MaterialTextures> materialTextures = materialLoader.Finish(uploader);
+	auto& brickTextures = materialTextures[brickIndex];
+	auto& goldTextures = materialTextures[goldIndex];
+	auto& concreteTextures = materialTextures[concreteIndex];
+	auto& wornMetalTextures = materialTextures[wornMetalIndex];
 
 	std::shared_ptr<DX12Engine::PBRMaterial> pbrBrick = std::make_shared<DX12Engine::PBRMaterial>();
 	pbrBrick->SetAllTextures(brickTextures);
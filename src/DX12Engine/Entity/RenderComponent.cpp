@@ -1,11 +1,16 @@
 #include "RenderComponent.h"
 #include "../Resources/ResourceManager.h"
+#include "../Input/Camera.h"
+#include "../Utils/Constants.h"
+#include "../Geometry/ClusterCuller.h"
+#include <algorithm>
 
 namespace DX12Engine
 {
 	RenderComponent::RenderComponent(GameObject* parent)
 		: Component(parent, ComponentType::Render),
 		m_ModelMatrix(DirectX::XMMatrixIdentity()),
+		m_CurrentLod(0),
 		m_Position({ 0.0f, 0.0f, 0.0f }),
 		m_Scale({ 1.0f, 1.0f, 1.0f }),
 		m_Rotation(DirectX::XMQuaternionIdentity())
@@ -14,16 +19,143 @@ namespace DX12Engine
 
 	RenderComponent::~RenderComponent()
 	{
-		m_Mesh.Reset();
+		m_Mesh.reset();
 		m_ModelMatrix = DirectX::XMMatrixIdentity();
 	}
 
-	void RenderComponent::SetMesh(Mesh mesh)
+	void RenderComponent::SetMesh(std::shared_ptr<MeshAsset> mesh)
 	{
-		m_Mesh = mesh;
-		m_VertexBuffer = ResourceManager::GetInstance().CreateVertexBuffer(mesh.Vertices);
-		m_IndexBuffer = ResourceManager::GetInstance().CreateIndexBuffer(mesh.Indices);
-		m_ConstantBuffer = ResourceManager::GetInstance().CreateConstantBuffer(sizeof(RenderComponentData));
+		m_Mesh = std::move(mesh);
+		m_CurrentLod = 0;
+		m_ClusterIndexBuffer.reset();
+		if (!m_Mesh->GetMeshlets().empty())
+			m_ClusterIndexBuffer = ResourceManager::GetInstance().CreateDynamicIndexBuffer(m_Mesh->GetClusterIndexCount(), m_Mesh->GetIndexFormat());
+		if (!m_ConstantBuffer)
+			m_ConstantBuffer = ResourceManager::GetInstance().CreateConstantBuffer(sizeof(RenderComponentData));
+	}
+
+	void RenderComponent::SetMaterial(UINT slot, std::shared_ptr<Material> material)
+	{
+		if (slot >= m_Materials.size())
+			m_Materials.resize(slot + 1);
+		m_Materials[slot] = material;
+	}
+
+	Material* RenderComponent::GetMaterial(UINT slot)
+	{
+		if (slot < m_Materials.size() && m_Materials[slot])
+			return m_Materials[slot].get();
+		return m_Materials.empty() ? nullptr : m_Materials[0].get();
+	}
+
+	const std::vector<IndexedDraw>& RenderComponent::PrepareDraw(const DirectX::XMMATRIX& viewProjection, const DirectX::XMFLOAT3* viewPosition, bool mergeSubmeshes)
+	{
+		m_Draws.clear();
+		const Submesh* submeshes = m_Mesh->GetSubmeshes(m_CurrentLod);
+		const UINT submeshCount = m_Mesh->GetSubmeshCount();
+		const std::vector<Meshlet>& meshlets = m_Mesh->GetMeshlets();
+		if (meshlets.empty() || m_CurrentLod != 0)
+		{
+			// The submeshes of a LOD are contiguous, so a merged draw is the LOD's whole range
+			D3D12_INDEX_BUFFER_VIEW view = m_Mesh->GetIndexBufferView();
+			if (mergeSubmeshes)
+			{
+				if (GetIndexCount() > 0)
+					m_Draws.push_back({ view, GetIndexCount(), GetStartIndex(), 0 });
+				return m_Draws;
+			}
+			for (UINT i = 0; i < submeshCount; i++)
+			{
+				if (submeshes[i].IndexCount > 0)
+					m_Draws.push_back({ view, submeshes[i].IndexCount, submeshes[i].IndexOffset, submeshes[i].MaterialSlot });
+			}
+			return m_Draws;
+		}
+
+		// Culling runs in object space, so only the viewer has to be transformed
+		DirectX::XMFLOAT3 objectViewPosition;
+		if (viewPosition)
+		{
+			DirectX::XMMATRIX inverseModel = DirectX::XMMatrixInverse(nullptr, m_ModelMatrix);
+			DirectX::XMStoreFloat3(&objectViewPosition, DirectX::XMVector3TransformCoord(DirectX::XMLoadFloat3(viewPosition), inverseModel));
+		}
+		ClusterCuller::Cull(meshlets.data(), meshlets.size(), m_ModelMatrix * viewProjection, viewPosition ? &objectViewPosition : nullptr, m_VisibleMeshlets);
+
+		// Every submesh owns a contiguous meshlet range, so its survivors are a slice of the ascending visible list
+		D3D12_INDEX_BUFFER_VIEW view = m_ClusterIndexBuffer->GetIndexBufferView();
+		UINT indexStride = IndexBuffer::GetIndexStride(view.Format);
+		uint8_t* destination = static_cast<uint8_t*>(m_ClusterIndexBuffer->GetMappedData());
+		UINT indexCount = 0;
+		for (UINT i = 0; i < submeshCount; i++)
+		{
+			auto first = std::lower_bound(m_VisibleMeshlets.begin(), m_VisibleMeshlets.end(), submeshes[i].MeshletOffset);
+			auto last = std::lower_bound(first, m_VisibleMeshlets.end(), submeshes[i].MeshletOffset + submeshes[i].MeshletCount);
+			UINT submeshIndexCount = ClusterCuller::GatherIndices(meshlets.data(), m_VisibleMeshlets.data() + (first - m_VisibleMeshlets.begin()), last - first,
+				m_Mesh->GetClusterSourceIndices(), indexStride, destination + static_cast<size_t>(indexCount) * indexStride);
+			if (submeshIndexCount == 0)
+				continue;
+
+			if (mergeSubmeshes && !m_Draws.empty())
+				m_Draws.back().IndexCount += submeshIndexCount;
+			else
+				m_Draws.push_back({ view, submeshIndexCount, indexCount, submeshes[i].MaterialSlot });
+			indexCount += submeshIndexCount;
+		}
+		return m_Draws;
+	}
+
+	const std::vector<IndexedDraw>& RenderComponent::PrepareCameraDraw(bool mergeSubmeshes)
+	{
+		return PrepareDraw(m_RenderObjectData.ViewMatrix * m_RenderObjectData.ProjectionMatrix, &m_RenderObjectData.CameraPosition, mergeSubmeshes);
+	}
+
+	void RenderComponent::SelectLod(const Camera& camera, float viewportHeight)
+	{
+		m_CurrentLod = 0;
+		const std::vector<MeshLod>& lods = m_Mesh->GetLods();
+		if (lods.size() <= 1)
+			return;
+
+		DirectX::BoundingSphere localSphere, worldSphere;
+		DirectX::BoundingSphere::CreateFromBoundingBox(localSphere, m_Mesh->GetBounds());
+		localSphere.Transform(worldSphere, m_ModelMatrix);
+		const float scale = localSphere.Radius > 0.0f ? worldSphere.Radius / localSphere.Radius : 1.0f;
+
+		// Distance to the closest point of the bounds, so the error is never underestimated
+		DirectX::XMFLOAT3 cameraPosition = camera.GetPosition();
+		float distance = DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&worldSphere.Center), DirectX::XMLoadFloat3(&cameraPosition))));
+		distance -= worldSphere.Radius;
+
+		for (UINT lod = static_cast<UINT>(lods.size()) - 1; lod > 0; lod--)
+		{
+			if (camera.GetScreenSpaceError(lods[lod].Error * scale, distance, viewportHeight) <= LOD_SCREEN_SPACE_ERROR_PIXELS)
+			{
+				m_CurrentLod = lod;
+				return;
+			}
+		}
+	}
+
+	void RenderComponent::RequestTextureDetail(const Camera& camera, float viewportHeight)
+	{
+		if (m_Materials.empty())
+			return;
+
+		DirectX::BoundingSphere localSphere, worldSphere;
+		DirectX::BoundingSphere::CreateFromBoundingBox(localSphere, m_Mesh->GetBounds());
+		localSphere.Transform(worldSphere, m_ModelMatrix);
+
+		// Diameter seen from the closest point of the bounds, so the detail is never underestimated
+		DirectX::XMFLOAT3 cameraPosition = camera.GetPosition();
+		float distance = DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&worldSphere.Center), DirectX::XMLoadFloat3(&cameraPosition))));
+		distance -= worldSphere.Radius;
+		const float pixels = camera.GetScreenSpaceError(2.0f * worldSphere.Radius, distance, viewportHeight);
+
+		for (const std::shared_ptr<Material>& material : m_Materials)
+		{
+			if (material)
+				material->RequestScreenSize(pixels);
+		}
 	}
 
 	void RenderComponent::Move(DirectX::XMFLOAT3 movement)
@@ -56,6 +188,9 @@ namespace DX12Engine
 		m_RenderObjectData.InvViewMatrix = DirectX::XMMatrixInverse(nullptr, viewMatrix);
 		m_RenderObjectData.InvProjectionMatrix = DirectX::XMMatrixInverse(nullptr, projectionMatrix);
 		m_RenderObjectData.CameraPosition = cameraPosition;
+		const VertexQuantization& quantization = m_Mesh->GetQuantization();
+		m_RenderObjectData.PositionScale = DirectX::XMFLOAT4(quantization.Scale.x, quantization.Scale.y, quantization.Scale.z, 0.0f);
+		m_RenderObjectData.PositionOffset = DirectX::XMFLOAT4(quantization.Offset.x, quantization.Offset.y, quantization.Offset.z, 0.0f);
 		m_ConstantBuffer->Update(&m_RenderObjectData, sizeof(RenderComponentData));
 	}
 
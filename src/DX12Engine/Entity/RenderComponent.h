@@ -1,7 +1,8 @@
 #pragma once
 #include "Component.h"
 #include "../Resources/Mesh.h"
-#include "../Rendering/Buffers/VertexBuffer.h"
+#include "../Resources/MeshAsset.h"
+#include "../IO/MeshCache.h"
 #include "../Rendering/Buffers/IndexBuffer.h"
 #include "../Rendering/Buffers/ConstantBuffer.h"
 #include "../Resources/Materials/Material.h"
@@ -19,9 +20,21 @@ namespace DX12Engine
 		DirectX::XMMATRIX InvProjectionMatrix;
 		DirectX::XMFLOAT3 CameraPosition;
 		float Padding;
+		DirectX::XMFLOAT4 PositionScale; // Dequantization of compact vertex positions, identity for full vertices
+		DirectX::XMFLOAT4 PositionOffset;
+	};
+
+	// Index buffer and range to draw for one view
+	struct IndexedDraw
+	{
+		D3D12_INDEX_BUFFER_VIEW IndexBufferView;
+		UINT IndexCount;
+		UINT StartIndex;
+		UINT MaterialSlot;
 	};
 
 	class GameObject;
+	class Camera;
 
 	class RenderComponent : public Component
 	{
@@ -32,32 +45,63 @@ namespace DX12Engine
 		RenderComponent(GameObject* parent);
 		~RenderComponent();
 
-		void SetMesh(Mesh mesh);
+		// Objects drawing the same asset share its vertex and index buffers, see ResourceManager::LoadMesh
+		void SetMesh(std::shared_ptr<MeshAsset> mesh);
+		// Uploads a mesh only this object uses
+		void SetMesh(const Mesh& mesh) { SetMesh(std::make_shared<MeshAsset>(mesh)); }
+		void SetMesh(const CookedMesh& mesh) { SetMesh(std::make_shared<MeshAsset>(mesh)); }
 		void SetModelMatrix(DirectX::XMMATRIX modelMatrix) { m_ModelMatrix = modelMatrix; }	
-		void SetMaterial(std::shared_ptr<Material> material) { m_Material = material; }
+		void SetMaterial(std::shared_ptr<Material> material) { SetMaterial(0, material); }
+		void SetMaterial(UINT slot, std::shared_ptr<Material> material);
 
 		void Move(DirectX::XMFLOAT3 movement);
 		void Scale(DirectX::XMFLOAT3 newScale);
 		void Rotate(DirectX::XMFLOAT3 rotation);
 
-		Material* GetMaterial() { return m_Material.get(); }	
+		// Slots without a material of their own fall back to slot 0
+		Material* GetMaterial(UINT slot = 0);
 		DirectX::XMMATRIX GetModelMatrix() { return m_ModelMatrix; }
 		D3D12_GPU_VIRTUAL_ADDRESS GetCBVAddress() { return m_ConstantBuffer->GetGPUAddress(); }
 
-		D3D12_VERTEX_BUFFER_VIEW GetVertexBufferView() { return m_VertexBuffer->GetVertexBufferView(); }
-		D3D12_INDEX_BUFFER_VIEW GetIndexBufferView() { return m_IndexBuffer->GetIndexBufferView(); }
+		MeshAsset* GetMesh() { return m_Mesh.get(); }
+		// Slot 0 holds positions only, slot 1 the remaining attributes
+		D3D12_VERTEX_BUFFER_VIEW GetPositionBufferView() { return m_Mesh->GetPositionBufferView(); }
+		D3D12_VERTEX_BUFFER_VIEW GetAttributeBufferView() { return m_Mesh->GetAttributeBufferView(); }
+		D3D12_INDEX_BUFFER_VIEW GetIndexBufferView() { return m_Mesh->GetIndexBufferView(); }
+		// Index range of the LOD picked by the last SelectLod call
+		UINT GetIndexCount() const { return m_Mesh->GetLods()[m_CurrentLod].IndexCount; }
+		UINT GetStartIndex() const { return m_Mesh->GetLods()[m_CurrentLod].IndexOffset; }
+		UINT GetCurrentLod() const { return m_CurrentLod; }
+
+		// Culls the meshlets of LOD 0 against the view (viewPosition in world space, nullptr skips backface culling) and
+		// writes the survivors to the cluster index buffer, which stays valid until the next call. Coarser LODs and meshes
+		// without meshlets draw their whole range. Returns one draw per non-empty submesh, or a single draw when
+		// mergeSubmeshes is set for passes that ignore materials
+		const std::vector<IndexedDraw>& PrepareDraw(const DirectX::XMMATRIX& viewProjection, const DirectX::XMFLOAT3* viewPosition, bool mergeSubmeshes = false);
+		// Same with the camera passed to the last constant buffer update
+		const std::vector<IndexedDraw>& PrepareCameraDraw(bool mergeSubmeshes = false);
+		VertexFormat GetVertexFormat() const { return m_Mesh->GetVertexFormat(); }
+		const VertexQuantization& GetQuantization() const { return m_Mesh->GetQuantization(); }
 
 	private:
+		// Picks the coarsest LOD whose error projects to at most LOD_SCREEN_SPACE_ERROR_PIXELS
+		void SelectLod(const Camera& camera, float viewportHeight);
+		// Reports the projected size of the bounds to the materials, which drives texture streaming
+		void RequestTextureDetail(const Camera& camera, float viewportHeight);
 		void UpdateConstantBufferData(DirectX::XMMATRIX viewMatrix, DirectX::XMMATRIX projectionMatrix, DirectX::XMFLOAT3 cameraPosition);
 		void UpdateModelMatrix();
 
-		Mesh m_Mesh;
-		std::unique_ptr<VertexBuffer> m_VertexBuffer;
-		std::unique_ptr<IndexBuffer> m_IndexBuffer;
+		std::shared_ptr<MeshAsset> m_Mesh;
 		std::unique_ptr<ConstantBuffer> m_ConstantBuffer;
+		UINT m_CurrentLod;
+		std::vector<IndexedDraw> m_Draws;
+
+		// Culling is per view and object, so the surviving cluster indices can't live in the shared asset
+		std::unique_ptr<IndexBuffer> m_ClusterIndexBuffer;
+		std::vector<UINT> m_VisibleMeshlets;
 		RenderComponentData m_RenderObjectData;
 		DirectX::XMMATRIX m_ModelMatrix;
-		std::shared_ptr<Material> m_Material;
+		std::vector<std::shared_ptr<Material>> m_Materials;
 
 		DirectX::XMVECTOR m_Position;
 		DirectX::XMVECTOR m_Scale;
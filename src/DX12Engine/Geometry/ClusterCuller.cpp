@@ -0,0 +1,84 @@
+#include "ClusterCuller.h"
+#include <cmath>
+#include <cstring>
+
+namespace DX12Engine
+{
+	void ClusterCuller::ExtractFrustumPlanes(const DirectX::XMMATRIX& objectToClip, DirectX::XMFLOAT4 planes[6])
+	{
+		// Gribb-Hartmann: with clip = p * M, each plane is a combination of the matrix columns
+		DirectX::XMFLOAT4X4 m;
+		DirectX::XMStoreFloat4x4(&m, objectToClip);
+		const DirectX::XMFLOAT4 x = { m._11, m._21, m._31, m._41 };
+		const DirectX::XMFLOAT4 y = { m._12, m._22, m._32, m._42 };
+		const DirectX::XMFLOAT4 z = { m._13, m._23, m._33, m._43 };
+		const DirectX::XMFLOAT4 w = { m._14, m._24, m._34, m._44 };
+
+		planes[0] = { w.x + x.x, w.y + x.y, w.z + x.z, w.w + x.w };
+		planes[1] = { w.x - x.x, w.y - x.y, w.z - x.z, w.w - x.w };
+		planes[2] = { w.x + y.x, w.y + y.y, w.z + y.z, w.w + y.w };
+		planes[3] = { w.x - y.x, w.y - y.y, w.z - y.z, w.w - y.w };
+		planes[4] = z;
+		planes[5] = { w.x - z.x, w.y - z.y, w.z - z.z, w.w - z.w };
+
+		for (int i = 0; i < 6; i++)
+		{
+			float length = std::sqrt(planes[i].x * planes[i].x + planes[i].y * planes[i].y + planes[i].z * planes[i].z);
+			if (length > 0.0f)
+				planes[i] = { planes[i].x / length, planes[i].y / length, planes[i].z / length, planes[i].w / length };
+		}
+	}
+
+	bool ClusterCuller::IsVisible(const Meshlet& meshlet, const DirectX::XMFLOAT4 planes[6], const DirectX::XMFLOAT3* viewPosition)
+	{
+		const DirectX::XMFLOAT3& c = meshlet.Center;
+		for (int i = 0; i < 6; i++)
+		{
+			if (planes[i].x * c.x + planes[i].y * c.y + planes[i].z * c.z + planes[i].w < -meshlet.Radius)
+				return false;
+		}
+
+		if (viewPosition)
+		{
+			DirectX::XMFLOAT3 toCenter = { c.x - viewPosition->x, c.y - viewPosition->y, c.z - viewPosition->z };
+			float distance = std::sqrt(toCenter.x * toCenter.x + toCenter.y * toCenter.y + toCenter.z * toCenter.z);
+			float facing = toCenter.x * meshlet.ConeAxis.x + toCenter.y * meshlet.ConeAxis.y + toCenter.z * meshlet.ConeAxis.z;
+			if (facing >= meshlet.ConeCutoff * distance + meshlet.Radius)
+				return false;
+		}
+		return true;
+	}
+
+	void ClusterCuller::Cull(const Meshlet* meshlets, size_t meshletCount, const DirectX::XMMATRIX& objectToClip, const DirectX::XMFLOAT3* viewPosition,
+		std::vector<UINT>& visibleMeshlets)
+	{
+		DirectX::XMFLOAT4 planes[6];
+		ExtractFrustumPlanes(objectToClip, planes);
+
+		visibleMeshlets.clear();
+		for (UINT i = 0; i < meshletCount; i++)
+		{
+			if (IsVisible(meshlets[i], planes, viewPosition))
+				visibleMeshlets.push_back(i);
+		}
+	}
+
+	UINT ClusterCuller::GatherIndices(const Meshlet* meshlets, const UINT* visibleMeshlets, size_t visibleCount, const void* sourceIndices, UINT indexStride, void* destination)
+	{
+		const uint8_t* source = static_cast<const uint8_t*>(sourceIndices);
+		uint8_t* target = static_cast<uint8_t*>(destination);
+		UINT indexCount = 0;
+		for (size_t i = 0; i < visibleCount;)
+		{
+			// Meshlets partition the index buffer in order, so consecutive visible meshlets form one contiguous run
+			UINT runStart = meshlets[visibleMeshlets[i]].IndexOffset;
+			UINT runCount = meshlets[visibleMeshlets[i]].IndexCount;
+			for (i++; i < visibleCount && visibleMeshlets[i] == visibleMeshlets[i - 1] + 1; i++)
+				runCount += meshlets[visibleMeshlets[i]].IndexCount;
+
+			memcpy(target + static_cast<size_t>(indexCount) * indexStride, source + static_cast<size_t>(runStart) * indexStride, static_cast<size_t>(runCount) * indexStride);
+			indexCount += runCount;
+		}
+		return indexCount;
+	}
+}
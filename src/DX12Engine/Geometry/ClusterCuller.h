@@ -0,0 +1,26 @@
+#pragma once
+#include <DirectXMath.h>
+#include <vector>
+#include "../Resources/Mesh.h"
+
+namespace DX12Engine
+{
+	// CPU meshlet culling against a view frustum and the meshlet normal cones. Everything runs in object space, so the only
+	// per-object work is extracting the planes from the object to clip matrix
+	class ClusterCuller
+	{
+	public:
+		// Left, right, bottom, top, near, far planes of a row-vector object to clip matrix with D3D's [0, 1] depth range,
+		// normalized so plane distances are in object space units
+		static void ExtractFrustumPlanes(const DirectX::XMMATRIX& objectToClip, DirectX::XMFLOAT4 planes[6]);
+
+		// viewPosition is in object space, nullptr skips the backface cone test (e.g. for passes that render both faces)
+		static bool IsVisible(const Meshlet& meshlet, const DirectX::XMFLOAT4 planes[6], const DirectX::XMFLOAT3* viewPosition);
+		static void Cull(const Meshlet* meshlets, size_t meshletCount, const DirectX::XMMATRIX& objectToClip, const DirectX::XMFLOAT3* viewPosition,
+			std::vector<UINT>& visibleMeshlets);
+
+		// Copies the index runs of the ascending visible meshlet list into destination, merging adjacent runs. Returns the
+		// index count
+		static UINT GatherIndices(const Meshlet* meshlets, const UINT* visibleMeshlets, size_t visibleCount, const void* sourceIndices, UINT indexStride, void* destination);
+	};
+}
@@ -0,0 +1,318 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace DX12Engine
+{
+	static constexpr UINT InvalidIndex = 0xFFFFFFFF;
+
+	// Triangles adjacent to each vertex, stored as offsets into one flat array
+	struct VertexAdjacency
+	{
+		std::vector<UINT> Counts;
+		std::vector<UINT> Offsets;
+		std::vector<UINT> Triangles;
+
+		VertexAdjacency(const UINT* indices, size_t indexCount, size_t vertexCount)
+			: Counts(vertexCount, 0), Offsets(vertexCount, 0), Triangles(indexCount)
+		{
+			for (size_t i = 0; i < indexCount; i++)
+				Counts[indices[i]]++;
+
+			UINT offset = 0;
+			for (size_t v = 0; v < vertexCount; v++)
+			{
+				Offsets[v] = offset;
+				offset += Counts[v];
+			}
+
+			std::vector<UINT> cursor(Offsets);
+			for (size_t i = 0; i < indexCount; i++)
+				Triangles[cursor[indices[i]]++] = static_cast<UINT>(i / 3);
+		}
+	};
+
+	MeshOptimizationStatistics MeshOptimizer::Optimize(Mesh& mesh, UINT cacheSize, float overdrawThreshold)
+	{
+		MeshOptimizationStatistics statistics;
+		if (mesh.Indices.empty())
+			return statistics;
+
+		const size_t vertexCount = mesh.Vertices.size();
+		statistics.Before = AnalyzeVertexCache(mesh.Indices.data(), mesh.Indices.size(), vertexCount, cacheSize);
+
+		// Triangles are only reordered within their submesh so material ranges stay intact
+		std::vector<Submesh> ranges = mesh.Submeshes;
+		if (ranges.empty())
+			ranges.push_back({ 0, static_cast<UINT>(mesh.Indices.size()), 0, 0, 0 });
+		for (const Submesh& range : ranges)
+		{
+			if (range.IndexCount == 0)
+				continue;
+			UINT* indices = mesh.Indices.data() + range.IndexOffset;
+			std::vector<UINT> clusterStarts;
+			OptimizeVertexCache(indices, range.IndexCount, vertexCount, cacheSize, &clusterStarts);
+			OptimizeOverdraw(indices, range.IndexCount, &mesh.Vertices[0].Position, sizeof(Vertex), vertexCount,
+				clusterStarts, cacheSize, overdrawThreshold);
+		}
+		OptimizeVertexFetch(mesh);
+
+		statistics.After = AnalyzeVertexCache(mesh.Indices.data(), mesh.Indices.size(), mesh.Vertices.size(), cacheSize);
+		return statistics;
+	}
+
+	VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(const UINT* indices, size_t indexCount, size_t vertexCount, UINT cacheSize)
+	{
+		VertexCacheStatistics statistics;
+		if (indexCount < 3)
+			return statistics;
+
+		// A vertex is cached while fewer than cacheSize misses happened since it was inserted
+		std::vector<UINT> cacheTime(vertexCount, 0);
+		std::vector<bool> referenced(vertexCount, false);
+		UINT time = cacheSize + 1;
+		UINT referencedCount = 0;
+
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			UINT v = indices[i];
+			if (time - cacheTime[v] > cacheSize)
+			{
+				cacheTime[v] = time++;
+				statistics.VerticesTransformed++;
+			}
+			if (!referenced[v])
+			{
+				referenced[v] = true;
+				referencedCount++;
+			}
+		}
+
+		statistics.ACMR = static_cast<float>(statistics.VerticesTransformed) / static_cast<float>(indexCount / 3);
+		statistics.ATVR = static_cast<float>(statistics.VerticesTransformed) / static_cast<float>(referencedCount);
+		return statistics;
+	}
+
+	void MeshOptimizer::OptimizeVertexCache(UINT* indices, size_t indexCount, size_t vertexCount, UINT cacheSize, std::vector<UINT>* clusterStarts)
+	{
+		const size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0)
+			return;
+
+		VertexAdjacency adjacency(indices, triangleCount * 3, vertexCount);
+		std::vector<UINT> liveTriangles(adjacency.Counts);
+		std::vector<UINT> cacheTime(vertexCount, 0);
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<UINT> deadEnds;
+		std::vector<UINT> candidates;
+		std::vector<UINT> output;
+		output.reserve(triangleCount * 3);
+		deadEnds.reserve(triangleCount * 3);
+
+		UINT time = cacheSize + 1;
+		UINT cursor = 0;
+		UINT fanVertex = 0;
+		bool startsCluster = true;
+
+		// Next vertex to fan around when the current one runs dry: the dead-end stack first, then input order
+		auto skipDeadEnd = [&]() -> UINT
+		{
+			while (!deadEnds.empty())
+			{
+				UINT v = deadEnds.back();
+				deadEnds.pop_back();
+				if (liveTriangles[v] > 0)
+					return v;
+			}
+			while (cursor < vertexCount)
+			{
+				if (liveTriangles[cursor] > 0)
+					return cursor;
+				cursor++;
+			}
+			return InvalidIndex;
+		};
+
+		while (fanVertex < vertexCount && liveTriangles[fanVertex] == 0)
+			fanVertex++;
+		if (fanVertex == vertexCount)
+			return;
+
+		while (fanVertex != InvalidIndex)
+		{
+			if (startsCluster && clusterStarts)
+				clusterStarts->push_back(static_cast<UINT>(output.size() / 3));
+			startsCluster = false;
+
+			candidates.clear();
+			const UINT begin = adjacency.Offsets[fanVertex];
+			const UINT end = begin + adjacency.Counts[fanVertex];
+			for (UINT a = begin; a < end; a++)
+			{
+				UINT triangle = adjacency.Triangles[a];
+				if (emitted[triangle])
+					continue;
+				emitted[triangle] = true;
+
+				for (UINT corner = 0; corner < 3; corner++)
+				{
+					UINT v = indices[triangle * 3 + corner];
+					output.push_back(v);
+					deadEnds.push_back(v);
+					candidates.push_back(v);
+					liveTriangles[v]--;
+					if (time - cacheTime[v] > cacheSize)
+						cacheTime[v] = time++;
+				}
+			}
+
+			// Prefer the candidate that entered the cache earliest and will still be resident after its remaining fans
+			UINT bestVertex = InvalidIndex;
+			int bestPriority = -1;
+			for (UINT v : candidates)
+			{
+				if (liveTriangles[v] == 0)
+					continue;
+				int priority = 0;
+				if (time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize)
+					priority = static_cast<int>(time - cacheTime[v]);
+				if (priority > bestPriority)
+				{
+					bestPriority = priority;
+					bestVertex = v;
+				}
+			}
+
+			if (bestVertex == InvalidIndex)
+			{
+				bestVertex = skipDeadEnd();
+				startsCluster = true;
+			}
+			fanVertex = bestVertex;
+		}
+
+		std::copy(output.begin(), output.end(), indices);
+	}
+
+	void MeshOptimizer::OptimizeOverdraw(UINT* indices, size_t indexCount, const DirectX::XMFLOAT3* positions, size_t positionStride, size_t vertexCount,
+		const std::vector<UINT>& clusterStarts, UINT cacheSize, float threshold)
+	{
+		const size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0 || clusterStarts.empty())
+			return;
+
+		auto position = [&](UINT v) -> DirectX::XMVECTOR
+		{
+			return DirectX::XMLoadFloat3(reinterpret_cast<const DirectX::XMFLOAT3*>(reinterpret_cast<const uint8_t*>(positions) + positionStride * v));
+		};
+
+		// Soft boundaries: split a hard cluster wherever its own ACMR, simulated from a cold cache, is already within
+		// threshold of the whole mesh, since a cache flush there costs little
+		const float targetACMR = AnalyzeVertexCache(indices, triangleCount * 3, vertexCount, cacheSize).ACMR * threshold;
+		std::vector<UINT> clusters;
+		std::vector<UINT> cacheTime(vertexCount, 0);
+		UINT time = cacheSize + 1;
+		for (size_t c = 0; c < clusterStarts.size(); c++)
+		{
+			const UINT clusterEnd = c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : static_cast<UINT>(triangleCount);
+			UINT start = clusterStarts[c];
+			UINT misses = 0;
+			clusters.push_back(start);
+			time += cacheSize + 1;
+
+			for (UINT t = start; t < clusterEnd; t++)
+			{
+				for (UINT corner = 0; corner < 3; corner++)
+				{
+					UINT v = indices[t * 3 + corner];
+					if (time - cacheTime[v] > cacheSize)
+					{
+						cacheTime[v] = time++;
+						misses++;
+					}
+				}
+
+				const UINT clusterTriangles = t + 1 - start;
+				if (t + 1 < clusterEnd && clusterTriangles >= cacheSize && static_cast<float>(misses) / clusterTriangles <= targetACMR)
+				{
+					start = t + 1;
+					misses = 0;
+					clusters.push_back(start);
+					time += cacheSize + 1;
+				}
+			}
+		}
+
+		// Clusters facing away from the mesh centroid are likely to occlude the rest, draw them first
+		DirectX::XMVECTOR meshCentroid = DirectX::XMVectorZero();
+		float meshArea = 0.0f;
+		std::vector<DirectX::XMFLOAT4> clusterCentroids(clusters.size());
+		std::vector<DirectX::XMFLOAT3> clusterNormals(clusters.size());
+		for (size_t c = 0; c < clusters.size(); c++)
+		{
+			const UINT clusterEnd = c + 1 < clusters.size() ? clusters[c + 1] : static_cast<UINT>(triangleCount);
+			DirectX::XMVECTOR centroid = DirectX::XMVectorZero();
+			DirectX::XMVECTOR normal = DirectX::XMVectorZero();
+			float area = 0.0f;
+			for (UINT t = clusters[c]; t < clusterEnd; t++)
+			{
+				DirectX::XMVECTOR p0 = position(indices[t * 3]);
+				DirectX::XMVECTOR p1 = position(indices[t * 3 + 1]);
+				DirectX::XMVECTOR p2 = position(indices[t * 3 + 2]);
+				DirectX::XMVECTOR faceNormal = DirectX::XMVector3Cross(DirectX::XMVectorSubtract(p1, p0), DirectX::XMVectorSubtract(p2, p0));
+				float faceArea = DirectX::XMVectorGetX(DirectX::XMVector3Length(faceNormal)) * 0.5f;
+				DirectX::XMVECTOR faceCentroid = DirectX::XMVectorScale(DirectX::XMVectorAdd(DirectX::XMVectorAdd(p0, p1), p2), 1.0f / 3.0f);
+
+				centroid = DirectX::XMVectorAdd(centroid, DirectX::XMVectorScale(faceCentroid, faceArea));
+				normal = DirectX::XMVectorAdd(normal, faceNormal);
+				area += faceArea;
+			}
+
+			meshCentroid = DirectX::XMVectorAdd(meshCentroid, centroid);
+			meshArea += area;
+			if (area > 0.0f)
+				centroid = DirectX::XMVectorScale(centroid, 1.0f / area);
+			DirectX::XMStoreFloat4(&clusterCentroids[c], centroid);
+			DirectX::XMStoreFloat3(&clusterNormals[c], DirectX::XMVector3Normalize(normal));
+		}
+		if (meshArea > 0.0f)
+			meshCentroid = DirectX::XMVectorScale(meshCentroid, 1.0f / meshArea);
+
+		std::vector<float> sortKeys(clusters.size());
+		std::vector<UINT> order(clusters.size());
+		for (size_t c = 0; c < clusters.size(); c++)
+		{
+			DirectX::XMVECTOR offset = DirectX::XMVectorSubtract(DirectX::XMLoadFloat4(&clusterCentroids[c]), meshCentroid);
+			sortKeys[c] = DirectX::XMVectorGetX(DirectX::XMVector3Dot(offset, DirectX::XMLoadFloat3(&clusterNormals[c])));
+			order[c] = static_cast<UINT>(c);
+		}
+		std::stable_sort(order.begin(), order.end(), [&](UINT a, UINT b) { return sortKeys[a] > sortKeys[b]; });
+
+		std::vector<UINT> output;
+		output.reserve(triangleCount * 3);
+		for (UINT c : order)
+		{
+			const UINT clusterEnd = c + 1 < clusters.size() ? clusters[c + 1] : static_cast<UINT>(triangleCount);
+			output.insert(output.end(), indices + clusters[c] * 3, indices + clusterEnd * 3);
+		}
+		std::copy(output.begin(), output.end(), indices);
+	}
+
+	void MeshOptimizer::OptimizeVertexFetch(Mesh& mesh)
+	{
+		std::vector<UINT> remap(mesh.Vertices.size(), InvalidIndex);
+		std::vector<Vertex> vertices;
+		vertices.reserve(mesh.Vertices.size());
+
+		for (UINT& index : mesh.Indices)
+		{
+			if (remap[index] == InvalidIndex)
+			{
+				remap[index] = static_cast<UINT>(vertices.size());
+				vertices.push_back(mesh.Vertices[index]);
+			}
+			index = remap[index];
+		}
+		mesh.Vertices.swap(vertices);
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <DirectXMath.h>
+#include <vector>
+#include "../Resources/Mesh.h"
+
+namespace DX12Engine
+{
+	// Post-transform cache behaviour of an index stream under a simulated FIFO cache
+	struct VertexCacheStatistics
+	{
+		UINT VerticesTransformed = 0;
+		float ACMR = 0.0f; // Transformed vertices per triangle, 0.5 is the ideal for a large regular grid
+		float ATVR = 0.0f; // Transformed vertices per referenced vertex, 1.0 is the ideal
+	};
+
+	struct MeshOptimizationStatistics
+	{
+		VertexCacheStatistics Before;
+		VertexCacheStatistics After;
+	};
+
+	// Import-time triangle and vertex reordering: Tipsify for the post-transform cache, cluster sorting for overdraw and
+	// first-use ordering for vertex fetch
+	class MeshOptimizer
+	{
+	public:
+		// Runs all three stages in order and returns the cache statistics before and after
+		static MeshOptimizationStatistics Optimize(Mesh& mesh, UINT cacheSize, float overdrawThreshold);
+
+		static VertexCacheStatistics AnalyzeVertexCache(const UINT* indices, size_t indexCount, size_t vertexCount, UINT cacheSize);
+
+		// Tipsify (Sander et al. 2007). Fills clusterStarts with the first triangle of each run started from a dead end
+		static void OptimizeVertexCache(UINT* indices, size_t indexCount, size_t vertexCount, UINT cacheSize, std::vector<UINT>* clusterStarts = nullptr);
+		// Splits the cache optimized clusters further where locality allows it (ACMR within threshold of the whole mesh)
+		// and sorts them so outward facing clusters are drawn first
+		static void OptimizeOverdraw(UINT* indices, size_t indexCount, const DirectX::XMFLOAT3* positions, size_t positionStride, size_t vertexCount,
+			const std::vector<UINT>& clusterStarts, UINT cacheSize, float threshold);
+		// Renumbers vertices in order of first use and drops unreferenced ones
+		static void OptimizeVertexFetch(Mesh& mesh);
+	};
+}
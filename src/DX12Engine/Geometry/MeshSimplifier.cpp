@@ -0,0 +1,366 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "../Utils/Constants.h"
+#include <queue>
+#include <unordered_map>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <climits>
+
+namespace DX12Engine
+{
+	// Symmetric 4x4 plane quadric plus the accumulated area it was weighted by
+	struct Quadric
+	{
+		double A2 = 0, AB = 0, AC = 0, AD = 0, B2 = 0, BC = 0, BD = 0, C2 = 0, CD = 0, D2 = 0;
+		double Weight = 0;
+
+		void AddPlane(double a, double b, double c, double d, double weight)
+		{
+			A2 += a * a * weight; AB += a * b * weight; AC += a * c * weight; AD += a * d * weight;
+			B2 += b * b * weight; BC += b * c * weight; BD += b * d * weight;
+			C2 += c * c * weight; CD += c * d * weight;
+			D2 += d * d * weight;
+			Weight += weight;
+		}
+
+		void Add(const Quadric& other)
+		{
+			A2 += other.A2; AB += other.AB; AC += other.AC; AD += other.AD;
+			B2 += other.B2; BC += other.BC; BD += other.BD;
+			C2 += other.C2; CD += other.CD;
+			D2 += other.D2;
+			Weight += other.Weight;
+		}
+
+		// Weighted sum of squared distances to the planes
+		double Evaluate(const DirectX::XMFLOAT3& p) const
+		{
+			const double x = p.x, y = p.y, z = p.z;
+			return A2 * x * x + 2 * AB * x * y + 2 * AC * x * z + 2 * AD * x
+				+ B2 * y * y + 2 * BC * y * z + 2 * BD * y
+				+ C2 * z * z + 2 * CD * z
+				+ D2;
+		}
+	};
+
+	struct Collapse
+	{
+		double Cost;
+		UINT From;
+		UINT To;
+		UINT FromVersion;
+		UINT ToVersion;
+
+		bool operator>(const Collapse& other) const { return Cost > other.Cost; }
+	};
+
+	static uint64_t EdgeKey(UINT a, UINT b)
+	{
+		return a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a;
+	}
+
+	static DirectX::XMVECTOR TriangleNormal(const DirectX::XMFLOAT3& p0, const DirectX::XMFLOAT3& p1, const DirectX::XMFLOAT3& p2)
+	{
+		DirectX::XMVECTOR v0 = DirectX::XMLoadFloat3(&p0);
+		return DirectX::XMVector3Cross(DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&p1), v0), DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&p2), v0));
+	}
+
+	std::vector<UINT> MeshSimplifier::Simplify(const DirectX::XMFLOAT3* positions, size_t positionStride, size_t vertexCount,
+		const UINT* indices, size_t indexCount, size_t targetIndexCount, float targetError, float* resultError)
+	{
+		auto position = [&](UINT v) -> const DirectX::XMFLOAT3&
+		{
+			return *reinterpret_cast<const DirectX::XMFLOAT3*>(reinterpret_cast<const uint8_t*>(positions) + positionStride * v);
+		};
+
+		const size_t triangleCount = indexCount / 3;
+		std::vector<UINT> triangles(indices, indices + triangleCount * 3);
+		std::vector<bool> triangleAlive(triangleCount, true);
+		size_t aliveCount = triangleCount;
+		if (resultError)
+			*resultError = 0.0f;
+
+		// Vertices sharing a position (attribute seams) are welded into one position class for quadrics and topology, the
+		// first vertex at a position represents the class
+		std::vector<UINT> positionRemap(vertexCount);
+		{
+			std::unordered_map<uint64_t, UINT> firstAtPosition;
+			firstAtPosition.reserve(vertexCount);
+			for (UINT v = 0; v < vertexCount; v++)
+			{
+				const DirectX::XMFLOAT3& p = position(v);
+				uint32_t bits[3];
+				memcpy(bits, &p, sizeof(bits));
+				uint64_t key = (uint64_t)bits[0] * 0x9E3779B97F4A7C15ull ^ (uint64_t)bits[1] * 0xC2B2AE3D27D4EB4Full ^ (uint64_t)bits[2] * 0x165667B19E3779F9ull;
+
+				// Different positions that collide on the hash probe the following keys until they find their own class
+				for (;; key++)
+				{
+					auto [it, inserted] = firstAtPosition.try_emplace(key, v);
+					if (inserted || memcmp(&position(it->second), &p, sizeof(p)) == 0)
+					{
+						positionRemap[v] = it->second;
+						break;
+					}
+				}
+			}
+		}
+
+		// Edges not shared by exactly two triangles are borders or non-manifold, their positions stay put
+		std::vector<bool> locked(vertexCount, false);
+		{
+			std::unordered_map<uint64_t, UINT> edgeUse;
+			edgeUse.reserve(triangleCount * 3);
+			for (size_t t = 0; t < triangleCount; t++)
+			{
+				for (UINT e = 0; e < 3; e++)
+					edgeUse[EdgeKey(positionRemap[triangles[t * 3 + e]], positionRemap[triangles[t * 3 + (e + 1) % 3]])]++;
+			}
+			for (size_t t = 0; t < triangleCount; t++)
+			{
+				for (UINT e = 0; e < 3; e++)
+				{
+					UINT a = positionRemap[triangles[t * 3 + e]];
+					UINT b = positionRemap[triangles[t * 3 + (e + 1) % 3]];
+					if (edgeUse[EdgeKey(a, b)] != 2)
+					{
+						locked[a] = true;
+						locked[b] = true;
+					}
+				}
+			}
+		}
+
+		// Quadrics, versions and triangle lists are kept per position class
+		std::vector<Quadric> quadrics(vertexCount);
+		std::vector<std::vector<UINT>> vertexTriangles(vertexCount);
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			const UINT i0 = triangles[t * 3], i1 = triangles[t * 3 + 1], i2 = triangles[t * 3 + 2];
+			DirectX::XMVECTOR normal = TriangleNormal(position(i0), position(i1), position(i2));
+			float area = DirectX::XMVectorGetX(DirectX::XMVector3Length(normal)) * 0.5f;
+			for (UINT corner = 0; corner < 3; corner++)
+				vertexTriangles[positionRemap[triangles[t * 3 + corner]]].push_back(static_cast<UINT>(t));
+			if (area <= 0.0f)
+				continue;
+
+			DirectX::XMFLOAT3 n;
+			DirectX::XMStoreFloat3(&n, DirectX::XMVector3Normalize(normal));
+			const DirectX::XMFLOAT3& p = position(i0);
+			double d = -(n.x * (double)p.x + n.y * (double)p.y + n.z * (double)p.z);
+			Quadric plane;
+			plane.AddPlane(n.x, n.y, n.z, d, area);
+			for (UINT corner = 0; corner < 3; corner++)
+				quadrics[positionRemap[triangles[t * 3 + corner]]].Add(plane);
+		}
+
+		std::vector<UINT> versions(vertexCount, 0);
+		std::vector<bool> collapsed(vertexCount, false);
+		std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> heap;
+
+		// Error of moving from onto to, as the mean squared distance to the planes of both neighbourhoods
+		auto cost = [&](UINT from, UINT to) -> double
+		{
+			Quadric q = quadrics[from];
+			q.Add(quadrics[to]);
+			return q.Weight > 0.0 ? (std::max)(q.Evaluate(position(to)) / q.Weight, 0.0) : 0.0;
+		};
+		auto pushEdge = [&](UINT from, UINT to)
+		{
+			if (!locked[from] && from != to)
+				heap.push({ cost(from, to), from, to, versions[from], versions[to] });
+		};
+
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			for (UINT e = 0; e < 3; e++)
+			{
+				UINT a = positionRemap[triangles[t * 3 + e]];
+				UINT b = positionRemap[triangles[t * 3 + (e + 1) % 3]];
+				pushEdge(a, b);
+				pushEdge(b, a);
+			}
+		}
+
+		const double maxCost = (double)targetError * targetError;
+		double largestCost = 0.0;
+		std::vector<std::pair<UINT, UINT>> wedgeTargets;
+		while (aliveCount * 3 > targetIndexCount && !heap.empty())
+		{
+			Collapse collapse = heap.top();
+			heap.pop();
+			if (collapsed[collapse.From] || collapsed[collapse.To] || versions[collapse.From] != collapse.FromVersion || versions[collapse.To] != collapse.ToVersion)
+				continue;
+			if (collapse.Cost > maxCost)
+				break;
+
+			// Every vertex at the source position moves onto the one vertex at the target it shares a triangle with, so a
+			// seam vertex only slides along its seam and keeps the attributes on each side. A vertex next to none or
+			// several of them would drag the seam across a face and is rejected
+			bool valid = true;
+			wedgeTargets.clear();
+			for (UINT t : vertexTriangles[collapse.From])
+			{
+				if (!triangleAlive[t])
+					continue;
+				const UINT* tri = &triangles[t * 3];
+				for (UINT corner = 0; corner < 3 && valid; corner++)
+				{
+					if (positionRemap[tri[corner]] != collapse.From)
+						continue;
+					auto target = std::find_if(wedgeTargets.begin(), wedgeTargets.end(), [&](const std::pair<UINT, UINT>& w) { return w.first == tri[corner]; });
+					if (target == wedgeTargets.end())
+						target = wedgeTargets.insert(wedgeTargets.end(), { tri[corner], UINT_MAX });
+					for (UINT other = 0; other < 3; other++)
+					{
+						if (positionRemap[tri[other]] != collapse.To)
+							continue;
+						if (target->second != UINT_MAX && target->second != tri[other])
+							valid = false;
+						target->second = tri[other];
+					}
+				}
+			}
+			for (const std::pair<UINT, UINT>& target : wedgeTargets)
+				valid = valid && target.second != UINT_MAX;
+			if (!valid || wedgeTargets.empty())
+				continue;
+
+			// Reject collapses that flip or squash any triangle that survives
+			for (UINT t : vertexTriangles[collapse.From])
+			{
+				if (!triangleAlive[t])
+					continue;
+				UINT* tri = &triangles[t * 3];
+				if (positionRemap[tri[0]] == collapse.To || positionRemap[tri[1]] == collapse.To || positionRemap[tri[2]] == collapse.To)
+					continue;
+
+				DirectX::XMFLOAT3 p[3] = { position(tri[0]), position(tri[1]), position(tri[2]) };
+				DirectX::XMVECTOR before = TriangleNormal(p[0], p[1], p[2]);
+				for (UINT corner = 0; corner < 3; corner++)
+				{
+					if (positionRemap[tri[corner]] == collapse.From)
+						p[corner] = position(collapse.To);
+				}
+				DirectX::XMVECTOR after = TriangleNormal(p[0], p[1], p[2]);
+				float beforeLength = DirectX::XMVectorGetX(DirectX::XMVector3Length(before));
+				float afterLength = DirectX::XMVectorGetX(DirectX::XMVector3Length(after));
+				float dot = DirectX::XMVectorGetX(DirectX::XMVector3Dot(before, after));
+				if (afterLength <= 0.0f || dot < 0.25f * beforeLength * afterLength)
+				{
+					valid = false;
+					break;
+				}
+			}
+			if (!valid)
+				continue;
+
+			collapsed[collapse.From] = true;
+			quadrics[collapse.To].Add(quadrics[collapse.From]);
+			versions[collapse.To]++;
+			largestCost = (std::max)(largestCost, collapse.Cost);
+
+			for (UINT t : vertexTriangles[collapse.From])
+			{
+				if (!triangleAlive[t])
+					continue;
+				UINT* tri = &triangles[t * 3];
+				for (UINT corner = 0; corner < 3; corner++)
+				{
+					if (positionRemap[tri[corner]] != collapse.From)
+						continue;
+					for (const std::pair<UINT, UINT>& target : wedgeTargets)
+					{
+						if (target.first == tri[corner])
+						{
+							tri[corner] = target.second;
+							break;
+						}
+					}
+				}
+				const UINT c0 = positionRemap[tri[0]], c1 = positionRemap[tri[1]], c2 = positionRemap[tri[2]];
+				if (c0 == c1 || c1 == c2 || c0 == c2)
+				{
+					triangleAlive[t] = false;
+					aliveCount--;
+				}
+				else
+				{
+					vertexTriangles[collapse.To].push_back(t);
+				}
+			}
+
+			for (UINT t : vertexTriangles[collapse.To])
+			{
+				if (!triangleAlive[t])
+					continue;
+				for (UINT corner = 0; corner < 3; corner++)
+				{
+					UINT other = positionRemap[triangles[t * 3 + corner]];
+					pushEdge(collapse.To, other);
+					pushEdge(other, collapse.To);
+				}
+			}
+		}
+
+		std::vector<UINT> result;
+		result.reserve(aliveCount * 3);
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			if (triangleAlive[t])
+				result.insert(result.end(), &triangles[t * 3], &triangles[t * 3] + 3);
+		}
+		if (resultError)
+			*resultError = static_cast<float>(std::sqrt(largestCost));
+		return result;
+	}
+
+	void MeshSimplifier::GenerateLods(Mesh& mesh, UINT lodCount, float reduction, float maxError, UINT cacheSize)
+	{
+		if (mesh.Submeshes.empty())
+			mesh.Submeshes.push_back({ 0, static_cast<UINT>(mesh.Indices.size()), 0, 0, 0 });
+		const size_t submeshCount = mesh.Submeshes.size();
+
+		mesh.Lods.clear();
+		mesh.Lods.push_back({ 0, static_cast<UINT>(mesh.Indices.size()), 0.0f });
+		if (mesh.Indices.empty() || lodCount <= 1)
+			return;
+
+		const float radius = DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMLoadFloat3(&mesh.Bounds.Extents)));
+		float accumulatedError = 0.0f;
+		for (UINT lod = 1; lod < lodCount && lod < MAX_MESH_LODS; lod++)
+		{
+			const UINT lodOffset = static_cast<UINT>(mesh.Indices.size());
+			std::vector<UINT> lodIndices;
+			std::vector<Submesh> lodSubmeshes;
+			float lodError = 0.0f;
+
+			// Submeshes are simplified separately, so material boundaries act as borders and never open cracks
+			for (size_t s = 0; s < submeshCount; s++)
+			{
+				const Submesh source = mesh.Submeshes[(lod - 1) * submeshCount + s];
+				size_t targetIndexCount = static_cast<size_t>(source.IndexCount / 3 * reduction) * 3;
+				float error = 0.0f;
+				std::vector<UINT> simplified = Simplify(&mesh.Vertices[0].Position, sizeof(Vertex), mesh.Vertices.size(),
+					mesh.Indices.data() + source.IndexOffset, source.IndexCount, targetIndexCount, maxError * radius, &error);
+				if (!simplified.empty())
+					MeshOptimizer::OptimizeVertexCache(simplified.data(), simplified.size(), mesh.Vertices.size(), cacheSize);
+
+				lodError = (std::max)(lodError, error);
+				lodSubmeshes.push_back({ lodOffset + static_cast<UINT>(lodIndices.size()), static_cast<UINT>(simplified.size()), source.MaterialSlot, 0, 0 });
+				lodIndices.insert(lodIndices.end(), simplified.begin(), simplified.end());
+			}
+
+			// Stop once the error bound (or locked borders) keep the simplifier from making real progress
+			if (lodIndices.empty() || lodIndices.size() > mesh.Lods.back().IndexCount * MESH_LOD_MIN_REDUCTION)
+				break;
+
+			accumulatedError += lodError;
+			mesh.Lods.push_back({ lodOffset, static_cast<UINT>(lodIndices.size()), accumulatedError });
+			mesh.Indices.insert(mesh.Indices.end(), lodIndices.begin(), lodIndices.end());
+			mesh.Submeshes.insert(mesh.Submeshes.end(), lodSubmeshes.begin(), lodSubmeshes.end());
+		}
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <DirectXMath.h>
+#include <vector>
+#include "../Resources/Mesh.h"
+
+namespace DX12Engine
+{
+	// Quadric error metric edge collapse (Garland & Heckbert). Vertices are only ever collapsed onto existing vertices, so
+	// every LOD indexes the same vertex buffer. Vertices on borders are locked, vertices on attribute seams only collapse
+	// along the seam so each side keeps its own attributes
+	class MeshSimplifier
+	{
+	public:
+		// Collapses edges until the index count reaches targetIndexCount or the next collapse would exceed targetError
+		// (an object space distance). resultError receives the largest error introduced
+		static std::vector<UINT> Simplify(const DirectX::XMFLOAT3* positions, size_t positionStride, size_t vertexCount,
+			const UINT* indices, size_t indexCount, size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+		// Appends up to lodCount - 1 simplified index ranges after LOD 0 in mesh.Indices and records them in mesh.Lods, with
+		// one range per submesh in mesh.Submeshes. Each LOD keeps reduction of the previous triangle count, with at most
+		// maxError (relative to the mesh radius) added
+		static void GenerateLods(Mesh& mesh, UINT lodCount, float reduction, float maxError, UINT cacheSize);
+	};
+}
@@ -0,0 +1,142 @@
+#include "MeshletBuilder.h"
+#include "../Utils/EngineUtils.h"
+#include <cmath>
+#include <algorithm>
+
+namespace DX12Engine
+{
+	void MeshletBuilder::Build(Mesh& mesh, UINT maxVertices, UINT maxTriangles, UINT threadCount)
+	{
+		mesh.Meshlets.clear();
+		if (mesh.Indices.empty())
+			return;
+
+		if (mesh.Submeshes.empty())
+			mesh.Submeshes.push_back({ 0, mesh.Lods.empty() ? static_cast<UINT>(mesh.Indices.size()) : mesh.Lods[0].IndexCount, 0, 0, 0 });
+
+		// Meshlets never straddle submeshes, so each material range can be culled and gathered on its own
+		const UINT submeshCount = mesh.GetSubmeshCount();
+		for (UINT s = 0; s < submeshCount; s++)
+		{
+			Submesh& submesh = mesh.Submeshes[s];
+			std::vector<Meshlet> meshlets = Partition(mesh.Vertices.size(), mesh.Indices.data() + submesh.IndexOffset, submesh.IndexCount, maxVertices, maxTriangles);
+			for (Meshlet& meshlet : meshlets)
+				meshlet.IndexOffset += submesh.IndexOffset;
+
+			submesh.MeshletOffset = static_cast<UINT>(mesh.Meshlets.size());
+			submesh.MeshletCount = static_cast<UINT>(meshlets.size());
+			mesh.Meshlets.insert(mesh.Meshlets.end(), meshlets.begin(), meshlets.end());
+		}
+
+		EngineUtils::ParallelFor(mesh.Meshlets.size(), threadCount, [&](size_t i)
+		{
+			ComputeBounds(&mesh.Vertices[0].Position, sizeof(Vertex), mesh.Indices.data(), mesh.Meshlets[i]);
+		});
+	}
+
+	std::vector<Meshlet> MeshletBuilder::Build(const DirectX::XMFLOAT3* positions, size_t positionStride, size_t vertexCount,
+		const UINT* indices, size_t indexCount, UINT maxVertices, UINT maxTriangles)
+	{
+		std::vector<Meshlet> meshlets = Partition(vertexCount, indices, indexCount, maxVertices, maxTriangles);
+		for (Meshlet& meshlet : meshlets)
+			ComputeBounds(positions, positionStride, indices, meshlet);
+		return meshlets;
+	}
+
+	std::vector<Meshlet> MeshletBuilder::Partition(size_t vertexCount, const UINT* indices, size_t indexCount, UINT maxVertices, UINT maxTriangles)
+	{
+		std::vector<Meshlet> meshlets;
+
+		// Stamp of the last meshlet that referenced each vertex, so counting unique vertices needs no clearing
+		std::vector<UINT> vertexStamp(vertexCount, 0);
+		UINT stamp = 1;
+		auto countNewVertices = [&](size_t i)
+		{
+			UINT count = 0;
+			for (UINT corner = 0; corner < 3; corner++)
+			{
+				UINT v = indices[i + corner];
+				if (vertexStamp[v] != stamp && (corner == 0 || indices[i] != v) && (corner < 2 || indices[i + 1] != v))
+					count++;
+			}
+			return count;
+		};
+
+		Meshlet current = {};
+		for (size_t i = 0; i + 2 < indexCount; i += 3)
+		{
+			UINT newVertices = countNewVertices(i);
+			if (current.IndexCount > 0 && (current.VertexCount + newVertices > maxVertices || current.IndexCount / 3 >= maxTriangles))
+			{
+				meshlets.push_back(current);
+				current = {};
+				current.IndexOffset = static_cast<UINT>(i);
+				stamp++;
+				newVertices = countNewVertices(i);
+			}
+
+			for (UINT corner = 0; corner < 3; corner++)
+				vertexStamp[indices[i + corner]] = stamp;
+			current.VertexCount += newVertices;
+			current.IndexCount += 3;
+		}
+		if (current.IndexCount > 0)
+			meshlets.push_back(current);
+		return meshlets;
+	}
+
+	void MeshletBuilder::ComputeBounds(const DirectX::XMFLOAT3* positions, size_t positionStride, const UINT* indices, Meshlet& meshlet)
+	{
+		auto position = [&](UINT v)
+		{
+			return DirectX::XMLoadFloat3(reinterpret_cast<const DirectX::XMFLOAT3*>(reinterpret_cast<const uint8_t*>(positions) + positionStride * v));
+		};
+
+		const UINT* first = indices + meshlet.IndexOffset;
+		DirectX::XMVECTOR minimum = position(first[0]);
+		DirectX::XMVECTOR maximum = minimum;
+		DirectX::XMVECTOR normalSum = DirectX::XMVectorZero();
+		std::vector<DirectX::XMVECTOR> normals;
+		normals.reserve(meshlet.IndexCount / 3);
+		for (UINT i = 0; i < meshlet.IndexCount; i += 3)
+		{
+			DirectX::XMVECTOR p0 = position(first[i]);
+			DirectX::XMVECTOR p1 = position(first[i + 1]);
+			DirectX::XMVECTOR p2 = position(first[i + 2]);
+			minimum = DirectX::XMVectorMin(minimum, DirectX::XMVectorMin(p0, DirectX::XMVectorMin(p1, p2)));
+			maximum = DirectX::XMVectorMax(maximum, DirectX::XMVectorMax(p0, DirectX::XMVectorMax(p1, p2)));
+
+			// Same winding as the rasterizer: front faces have their cross product pointing at the viewer
+			DirectX::XMVECTOR normal = DirectX::XMVector3Cross(DirectX::XMVectorSubtract(p1, p0), DirectX::XMVectorSubtract(p2, p0));
+			if (DirectX::XMVectorGetX(DirectX::XMVector3LengthSq(normal)) > 0.0f)
+			{
+				normal = DirectX::XMVector3Normalize(normal);
+				normals.push_back(normal);
+				normalSum = DirectX::XMVectorAdd(normalSum, normal);
+			}
+		}
+
+		// Sphere around the box center, which is conservative and cheap compared to a minimal sphere
+		DirectX::XMVECTOR center = DirectX::XMVectorScale(DirectX::XMVectorAdd(minimum, maximum), 0.5f);
+		float radiusSq = 0.0f;
+		for (UINT i = 0; i < meshlet.IndexCount; i++)
+			radiusSq = (std::max)(radiusSq, DirectX::XMVectorGetX(DirectX::XMVector3LengthSq(DirectX::XMVectorSubtract(position(first[i]), center))));
+		DirectX::XMStoreFloat3(&meshlet.Center, center);
+		meshlet.Radius = std::sqrt(radiusSq);
+
+		meshlet.ConeAxis = { 0.0f, 0.0f, 0.0f };
+		meshlet.ConeCutoff = 1.0f;
+		if (normals.empty() || DirectX::XMVectorGetX(DirectX::XMVector3LengthSq(normalSum)) <= 0.0f)
+			return;
+
+		DirectX::XMVECTOR axis = DirectX::XMVector3Normalize(normalSum);
+		float minDot = 1.0f;
+		for (const DirectX::XMVECTOR& normal : normals)
+			minDot = (std::min)(minDot, DirectX::XMVectorGetX(DirectX::XMVector3Dot(axis, normal)));
+
+		// Cones wider than ~84 degrees would almost never cull, leave them disabled
+		DirectX::XMStoreFloat3(&meshlet.ConeAxis, axis);
+		if (minDot > 0.1f)
+			meshlet.ConeCutoff = std::sqrt(1.0f - minDot * minDot);
+	}
+}
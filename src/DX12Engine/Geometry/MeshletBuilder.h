@@ -0,0 +1,27 @@
+#pragma once
+#include <DirectXMath.h>
+#include <vector>
+#include "../Resources/Mesh.h"
+
+namespace DX12Engine
+{
+	// Partitions the index buffer into meshlets without reordering it. The optimizer already emits triangles in spatially
+	// coherent clusters, so cutting runs of consecutive triangles keeps the meshlets tight and lets culled draws copy whole runs
+	class MeshletBuilder
+	{
+	public:
+		// Fills mesh.Meshlets from the LOD 0 submeshes and records the meshlet range of each. Bounds are computed on
+		// threadCount threads (0 = hardware concurrency)
+		static void Build(Mesh& mesh, UINT maxVertices, UINT maxTriangles, UINT threadCount = 1);
+
+		static std::vector<Meshlet> Build(const DirectX::XMFLOAT3* positions, size_t positionStride, size_t vertexCount,
+			const UINT* indices, size_t indexCount, UINT maxVertices, UINT maxTriangles);
+
+		// Bounding sphere and normal cone of the meshlet triangles, indices is the whole index buffer
+		static void ComputeBounds(const DirectX::XMFLOAT3* positions, size_t positionStride, const UINT* indices, Meshlet& meshlet);
+
+	private:
+		// Cuts the meshlet ranges without bounds
+		static std::vector<Meshlet> Partition(size_t vertexCount, const UINT* indices, size_t indexCount, UINT maxVertices, UINT maxTriangles);
+	};
+}
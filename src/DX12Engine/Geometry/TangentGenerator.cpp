@@ -0,0 +1,304 @@
+#include "TangentGenerator.h"
+#include "../Utils/EngineUtils.h"
+#include "../Utils/Constants.h"
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <immintrin.h>
+
+namespace DX12Engine
+{
+	template<typename T>
+	static const T& Fetch(const T* base, size_t stride, size_t index)
+	{
+		return *reinterpret_cast<const T*>(reinterpret_cast<const uint8_t*>(base) + stride * index);
+	}
+
+	// Per-vertex sums of the area weighted tangent (S) and bitangent (T) directions, one cache line per update
+	struct TangentSum
+	{
+		float SX, SY, SZ;
+		float TX, TY, TZ;
+	};
+
+	// Triangle directions of one batch, structure of arrays within the batch
+	template<size_t Width>
+	struct TriangleBatchResult
+	{
+		float SX[Width], SY[Width], SZ[Width];
+		float TX[Width], TY[Width], TZ[Width];
+	};
+
+	struct SSEOps
+	{
+		using Vec = __m128;
+		static constexpr size_t Width = 4;
+		static Vec Load(const float* p) { return _mm_loadu_ps(p); }
+		static void Store(float* p, Vec v) { _mm_storeu_ps(p, v); }
+		static Vec Set1(float f) { return _mm_set1_ps(f); }
+		static Vec Add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+		static Vec Sub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+		static Vec Mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+		static Vec Div(Vec a, Vec b) { return _mm_div_ps(a, b); }
+		static Vec Sqrt(Vec a) { return _mm_sqrt_ps(a); }
+		static Vec Greater(Vec a, Vec b) { return _mm_cmpgt_ps(a, b); }
+		static Vec Less(Vec a, Vec b) { return _mm_cmplt_ps(a, b); }
+		static Vec Select(Vec mask, Vec a, Vec b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+		static Vec And(Vec a, Vec b) { return _mm_and_ps(a, b); }
+		static Vec Abs(Vec a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+		static Vec Negate(Vec a) { return _mm_xor_ps(_mm_set1_ps(-0.0f), a); }
+	};
+
+#if defined(__AVX__)
+	struct AVXOps
+	{
+		using Vec = __m256;
+		static constexpr size_t Width = 8;
+		static Vec Load(const float* p) { return _mm256_loadu_ps(p); }
+		static void Store(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+		static Vec Set1(float f) { return _mm256_set1_ps(f); }
+		static Vec Add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+		static Vec Sub(Vec a, Vec b) { return _mm256_sub_ps(a, b); }
+		static Vec Mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+		static Vec Div(Vec a, Vec b) { return _mm256_div_ps(a, b); }
+		static Vec Sqrt(Vec a) { return _mm256_sqrt_ps(a); }
+		static Vec Greater(Vec a, Vec b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+		static Vec Less(Vec a, Vec b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+		static Vec Select(Vec mask, Vec a, Vec b) { return _mm256_blendv_ps(b, a, mask); }
+		static Vec And(Vec a, Vec b) { return _mm256_and_ps(a, b); }
+		static Vec Abs(Vec a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+		static Vec Negate(Vec a) { return _mm256_xor_ps(_mm256_set1_ps(-0.0f), a); }
+	};
+	using BatchOps = AVXOps;
+#else
+	using BatchOps = SSEOps;
+#endif
+
+	static constexpr float DegenerateEpsilon = 1e-20f;
+
+	// UV directions of Width triangles starting at first, each normalized and scaled by the triangle's area so the UV scale
+	// does not skew the weighting. The edges are gathered per lane, the rest runs across the batch. Triangles with
+	// degenerate UVs or no area, and lanes past the last triangle, get zero
+	template<typename Ops>
+	static void ComputeTriangleBatch(
+		const DirectX::XMFLOAT3* positions, size_t positionStride,
+		const DirectX::XMFLOAT2* texCoords, size_t texCoordStride,
+		const UINT* indices, size_t triangleCount, size_t first, TriangleBatchResult<Ops::Width>& result)
+	{
+		using Vec = typename Ops::Vec;
+		alignas(32) float edges[10][Ops::Width] = {};
+		for (size_t lane = 0; lane < Ops::Width && first + lane < triangleCount; lane++)
+		{
+			const UINT* triangle = indices + (first + lane) * 3;
+			const DirectX::XMFLOAT3& v1 = Fetch(positions, positionStride, triangle[0]);
+			const DirectX::XMFLOAT3& v2 = Fetch(positions, positionStride, triangle[1]);
+			const DirectX::XMFLOAT3& v3 = Fetch(positions, positionStride, triangle[2]);
+			const DirectX::XMFLOAT2& w1 = Fetch(texCoords, texCoordStride, triangle[0]);
+			const DirectX::XMFLOAT2& w2 = Fetch(texCoords, texCoordStride, triangle[1]);
+			const DirectX::XMFLOAT2& w3 = Fetch(texCoords, texCoordStride, triangle[2]);
+			edges[0][lane] = v2.x - v1.x; edges[1][lane] = v3.x - v1.x;
+			edges[2][lane] = v2.y - v1.y; edges[3][lane] = v3.y - v1.y;
+			edges[4][lane] = v2.z - v1.z; edges[5][lane] = v3.z - v1.z;
+			edges[6][lane] = w2.x - w1.x; edges[7][lane] = w3.x - w1.x;
+			edges[8][lane] = w2.y - w1.y; edges[9][lane] = w3.y - w1.y;
+		}
+
+		Vec x1 = Ops::Load(edges[0]), x2 = Ops::Load(edges[1]);
+		Vec y1 = Ops::Load(edges[2]), y2 = Ops::Load(edges[3]);
+		Vec z1 = Ops::Load(edges[4]), z2 = Ops::Load(edges[5]);
+		Vec s1 = Ops::Load(edges[6]), s2 = Ops::Load(edges[7]);
+		Vec t1 = Ops::Load(edges[8]), t2 = Ops::Load(edges[9]);
+
+		Vec det = Ops::Sub(Ops::Mul(s1, t2), Ops::Mul(s2, t1));
+		Vec sx = Ops::Sub(Ops::Mul(t2, x1), Ops::Mul(t1, x2));
+		Vec sy = Ops::Sub(Ops::Mul(t2, y1), Ops::Mul(t1, y2));
+		Vec sz = Ops::Sub(Ops::Mul(t2, z1), Ops::Mul(t1, z2));
+		Vec tx = Ops::Sub(Ops::Mul(s1, x2), Ops::Mul(s2, x1));
+		Vec ty = Ops::Sub(Ops::Mul(s1, y2), Ops::Mul(s2, y1));
+		Vec tz = Ops::Sub(Ops::Mul(s1, z2), Ops::Mul(s2, z1));
+		Vec sLength = Ops::Sqrt(Ops::Add(Ops::Add(Ops::Mul(sx, sx), Ops::Mul(sy, sy)), Ops::Mul(sz, sz)));
+		Vec tLength = Ops::Sqrt(Ops::Add(Ops::Add(Ops::Mul(tx, tx), Ops::Mul(ty, ty)), Ops::Mul(tz, tz)));
+
+		Vec cx = Ops::Sub(Ops::Mul(y1, z2), Ops::Mul(z1, y2));
+		Vec cy = Ops::Sub(Ops::Mul(z1, x2), Ops::Mul(x1, z2));
+		Vec cz = Ops::Sub(Ops::Mul(x1, y2), Ops::Mul(y1, x2));
+		Vec area = Ops::Mul(Ops::Set1(0.5f), Ops::Sqrt(Ops::Add(Ops::Add(Ops::Mul(cx, cx), Ops::Mul(cy, cy)), Ops::Mul(cz, cz))));
+
+		// The sign of det carries the UV winding. Invalid lanes may divide by zero, their results are masked out
+		const Vec zero = Ops::Set1(0.0f);
+		Vec valid = Ops::And(Ops::Greater(Ops::Abs(det), Ops::Set1(DegenerateEpsilon)),
+			Ops::And(Ops::Greater(sLength, zero), Ops::Greater(tLength, zero)));
+		Vec signedArea = Ops::Select(Ops::Less(det, zero), Ops::Negate(area), area);
+		Vec sScale = Ops::Select(valid, Ops::Div(signedArea, sLength), zero);
+		Vec tScale = Ops::Select(valid, Ops::Div(signedArea, tLength), zero);
+
+		Ops::Store(result.SX, Ops::Select(valid, Ops::Mul(sx, sScale), zero));
+		Ops::Store(result.SY, Ops::Select(valid, Ops::Mul(sy, sScale), zero));
+		Ops::Store(result.SZ, Ops::Select(valid, Ops::Mul(sz, sScale), zero));
+		Ops::Store(result.TX, Ops::Select(valid, Ops::Mul(tx, tScale), zero));
+		Ops::Store(result.TY, Ops::Select(valid, Ops::Mul(ty, tScale), zero));
+		Ops::Store(result.TZ, Ops::Select(valid, Ops::Mul(tz, tScale), zero));
+	}
+
+	// Gram-Schmidt orthogonalize T against N, normalize it and derive handedness from sign(dot(cross(N, T), B)) for Width
+	// vertices starting at first. Tangents that collapse to zero are left as zero and patched up per lane
+	template<typename Ops>
+	static void OrthonormalizeBatch(const DirectX::XMFLOAT3* normals, size_t normalStride, const TangentSum* sums, size_t vertexCount, size_t first, float (&result)[7][Ops::Width])
+	{
+		using Vec = typename Ops::Vec;
+		alignas(32) float lanes[9][Ops::Width] = {};
+		for (size_t lane = 0; lane < Ops::Width && first + lane < vertexCount; lane++)
+		{
+			const DirectX::XMFLOAT3& n = Fetch(normals, normalStride, first + lane);
+			const TangentSum& sum = sums[first + lane];
+			lanes[0][lane] = n.x; lanes[1][lane] = n.y; lanes[2][lane] = n.z;
+			lanes[3][lane] = sum.SX; lanes[4][lane] = sum.SY; lanes[5][lane] = sum.SZ;
+			lanes[6][lane] = sum.TX; lanes[7][lane] = sum.TY; lanes[8][lane] = sum.TZ;
+		}
+		Vec nx = Ops::Load(lanes[0]), ny = Ops::Load(lanes[1]), nz = Ops::Load(lanes[2]);
+		Vec tx = Ops::Load(lanes[3]), ty = Ops::Load(lanes[4]), tz = Ops::Load(lanes[5]);
+		Vec bx = Ops::Load(lanes[6]), by = Ops::Load(lanes[7]), bz = Ops::Load(lanes[8]);
+
+		Vec nDotT = Ops::Add(Ops::Add(Ops::Mul(nx, tx), Ops::Mul(ny, ty)), Ops::Mul(nz, tz));
+		tx = Ops::Sub(tx, Ops::Mul(nx, nDotT));
+		ty = Ops::Sub(ty, Ops::Mul(ny, nDotT));
+		tz = Ops::Sub(tz, Ops::Mul(nz, nDotT));
+
+		Vec lengthSq = Ops::Add(Ops::Add(Ops::Mul(tx, tx), Ops::Mul(ty, ty)), Ops::Mul(tz, tz));
+		Vec valid = Ops::Greater(lengthSq, Ops::Set1(DegenerateEpsilon));
+		Vec invLength = Ops::Select(valid, Ops::Div(Ops::Set1(1.0f), Ops::Sqrt(lengthSq)), Ops::Set1(0.0f));
+		tx = Ops::Mul(tx, invLength);
+		ty = Ops::Mul(ty, invLength);
+		tz = Ops::Mul(tz, invLength);
+
+		Vec cx = Ops::Sub(Ops::Mul(ny, tz), Ops::Mul(nz, ty));
+		Vec cy = Ops::Sub(Ops::Mul(nz, tx), Ops::Mul(nx, tz));
+		Vec cz = Ops::Sub(Ops::Mul(nx, ty), Ops::Mul(ny, tx));
+		Vec handedness = Ops::Add(Ops::Add(Ops::Mul(cx, bx), Ops::Mul(cy, by)), Ops::Mul(cz, bz));
+		Vec w = Ops::Select(Ops::Less(handedness, Ops::Set1(0.0f)), Ops::Set1(-1.0f), Ops::Set1(1.0f));
+
+		Ops::Store(result[0], tx);
+		Ops::Store(result[1], ty);
+		Ops::Store(result[2], tz);
+		Ops::Store(result[3], w);
+		Ops::Store(result[4], nx);
+		Ops::Store(result[5], ny);
+		Ops::Store(result[6], nz);
+	}
+
+	// Any unit vector perpendicular to the normal, used when the UVs give no usable direction
+	static DirectX::XMFLOAT3 PerpendicularTo(float nx, float ny, float nz)
+	{
+		DirectX::XMFLOAT3 axis = std::fabs(nx) < 0.9f ? DirectX::XMFLOAT3(1.0f, 0.0f, 0.0f) : DirectX::XMFLOAT3(0.0f, 1.0f, 0.0f);
+		float d = axis.x * nx + axis.y * ny + axis.z * nz;
+		DirectX::XMFLOAT3 t = { axis.x - nx * d, axis.y - ny * d, axis.z - nz * d };
+		float length = std::sqrt(t.x * t.x + t.y * t.y + t.z * t.z);
+		return { t.x / length, t.y / length, t.z / length };
+	}
+
+	void TangentGenerator::Generate(
+		const DirectX::XMFLOAT3* positions, size_t positionStride,
+		const DirectX::XMFLOAT3* normals, size_t normalStride,
+		const DirectX::XMFLOAT2* texCoords, size_t texCoordStride,
+		size_t vertexCount,
+		const UINT* indices, size_t indexCount,
+		DirectX::XMFLOAT4* tangents, size_t tangentStride,
+		UINT threadCount)
+	{
+		if (vertexCount == 0)
+			return;
+		if (threadCount == 0)
+			threadCount = (std::max)(1u, std::thread::hardware_concurrency());
+
+		// Per-triangle UV directions in batches, each weighted by the triangle's area and summed per vertex in triangle order
+		typedef TriangleBatchResult<BatchOps::Width> BatchResult;
+		const size_t triangleCount = indexCount / 3;
+		const size_t triangleBatchCount = (triangleCount + BatchOps::Width - 1) / BatchOps::Width;
+		std::vector<TangentSum> sums(vertexCount, TangentSum{});
+		auto accumulate = [&](const BatchResult& batch, size_t batchIndex, size_t firstVertex, size_t lastVertex)
+		{
+			const size_t firstTriangle = batchIndex * BatchOps::Width;
+			for (size_t lane = 0; lane < BatchOps::Width && firstTriangle + lane < triangleCount; lane++)
+			{
+				for (size_t corner = 0; corner < 3; corner++)
+				{
+					const UINT index = indices[(firstTriangle + lane) * 3 + corner];
+					if (index < firstVertex || index >= lastVertex)
+						continue;
+					TangentSum& sum = sums[index];
+					sum.SX += batch.SX[lane]; sum.SY += batch.SY[lane]; sum.SZ += batch.SZ[lane];
+					sum.TX += batch.TX[lane]; sum.TY += batch.TY[lane]; sum.TZ += batch.TZ[lane];
+				}
+			}
+		};
+
+		if (threadCount == 1)
+		{
+			// Summing each batch right away keeps it in cache
+			BatchResult batch;
+			for (size_t batchIndex = 0; batchIndex < triangleBatchCount; batchIndex++)
+			{
+				ComputeTriangleBatch<BatchOps>(positions, positionStride, texCoords, texCoordStride, indices, triangleCount, batchIndex * BatchOps::Width, batch);
+				accumulate(batch, batchIndex, 0, vertexCount);
+			}
+		}
+		else
+		{
+			std::unique_ptr<BatchResult[]> batches(new BatchResult[triangleBatchCount]);
+			EngineUtils::ParallelForBlocks(triangleBatchCount, IMPORT_PARALLEL_BLOCK_SIZE / BatchOps::Width, threadCount, [&](size_t first, size_t last)
+			{
+				for (size_t batchIndex = first; batchIndex < last; batchIndex++)
+					ComputeTriangleBatch<BatchOps>(positions, positionStride, texCoords, texCoordStride, indices, triangleCount, batchIndex * BatchOps::Width, batches[batchIndex]);
+			});
+
+			// Each thread owns a vertex range and scans all triangles in order, so every vertex sums its triangles in the
+			// same order as a single thread would
+			const size_t vertexRange = (vertexCount + threadCount - 1) / threadCount;
+			EngineUtils::ParallelFor(threadCount, threadCount, [&](size_t range)
+			{
+				const size_t firstVertex = range * vertexRange, lastVertex = (std::min)(vertexCount, firstVertex + vertexRange);
+				for (size_t batchIndex = 0; batchIndex < triangleBatchCount; batchIndex++)
+					accumulate(batches[batchIndex], batchIndex, firstVertex, lastVertex);
+			});
+		}
+
+		const size_t vertexBatchCount = (vertexCount + BatchOps::Width - 1) / BatchOps::Width;
+		EngineUtils::ParallelForBlocks(vertexBatchCount, IMPORT_PARALLEL_BLOCK_SIZE / BatchOps::Width, threadCount, [&](size_t first, size_t last)
+		{
+			alignas(32) float frames[7][BatchOps::Width];
+			for (size_t batch = first; batch < last; batch++)
+			{
+				const size_t firstVertex = batch * BatchOps::Width;
+				OrthonormalizeBatch<BatchOps>(normals, normalStride, sums.data(), vertexCount, firstVertex, frames);
+				for (size_t lane = 0; lane < BatchOps::Width && firstVertex + lane < vertexCount; lane++)
+				{
+					DirectX::XMFLOAT4& tangent = *reinterpret_cast<DirectX::XMFLOAT4*>(reinterpret_cast<uint8_t*>(tangents) + tangentStride * (firstVertex + lane));
+					if (frames[0][lane] == 0.0f && frames[1][lane] == 0.0f && frames[2][lane] == 0.0f)
+					{
+						DirectX::XMFLOAT3 fallback = PerpendicularTo(frames[4][lane], frames[5][lane], frames[6][lane]);
+						tangent = { fallback.x, fallback.y, fallback.z, 1.0f };
+					}
+					else
+					{
+						tangent = { frames[0][lane], frames[1][lane], frames[2][lane], frames[3][lane] };
+					}
+				}
+			}
+		});
+	}
+
+	void TangentGenerator::Generate(Mesh& mesh, UINT threadCount)
+	{
+		if (mesh.Vertices.empty())
+			return;
+
+		Generate(
+			&mesh.Vertices[0].Position, sizeof(Vertex),
+			&mesh.Vertices[0].Normal, sizeof(Vertex),
+			&mesh.Vertices[0].TexCoord, sizeof(Vertex),
+			mesh.Vertices.size(),
+			mesh.Indices.data(), mesh.Indices.size(),
+			&mesh.Vertices[0].Tangent, sizeof(Vertex),
+			threadCount);
+	}
+}
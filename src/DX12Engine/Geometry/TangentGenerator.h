@@ -0,0 +1,26 @@
+#pragma once
+#include <DirectXMath.h>
+#include "../Resources/Mesh.h"
+
+namespace DX12Engine
+{
+	// Builds per-vertex tangent frames from positions, normals and UVs of any indexed triangle list. Triangle tangents are
+	// computed in SoA batches and accumulated weighted by area, then orthogonalized against the normal in SoA batches; w
+	// holds the bitangent handedness.
+	// Every pass splits across threadCount threads (0 = hardware concurrency) and the result matches a single thread exactly
+	class TangentGenerator
+	{
+	public:
+		static void Generate(
+			const DirectX::XMFLOAT3* positions, size_t positionStride,
+			const DirectX::XMFLOAT3* normals, size_t normalStride,
+			const DirectX::XMFLOAT2* texCoords, size_t texCoordStride,
+			size_t vertexCount,
+			const UINT* indices, size_t indexCount,
+			DirectX::XMFLOAT4* tangents, size_t tangentStride,
+			UINT threadCount = 1);
+
+		static void Generate(Mesh& mesh, UINT threadCount = 1);
+	};
+}
+
@@ -0,0 +1,123 @@
+#include "VertexCompression.h"
+#include "../Utils/EngineUtils.h"
+#include "../Utils/Constants.h"
+#include <cmath>
+#include <algorithm>
+
+namespace DX12Engine
+{
+	using namespace DirectX::PackedVector;
+
+	void VertexCompression::Compress(Mesh& mesh, UINT threadCount)
+	{
+		mesh.Quantization = ComputeQuantization(mesh.Bounds);
+		mesh.CompactVertices.resize(mesh.Vertices.size());
+		EngineUtils::ParallelForBlocks(mesh.Vertices.size(), IMPORT_PARALLEL_BLOCK_SIZE, threadCount, [&](size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; i++)
+				mesh.CompactVertices[i] = Encode(mesh.Vertices[i], mesh.Quantization);
+		});
+		mesh.Format = VertexFormat::Compact;
+	}
+
+	VertexQuantization VertexCompression::ComputeQuantization(const DirectX::BoundingBox& bounds)
+	{
+		VertexQuantization quantization;
+		quantization.Scale = { bounds.Extents.x * 2.0f, bounds.Extents.y * 2.0f, bounds.Extents.z * 2.0f };
+		quantization.Offset = { bounds.Center.x - bounds.Extents.x, bounds.Center.y - bounds.Extents.y, bounds.Center.z - bounds.Extents.z };
+		return quantization;
+	}
+
+	CompactVertex VertexCompression::Encode(const Vertex& vertex, const VertexQuantization& quantization)
+	{
+		auto normalize = [](float value, float offset, float scale) { return scale > 0.0f ? (std::clamp)((value - offset) / scale, 0.0f, 1.0f) : 0.0f; };
+
+		CompactVertex compact;
+		compact.Position = XMUSHORTN4(
+			normalize(vertex.Position.x, quantization.Offset.x, quantization.Scale.x),
+			normalize(vertex.Position.y, quantization.Offset.y, quantization.Scale.y),
+			normalize(vertex.Position.z, quantization.Offset.z, quantization.Scale.z),
+			vertex.Tangent.w < 0.0f ? 0.0f : 1.0f);
+		compact.Normal = QuantizeOctahedral(vertex.Normal);
+		compact.Tangent = QuantizeOctahedral({ vertex.Tangent.x, vertex.Tangent.y, vertex.Tangent.z });
+		compact.TexCoord = XMHALF2(vertex.TexCoord.x, vertex.TexCoord.y);
+		return compact;
+	}
+
+	Vertex VertexCompression::Decode(const CompactVertex& vertex, const VertexQuantization& quantization)
+	{
+		DirectX::XMFLOAT4 position;
+		DirectX::XMFLOAT2 normal, tangent;
+		DirectX::XMStoreFloat4(&position, XMLoadUShortN4(&vertex.Position));
+		DirectX::XMStoreFloat2(&normal, XMLoadShortN2(&vertex.Normal));
+		DirectX::XMStoreFloat2(&tangent, XMLoadShortN2(&vertex.Tangent));
+
+		Vertex decoded;
+		decoded.Position = {
+			position.x * quantization.Scale.x + quantization.Offset.x,
+			position.y * quantization.Scale.y + quantization.Offset.y,
+			position.z * quantization.Scale.z + quantization.Offset.z };
+		decoded.Normal = DecodeOctahedral(normal);
+		DirectX::XMFLOAT3 tangentDirection = DecodeOctahedral(tangent);
+		decoded.Tangent = { tangentDirection.x, tangentDirection.y, tangentDirection.z, position.w * 2.0f - 1.0f };
+		DirectX::XMStoreFloat2(&decoded.TexCoord, XMLoadHalf2(&vertex.TexCoord));
+		return decoded;
+	}
+
+	DirectX::XMFLOAT2 VertexCompression::EncodeOctahedral(const DirectX::XMFLOAT3& direction)
+	{
+		float length = std::fabs(direction.x) + std::fabs(direction.y) + std::fabs(direction.z);
+		if (length == 0.0f)
+			return { 0.0f, 0.0f };
+
+		float x = direction.x / length;
+		float y = direction.y / length;
+		if (direction.z < 0.0f)
+		{
+			float foldedX = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			float foldedY = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = foldedX;
+			y = foldedY;
+		}
+		return { x, y };
+	}
+
+	DirectX::XMFLOAT3 VertexCompression::DecodeOctahedral(const DirectX::XMFLOAT2& encoded)
+	{
+		// Same as DecodeOctahedral in the vertex shaders
+		DirectX::XMFLOAT3 n = { encoded.x, encoded.y, 1.0f - std::fabs(encoded.x) - std::fabs(encoded.y) };
+		float t = (std::max)(-n.z, 0.0f);
+		n.x += n.x >= 0.0f ? -t : t;
+		n.y += n.y >= 0.0f ? -t : t;
+		DirectX::XMStoreFloat3(&n, DirectX::XMVector3Normalize(DirectX::XMLoadFloat3(&n)));
+		return n;
+	}
+
+	XMSHORTN2 VertexCompression::QuantizeOctahedral(const DirectX::XMFLOAT3& direction)
+	{
+		DirectX::XMFLOAT2 encoded = EncodeOctahedral(direction);
+		DirectX::XMVECTOR target = DirectX::XMVector3Normalize(DirectX::XMLoadFloat3(&direction));
+
+		const float baseX = std::floor(encoded.x * 32767.0f);
+		const float baseY = std::floor(encoded.y * 32767.0f);
+		XMSHORTN2 best(encoded.x, encoded.y);
+		float bestDot = -2.0f;
+		for (int i = 0; i < 4; i++)
+		{
+			float x = (std::clamp)((baseX + (i & 1)) / 32767.0f, -1.0f, 1.0f);
+			float y = (std::clamp)((baseY + (i >> 1)) / 32767.0f, -1.0f, 1.0f);
+			XMSHORTN2 candidate(x, y);
+
+			DirectX::XMFLOAT2 candidateEncoded;
+			DirectX::XMStoreFloat2(&candidateEncoded, XMLoadShortN2(&candidate));
+			DirectX::XMFLOAT3 decoded = DecodeOctahedral(candidateEncoded);
+			float dot = DirectX::XMVectorGetX(DirectX::XMVector3Dot(DirectX::XMLoadFloat3(&decoded), target));
+			if (dot > bestDot)
+			{
+				bestDot = dot;
+				best = candidate;
+			}
+		}
+		return best;
+	}
+}
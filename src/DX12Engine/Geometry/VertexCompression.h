@@ -0,0 +1,26 @@
+#pragma once
+#include <DirectXMath.h>
+#include "../Resources/Mesh.h"
+
+namespace DX12Engine
+{
+	// Encodes full vertices into the compact layout and back. The decode path mirrors the vertex shaders and is used to
+	// check the round-trip error on the CPU
+	class VertexCompression
+	{
+	public:
+		// Fills mesh.CompactVertices and mesh.Quantization from mesh.Vertices and mesh.Bounds and switches the format,
+		// encoding on threadCount threads (0 = hardware concurrency)
+		static void Compress(Mesh& mesh, UINT threadCount = 1);
+		static VertexQuantization ComputeQuantization(const DirectX::BoundingBox& bounds);
+
+		static CompactVertex Encode(const Vertex& vertex, const VertexQuantization& quantization);
+		static Vertex Decode(const CompactVertex& vertex, const VertexQuantization& quantization);
+
+		// Octahedral mapping of a unit vector to [-1, 1]^2
+		static DirectX::XMFLOAT2 EncodeOctahedral(const DirectX::XMFLOAT3& direction);
+		static DirectX::XMFLOAT3 DecodeOctahedral(const DirectX::XMFLOAT2& encoded);
+		// Picks the 16-bit snorm rounding of the octahedral coordinates that decodes closest to the direction
+		static DirectX::PackedVector::XMSHORTN2 QuantizeOctahedral(const DirectX::XMFLOAT3& direction);
+	};
+}
@@ -0,0 +1,398 @@
+#include "ModelLoader.h"
+#include "MappedFile.h"
+#include "../Geometry/TangentGenerator.h"
+#include <filesystem>
+#include <stdexcept>
+#include <iostream>
+#include <memory>
+#include <cstring>
+#include <algorithm>
+#include <numeric>
+#include <climits>
+
+#define CGLTF_IMPLEMENTATION
+#include "cgltf.h"
+
+namespace DX12Engine
+{
+	using GltfDataPtr = std::unique_ptr<cgltf_data, decltype(&cgltf_free)>;
+
+	static std::filesystem::path DecodeUri(const char* uri)
+	{
+		std::string decoded = uri;
+		cgltf_decode_uri(decoded.data());
+		decoded.resize(strlen(decoded.c_str()));
+		return std::filesystem::path(reinterpret_cast<const char8_t*>(decoded.c_str()));
+	}
+
+	// Copies up to `components` floats per element into the destination. glTF keeps every attribute in its own accessor
+	// while Vertex interleaves them, so each attribute is scattered once into the final vertices at their stride. Float
+	// accessors are read straight out of the mapped buffer and normalized integer (quantized) ones through cgltf's
+	// converting reader. cgltf's per-element reader refuses sparse accessors, so those are unpacked whole first
+	static void ReadAccessor(const cgltf_accessor* accessor, UINT components, void* destination, size_t destinationStride)
+	{
+		uint8_t* out = static_cast<uint8_t*>(destination);
+		const UINT accessorComponents = static_cast<UINT>(cgltf_num_components(accessor->type));
+		const size_t copySize = (std::min)(components, accessorComponents) * sizeof(float);
+		const uint8_t* view = accessor->buffer_view ? cgltf_buffer_view_data(accessor->buffer_view) : nullptr;
+		if (view && !accessor->is_sparse && accessor->component_type == cgltf_component_type_r_32f)
+		{
+			const uint8_t* source = view + accessor->offset;
+			for (size_t i = 0; i < accessor->count; i++)
+				memcpy(out + i * destinationStride, source + i * accessor->stride, copySize);
+			return;
+		}
+
+		if (accessor->is_sparse)
+		{
+			std::vector<float> unpacked(cgltf_accessor_unpack_floats(accessor, nullptr, 0));
+			if (unpacked.size() != accessor->count * accessorComponents
+				|| cgltf_accessor_unpack_floats(accessor, unpacked.data(), unpacked.size()) != unpacked.size())
+				throw std::runtime_error("Failed to read sparse glTF accessor");
+			for (size_t i = 0; i < accessor->count; i++)
+				memcpy(out + i * destinationStride, &unpacked[i * accessorComponents], copySize);
+			return;
+		}
+
+		float element[16] = {};
+		for (size_t i = 0; i < accessor->count; i++)
+		{
+			if (!cgltf_accessor_read_float(accessor, i, element, accessorComponents))
+				throw std::runtime_error("Failed to read glTF accessor");
+			memcpy(out + i * destinationStride, element, copySize);
+		}
+	}
+
+	// One unsigned integer of an index or sparse index stream
+	static UINT ReadIndex(const uint8_t* source, cgltf_component_type componentType)
+	{
+		switch (componentType)
+		{
+		case cgltf_component_type_r_8u:
+			return *source;
+		case cgltf_component_type_r_16u:
+		{
+			uint16_t index;
+			memcpy(&index, source, sizeof(index));
+			return index;
+		}
+		case cgltf_component_type_r_32u:
+		{
+			UINT index;
+			memcpy(&index, source, sizeof(index));
+			return index;
+		}
+		default:
+			throw std::runtime_error("Unsupported glTF index component type");
+		}
+	}
+
+	// Reads the first indexCount indices, relative to the primitive's own vertices. cgltf reads neither single sparse
+	// indices nor unpacks sparse index accessors, so the dense indices are read first (zeros without a buffer view) and
+	// the sparse values substituted afterwards
+	static void ReadIndices(const cgltf_accessor* accessor, UINT* indices, size_t indexCount)
+	{
+		const uint8_t* view = accessor->buffer_view ? cgltf_buffer_view_data(accessor->buffer_view) : nullptr;
+		if (!view)
+		{
+			if (accessor->buffer_view || !accessor->is_sparse)
+				throw std::runtime_error("glTF index accessor without data");
+			std::fill(indices, indices + indexCount, 0u);
+		}
+		else if (accessor->component_type == cgltf_component_type_r_32u && accessor->stride == sizeof(UINT))
+		{
+			memcpy(indices, view + accessor->offset, indexCount * sizeof(UINT));
+		}
+		else
+		{
+			const uint8_t* source = view + accessor->offset;
+			for (size_t i = 0; i < indexCount; i++)
+				indices[i] = ReadIndex(source + i * accessor->stride, accessor->component_type);
+		}
+
+		if (!accessor->is_sparse)
+			return;
+		const cgltf_accessor_sparse& sparse = accessor->sparse;
+		const uint8_t* sparseIndices = cgltf_buffer_view_data(sparse.indices_buffer_view);
+		const uint8_t* sparseValues = cgltf_buffer_view_data(sparse.values_buffer_view);
+		if (!sparseIndices || !sparseValues)
+			throw std::runtime_error("glTF sparse index accessor without data");
+		sparseIndices += sparse.indices_byte_offset;
+		sparseValues += sparse.values_byte_offset;
+		const size_t indexSize = cgltf_component_size(sparse.indices_component_type), valueSize = cgltf_component_size(accessor->component_type);
+		for (size_t i = 0; i < sparse.count; i++)
+		{
+			const UINT target = ReadIndex(sparseIndices + i * indexSize, sparse.indices_component_type);
+			if (target < indexCount)
+				indices[target] = ReadIndex(sparseValues + i * valueSize, accessor->component_type);
+		}
+	}
+
+	// Area weighted vertex normals for primitives that come without them
+	static void ComputeNormals(Vertex* vertices, size_t vertexCount, const UINT* indices, size_t indexCount)
+	{
+		std::vector<DirectX::XMVECTOR> normals(vertexCount, DirectX::XMVectorZero());
+		for (size_t i = 0; i + 2 < indexCount; i += 3)
+		{
+			DirectX::XMVECTOR p0 = DirectX::XMLoadFloat3(&vertices[indices[i]].Position);
+			DirectX::XMVECTOR p1 = DirectX::XMLoadFloat3(&vertices[indices[i + 1]].Position);
+			DirectX::XMVECTOR p2 = DirectX::XMLoadFloat3(&vertices[indices[i + 2]].Position);
+			DirectX::XMVECTOR faceNormal = DirectX::XMVector3Cross(DirectX::XMVectorSubtract(p1, p0), DirectX::XMVectorSubtract(p2, p0));
+			for (size_t corner = 0; corner < 3; corner++)
+				normals[indices[i + corner]] = DirectX::XMVectorAdd(normals[indices[i + corner]], faceNormal);
+		}
+		for (size_t v = 0; v < vertexCount; v++)
+			DirectX::XMStoreFloat3(&vertices[v].Normal, DirectX::XMVector3Normalize(normals[v]));
+	}
+
+	struct GltfPrimitive
+	{
+		const cgltf_primitive* Primitive = nullptr;
+		const cgltf_accessor* Positions = nullptr;
+		const cgltf_accessor* Normals = nullptr;
+		const cgltf_accessor* Tangents = nullptr;
+		const cgltf_accessor* TexCoords = nullptr;
+		size_t IndexCount = 0; // Whole triangles only
+	};
+
+	// Returns false for primitives the renderer cannot draw (points, lines, strips, missing positions)
+	static bool GetPrimitive(const cgltf_primitive& primitive, GltfPrimitive& result)
+	{
+		if (primitive.type != cgltf_primitive_type_triangles)
+			return false;
+
+		result.Primitive = &primitive;
+		for (cgltf_size i = 0; i < primitive.attributes_count; i++)
+		{
+			const cgltf_attribute& attribute = primitive.attributes[i];
+			switch (attribute.type)
+			{
+			case cgltf_attribute_type_position:
+				result.Positions = attribute.data;
+				break;
+			case cgltf_attribute_type_normal:
+				result.Normals = attribute.data;
+				break;
+			case cgltf_attribute_type_tangent:
+				result.Tangents = attribute.data;
+				break;
+			case cgltf_attribute_type_texcoord:
+				if (attribute.index == 0)
+					result.TexCoords = attribute.data;
+				break;
+			default:
+				break;
+			}
+		}
+		if (!result.Positions || result.Positions->count == 0)
+			return false;
+
+		result.IndexCount = (primitive.indices ? primitive.indices->count : result.Positions->count) / 3 * 3;
+		return true;
+	}
+
+	// Fills the primitive's range of the mesh vertices and indices, which are already sized for every primitive
+	static void ReadPrimitive(const GltfPrimitive& primitive, Mesh& mesh, UINT vertexOffset, UINT indexOffset)
+	{
+		const size_t vertexCount = primitive.Positions->count;
+		Vertex* vertices = &mesh.Vertices[vertexOffset];
+		UINT* indices = mesh.Indices.data() + indexOffset;
+		ReadAccessor(primitive.Positions, 3, &vertices->Position, sizeof(Vertex));
+		if (primitive.Normals)
+			ReadAccessor(primitive.Normals, 3, &vertices->Normal, sizeof(Vertex));
+		if (primitive.TexCoords)
+			ReadAccessor(primitive.TexCoords, 2, &vertices->TexCoord, sizeof(Vertex));
+
+		if (primitive.Primitive->indices)
+		{
+			ReadIndices(primitive.Primitive->indices, indices, primitive.IndexCount);
+			for (size_t i = 0; i < primitive.IndexCount; i++)
+			{
+				if (indices[i] >= vertexCount)
+					throw std::runtime_error("glTF primitive index out of range");
+			}
+		}
+		else
+		{
+			std::iota(indices, indices + primitive.IndexCount, 0u);
+		}
+
+		// glTF tangents use the same handedness convention as TangentGenerator, but are only valid alongside the normals
+		if (!primitive.Normals)
+			ComputeNormals(vertices, vertexCount, indices, primitive.IndexCount);
+		if (primitive.Tangents && primitive.Normals)
+		{
+			ReadAccessor(primitive.Tangents, 4, &vertices->Tangent, sizeof(Vertex));
+		}
+		else
+		{
+			TangentGenerator::Generate(&vertices->Position, sizeof(Vertex), &vertices->Normal, sizeof(Vertex), &vertices->TexCoord, sizeof(Vertex),
+				vertexCount, indices, primitive.IndexCount, &vertices->Tangent, sizeof(Vertex));
+		}
+
+		// The generators above work on the primitive's own vertices, so the indices are rebased only once they are done
+		if (vertexOffset > 0)
+		{
+			for (size_t i = 0; i < primitive.IndexCount; i++)
+				indices[i] += vertexOffset;
+		}
+	}
+
+	static std::wstring GetTexturePath(const cgltf_texture_view& view, const std::filesystem::path& directory)
+	{
+		if (!view.texture || !view.texture->image)
+			return {};
+
+		// Images embedded in buffers or data URIs would need a WIC memory load, they are reported and skipped for now
+		const cgltf_image* image = view.texture->image;
+		if (!image->uri || strncmp(image->uri, "data:", 5) == 0)
+		{
+			std::cerr << "glTF Warning: embedded image " << (image->name ? image->name : "") << " is not supported" << std::endl;
+			return {};
+		}
+		return (directory / DecodeUri(image->uri)).wstring();
+	}
+
+	static GltfMaterial ReadMaterial(const cgltf_material& material, const std::filesystem::path& directory)
+	{
+		GltfMaterial result;
+		result.Name = material.name ? material.name : "";
+		result.EmissiveFactor = { material.emissive_factor[0], material.emissive_factor[1], material.emissive_factor[2] };
+
+		auto addTexture = [&](TextureType type, const cgltf_texture_view& view)
+		{
+			std::wstring path = GetTexturePath(view, directory);
+			if (!path.empty())
+				result.Textures[type] = path;
+		};
+
+		if (material.has_pbr_metallic_roughness)
+		{
+			const cgltf_pbr_metallic_roughness& pbr = material.pbr_metallic_roughness;
+			result.BaseColorFactor = { pbr.base_color_factor[0], pbr.base_color_factor[1], pbr.base_color_factor[2], pbr.base_color_factor[3] };
+			result.MetallicFactor = pbr.metallic_factor;
+			result.RoughnessFactor = pbr.roughness_factor;
+			addTexture(TextureType::Albedo, pbr.base_color_texture);
+			addTexture(TextureType::Metallic, pbr.metallic_roughness_texture);
+			addTexture(TextureType::Roughness, pbr.metallic_roughness_texture);
+		}
+		addTexture(TextureType::Normal, material.normal_texture);
+		addTexture(TextureType::AOMap, material.occlusion_texture);
+		return result;
+	}
+
+	GltfModel ModelLoader::LoadGltf(const std::string& filename, const ModelLoadOptions& options)
+	{
+		// The JSON and the GLB binary chunk are parsed in place, so the mapping has to outlive the cgltf data
+		MappedFile file(filename);
+		if (!file.IsOpen())
+			throw std::runtime_error("Failed to open glTF file: " + filename);
+
+		cgltf_options gltfOptions = {};
+		cgltf_data* parsed = nullptr;
+		if (cgltf_parse(&gltfOptions, file.GetData(), file.GetSize(), &parsed) != cgltf_result_success)
+			throw std::runtime_error("Failed to parse glTF file: " + filename);
+
+		const std::filesystem::path directory = std::filesystem::path(filename).parent_path();
+		std::vector<std::unique_ptr<MappedFile>> mappedBuffers;
+		GltfDataPtr data(parsed, &cgltf_free);
+
+		// External .bin buffers are mapped rather than read. cgltf_load_buffers skips buffers that already have data and
+		// points the GLB buffer at the mapped binary chunk, only data URIs end up being decoded into memory
+		for (cgltf_size i = 0; i < data->buffers_count; i++)
+		{
+			cgltf_buffer& buffer = data->buffers[i];
+			if (!buffer.uri || strncmp(buffer.uri, "data:", 5) == 0)
+				continue;
+
+			auto mapped = std::make_unique<MappedFile>((directory / DecodeUri(buffer.uri)).string());
+			if (!mapped->IsOpen() || mapped->GetSize() < buffer.size)
+				throw std::runtime_error("Failed to map glTF buffer " + std::string(buffer.uri) + " of " + filename);
+			buffer.data = const_cast<uint8_t*>(mapped->GetData());
+			buffer.data_free_method = cgltf_data_free_method_none;
+			mappedBuffers.push_back(std::move(mapped));
+		}
+		if (cgltf_load_buffers(&gltfOptions, data.get(), filename.c_str()) != cgltf_result_success)
+			throw std::runtime_error("Failed to load glTF buffers: " + filename);
+		if (cgltf_validate(data.get()) != cgltf_result_success)
+			throw std::runtime_error("Invalid glTF file: " + filename);
+
+		GltfModel model;
+		model.Materials.reserve(data->materials_count);
+		for (cgltf_size i = 0; i < data->materials_count; i++)
+			model.Materials.push_back(ReadMaterial(data->materials[i], directory));
+
+		model.Meshes.resize(data->meshes_count);
+		for (cgltf_size i = 0; i < data->meshes_count; i++)
+		{
+			const cgltf_mesh& gltfMesh = data->meshes[i];
+			GltfMesh& mesh = model.Meshes[i];
+			mesh.Name = gltfMesh.name ? gltfMesh.name : "";
+
+			// Sizes the shared buffers first so every primitive is read straight into its final range
+			std::vector<GltfPrimitive> primitives;
+			size_t vertexCount = 0, indexCount = 0;
+			for (cgltf_size p = 0; p < gltfMesh.primitives_count; p++)
+			{
+				GltfPrimitive primitive;
+				if (!GetPrimitive(gltfMesh.primitives[p], primitive))
+				{
+					std::cerr << "glTF Warning: skipping non-triangle primitive " << p << " of mesh " << mesh.Name << std::endl;
+					continue;
+				}
+				vertexCount += primitive.Positions->count;
+				indexCount += primitive.IndexCount;
+				primitives.push_back(primitive);
+			}
+			if (vertexCount > UINT_MAX || indexCount > UINT_MAX)
+				throw std::runtime_error("glTF mesh " + mesh.Name + " is too large");
+			mesh.Geometry.Vertices.assign(vertexCount, Vertex{});
+			mesh.Geometry.Indices.resize(indexCount);
+
+			// Each primitive keeps its own submesh and material slot
+			UINT vertexOffset = 0, indexOffset = 0;
+			for (const GltfPrimitive& primitive : primitives)
+			{
+				ReadPrimitive(primitive, mesh.Geometry, vertexOffset, indexOffset);
+				const UINT slot = static_cast<UINT>(mesh.SlotMaterials.size());
+				mesh.Geometry.Submeshes.push_back({ indexOffset, static_cast<UINT>(primitive.IndexCount), slot, 0, 0 });
+				mesh.SlotMaterials.push_back(primitive.Primitive->material ? static_cast<int>(primitive.Primitive->material - data->materials) : -1);
+				vertexOffset += static_cast<UINT>(primitive.Positions->count);
+				indexOffset += static_cast<UINT>(primitive.IndexCount);
+			}
+			if (!mesh.Geometry.Indices.empty())
+				ProcessMesh(mesh.Geometry, options);
+		}
+
+		// cgltf matrices are column-major for column vectors, which is the same memory layout as a row-vector XMFLOAT4X4
+		model.Nodes.resize(data->nodes_count);
+		for (cgltf_size i = 0; i < data->nodes_count; i++)
+		{
+			const cgltf_node& gltfNode = data->nodes[i];
+			GltfNode& node = model.Nodes[i];
+			node.Name = gltfNode.name ? gltfNode.name : "";
+			node.Parent = gltfNode.parent ? static_cast<int>(gltfNode.parent - data->nodes) : -1;
+			node.MeshIndex = gltfNode.mesh ? static_cast<int>(gltfNode.mesh - data->meshes) : -1;
+			for (cgltf_size c = 0; c < gltfNode.children_count; c++)
+				node.Children.push_back(static_cast<UINT>(gltfNode.children[c] - data->nodes));
+			cgltf_node_transform_local(&gltfNode, &node.LocalTransform.m[0][0]);
+			cgltf_node_transform_world(&gltfNode, &node.WorldTransform.m[0][0]);
+		}
+
+		const cgltf_scene* scene = data->scene ? data->scene : (data->scenes_count > 0 ? &data->scenes[0] : nullptr);
+		if (scene)
+		{
+			for (cgltf_size i = 0; i < scene->nodes_count; i++)
+				model.RootNodes.push_back(static_cast<UINT>(scene->nodes[i] - data->nodes));
+		}
+		else
+		{
+			for (UINT i = 0; i < model.Nodes.size(); i++)
+			{
+				if (model.Nodes[i].Parent < 0)
+					model.RootNodes.push_back(i);
+			}
+		}
+		return model;
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "../Resources/Mesh.h"
+#include "../Resources/Texture.h"
+#include <DirectXMath.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace DX12Engine
+{
+	// glTF metallic-roughness material. Texture paths are resolved against the model directory, metallic and roughness
+	// point at the same texture (blue and green channels) as the spec packs them together
+	struct GltfMaterial
+	{
+		std::string Name;
+		DirectX::XMFLOAT4 BaseColorFactor = { 1.0f, 1.0f, 1.0f, 1.0f };
+		float MetallicFactor = 1.0f;
+		float RoughnessFactor = 1.0f;
+		DirectX::XMFLOAT3 EmissiveFactor = { 0.0f, 0.0f, 0.0f };
+		std::unordered_map<TextureType, std::wstring> Textures;
+	};
+
+	// All primitives share one vertex and index buffer, primitive i is drawn as material slot i
+	struct GltfMesh
+	{
+		std::string Name;
+		Mesh Geometry;
+		std::vector<int> SlotMaterials; // Index into GltfModel::Materials per material slot, -1 for the default material
+	};
+
+	// Transforms use the row-vector convention of DirectXMath, so WorldTransform can go straight into SetModelMatrix
+	struct GltfNode
+	{
+		std::string Name;
+		int Parent = -1;
+		int MeshIndex = -1; // Index into GltfModel::Meshes
+		std::vector<UINT> Children;
+		DirectX::XMFLOAT4X4 LocalTransform;
+		DirectX::XMFLOAT4X4 WorldTransform;
+	};
+
+	struct GltfModel
+	{
+		std::vector<GltfMesh> Meshes;
+		std::vector<GltfMaterial> Materials;
+		std::vector<GltfNode> Nodes;
+		std::vector<UINT> RootNodes; // Roots of the default scene
+	};
+}
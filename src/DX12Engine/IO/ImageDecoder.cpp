@@ -0,0 +1,84 @@
+#include "ImageDecoder.h"
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <stdexcept>
+#include <cstring>
+#include <cwctype>
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_NO_STDIO
+#define STBI_FAILURE_USERMSG
+#include "stb_image.h"
+
+namespace DX12Engine
+{
+	static std::string ToNarrow(const std::wstring& text)
+	{
+		return std::filesystem::path(text).string();
+	}
+
+	static DXGI_FORMAT GetFormat(int channels, bool is16Bit, bool isHdr)
+	{
+		if (isHdr)
+			return DXGI_FORMAT_R32G32B32A32_FLOAT;
+		switch (channels)
+		{
+		case 1: return is16Bit ? DXGI_FORMAT_R16_UNORM : DXGI_FORMAT_R8_UNORM;
+		case 2: return is16Bit ? DXGI_FORMAT_R16G16_UNORM : DXGI_FORMAT_R8G8_UNORM;
+		default: return is16Bit ? DXGI_FORMAT_R16G16B16A16_UNORM : DXGI_FORMAT_R8G8B8A8_UNORM;
+		}
+	}
+
+	void ImageDecoder::Decode(const std::wstring& filename, DirectX::ScratchImage& image)
+	{
+		const std::filesystem::path path(filename);
+		std::wstring extension = path.extension().wstring();
+		for (wchar_t& c : extension)
+			c = static_cast<wchar_t>(towlower(c));
+		if (extension == L".dds")
+		{
+			if (FAILED(DirectX::LoadFromDDSFile(filename.c_str(), DirectX::DDS_FLAGS_NONE, nullptr, image)))
+				throw std::runtime_error("Failed to load DDS file: " + ToNarrow(filename));
+			return;
+		}
+
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file)
+			throw std::runtime_error("Failed to open image: " + ToNarrow(filename));
+		std::vector<stbi_uc> bytes(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+
+		const int byteCount = static_cast<int>(bytes.size());
+		int width = 0, height = 0, channels = 0;
+		if (!stbi_info_from_memory(bytes.data(), byteCount, &width, &height, &channels))
+			throw std::runtime_error("Failed to decode " + ToNarrow(filename) + ": " + stbi_failure_reason());
+
+		// Three channel images have no DXGI format, they are expanded to RGBA
+		const bool isHdr = stbi_is_hdr_from_memory(bytes.data(), byteCount) != 0;
+		const bool is16Bit = !isHdr && stbi_is_16_bit_from_memory(bytes.data(), byteCount) != 0;
+		const int outputChannels = isHdr || channels >= 3 ? 4 : channels;
+		void* pixels = nullptr;
+		if (isHdr)
+			pixels = stbi_loadf_from_memory(bytes.data(), byteCount, &width, &height, &channels, outputChannels);
+		else if (is16Bit)
+			pixels = stbi_load_16_from_memory(bytes.data(), byteCount, &width, &height, &channels, outputChannels);
+		else
+			pixels = stbi_load_from_memory(bytes.data(), byteCount, &width, &height, &channels, outputChannels);
+		if (!pixels)
+			throw std::runtime_error("Failed to decode " + ToNarrow(filename) + ": " + stbi_failure_reason());
+
+		HRESULT hr = image.Initialize2D(GetFormat(outputChannels, is16Bit, isHdr), width, height, 1, 1);
+		if (SUCCEEDED(hr))
+		{
+			const DirectX::Image* target = image.GetImage(0, 0, 0);
+			const size_t sourcePitch = static_cast<size_t>(width) * outputChannels * (isHdr ? sizeof(float) : is16Bit ? sizeof(uint16_t) : sizeof(stbi_uc));
+			for (int y = 0; y < height; y++)
+				memcpy(target->pixels + y * target->rowPitch, static_cast<const uint8_t*>(pixels) + y * sourcePitch, sourcePitch);
+		}
+		stbi_image_free(pixels);
+		if (FAILED(hr))
+			throw std::runtime_error("Failed to allocate image for: " + ToNarrow(filename));
+	}
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <DirectXTex.h>
+#include <string>
+
+namespace DX12Engine
+{
+	// Decodes image files without WIC, so it needs no COM setup on worker threads and builds on every platform. DDS goes
+	// through DirectXTex, everything else (PNG, JPEG, TGA, BMP, HDR) through stb_image
+	class ImageDecoder
+	{
+	public:
+		// 8 and 16-bit images keep one or two channels (R, RG) and are expanded to RGBA otherwise, HDR decodes to float
+		// RGBA. Throws std::runtime_error if the file can't be read or decoded
+		static void Decode(const std::wstring& filename, DirectX::ScratchImage& image);
+	};
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <wtypes.h>
+#include <string>
+#include <cstdint>
+
+namespace DX12Engine
+{
+	// Read-only memory mapping of a file on disk
+	class MappedFile
+	{
+	public:
+		MappedFile(const std::string& filename);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool IsOpen() const { return m_Data != nullptr; }
+		const uint8_t* GetData() const { return m_Data; }
+		size_t GetSize() const { return m_Size; }
+
+	private:
+		HANDLE m_File;
+		HANDLE m_Mapping;
+		const uint8_t* m_Data;
+		size_t m_Size;
+	};
+}
+
@@ -0,0 +1,171 @@
+#include "MaterialLoader.h"
+#include "ImageDecoder.h"
+#include "../Imaging/ORMPacker.h"
+#include "TextureLoader.h"
+#include "../Rendering/GPUUploader.h"
+#include "../Resources/ResourceManager.h"
+#include "../Utils/Constants.h"
+#include <algorithm>
+
+namespace DX12Engine
+{
+	MaterialLoader::MaterialLoader(UINT threadCount)
+		: m_Pool(threadCount), m_MaterialCount(0)
+	{
+	}
+
+	size_t MaterialLoader::Request(const std::wstring& materialDirectory)
+	{
+		return Request(TextureLoader::FindMaterialMaps(materialDirectory));
+	}
+
+	size_t MaterialLoader::Request(const std::unordered_map<TextureType, std::wstring>& paths)
+	{
+		if (m_Pending.empty())
+			m_StartTime = std::chrono::steady_clock::now();
+
+		const size_t material = m_MaterialCount++;
+
+		// Occlusion, roughness and metallic are packed into one map, keyed by all of its sources
+		std::unordered_map<TextureType, std::wstring> maps = paths;
+		std::unordered_map<TextureType, std::wstring> ormSources;
+		if (ORMPacker::ExtractSources(maps, ormSources))
+		{
+			std::wstring key = L"orm";
+			for (TextureType type : { TextureType::AOMap, TextureType::Roughness, TextureType::Metallic })
+				key += L"|" + (ormSources.count(type) ? ormSources[type] : std::wstring());
+			auto [it, inserted] = m_PendingByPath.try_emplace(key, m_Pending.size());
+			if (inserted)
+			{
+				PendingImage pending;
+				pending.Image = m_Pool.Submit([ormSources]()
+				{
+					DecodedImage decoded = { std::make_unique<DirectX::ScratchImage>() };
+					decoded.Info = TextureCooker::LoadORM(ormSources, *decoded.Image, TEXTURE_STREAMING_INITIAL_SIZE);
+					decoded.DecodedAt = std::chrono::steady_clock::now();
+					return decoded;
+				});
+				m_Pending.push_back(std::move(pending));
+			}
+			m_Pending[it->second].Users.push_back({ material, TextureType::ORM });
+			for (const auto& [type, source] : ormSources)
+				m_Pending[it->second].Users.push_back({ material, type });
+		}
+
+		std::unordered_map<std::wstring, DXGI_FORMAT> formats = TextureCooker::GetCookedFormats(maps);
+		for (const auto& [type, path] : maps)
+		{
+			auto [it, inserted] = m_PendingByPath.try_emplace(path, m_Pending.size());
+			if (inserted)
+			{
+				PendingImage pending;
+				// Cooking runs on the worker too, with the mip filter of the first slot using the file
+				const DXGI_FORMAT format = formats[path];
+				const MipFilter filter = MipGenerator::GetFilter(type);
+				pending.Image = m_Pool.Submit([path, format, filter]()
+				{
+					DecodedImage decoded = { std::make_unique<DirectX::ScratchImage>() };
+					decoded.Info = TextureCooker::Load(path, format, filter, *decoded.Image, TEXTURE_STREAMING_INITIAL_SIZE);
+					decoded.DecodedAt = std::chrono::steady_clock::now();
+					return decoded;
+				});
+				m_Pending.push_back(std::move(pending));
+			}
+			m_Pending[it->second].Users.push_back({ material, type });
+		}
+		return material;
+	}
+
+	std::vector<size_t> MaterialLoader::GetMaterials(const PendingImage& pending)
+	{
+		// An ORM map lists its material once per packed slot
+		std::vector<size_t> materials;
+		for (const auto& [material, type] : pending.Users)
+		{
+			if (std::find(materials.begin(), materials.end(), material) == materials.end())
+				materials.push_back(material);
+		}
+		return materials;
+	}
+
+	void MaterialLoader::WaitForDecodes()
+	{
+		for (PendingImage& pending : m_Pending)
+			pending.Image.wait();
+	}
+
+	std::vector<MaterialTextures> MaterialLoader::Finish(GPUUploader& uploader)
+	{
+		std::vector<MaterialTextures> materials(m_MaterialCount);
+		std::vector<Texture*> batchTextures;
+		std::exception_ptr error = nullptr;
+		auto decodeEnd = m_StartTime;
+		UINT cacheHits = 0;
+
+		// Images left to collect per material, a material's textures are submitted once it has all of them
+		std::vector<UINT> remainingImages(m_MaterialCount, 0);
+		for (const PendingImage& pending : m_Pending)
+		{
+			for (size_t material : GetMaterials(pending))
+				remainingImages[material]++;
+		}
+
+		// The textures own their decoded images and free them as soon as their batch is recorded
+		auto uploadBatch = [&]()
+		{
+			if (batchTextures.empty())
+				return;
+			uploader.UploadTextureBatch(batchTextures);
+			batchTextures.clear();
+		};
+
+		// Collected in request order, so early materials upload while later ones are still decoding
+		for (PendingImage& pending : m_Pending)
+		{
+			bool materialComplete = false;
+			for (size_t material : GetMaterials(pending))
+				materialComplete |= --remainingImages[material] == 0;
+
+			DecodedImage decoded;
+			try
+			{
+				decoded = pending.Image.get();
+			}
+			catch (...)
+			{
+				if (!error)
+					error = std::current_exception();
+				continue;
+			}
+			decodeEnd = (std::max)(decodeEnd, decoded.DecodedAt);
+			cacheHits += decoded.Info.FromCache ? 1 : 0;
+			if (error)
+				continue;
+
+			std::shared_ptr<Texture> texture = ResourceManager::GetInstance().CreateTexture(decoded.Info.Metadata, std::move(decoded.Image));
+			if (!decoded.Info.StreamPath.empty())
+				ResourceManager::GetInstance().GetTextureStreamer().Register(texture, decoded.Info.StreamPath);
+			for (const auto& [material, type] : pending.Users)
+				materials[material][type] = texture;
+			batchTextures.push_back(texture.get());
+			if (materialComplete || batchTextures.size() >= MAX_UPLOAD_BATCH_SIZE)
+				uploadBatch();
+		}
+		if (!error)
+			uploadBatch();
+
+		auto end = std::chrono::steady_clock::now();
+		m_LastStatistics.ThreadCount = m_Pool.GetThreadCount();
+		m_LastStatistics.ImageCount = static_cast<UINT>(m_Pending.size());
+		m_LastStatistics.CacheHitCount = cacheHits;
+		m_LastStatistics.DecodeMilliseconds = std::chrono::duration<float, std::milli>(decodeEnd - m_StartTime).count();
+		m_LastStatistics.TotalMilliseconds = std::chrono::duration<float, std::milli>(end - m_StartTime).count();
+
+		m_Pending.clear();
+		m_PendingByPath.clear();
+		m_MaterialCount = 0;
+		if (error)
+			std::rethrow_exception(error);
+		return materials;
+	}
+}
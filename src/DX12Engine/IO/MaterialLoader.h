@@ -0,0 +1,74 @@
+#pragma once
+#include "../Resources/Texture.h"
+#include "../Utils/ThreadPool.h"
+#include "../Imaging/TextureCooker.h"
+#include <DirectXTex.h>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <chrono>
+
+namespace DX12Engine
+{
+	class GPUUploader;
+
+	typedef std::unordered_map<TextureType, std::shared_ptr<Texture>> MaterialTextures;
+
+	struct MaterialLoadStatistics
+	{
+		UINT ThreadCount = 0;
+		UINT ImageCount = 0;
+		UINT CacheHitCount = 0; // Images loaded from the block compressed cache instead of being decoded
+		float DecodeMilliseconds = 0.0f; // From the first request until the last image was decoded
+		float TotalMilliseconds = 0.0f; // Including texture creation and upload submission
+	};
+
+	// Decodes the maps of many materials concurrently on a thread pool, starting as soon as they are requested. Maps are
+	// loaded through TextureCooker, so only images without a cooked DDS are decoded and compressed, and cooked maps larger
+	// than TEXTURE_STREAMING_INITIAL_SIZE only read their small mips and are handed to the TextureStreamer. Finish creates
+	// the textures on the calling thread and submits each material's upload as soon as its last map is decoded, while
+	// later images are still decoding
+	class MaterialLoader
+	{
+	public:
+		MaterialLoader(UINT threadCount = 0); // 0 = hardware concurrency
+
+		// Both return the index of the material in the Finish result. Maps sharing a file are decoded once, AOMap, Roughness
+		// and Metallic are packed into one ORM texture, which also fills the slots of the channels it holds
+		size_t Request(const std::wstring& materialDirectory);
+		size_t Request(const std::unordered_map<TextureType, std::wstring>& paths);
+
+		// Blocks until every requested map is decoded and its upload submitted, then clears the requests. A decode failure
+		// is rethrown after the remaining decodes finished
+		std::vector<MaterialTextures> Finish(GPUUploader& uploader);
+		// Blocks until every requested map is decoded without taking them, Finish still creates the textures. Lets the decode
+		// be timed on its own
+		void WaitForDecodes();
+
+		const MaterialLoadStatistics& GetLastStatistics() const { return m_LastStatistics; }
+
+	private:
+		struct DecodedImage
+		{
+			std::unique_ptr<DirectX::ScratchImage> Image;
+			std::chrono::steady_clock::time_point DecodedAt;
+			TextureLoadInfo Info;
+		};
+
+		struct PendingImage
+		{
+			std::future<DecodedImage> Image;
+			std::vector<std::pair<size_t, TextureType>> Users; // Material index and slot
+		};
+
+		// Each material using the image once
+		static std::vector<size_t> GetMaterials(const PendingImage& pending);
+
+		ThreadPool m_Pool;
+		std::vector<PendingImage> m_Pending;
+		std::unordered_map<std::wstring, size_t> m_PendingByPath;
+		size_t m_MaterialCount;
+		std::chrono::steady_clock::time_point m_StartTime;
+		MaterialLoadStatistics m_LastStatistics;
+	};
+}
@@ -0,0 +1,155 @@
+#include "MeshCache.h"
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+
+namespace DX12Engine
+{
+	CookedMesh::CookedMesh(std::unique_ptr<MappedFile> file)
+		: m_File(std::move(file))
+	{
+		m_Header = reinterpret_cast<const MeshCacheHeader*>(m_File->GetData());
+	}
+
+	CookedMesh::~CookedMesh()
+	{
+		m_Header = nullptr;
+	}
+
+	std::unique_ptr<CookedMesh> MeshCache::Load(const std::string& sourcePath, uint64_t optionsHash)
+	{
+		std::string cachePath = GetCachePath(sourcePath);
+		if (!std::filesystem::exists(cachePath) || !std::filesystem::exists(sourcePath))
+			return nullptr;
+
+		auto file = std::make_unique<MappedFile>(cachePath);
+		if (!file->IsOpen() || file->GetSize() < sizeof(MeshCacheHeader))
+			return nullptr;
+
+		const MeshCacheHeader* header = reinterpret_cast<const MeshCacheHeader*>(file->GetData());
+		if (!IsHeaderValid(*header, sourcePath, optionsHash, file->GetSize()))
+			return nullptr;
+
+		return std::make_unique<CookedMesh>(std::move(file));
+	}
+
+	void MeshCache::Write(const std::string& sourcePath, const Mesh& mesh, uint64_t optionsHash, const MeshOptimizationStatistics& statistics)
+	{
+		MeshCacheHeader header = {};
+		header.Magic = MESH_CACHE_MAGIC;
+		header.Version = MESH_CACHE_VERSION;
+		header.SourceSize = std::filesystem::file_size(sourcePath);
+		header.SourceWriteTime = std::filesystem::last_write_time(sourcePath).time_since_epoch().count();
+		header.SourceHash = HashFile(sourcePath);
+		header.OptionsHash = optionsHash;
+		header.VertexCount = static_cast<uint32_t>(mesh.Vertices.size());
+		header.IndexCount = static_cast<uint32_t>(mesh.Indices.size());
+		header.IndexStride = mesh.UsesShortIndices() ? sizeof(uint16_t) : sizeof(UINT);
+		header.VertexStride = GetVertexStride(mesh.Format);
+		header.Format = mesh.Format;
+		header.Quantization = mesh.Quantization;
+
+		const uint64_t positionSize = static_cast<uint64_t>(GetPositionStride(mesh.Format)) * header.VertexCount;
+		const uint64_t attributeSize = static_cast<uint64_t>(GetAttributeStride(mesh.Format)) * header.VertexCount;
+		header.PositionOffset = (sizeof(MeshCacheHeader) + 15) & ~15ull;
+		header.AttributeOffset = (header.PositionOffset + positionSize + 15) & ~15ull;
+		header.IndexOffset = (header.AttributeOffset + attributeSize + 15) & ~15ull;
+		const uint64_t indexSize = static_cast<uint64_t>(header.IndexStride) * header.IndexCount;
+		header.MeshletOffset = (header.IndexOffset + indexSize + 15) & ~15ull;
+		header.MeshletCount = static_cast<uint32_t>(mesh.Meshlets.size());
+		const uint64_t meshletSize = sizeof(Meshlet) * static_cast<uint64_t>(header.MeshletCount);
+		header.SubmeshOffset = (header.MeshletOffset + meshletSize + 15) & ~15ull;
+		header.SubmeshCount = static_cast<uint32_t>(mesh.Submeshes.size());
+		header.Bounds = mesh.Bounds;
+		header.Optimization = statistics;
+		header.LodCount = static_cast<uint32_t>((std::min)(mesh.Lods.size(), static_cast<size_t>(MAX_MESH_LODS)));
+		std::copy_n(mesh.Lods.begin(), header.LodCount, header.Lods);
+
+		// Write to a temporary file first so a crash mid-write never leaves a valid looking cache behind
+		std::string cachePath = GetCachePath(sourcePath);
+		std::string tempPath = cachePath + ".tmp";
+		{
+			std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+			if (!out)
+				throw std::runtime_error("Failed to open mesh cache for writing: " + tempPath);
+
+			std::vector<uint8_t> positions(positionSize);
+			std::vector<uint8_t> attributes(attributeSize);
+			SplitVertexStreams(mesh.GetVertexData(), header.VertexCount, mesh.Format, positions.data(), attributes.data());
+
+			const char padding[16] = {};
+			out.write(reinterpret_cast<const char*>(&header), sizeof(MeshCacheHeader));
+			out.write(padding, header.PositionOffset - sizeof(MeshCacheHeader));
+			out.write(reinterpret_cast<const char*>(positions.data()), positionSize);
+			out.write(padding, header.AttributeOffset - (header.PositionOffset + positionSize));
+			out.write(reinterpret_cast<const char*>(attributes.data()), attributeSize);
+			out.write(padding, header.IndexOffset - (header.AttributeOffset + attributeSize));
+			if (header.IndexStride == sizeof(uint16_t))
+			{
+				std::vector<uint16_t> shortIndices(header.IndexCount);
+				for (size_t i = 0; i < shortIndices.size(); i++)
+					shortIndices[i] = static_cast<uint16_t>(mesh.Indices[i]);
+				out.write(reinterpret_cast<const char*>(shortIndices.data()), sizeof(uint16_t) * header.IndexCount);
+			}
+			else
+			{
+				out.write(reinterpret_cast<const char*>(mesh.Indices.data()), sizeof(UINT) * header.IndexCount);
+			}
+			out.write(padding, header.MeshletOffset - (header.IndexOffset + indexSize));
+			out.write(reinterpret_cast<const char*>(mesh.Meshlets.data()), meshletSize);
+			out.write(padding, header.SubmeshOffset - (header.MeshletOffset + meshletSize));
+			out.write(reinterpret_cast<const char*>(mesh.Submeshes.data()), sizeof(Submesh) * header.SubmeshCount);
+		}
+		std::filesystem::rename(tempPath, cachePath);
+	}
+
+	uint64_t MeshCache::HashFile(const std::string& path)
+	{
+		// FNV-1a
+		uint64_t hash = 14695981039346656037ull;
+		MappedFile file(path);
+		const uint8_t* data = file.GetData();
+		for (size_t i = 0; i < file.GetSize(); i++)
+		{
+			hash ^= data[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	bool MeshCache::IsHeaderValid(const MeshCacheHeader& header, const std::string& sourcePath, uint64_t optionsHash, size_t cacheSize)
+	{
+		if (header.Magic != MESH_CACHE_MAGIC || header.Version != MESH_CACHE_VERSION || header.OptionsHash != optionsHash)
+			return false;
+		if (header.IndexStride != sizeof(uint16_t) && header.IndexStride != sizeof(UINT))
+			return false;
+		if (header.VertexStride != GetVertexStride(header.Format))
+			return false;
+		if (header.IndexOffset + static_cast<uint64_t>(header.IndexStride) * header.IndexCount > cacheSize)
+			return false;
+		if (header.LodCount > MAX_MESH_LODS)
+			return false;
+		if (header.MeshletOffset + sizeof(Meshlet) * static_cast<uint64_t>(header.MeshletCount) > cacheSize)
+			return false;
+		if (header.SubmeshOffset + sizeof(Submesh) * static_cast<uint64_t>(header.SubmeshCount) > cacheSize)
+			return false;
+		if (header.LodCount > 0 && header.SubmeshCount % header.LodCount != 0)
+			return false;
+		for (uint32_t i = 0; i < header.LodCount; i++)
+		{
+			if (static_cast<uint64_t>(header.Lods[i].IndexOffset) + header.Lods[i].IndexCount > header.IndexCount)
+				return false;
+		}
+
+		uint64_t sourceSize = std::filesystem::file_size(sourcePath);
+		if (header.SourceSize != sourceSize)
+			return false;
+
+		// Matching size and write time is trusted, otherwise fall back to the content hash (e.g. fresh checkouts touch every mtime)
+		int64_t sourceWriteTime = std::filesystem::last_write_time(sourcePath).time_since_epoch().count();
+		if (header.SourceWriteTime == sourceWriteTime)
+			return true;
+		return header.SourceHash == HashFile(sourcePath);
+	}
+}
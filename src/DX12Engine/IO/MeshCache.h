@@ -0,0 +1,86 @@
+#pragma once
+#include "../Resources/Mesh.h"
+#include "MappedFile.h"
+#include "../Geometry/MeshOptimizer.h"
+#include "../Utils/Constants.h"
+#include <memory>
+#include <string>
+
+#define MESH_CACHE_MAGIC 0x4853454D // "MESH"
+#define MESH_CACHE_VERSION 12
+
+namespace DX12Engine
+{
+	struct MeshCacheHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint64_t SourceSize;
+		int64_t SourceWriteTime;
+		uint64_t SourceHash;
+		uint64_t OptionsHash;
+		uint32_t VertexCount;
+		uint32_t IndexCount;
+		uint32_t IndexStride; // 2 when the indices were narrowed to 16-bit
+		uint32_t VertexStride;
+		VertexFormat Format;
+		VertexQuantization Quantization;
+		uint64_t PositionOffset; // Position and attribute streams are stored split, ready to upload
+		uint64_t AttributeOffset;
+		uint64_t IndexOffset;
+		uint64_t MeshletOffset;
+		uint32_t MeshletCount;
+		uint64_t SubmeshOffset;
+		uint32_t SubmeshCount; // All LODs, LOD-major like Mesh::Submeshes
+		DirectX::BoundingBox Bounds;
+		MeshOptimizationStatistics Optimization;
+		uint32_t LodCount;
+		MeshLod Lods[MAX_MESH_LODS];
+	};
+
+	// Cooked mesh read straight out of a memory mapped cache file, vertex and index data are never copied
+	class CookedMesh
+	{
+	public:
+		CookedMesh(std::unique_ptr<MappedFile> file);
+		~CookedMesh();
+
+		const void* GetPositionData() const { return m_File->GetData() + m_Header->PositionOffset; }
+		const void* GetAttributeData() const { return m_File->GetData() + m_Header->AttributeOffset; }
+		const void* GetIndexData() const { return m_File->GetData() + m_Header->IndexOffset; }
+		UINT GetVertexCount() const { return m_Header->VertexCount; }
+		UINT GetIndexCount() const { return m_Header->IndexCount; }
+		UINT GetIndexStride() const { return m_Header->IndexStride; }
+		VertexFormat GetVertexFormat() const { return m_Header->Format; }
+		const VertexQuantization& GetQuantization() const { return m_Header->Quantization; }
+		const DirectX::BoundingBox& GetBounds() const { return m_Header->Bounds; }
+		const MeshOptimizationStatistics& GetOptimizationStatistics() const { return m_Header->Optimization; }
+		UINT GetLodCount() const { return m_Header->LodCount; }
+		const MeshLod* GetLods() const { return m_Header->Lods; }
+		UINT GetMeshletCount() const { return m_Header->MeshletCount; }
+		const Meshlet* GetMeshlets() const { return reinterpret_cast<const Meshlet*>(m_File->GetData() + m_Header->MeshletOffset); }
+		// Submeshes of all LODs, LOD-major
+		UINT GetSubmeshCount() const { return m_Header->SubmeshCount; }
+		const Submesh* GetSubmeshes() const { return reinterpret_cast<const Submesh*>(m_File->GetData() + m_Header->SubmeshOffset); }
+
+	private:
+		std::unique_ptr<MappedFile> m_File;
+		const MeshCacheHeader* m_Header;
+	};
+
+	class MeshCache
+	{
+	public:
+		static std::string GetCachePath(const std::string& sourcePath) { return sourcePath + ".meshbin"; }
+
+		// Returns nullptr if there is no cooked file or it is stale relative to the source
+		static std::unique_ptr<CookedMesh> Load(const std::string& sourcePath, uint64_t optionsHash = 0);
+		static void Write(const std::string& sourcePath, const Mesh& mesh, uint64_t optionsHash = 0, const MeshOptimizationStatistics& statistics = {});
+
+		static uint64_t HashFile(const std::string& path);
+
+	private:
+		static bool IsHeaderValid(const MeshCacheHeader& header, const std::string& sourcePath, uint64_t optionsHash, size_t cacheSize);
+	};
+}
+
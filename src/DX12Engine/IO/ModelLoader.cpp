@@ -1,8 +1,17 @@
 #include "ModelLoader.h"
+#include "VertexWeldMap.h"
+#include "ObjStreamReader.h"
+#include "../Geometry/TangentGenerator.h"
+#include "../Geometry/VertexCompression.h"
+#include "../Geometry/MeshSimplifier.h"
+#include "../Geometry/MeshletBuilder.h"
+#include "../Utils/EngineUtils.h"
+#include "../Utils/Constants.h"
 #include <string>
 #include <stdexcept>
 #include <iostream>
-#include <unordered_map>
+#include <algorithm>
+#include <numeric>
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "tiny_obj_loader.h"
@@ -17,26 +26,52 @@ namespace DX12Engine
     {
     }
 
-    Mesh ModelLoader::LoadObj(const std::string& filename)
+    static Vertex ReadVertex(const tinyobj::attrib_t& attrib, const tinyobj::index_t& idx)
     {
-        tinyobj::ObjReader reader;
+        // Extract vertex position
+        DirectX::XMFLOAT3 position =
+        {
+            attrib.vertices[3 * idx.vertex_index + 0],
+            attrib.vertices[3 * idx.vertex_index + 1],
+            attrib.vertices[3 * idx.vertex_index + 2]
+        };
 
-        if (!reader.ParseFromFile(filename))
+        // Extract normal
+        DirectX::XMFLOAT3 normal = { 0.0f, 0.0f, 0.0f };
+        if (idx.normal_index >= 0)
         {
-            if (!reader.Error().empty())
-                throw std::runtime_error("TinyObjReader: " + reader.Error());
-            throw std::runtime_error("Failed to load OBJ file: " + filename);
+            normal =
+            {
+                attrib.normals[(3 * idx.normal_index) + 0],
+                attrib.normals[(3 * idx.normal_index) + 1],
+                attrib.normals[(3 * idx.normal_index) + 2]
+            };
         }
 
-        if (!reader.Warning().empty())
-            std::cerr << "TinyObjReader Warning: " << reader.Warning() << std::endl;
+        // Extract texture coordinate
+        DirectX::XMFLOAT2 texCoord = { 0.0f, 0.0f };
+        if (idx.texcoord_index >= 0)
+        {
+            texCoord =
+            {
+                attrib.texcoords[2 * idx.texcoord_index + 0],
+                attrib.texcoords[2 * idx.texcoord_index + 1]
+            };
+        }
 
-        const auto& attrib = reader.GetAttrib();
-        const auto& shapes = reader.GetShapes();
-        const auto& materials = reader.GetMaterials();
+        return { position, normal, texCoord };
+    }
 
-        Mesh mesh;
-        std::unordered_map<std::string, uint32_t> uniqueVertices;
+    static void WeldShapes(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes, Mesh& mesh)
+    {
+        // Every face corner can at most produce one new vertex, so size everything up front
+        size_t cornerCount = 0;
+        for (const auto& shape : shapes)
+            cornerCount += shape.mesh.indices.size();
+
+        mesh.Vertices.reserve(cornerCount);
+        mesh.Indices.reserve(cornerCount);
+        VertexWeldMap uniqueVertices(cornerCount);
 
         // Iterate over shapes (e.g., cube, sphere, etc.)
         for (const auto& shape : shapes)
@@ -52,124 +87,230 @@ namespace DX12Engine
                     // Access indices for vertex, texture coord, and normal
                     tinyobj::index_t idx = shape.mesh.indices[indexOffset + v];
 
-                    // Extract vertex position
-                    DirectX::XMFLOAT3 position =
-                    {
-                        attrib.vertices[3 * idx.vertex_index + 0],
-                        attrib.vertices[3 * idx.vertex_index + 1],
-                        attrib.vertices[3 * idx.vertex_index + 2]
-                    };
-
-                    // Extract normal
-                    DirectX::XMFLOAT3 normal = { 0.0f, 0.0f, 0.0f };
-                    if (idx.normal_index >= 0)
-                    {
-                        normal =
-                        {
-                            attrib.normals[(3 * idx.normal_index) + 0],
-                            attrib.normals[(3 * idx.normal_index) + 1],
-                            attrib.normals[(3 * idx.normal_index) + 2]
-                        };
-                    }
-
-                    // Extract texture coordinate
-                    DirectX::XMFLOAT2 texCoord = { 0.0f, 0.0f };
-                    if (idx.texcoord_index >= 0)
-                    {
-                        texCoord =
-                        {
-                            attrib.texcoords[2 * idx.texcoord_index + 0],
-                            attrib.texcoords[2 * idx.texcoord_index + 1]
-                        };
-                    }
-
-                    // Construct a unique key for this vertex
-                    std::string key = std::to_string(idx.vertex_index) + "/" +
-                        std::to_string(idx.normal_index) + "/" +
-                        std::to_string(idx.texcoord_index);
-
-                    // Add the vertex if it hasnt been added yet
-                    if (uniqueVertices.find(key) == uniqueVertices.end())
-                    {
-                        uniqueVertices[key] = static_cast<uint32_t>(mesh.Vertices.size());
-                        mesh.Vertices.push_back({ position, normal, texCoord });
-                    }
+                    // Add the vertex if it hasn't been added yet
+                    bool inserted = false;
+                    uint32_t index = uniqueVertices.FindOrInsert({ idx.vertex_index, idx.normal_index, idx.texcoord_index }, static_cast<uint32_t>(mesh.Vertices.size()), inserted);
+                    if (inserted)
+                        mesh.Vertices.push_back(ReadVertex(attrib, idx));
+
                     // Add the index for this vertex
-                    mesh.Indices.push_back(uniqueVertices[key]);
+                    mesh.Indices.push_back(index);
                 }
                 indexOffset += fv;
             }
         }
+    }
 
-        // Compute tangents
-        std::vector<DirectX::XMFLOAT3> tan1(mesh.Vertices.size() * 2);
-        std::vector<DirectX::XMFLOAT3> tan2(tan1.begin() + mesh.Vertices.size(), tan1.end());
+    struct ObjImportChunk
+    {
+        const tinyobj::shape_t* Shape;
+        size_t FirstFace;
+        size_t FaceCount;
+        size_t FirstCorner;
+        Mesh Result;
+    };
 
-        for (size_t i = 0; i < mesh.Indices.size(); i += 3)
+    // Shapes are split into fixed-size face chunks which are welded independently, so the output only depends on the
+    // chunk layout and never on how many threads picked up the work
+    static void WeldShapesParallel(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes, UINT threadCount, Mesh& mesh)
+    {
+        std::vector<ObjImportChunk> chunks;
+        for (const auto& shape : shapes)
         {
-            UINT i1 = mesh.Indices[i];
-            UINT i2 = mesh.Indices[i + 1];
-            UINT i3 = mesh.Indices[i + 2];
-
-            const DirectX::XMFLOAT3& v1 = mesh.Vertices[i1].Position;
-            const DirectX::XMFLOAT3& v2 = mesh.Vertices[i2].Position;
-            const DirectX::XMFLOAT3& v3 = mesh.Vertices[i3].Position;
-
-            const DirectX::XMFLOAT2& w1 = mesh.Vertices[i1].TexCoord;
-            const DirectX::XMFLOAT2& w2 = mesh.Vertices[i2].TexCoord;
-            const DirectX::XMFLOAT2& w3 = mesh.Vertices[i3].TexCoord;
-
-            float x1 = v2.x - v1.x;
-            float x2 = v3.x - v1.x;
-            float y1 = v2.y - v1.y;
-            float y2 = v3.y - v1.y;
-            float z1 = v2.z - v1.z;
-            float z2 = v3.z - v1.z;
-
-            float s1 = w2.x - w1.x;
-            float s2 = w3.x - w1.x;
-            float t1 = w2.y - w1.y;
-            float t2 = w3.y - w1.y;
-
-            float r = 1.0F / (s1 * t2 - s2 * t1);
-            DirectX::XMFLOAT3 sdir =
+            size_t corner = 0;
+            const size_t faceCount = shape.mesh.num_face_vertices.size();
+            for (size_t face = 0; face < faceCount; face++)
             {
-                (t2 * x1 - t1 * x2) * r,
-                (t2 * y1 - t1 * y2) * r,
-                (t2 * z1 - t1 * z2) * r
-            };
-            DirectX::XMFLOAT3 tdir =
+                if (face % OBJ_IMPORT_CHUNK_FACES == 0)
+                    chunks.push_back({ &shape, face, (std::min)((size_t)OBJ_IMPORT_CHUNK_FACES, faceCount - face), corner, {} });
+                corner += shape.mesh.num_face_vertices[face];
+            }
+        }
+
+        EngineUtils::ParallelFor(chunks.size(), threadCount, [&](size_t chunkIndex)
+        {
+            ObjImportChunk& chunk = chunks[chunkIndex];
+            const tinyobj::mesh_t& shapeMesh = chunk.Shape->mesh;
+
+            size_t cornerCount = 0;
+            for (size_t f = chunk.FirstFace; f < chunk.FirstFace + chunk.FaceCount; f++)
+                cornerCount += shapeMesh.num_face_vertices[f];
+
+            Mesh& result = chunk.Result;
+            result.Vertices.reserve(cornerCount);
+            result.Indices.reserve(cornerCount);
+            VertexWeldMap uniqueVertices(cornerCount);
+
+            for (size_t corner = chunk.FirstCorner; corner < chunk.FirstCorner + cornerCount; corner++)
             {
-                (s1 * x2 - s2 * x1) * r,
-                (s1 * y2 - s2 * y1) * r,
-                (s1 * z2 - s2 * z1) * r
-            };
+                tinyobj::index_t idx = shapeMesh.indices[corner];
+                bool inserted = false;
+                uint32_t index = uniqueVertices.FindOrInsert({ idx.vertex_index, idx.normal_index, idx.texcoord_index }, static_cast<uint32_t>(result.Vertices.size()), inserted);
+                if (inserted)
+                    result.Vertices.push_back(ReadVertex(attrib, idx));
+                result.Indices.push_back(index);
+            }
+        });
+
+        // Prefix sum over the chunk sizes gives every chunk its slot in the merged mesh
+        std::vector<size_t> vertexOffsets(chunks.size() + 1, 0);
+        std::vector<size_t> indexOffsets(chunks.size() + 1, 0);
+        for (size_t i = 0; i < chunks.size(); i++)
+        {
+            vertexOffsets[i + 1] = vertexOffsets[i] + chunks[i].Result.Vertices.size();
+            indexOffsets[i + 1] = indexOffsets[i] + chunks[i].Result.Indices.size();
+        }
+
+        mesh.Vertices.resize(vertexOffsets.back());
+        mesh.Indices.resize(indexOffsets.back());
+        EngineUtils::ParallelFor(chunks.size(), threadCount, [&](size_t chunkIndex)
+        {
+            Mesh& result = chunks[chunkIndex].Result;
+            const UINT vertexOffset = static_cast<UINT>(vertexOffsets[chunkIndex]);
+            std::copy(result.Vertices.begin(), result.Vertices.end(), mesh.Vertices.begin() + vertexOffsets[chunkIndex]);
+            for (size_t i = 0; i < result.Indices.size(); i++)
+                mesh.Indices[indexOffsets[chunkIndex] + i] = result.Indices[i] + vertexOffset;
+            result = Mesh();
+        });
+    }
 
-            tan1[i1] = sdir;
-            tan1[i2] = sdir;
-            tan1[i3] = sdir;
+    // Stable sorts the triangles by material slot, each slot becomes one submesh
+    static void GroupSubmeshes(Mesh& mesh, const std::vector<UINT>& triangleSlots)
+    {
+        const size_t triangleCount = mesh.Indices.size() / 3;
+        std::vector<UINT> order(triangleCount);
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), [&](UINT a, UINT b) { return triangleSlots[a] < triangleSlots[b]; });
 
-            tan2[i1] = tdir;
-            tan2[i2] = tdir;
-            tan2[i3] = tdir;
+        std::vector<UINT> indices(triangleCount * 3);
+        mesh.Submeshes.clear();
+        for (size_t i = 0; i < triangleCount; i++)
+        {
+            const UINT triangle = order[i];
+            std::copy_n(mesh.Indices.begin() + triangle * 3, 3, indices.begin() + i * 3);
+            if (mesh.Submeshes.empty() || mesh.Submeshes.back().MaterialSlot != triangleSlots[triangle])
+                mesh.Submeshes.push_back({ static_cast<UINT>(i * 3), 0, triangleSlots[triangle], 0, 0 });
+            mesh.Submeshes.back().IndexCount += 3;
         }
+        mesh.Indices.swap(indices);
+    }
 
-        for (size_t i = 0; i < mesh.Vertices.size(); ++i)
+    Mesh ModelLoader::LoadObj(const std::string& filename, const ModelLoadOptions& options)
+    {
+        const UINT threadCount = GetImportThreadCount(options);
+        if (options.StreamingImport)
         {
-            const DirectX::XMFLOAT3& n = mesh.Vertices[i].Normal;
-            const DirectX::XMFLOAT3& t = tan1[i];
+            ObjStreamReader streamReader(threadCount);
+            Mesh mesh = streamReader.Read(filename);
+            TangentGenerator::Generate(mesh, threadCount);
+            ProcessMesh(mesh, options);
+            return mesh;
+        }
 
-            // Gram-Schmidt orthogonalize
-            mesh.Vertices[i].Tangent =
-            {
-                t.x - n.x * DirectX::XMVector3Dot(XMLoadFloat3(&n), XMLoadFloat3(&t)).m128_f32[0],
-                t.y - n.y * DirectX::XMVector3Dot(XMLoadFloat3(&n), XMLoadFloat3(&t)).m128_f32[0],
-                t.z - n.z * DirectX::XMVector3Dot(XMLoadFloat3(&n), XMLoadFloat3(&t)).m128_f32[0]
-            };
+        tinyobj::ObjReader reader;
+
+        if (!reader.ParseFromFile(filename))
+        {
+            if (!reader.Error().empty())
+                throw std::runtime_error("TinyObjReader: " + reader.Error());
+            throw std::runtime_error("Failed to load OBJ file: " + filename);
+        }
+
+        if (!reader.Warning().empty())
+            std::cerr << "TinyObjReader Warning: " << reader.Warning() << std::endl;
+
+        const auto& attrib = reader.GetAttrib();
+        const auto& shapes = reader.GetShapes();
+        const auto& materials = reader.GetMaterials();
+
+        Mesh mesh;
+        if (options.ParallelImport)
+            WeldShapesParallel(attrib, shapes, options.ThreadCount, mesh);
+        else
+            WeldShapes(attrib, shapes, mesh);
 
-            // Normalize the tangent
-            DirectX::XMStoreFloat3(&mesh.Vertices[i].Tangent, DirectX::XMVector3Normalize(XMLoadFloat3(&mesh.Vertices[i].Tangent)));
+        // The reader triangulates, so there is one triangle per face. Faces without a material share slot 0
+        std::vector<UINT> triangleSlots;
+        triangleSlots.reserve(mesh.Indices.size() / 3);
+        for (const auto& shape : shapes)
+        {
+            for (size_t f = 0; f < shape.mesh.num_face_vertices.size(); f++)
+                triangleSlots.push_back(f < shape.mesh.material_ids.size() ? static_cast<UINT>((std::max)(shape.mesh.material_ids[f], 0)) : 0);
         }
+        GroupSubmeshes(mesh, triangleSlots);
+
+        TangentGenerator::Generate(mesh, threadCount);
+        ProcessMesh(mesh, options);
         return mesh;
     }
+
+    // Same box as BoundingBox::CreateFromPoints, min and max are reduced per block
+    static void ComputeBounds(Mesh& mesh, UINT threadCount)
+    {
+        const size_t blockCount = (mesh.Vertices.size() + IMPORT_PARALLEL_BLOCK_SIZE - 1) / IMPORT_PARALLEL_BLOCK_SIZE;
+        std::vector<DirectX::XMVECTOR> minimums(blockCount), maximums(blockCount);
+        EngineUtils::ParallelForBlocks(mesh.Vertices.size(), IMPORT_PARALLEL_BLOCK_SIZE, threadCount, [&](size_t first, size_t last)
+        {
+            DirectX::XMVECTOR minimum = DirectX::XMLoadFloat3(&mesh.Vertices[first].Position);
+            DirectX::XMVECTOR maximum = minimum;
+            for (size_t i = first + 1; i < last; i++)
+            {
+                DirectX::XMVECTOR position = DirectX::XMLoadFloat3(&mesh.Vertices[i].Position);
+                minimum = DirectX::XMVectorMin(minimum, position);
+                maximum = DirectX::XMVectorMax(maximum, position);
+            }
+            minimums[first / IMPORT_PARALLEL_BLOCK_SIZE] = minimum;
+            maximums[first / IMPORT_PARALLEL_BLOCK_SIZE] = maximum;
+        });
+
+        DirectX::XMVECTOR minimum = minimums[0], maximum = maximums[0];
+        for (size_t block = 1; block < blockCount; block++)
+        {
+            minimum = DirectX::XMVectorMin(minimum, minimums[block]);
+            maximum = DirectX::XMVectorMax(maximum, maximums[block]);
+        }
+        DirectX::XMStoreFloat3(&mesh.Bounds.Center, DirectX::XMVectorScale(DirectX::XMVectorAdd(minimum, maximum), 0.5f));
+        DirectX::XMStoreFloat3(&mesh.Bounds.Extents, DirectX::XMVectorScale(DirectX::XMVectorSubtract(maximum, minimum), 0.5f));
+    }
+
+    UINT ModelLoader::GetImportThreadCount(const ModelLoadOptions& options)
+    {
+        return options.ParallelImport ? options.ThreadCount : 1;
+    }
+
+    void ModelLoader::ProcessMesh(Mesh& mesh, const ModelLoadOptions& options)
+    {
+        const UINT threadCount = GetImportThreadCount(options);
+        m_LastOptimizationStatistics = {};
+        if (options.OptimizeMesh)
+            m_LastOptimizationStatistics = MeshOptimizer::Optimize(mesh, options.VertexCacheSize, options.OverdrawThreshold);
+
+        if (!mesh.Vertices.empty())
+            ComputeBounds(mesh, threadCount);
+
+        // LODs are simplified from the optimized indices and appended after LOD 0, sharing the vertex buffer
+        MeshSimplifier::GenerateLods(mesh, options.LodCount, options.LodReduction, options.LodTargetError, options.VertexCacheSize);
+        if (options.BuildMeshlets)
+            MeshletBuilder::Build(mesh, options.MeshletMaxVertices, options.MeshletMaxTriangles, threadCount);
+
+        if (options.CompactVertices)
+            VertexCompression::Compress(mesh, threadCount);
+    }
+
+    std::unique_ptr<CookedMesh> ModelLoader::LoadObjCached(const std::string& filename, const ModelLoadOptions& options)
+    {
+        std::unique_ptr<CookedMesh> cookedMesh = MeshCache::Load(filename, options.GetHash());
+        if (cookedMesh)
+        {
+            m_LastOptimizationStatistics = cookedMesh->GetOptimizationStatistics();
+            return cookedMesh;
+        }
+
+        Mesh mesh = LoadObj(filename, options);
+        MeshCache::Write(filename, mesh, options.GetHash(), m_LastOptimizationStatistics);
+        cookedMesh = MeshCache::Load(filename, options.GetHash());
+        if (!cookedMesh)
+            throw std::runtime_error("Failed to load cooked mesh for: " + filename);
+        return cookedMesh;
+    }
 }
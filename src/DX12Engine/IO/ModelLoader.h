@@ -1,16 +1,86 @@
 #pragma once
 #include "../Resources/Mesh.h"
+#include "MeshCache.h"
+#include "GltfModel.h"
+#include "../Geometry/MeshOptimizer.h"
+#include "../Utils/Constants.h"
 #include <string>
+#include <memory>
 
 namespace DX12Engine
 {
+	struct ModelLoadOptions
+	{
+		// Parses each streaming window in line ranges on worker threads and runs the tangent, bounds, meshlet and
+		// compression passes in parallel, with the same result as a serial import. Without StreamingImport tinyobj parses
+		// on one thread and fixed-size face chunks are welded on the workers, vertices are then not shared across chunk
+		// seams but the result is still identical for any thread count
+		bool ParallelImport = false;
+		UINT ThreadCount = 0; // 0 = hardware concurrency
+
+		// Parses through a fixed-size file window and welds each face as it is read, instead of first building tinyobj's
+		// per-corner index lists. Material slots follow the .mtl declaration order like tinyobj
+		bool StreamingImport = true;
+
+		// Reorders triangles and vertices for the post-transform cache, overdraw and vertex fetch
+		bool OptimizeMesh = true;
+		UINT VertexCacheSize = MESH_OPTIMIZER_CACHE_SIZE;
+		float OverdrawThreshold = MESH_OPTIMIZER_OVERDRAW_THRESHOLD; // Allowed ACMR increase traded for less overdraw
+
+		// Also encodes the 20 byte CompactVertex layout, which is what gets cooked and uploaded
+		bool CompactVertices = false;
+
+		// Number of levels including the full mesh, each one keeping LodReduction of the previous triangles. LodTargetError
+		// bounds the error a single level may add, relative to the bounding radius
+		UINT LodCount = MESH_LOD_COUNT;
+		float LodReduction = MESH_LOD_REDUCTION;
+		float LodTargetError = MESH_LOD_TARGET_ERROR;
+
+		// Partitions LOD 0 into meshlets with bounds and normal cones for CPU cluster culling
+		bool BuildMeshlets = true;
+		UINT MeshletMaxVertices = MESHLET_MAX_VERTICES;
+		UINT MeshletMaxTriangles = MESHLET_MAX_TRIANGLES;
+
+		// Only options that change the imported data take part in the hash
+		uint64_t GetHash() const
+		{
+			uint64_t hash = (ParallelImport && !StreamingImport ? 1 : 0) | (OptimizeMesh ? 2 : 0) | (CompactVertices ? 4 : 0);
+			if (OptimizeMesh)
+				hash |= (uint64_t)VertexCacheSize << 8 | (uint64_t)(OverdrawThreshold * 1000.0f) << 32;
+			if (LodCount > 1)
+				hash ^= ((uint64_t)LodCount << 48 | (uint64_t)(LodReduction * 1000.0f) << 16 | (uint64_t)(LodTargetError * 100000.0f)) * 0x9E3779B97F4A7C15ull;
+			if (StreamingImport)
+				hash ^= 0x94D049BB133111EBull;
+			if (BuildMeshlets)
+				hash ^= ((uint64_t)MeshletMaxVertices << 40 | (uint64_t)MeshletMaxTriangles << 24 | 1) * 0xC2B2AE3D27D4EB4Full;
+			return hash;
+		}
+	};
+
 	class ModelLoader
 	{
 	public:
 		ModelLoader();
 		~ModelLoader();
 
-		Mesh LoadObj(const std::string& filename);
+		// Faces are grouped into one submesh per material, see StreamingImport for the slot order
+		Mesh LoadObj(const std::string& filename, const ModelLoadOptions& options = {});
+		// Loads the cooked binary for the OBJ, cooking it first if it is missing or stale
+		std::unique_ptr<CookedMesh> LoadObjCached(const std::string& filename, const ModelLoadOptions& options = {});
+		// Loads a .gltf or .glb file. Buffers are memory mapped and accessors are read in place, the primitives of each glTF
+		// mesh become the submeshes of one Mesh processed with the same options as OBJ meshes
+		GltfModel LoadGltf(const std::string& filename, const ModelLoadOptions& options = {});
+
+		// Cache statistics of the last loaded mesh (also kept in the cooked file), zeroed when the optimizer was skipped
+		const MeshOptimizationStatistics& GetLastOptimizationStatistics() const { return m_LastOptimizationStatistics; }
+
+	private:
+		// Shared post-import steps: optimization, bounds, LODs, meshlets and compression
+		void ProcessMesh(Mesh& mesh, const ModelLoadOptions& options);
+		// Threads for the parallel import passes, 1 unless ParallelImport is set
+		static UINT GetImportThreadCount(const ModelLoadOptions& options);
+
+		MeshOptimizationStatistics m_LastOptimizationStatistics;
 	};
 }
 
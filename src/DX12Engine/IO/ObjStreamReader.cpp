@@ -0,0 +1,384 @@
+#include "ObjStreamReader.h"
+#include "../Utils/Constants.h"
+#include "../Utils/EngineUtils.h"
+#include <fstream>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <charconv>
+#include <cstring>
+#include <bit>
+#include <emmintrin.h>
+
+namespace DX12Engine
+{
+	// SSE2 scan for the next '\n', 16 bytes per compare
+	static const char* FindNewline(const char* p, const char* end)
+	{
+		const __m128i newline = _mm_set1_epi8('\n');
+		for (; p + 16 <= end; p += 16)
+		{
+			int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), newline));
+			if (mask != 0)
+				return p + std::countr_zero(static_cast<unsigned int>(mask));
+		}
+		for (; p < end; p++)
+		{
+			if (*p == '\n')
+				return p;
+		}
+		return nullptr;
+	}
+
+	static const char* SkipSpaces(const char* p, const char* end)
+	{
+		while (p < end && (*p == ' ' || *p == '\t'))
+			p++;
+		return p;
+	}
+
+	static bool IsKeyword(const char* line, const char* end, const char* keyword, size_t length)
+	{
+		return static_cast<size_t>(end - line) > length && memcmp(line, keyword, length) == 0 && (line[length] == ' ' || line[length] == '\t');
+	}
+
+	static const char* ParseFloat(const char* p, const char* end, float& value, size_t lineNumber)
+	{
+		p = SkipSpaces(p, end);
+		if (p < end && *p == '+')
+			p++;
+		auto result = std::from_chars(p, end, value);
+		if (result.ec != std::errc())
+			throw std::runtime_error("OBJ: invalid number on line " + std::to_string(lineNumber));
+		return result.ptr;
+	}
+
+	// OBJ indices are 1-based, negative ones count back from the newest element. Returns -1 for an empty index
+	static const char* ParseIndex(const char* p, const char* end, size_t elementCount, int32_t& index, size_t lineNumber)
+	{
+		bool negative = p < end && *p == '-';
+		if (negative)
+			p++;
+		if (p == end || *p < '0' || *p > '9')
+		{
+			if (negative)
+				throw std::runtime_error("OBJ: invalid face index on line " + std::to_string(lineNumber));
+			index = -1;
+			return p;
+		}
+
+		int64_t value = 0;
+		for (; p < end && *p >= '0' && *p <= '9'; p++)
+			value = value * 10 + (*p - '0');
+
+		int64_t resolved = negative ? static_cast<int64_t>(elementCount) - value : value - 1;
+		if (value == 0 || resolved < 0 || resolved >= static_cast<int64_t>(elementCount))
+			throw std::runtime_error("OBJ: face index out of range on line " + std::to_string(lineNumber));
+		index = static_cast<int32_t>(resolved);
+		return p;
+	}
+
+	// Calls func(line, end) for every line in [begin, end), the last one may lack its newline
+	template<typename Func>
+	static void ForEachLine(const char* begin, const char* end, Func&& func)
+	{
+		while (begin < end)
+		{
+			const char* newline = FindNewline(begin, end);
+			const char* lineEnd = newline ? newline : end;
+			func(begin, lineEnd);
+			begin = lineEnd + 1;
+		}
+	}
+
+	ObjStreamReader::ObjStreamReader(UINT threadCount)
+		: m_ThreadCount(threadCount == 0 ? (std::max)(1u, std::thread::hardware_concurrency()) : threadCount),
+		m_Ranges(m_ThreadCount), m_WeldMap(0), m_MaterialCount(0), m_CurrentSlot(0), m_LineNumber(0)
+	{
+	}
+
+	void ObjStreamReader::Reset()
+	{
+		m_Positions.clear();
+		m_Normals.clear();
+		m_TexCoords.clear();
+		m_Mesh = Mesh();
+		m_WeldMap = VertexWeldMap(0);
+		m_SlotIndices.assign(1, {});
+		m_MaterialSlots.clear();
+		m_MaterialCount = 0;
+		m_CurrentSlot = 0;
+		m_LineNumber = 0;
+	}
+
+	Mesh ObjStreamReader::Read(const std::string& filename)
+	{
+		std::ifstream file(filename, std::ios::binary);
+		if (!file)
+			throw std::runtime_error("Failed to load OBJ file: " + filename);
+
+		Reset();
+		m_Directory = std::filesystem::path(filename).parent_path().string();
+
+		// A line that does not fit the window is carried to the front and completed by the next read
+		std::vector<char> window(OBJ_STREAM_WINDOW_SIZE);
+		size_t carried = 0;
+		while (true)
+		{
+			const size_t requested = window.size() - carried;
+			file.read(window.data() + carried, requested);
+			const size_t readCount = static_cast<size_t>(file.gcount());
+			const bool lastWindow = readCount < requested;
+
+			const char* begin = window.data();
+			const char* end = window.data() + carried + readCount;
+			const char* parsedEnd = end;
+			if (!lastWindow)
+			{
+				while (parsedEnd > begin && parsedEnd[-1] != '\n')
+					parsedEnd--;
+			}
+			ParseWindow(begin, parsedEnd);
+
+			carried = end - parsedEnd;
+			if (lastWindow)
+				break;
+			if (carried == window.size())
+				throw std::runtime_error("OBJ: line " + std::to_string(m_LineNumber + 1) + " is longer than the stream window in " + filename);
+			memmove(window.data(), parsedEnd, carried);
+		}
+
+		// Per-slot index lists are concatenated into the submeshes
+		for (UINT slot = 0; slot < m_SlotIndices.size(); slot++)
+		{
+			std::vector<UINT>& indices = m_SlotIndices[slot];
+			if (indices.empty())
+				continue;
+			m_Mesh.Submeshes.push_back({ static_cast<UINT>(m_Mesh.Indices.size()), static_cast<UINT>(indices.size()), slot, 0, 0 });
+			m_Mesh.Indices.insert(m_Mesh.Indices.end(), indices.begin(), indices.end());
+			std::vector<UINT>().swap(indices);
+		}
+
+		Mesh mesh = std::move(m_Mesh);
+		Reset();
+		return mesh;
+	}
+
+	void ObjStreamReader::ParseWindow(const char* begin, const char* end)
+	{
+		// Equal byte ranges moved forward to the next line start, a range is empty when a single line spans it
+		const size_t rangeCount = m_Ranges.size();
+		const char* rangeBegin = begin;
+		for (size_t i = 0; i < rangeCount; i++)
+		{
+			const char* rangeEnd = i + 1 == rangeCount ? end : (std::max)(rangeBegin, begin + (end - begin) * (i + 1) / rangeCount);
+			if (rangeEnd > begin && rangeEnd < end && rangeEnd[-1] != '\n')
+			{
+				const char* newline = FindNewline(rangeEnd, end);
+				rangeEnd = newline ? newline + 1 : end;
+			}
+			m_Ranges[i].Begin = rangeBegin;
+			m_Ranges[i].End = rangeEnd;
+			rangeBegin = rangeEnd;
+		}
+
+		// Every range but the first needs the line and element counts in front of it to resolve indices on its own
+		if (rangeCount > 1)
+			EngineUtils::ParallelFor(rangeCount - 1, m_ThreadCount, [&](size_t i) { CountRange(m_Ranges[i]); });
+		size_t lineNumber = m_LineNumber;
+		size_t positionCount = m_Positions.size(), normalCount = m_Normals.size(), texCoordCount = m_TexCoords.size();
+		for (ParsedRange& range : m_Ranges)
+		{
+			range.LineNumber = lineNumber;
+			range.PositionBase = positionCount;
+			range.NormalBase = normalCount;
+			range.TexCoordBase = texCoordCount;
+			lineNumber += range.LineCount;
+			positionCount += range.PositionCount;
+			normalCount += range.NormalCount;
+			texCoordCount += range.TexCoordCount;
+		}
+
+		EngineUtils::ParallelFor(rangeCount, m_ThreadCount, [&](size_t i) { ParseRange(m_Ranges[i]); });
+		for (const ParsedRange& range : m_Ranges)
+			MergeRange(range);
+		m_LineNumber = m_Ranges.back().LineNumber;
+	}
+
+	void ObjStreamReader::CountRange(ParsedRange& range)
+	{
+		range.LineCount = range.PositionCount = range.NormalCount = range.TexCoordCount = 0;
+		ForEachLine(range.Begin, range.End, [&](const char* line, const char* end)
+		{
+			range.LineCount++;
+			line = SkipSpaces(line, end);
+			if (IsKeyword(line, end, "v", 1))
+				range.PositionCount++;
+			else if (IsKeyword(line, end, "vn", 2))
+				range.NormalCount++;
+			else if (IsKeyword(line, end, "vt", 2))
+				range.TexCoordCount++;
+		});
+	}
+
+	void ObjStreamReader::ParseRange(ParsedRange& range)
+	{
+		range.Positions.clear();
+		range.Normals.clear();
+		range.TexCoords.clear();
+		range.Corners.clear();
+		range.FaceSizes.clear();
+		range.Materials.clear();
+		ForEachLine(range.Begin, range.End, [&](const char* line, const char* end) { ParseLine(range, line, end); });
+	}
+
+	void ObjStreamReader::ParseLine(ParsedRange& range, const char* line, const char* end)
+	{
+		const size_t lineNumber = ++range.LineNumber;
+		if (end > line && end[-1] == '\r')
+			end--;
+		line = SkipSpaces(line, end);
+		if (line == end || *line == '#')
+			return;
+
+		if (IsKeyword(line, end, "v", 1))
+		{
+			DirectX::XMFLOAT3 position;
+			const char* p = ParseFloat(line + 1, end, position.x, lineNumber);
+			p = ParseFloat(p, end, position.y, lineNumber);
+			ParseFloat(p, end, position.z, lineNumber);
+			range.Positions.push_back(position);
+		}
+		else if (IsKeyword(line, end, "vn", 2))
+		{
+			DirectX::XMFLOAT3 normal;
+			const char* p = ParseFloat(line + 2, end, normal.x, lineNumber);
+			p = ParseFloat(p, end, normal.y, lineNumber);
+			ParseFloat(p, end, normal.z, lineNumber);
+			range.Normals.push_back(normal);
+		}
+		else if (IsKeyword(line, end, "vt", 2))
+		{
+			DirectX::XMFLOAT2 texCoord;
+			const char* p = ParseFloat(line + 2, end, texCoord.x, lineNumber);
+			ParseFloat(p, end, texCoord.y, lineNumber);
+			range.TexCoords.push_back(texCoord);
+		}
+		else if (IsKeyword(line, end, "f", 1))
+		{
+			ParseFace(range, line + 1, end);
+		}
+		else if (IsKeyword(line, end, "usemtl", 6) || IsKeyword(line, end, "mtllib", 6))
+		{
+			const char* text = SkipSpaces(line + 6, end);
+			const char* textEnd = end;
+			while (textEnd > text && (textEnd[-1] == ' ' || textEnd[-1] == '\t'))
+				textEnd--;
+			range.Materials.push_back({ range.FaceSizes.size(), *line == 'm', std::string(text, textEnd) });
+		}
+	}
+
+	void ObjStreamReader::ParseFace(ParsedRange& range, const char* line, const char* end)
+	{
+		const size_t firstCorner = range.Corners.size();
+		const char* p = SkipSpaces(line, end);
+		while (p < end)
+		{
+			VertexKey key = { -1, -1, -1 };
+			p = ParseIndex(p, end, range.PositionBase + range.Positions.size(), key.Position, range.LineNumber);
+			if (key.Position < 0)
+				throw std::runtime_error("OBJ: face without position index on line " + std::to_string(range.LineNumber));
+			if (p < end && *p == '/')
+			{
+				p = ParseIndex(p + 1, end, range.TexCoordBase + range.TexCoords.size(), key.TexCoord, range.LineNumber);
+				if (p < end && *p == '/')
+					p = ParseIndex(p + 1, end, range.NormalBase + range.Normals.size(), key.Normal, range.LineNumber);
+			}
+			range.Corners.push_back(key);
+			p = SkipSpaces(p, end);
+		}
+		range.FaceSizes.push_back(static_cast<UINT>(range.Corners.size() - firstCorner));
+	}
+
+	void ObjStreamReader::MergeRange(const ParsedRange& range)
+	{
+		m_Positions.insert(m_Positions.end(), range.Positions.begin(), range.Positions.end());
+		m_Normals.insert(m_Normals.end(), range.Normals.begin(), range.Normals.end());
+		m_TexCoords.insert(m_TexCoords.end(), range.TexCoords.begin(), range.TexCoords.end());
+
+		size_t corner = 0, material = 0;
+		for (size_t face = 0; face <= range.FaceSizes.size(); face++)
+		{
+			for (; material < range.Materials.size() && range.Materials[material].Face == face; material++)
+			{
+				const MaterialStatement& statement = range.Materials[material];
+				if (statement.Library)
+					LoadMaterialLibrary(statement.Text);
+				else
+					UseMaterial(statement.Text);
+			}
+			if (face == range.FaceSizes.size())
+				break;
+
+			m_FaceCorners.clear();
+			for (UINT i = 0; i < range.FaceSizes[face]; i++)
+			{
+				const VertexKey& key = range.Corners[corner++];
+				bool inserted = false;
+				uint32_t index = m_WeldMap.FindOrInsert(key, static_cast<uint32_t>(m_Mesh.Vertices.size()), inserted);
+				if (inserted)
+				{
+					Vertex vertex = {};
+					vertex.Position = m_Positions[key.Position];
+					vertex.Normal = key.Normal >= 0 ? m_Normals[key.Normal] : DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+					vertex.TexCoord = key.TexCoord >= 0 ? m_TexCoords[key.TexCoord] : DirectX::XMFLOAT2(0.0f, 0.0f);
+					m_Mesh.Vertices.push_back(vertex);
+				}
+				m_FaceCorners.push_back(index);
+			}
+
+			std::vector<UINT>& indices = m_SlotIndices[m_CurrentSlot];
+			for (size_t i = 2; i < m_FaceCorners.size(); i++)
+				indices.insert(indices.end(), { m_FaceCorners[0], m_FaceCorners[i - 1], m_FaceCorners[i] });
+		}
+	}
+
+	void ObjStreamReader::LoadMaterialLibrary(const std::string& names)
+	{
+		// Like tinyobj only the first file of the line that opens is read, every newmtl takes the next material index
+		const char* p = names.c_str();
+		const char* end = p + names.size();
+		while (p < end)
+		{
+			const char* nameEnd = p;
+			while (nameEnd < end && *nameEnd != ' ' && *nameEnd != '\t')
+				nameEnd++;
+			std::ifstream file(std::filesystem::path(m_Directory) / std::string(p, nameEnd));
+			p = SkipSpaces(nameEnd, end);
+			if (!file)
+				continue;
+
+			std::string line;
+			while (std::getline(file, line))
+			{
+				const char* text = SkipSpaces(line.c_str(), line.c_str() + line.size());
+				const char* textEnd = line.c_str() + line.size();
+				while (textEnd > text && (textEnd[-1] == '\r' || textEnd[-1] == ' ' || textEnd[-1] == '\t'))
+					textEnd--;
+				if (IsKeyword(text, textEnd, "newmtl", 6))
+					m_MaterialSlots.try_emplace(std::string(SkipSpaces(text + 6, textEnd), textEnd), m_MaterialCount++);
+			}
+			return;
+		}
+		std::cerr << "OBJ Warning: material library " << names << " not found" << std::endl;
+	}
+
+	void ObjStreamReader::UseMaterial(const std::string& name)
+	{
+		// Unknown materials fall back to slot 0, which tinyobj reports as material id -1 and the OBJ path maps to 0
+		auto it = m_MaterialSlots.find(name);
+		m_CurrentSlot = it != m_MaterialSlots.end() ? it->second : 0;
+		if (m_CurrentSlot >= m_SlotIndices.size())
+			m_SlotIndices.resize(m_CurrentSlot + 1);
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "../Resources/Mesh.h"
+#include "VertexWeldMap.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace DX12Engine
+{
+	// Streaming OBJ front end. The file is read through a fixed-size window and every face is welded as soon as its window
+	// is parsed, so memory is one window of text plus the attribute arrays, weld map and output mesh (the objmemory
+	// benchmark reports the peak). With more than one thread each window is split into line ranges that are parsed
+	// concurrently, welding stays serial in file order so the result is identical for any thread count
+	class ObjStreamReader
+	{
+	public:
+		ObjStreamReader(UINT threadCount = 1); // 0 = hardware concurrency
+
+		// Polygons are fan triangulated. Faces are grouped into one submesh per material, the slot of a material is its
+		// index in the mtllib files in declaration order like tinyobj's material ids. Faces before the first usemtl and
+		// faces using a material no library declares share slot 0
+		Mesh Read(const std::string& filename);
+
+	private:
+		// usemtl, or mtllib with its file names, in front of the given face of a range
+		struct MaterialStatement
+		{
+			size_t Face;
+			bool Library;
+			std::string Text;
+		};
+
+		// Lines of one window range, parsed with indices already resolved against everything in front of the range
+		struct ParsedRange
+		{
+			const char* Begin = nullptr;
+			const char* End = nullptr;
+			size_t LineNumber = 0;
+			size_t PositionBase = 0;
+			size_t NormalBase = 0;
+			size_t TexCoordBase = 0;
+			size_t LineCount = 0;
+			size_t PositionCount = 0;
+			size_t NormalCount = 0;
+			size_t TexCoordCount = 0;
+
+			std::vector<DirectX::XMFLOAT3> Positions;
+			std::vector<DirectX::XMFLOAT3> Normals;
+			std::vector<DirectX::XMFLOAT2> TexCoords;
+			std::vector<VertexKey> Corners;
+			std::vector<UINT> FaceSizes;
+			std::vector<MaterialStatement> Materials;
+		};
+
+		void ParseWindow(const char* begin, const char* end);
+		static void CountRange(ParsedRange& range);
+		static void ParseRange(ParsedRange& range);
+		static void ParseLine(ParsedRange& range, const char* line, const char* end);
+		static void ParseFace(ParsedRange& range, const char* line, const char* end);
+		void MergeRange(const ParsedRange& range);
+		void LoadMaterialLibrary(const std::string& names);
+		void UseMaterial(const std::string& name);
+		void Reset();
+
+		UINT m_ThreadCount;
+		std::vector<ParsedRange> m_Ranges;
+
+		std::vector<DirectX::XMFLOAT3> m_Positions;
+		std::vector<DirectX::XMFLOAT3> m_Normals;
+		std::vector<DirectX::XMFLOAT2> m_TexCoords;
+
+		Mesh m_Mesh;
+		VertexWeldMap m_WeldMap;
+		std::vector<std::vector<UINT>> m_SlotIndices;
+		std::string m_Directory;
+		std::unordered_map<std::string, UINT> m_MaterialSlots;
+		UINT m_MaterialCount;
+		UINT m_CurrentSlot;
+		std::vector<UINT> m_FaceCorners;
+		size_t m_LineNumber;
+	};
+}
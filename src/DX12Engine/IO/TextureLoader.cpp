@@ -2,6 +2,8 @@
 #include "DirectXTex.h"
 #include "../Utils/EngineUtils.h"
 #include "../Resources/ResourceManager.h"
+#include "../Imaging/TextureCooker.h"
+#include "../Imaging/ORMPacker.h"
 #include <iostream>
 #include <filesystem>
 
@@ -17,42 +19,82 @@ namespace DX12Engine
 
 	std::unique_ptr<Texture> TextureLoader::LoadDDS(const std::wstring& filename)
 	{
-		DirectX::ScratchImage* imageData = new DirectX::ScratchImage();
+		auto imageData = std::make_unique<DirectX::ScratchImage>();
 		EngineUtils::ThrowIfFailed(DirectX::LoadFromDDSFile(filename.c_str(), DirectX::DDS_FLAGS_NONE, nullptr, *imageData));
-		return ResourceManager::GetInstance().CreateTexture(imageData);
+		return ResourceManager::GetInstance().CreateTexture(std::move(imageData));
 	}
 
 	std::unique_ptr<Texture> TextureLoader::LoadCubemapDDS(const std::wstring& filename)
 	{
-		DirectX::ScratchImage* imageData = new DirectX::ScratchImage();
+		auto imageData = std::make_unique<DirectX::ScratchImage>();
 		EngineUtils::ThrowIfFailed(DirectX::LoadFromDDSFile(filename.c_str(), DirectX::DDS_FLAGS_NONE, nullptr, *imageData));
 		const DirectX::TexMetadata& metadata = imageData->GetMetadata();
 		if (!metadata.IsCubemap())
 			throw std::runtime_error("Loaded texture is not a cubemap!");
 
-		return ResourceManager::GetInstance().CreateCubeMap(imageData);
+		return ResourceManager::GetInstance().CreateCubeMap(std::move(imageData));
 	}
 
 	std::unique_ptr<Texture> TextureLoader::LoadWIC(const std::wstring& filename)
 	{
-		DirectX::ScratchImage* imageData = new DirectX::ScratchImage();
+		auto imageData = std::make_unique<DirectX::ScratchImage>();
 		EngineUtils::ThrowIfFailed(DirectX::LoadFromWICFile(filename.c_str(), DirectX::WIC_FLAGS_NONE, nullptr, *imageData));
-		return ResourceManager::GetInstance().CreateTexture(imageData);
+		return ResourceManager::GetInstance().CreateTexture(std::move(imageData));
+	}
+
+	std::unordered_map<TextureType, std::wstring> TextureLoader::FindMaterialMaps(const std::wstring& path)
+	{
+		static const std::pair<TextureType, const wchar_t*> mapNames[] =
+		{
+			{ TextureType::Albedo, L"/albedo.png" },
+			{ TextureType::Normal, L"/normal.png" },
+			{ TextureType::Metallic, L"/metallic.png" },
+			{ TextureType::Roughness, L"/roughness.png" },
+			{ TextureType::AOMap, L"/ao.png" },
+		};
+
+		std::unordered_map<TextureType, std::wstring> maps;
+		for (const auto& [type, name] : mapNames)
+		{
+			if (std::filesystem::exists(path + name))
+				maps[type] = path + name;
+		}
+		return maps;
 	}
 
 	std::unordered_map<TextureType, std::shared_ptr<Texture>> TextureLoader::LoadMaterial(std::wstring path)
+	{
+		return LoadMaterial(FindMaterialMaps(path));
+	}
+
+	std::unordered_map<TextureType, std::shared_ptr<Texture>> TextureLoader::LoadMaterial(const std::unordered_map<TextureType, std::wstring>& paths)
 	{
 		std::unordered_map<TextureType, std::shared_ptr<Texture>> textures;
-		if (std::filesystem::exists(path + L"/albedo.png"))
-			textures[TextureType::Albedo] = LoadWIC(path + L"/albedo.png");
-		if (std::filesystem::exists(path + L"/normal.png"))
-			textures[TextureType::Normal] = LoadWIC(path + L"/normal.png");
-		if (std::filesystem::exists(path + L"/metallic.png"))
-			textures[TextureType::Metallic] = LoadWIC(path + L"/metallic.png");
-		if (std::filesystem::exists(path + L"/roughness.png"))
-			textures[TextureType::Roughness] = LoadWIC(path + L"/roughness.png");
-		if (std::filesystem::exists(path + L"/ao.png"))
-			textures[TextureType::AOMap] = LoadWIC(path + L"/ao.png");
+		std::unordered_map<std::wstring, std::shared_ptr<Texture>> loaded;
+
+		std::unordered_map<TextureType, std::wstring> maps = paths;
+		std::unordered_map<TextureType, std::wstring> ormSources;
+		if (ORMPacker::ExtractSources(maps, ormSources))
+		{
+			auto imageData = std::make_unique<DirectX::ScratchImage>();
+			TextureCooker::LoadORM(ormSources, *imageData);
+			textures[TextureType::ORM] = ResourceManager::GetInstance().CreateTexture(std::move(imageData));
+			for (const auto& [type, source] : ormSources)
+				textures[type] = textures[TextureType::ORM];
+		}
+
+		std::unordered_map<std::wstring, DXGI_FORMAT> formats = TextureCooker::GetCookedFormats(maps);
+		for (const auto& [type, path] : maps)
+		{
+			std::shared_ptr<Texture>& texture = loaded[path];
+			if (!texture)
+			{
+				auto imageData = std::make_unique<DirectX::ScratchImage>();
+				TextureCooker::Load(path, formats[path], MipGenerator::GetFilter(type), *imageData);
+				texture = ResourceManager::GetInstance().CreateTexture(std::move(imageData));
+			}
+			textures[type] = texture;
+		}
 		return textures;
 	}
 }
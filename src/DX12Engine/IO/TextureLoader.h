@@ -14,7 +14,13 @@ namespace DX12Engine
 		std::unique_ptr<Texture> LoadCubemapDDS(const std::wstring& filename);
 		std::unique_ptr<Texture> LoadWIC(const std::wstring& filename);
 
+		// Paths of the maps present in a material directory (albedo.png, normal.png, metallic.png, roughness.png, ao.png)
+		static std::unordered_map<TextureType, std::wstring> FindMaterialMaps(const std::wstring& path);
+
 		std::unordered_map<TextureType, std::shared_ptr<Texture>> LoadMaterial(std::wstring path);
+		// Loads explicit texture paths (e.g. from GltfMaterial::Textures), slots sharing a file share the texture. AOMap,
+		// Roughness and Metallic come back packed as one ORM texture, which also fills the slots of the channels it holds
+		std::unordered_map<TextureType, std::shared_ptr<Texture>> LoadMaterial(const std::unordered_map<TextureType, std::wstring>& paths);
 
 		static std::vector<Texture*> GetTextureArray(std::unordered_map<TextureType, std::shared_ptr<Texture>> textures)
 		{
@@ -0,0 +1,106 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace DX12Engine
+{
+	// OBJ face-corner index triple, packed into 96 bits
+	struct VertexKey
+	{
+		int32_t Position;
+		int32_t Normal;
+		int32_t TexCoord;
+
+		bool operator==(const VertexKey& other) const { return Position == other.Position && Normal == other.Normal && TexCoord == other.TexCoord; }
+	};
+
+	// Open addressing (linear probing) map from face-corner key to welded vertex index, no allocation per lookup
+	class VertexWeldMap
+	{
+	public:
+		VertexWeldMap(size_t expectedCount)
+		{
+			Allocate(expectedCount);
+		}
+
+		// Returns the index already stored for the key, or stores and returns newIndex
+		uint32_t FindOrInsert(const VertexKey& key, uint32_t newIndex, bool& inserted)
+		{
+			if ((m_Count + 1) * 2 > m_Slots.size())
+				Grow();
+
+			size_t slot = Hash(key) & m_Mask;
+			while (true)
+			{
+				Slot& current = m_Slots[slot];
+				if (current.Value == EmptySlot)
+				{
+					current.Key = key;
+					current.Value = newIndex;
+					m_Count++;
+					inserted = true;
+					return newIndex;
+				}
+				if (current.Key == key)
+				{
+					inserted = false;
+					return current.Value;
+				}
+				slot = (slot + 1) & m_Mask;
+			}
+		}
+
+		size_t Size() const { return m_Count; }
+
+	private:
+		struct Slot
+		{
+			VertexKey Key;
+			uint32_t Value;
+		};
+
+		static constexpr uint32_t EmptySlot = 0xFFFFFFFF;
+
+		static uint64_t Hash(const VertexKey& key)
+		{
+			uint64_t hash = (uint64_t)(uint32_t)key.Position * 0x9E3779B97F4A7C15ull;
+			hash ^= (uint64_t)(uint32_t)key.Normal * 0xC2B2AE3D27D4EB4Full;
+			hash ^= (uint64_t)(uint32_t)key.TexCoord * 0x165667B19E3779F9ull;
+			return hash ^ (hash >> 32);
+		}
+
+		void Allocate(size_t expectedCount)
+		{
+			// Keep the load factor at or below 0.5
+			size_t capacity = 16;
+			while (capacity < expectedCount * 2)
+				capacity <<= 1;
+			m_Slots.assign(capacity, Slot{ { 0, 0, 0 }, EmptySlot });
+			m_Mask = capacity - 1;
+			m_Count = 0;
+		}
+
+		void Grow()
+		{
+			std::vector<Slot> oldSlots;
+			oldSlots.swap(m_Slots);
+			Allocate(oldSlots.size());
+			for (const Slot& oldSlot : oldSlots)
+			{
+				if (oldSlot.Value == EmptySlot)
+					continue;
+				size_t slot = Hash(oldSlot.Key) & m_Mask;
+				while (m_Slots[slot].Value != EmptySlot)
+					slot = (slot + 1) & m_Mask;
+				m_Slots[slot] = oldSlot;
+				m_Count++;
+			}
+		}
+
+		std::vector<Slot> m_Slots;
+		size_t m_Mask;
+		size_t m_Count;
+	};
+}
+
@@ -0,0 +1,288 @@
+#include "MipGenerator.h"
+#include <emmintrin.h>
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+namespace DX12Engine
+{
+	static const UINT LinearToSrgbTableSize = 4096;
+
+	static const float* GetSrgbToLinearTable()
+	{
+		static const std::vector<float> table = []()
+		{
+			std::vector<float> values(256);
+			for (int i = 0; i < 256; i++)
+			{
+				float c = i / 255.0f;
+				values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+			}
+			return values;
+		}();
+		return table.data();
+	}
+
+	static const uint8_t* GetLinearToSrgbTable()
+	{
+		static const std::vector<uint8_t> table = []()
+		{
+			std::vector<uint8_t> values(LinearToSrgbTableSize + 1);
+			for (UINT i = 0; i <= LinearToSrgbTableSize; i++)
+			{
+				float c = static_cast<float>(i) / LinearToSrgbTableSize;
+				float srgb = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+				values[i] = static_cast<uint8_t>(srgb * 255.0f + 0.5f);
+			}
+			return values;
+		}();
+		return table.data();
+	}
+
+	static UINT GetChannelCount(DXGI_FORMAT format)
+	{
+		switch (format)
+		{
+		case DXGI_FORMAT_R8_UNORM: return 1;
+		case DXGI_FORMAT_R8G8_UNORM: return 2;
+		case DXGI_FORMAT_R8G8B8A8_UNORM: return 4;
+		default: return 0;
+		}
+	}
+
+	static __m128 Normalize3(__m128 v)
+	{
+		// Length of xyz only, w passes through
+		const __m128 xyzMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+		__m128 squared = _mm_and_ps(_mm_mul_ps(v, v), xyzMask);
+		__m128 sum = _mm_add_ps(squared, _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(2, 3, 0, 1)));
+		sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2)));
+		if (_mm_cvtss_f32(sum) < 1e-12f)
+			return _mm_or_ps(_mm_andnot_ps(xyzMask, v), _mm_set_ps(0.0f, 1.0f, 0.0f, 0.0f));
+		__m128 scale = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(sum));
+		return _mm_or_ps(_mm_and_ps(_mm_mul_ps(v, scale), xyzMask), _mm_andnot_ps(xyzMask, v));
+	}
+
+	// Unused channels decode to 0 and alpha to 1
+	static void DecodeRow(const uint8_t* source, UINT width, UINT channels, MipFilter filter, __m128* destination)
+	{
+		const float* srgbToLinear = GetSrgbToLinearTable();
+		const __m128 byteScale = _mm_set1_ps(1.0f / 255.0f);
+		const __m128i zero = _mm_setzero_si128();
+		UINT x = 0;
+		if (channels == 4 && filter == MipFilter::Color)
+		{
+			// Alpha is converted four pixels at a time like the linear path, RGB goes through the table
+			for (; x + 4 <= width; x += 4)
+			{
+				const uint8_t* pixels = source + static_cast<size_t>(x) * 4;
+				__m128i alpha = _mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels)), 24);
+				alignas(16) float alphas[4];
+				_mm_store_ps(alphas, _mm_mul_ps(_mm_cvtepi32_ps(alpha), byteScale));
+				for (UINT i = 0; i < 4; i++)
+				{
+					const uint8_t* pixel = pixels + i * 4;
+					destination[x + i] = _mm_set_ps(alphas[i], srgbToLinear[pixel[2]], srgbToLinear[pixel[1]], srgbToLinear[pixel[0]]);
+				}
+			}
+		}
+		else if (channels == 4)
+		{
+			// Four RGBA pixels per load
+			for (; x + 4 <= width; x += 4)
+			{
+				__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + static_cast<size_t>(x) * 4));
+				__m128i low = _mm_unpacklo_epi8(bytes, zero);
+				__m128i high = _mm_unpackhi_epi8(bytes, zero);
+				destination[x + 0] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), byteScale);
+				destination[x + 1] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), byteScale);
+				destination[x + 2] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), byteScale);
+				destination[x + 3] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), byteScale);
+			}
+		}
+		for (; x < width; x++)
+		{
+			uint8_t bytes[4] = { 0, 0, 0, 255 };
+			memcpy(bytes, source + static_cast<size_t>(x) * channels, channels);
+			if (filter == MipFilter::Color && channels >= 3)
+			{
+				destination[x] = _mm_set_ps(bytes[3] * (1.0f / 255.0f), srgbToLinear[bytes[2]], srgbToLinear[bytes[1]], srgbToLinear[bytes[0]]);
+				continue;
+			}
+			if (filter == MipFilter::Color)
+			{
+				destination[x] = _mm_set_ps(bytes[3] * (1.0f / 255.0f), bytes[2] * (1.0f / 255.0f), channels == 2 ? srgbToLinear[bytes[1]] : 0.0f, srgbToLinear[bytes[0]]);
+				continue;
+			}
+			int packed;
+			memcpy(&packed, bytes, sizeof(packed));
+			__m128i words = _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero);
+			destination[x] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero)), byteScale);
+		}
+
+		if (filter == MipFilter::NormalMap && channels >= 2)
+		{
+			const __m128 bias = _mm_set_ps(0.0f, 1.0f, 1.0f, 1.0f);
+			for (x = 0; x < width; x++)
+			{
+				__m128 value = _mm_sub_ps(_mm_add_ps(destination[x], destination[x]), bias);
+				if (channels == 2)
+				{
+					// Two channel normal maps store XY only
+					alignas(16) float v[4];
+					_mm_store_ps(v, value);
+					v[2] = std::sqrt((std::max)(0.0f, 1.0f - v[0] * v[0] - v[1] * v[1]));
+					value = _mm_load_ps(v);
+				}
+				destination[x] = value;
+			}
+		}
+	}
+
+	static void EncodeRow(const __m128* source, UINT width, UINT channels, MipFilter filter, uint8_t* destination)
+	{
+		const uint8_t* linearToSrgb = GetLinearToSrgbTable();
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 tableScale = _mm_set1_ps(static_cast<float>(LinearToSrgbTableSize));
+		for (UINT x = 0; x < width; x++)
+		{
+			__m128 value = source[x];
+			if (filter == MipFilter::NormalMap && channels >= 2)
+				value = _mm_add_ps(_mm_mul_ps(value, _mm_set_ps(1.0f, 0.5f, 0.5f, 0.5f)), _mm_set_ps(0.0f, 0.5f, 0.5f, 0.5f));
+			value = _mm_min_ps(_mm_max_ps(value, zero), one);
+
+			__m128i integers = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(255.0f)), half));
+			__m128i bytes = _mm_packus_epi16(_mm_packs_epi32(integers, integers), integers);
+			int packed = _mm_cvtsi128_si32(bytes);
+			uint8_t* out = destination + static_cast<size_t>(x) * channels;
+			memcpy(out, &packed, channels);
+
+			if (filter == MipFilter::Color)
+			{
+				// The table indices of all channels in one conversion, alpha keeps the byte from above
+				alignas(16) int32_t indices[4];
+				_mm_store_si128(reinterpret_cast<__m128i*>(indices), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, tableScale), half)));
+				for (UINT c = 0; c < (std::min)(channels, 3u); c++)
+					out[c] = linearToSrgb[indices[c]];
+			}
+		}
+	}
+
+	// Source texels averaged into the destination texel at index, the last one of an odd size takes three so no row or
+	// column is dropped. A size of 1 has nothing to pair with
+	static UINT GetTapCount(UINT index, UINT size, UINT sourceSize)
+	{
+		if (sourceSize == 1)
+			return 1;
+		return index + 1 == size && (sourceSize & 1) ? 3 : 2;
+	}
+
+	// 2x2 box filter from one float level into the next, 3x2, 2x3 or 3x3 along the last row and column of odd sizes
+	static void Downsample(const __m128* source, UINT sourceWidth, UINT sourceHeight, __m128* destination, UINT width, UINT height, bool normalize)
+	{
+		const __m128 quarter = _mm_set1_ps(0.25f);
+		for (UINT y = 0; y < height; y++)
+		{
+			const UINT rowTaps = GetTapCount(y, height, sourceHeight);
+			const __m128* row0 = source + static_cast<size_t>(y * 2) * sourceWidth;
+			__m128* out = destination + static_cast<size_t>(y) * width;
+			for (UINT x = 0; x < width; x++)
+			{
+				const UINT columnTaps = GetTapCount(x, width, sourceWidth);
+				__m128 value;
+				if (rowTaps == 2 && columnTaps == 2)
+				{
+					const __m128* row1 = row0 + sourceWidth;
+					value = _mm_mul_ps(_mm_add_ps(_mm_add_ps(row0[x * 2], row0[x * 2 + 1]), _mm_add_ps(row1[x * 2], row1[x * 2 + 1])), quarter);
+				}
+				else
+				{
+					__m128 sum = _mm_setzero_ps();
+					for (UINT r = 0; r < rowTaps; r++)
+					{
+						for (UINT c = 0; c < columnTaps; c++)
+							sum = _mm_add_ps(sum, row0[static_cast<size_t>(r) * sourceWidth + x * 2 + c]);
+					}
+					value = _mm_mul_ps(sum, _mm_set1_ps(1.0f / (rowTaps * columnTaps)));
+				}
+				out[x] = normalize ? Normalize3(value) : value;
+			}
+		}
+	}
+
+	void MipGenerator::Generate(const DirectX::ScratchImage& source, MipFilter filter, DirectX::ScratchImage& result)
+	{
+		const DirectX::TexMetadata& metadata = source.GetMetadata();
+		const UINT channels = GetChannelCount(metadata.format);
+		if (channels == 0 || metadata.dimension != DirectX::TEX_DIMENSION_TEXTURE2D || metadata.arraySize != 1 || metadata.depth != 1)
+		{
+			DirectX::TEX_FILTER_FLAGS flags = DirectX::TEX_FILTER_BOX | DirectX::TEX_FILTER_FORCE_NON_WIC;
+			if (filter == MipFilter::Color)
+				flags |= DirectX::TEX_FILTER_SRGB;
+			if (FAILED(DirectX::GenerateMipMaps(source.GetImages(), source.GetImageCount(), metadata, flags, 0, result)))
+				throw std::runtime_error("Failed to generate mip maps");
+			return;
+		}
+
+		const UINT width = static_cast<UINT>(metadata.width);
+		const UINT height = static_cast<UINT>(metadata.height);
+		size_t mipLevels = 1;
+		while ((std::max)(width, height) >> mipLevels)
+			mipLevels++;
+		if (FAILED(result.Initialize2D(metadata.format, width, height, 1, mipLevels)))
+			throw std::runtime_error("Failed to allocate mip chain");
+
+		const DirectX::Image* level0 = source.GetImage(0, 0, 0);
+		const DirectX::Image* target0 = result.GetImage(0, 0, 0);
+		for (UINT y = 0; y < height; y++)
+			memcpy(target0->pixels + y * target0->rowPitch, level0->pixels + y * level0->rowPitch, static_cast<size_t>(width) * channels);
+		if (mipLevels == 1)
+			return;
+
+		// Level 1 is filtered straight from two decoded source rows, so level 0 never exists in float
+		const bool normalize = filter == MipFilter::NormalMap && channels >= 2;
+		UINT levelWidth = (std::max)(1u, width >> 1);
+		UINT levelHeight = (std::max)(1u, height >> 1);
+		std::vector<__m128> rows(static_cast<size_t>(width) * 3);
+		std::vector<__m128> current(static_cast<size_t>(levelWidth) * levelHeight);
+		for (UINT y = 0; y < levelHeight; y++)
+		{
+			const UINT sourceRows = GetTapCount(y, levelHeight, height);
+			for (UINT r = 0; r < sourceRows; r++)
+				DecodeRow(level0->pixels + (y * 2 + r) * level0->rowPitch, width, channels, filter, rows.data() + static_cast<size_t>(r) * width);
+			Downsample(rows.data(), width, sourceRows, current.data() + static_cast<size_t>(y) * levelWidth, levelWidth, 1, normalize);
+		}
+
+		std::vector<__m128> next;
+		for (size_t level = 1; level < mipLevels; level++)
+		{
+			const DirectX::Image* target = result.GetImage(level, 0, 0);
+			for (UINT y = 0; y < levelHeight; y++)
+				EncodeRow(current.data() + static_cast<size_t>(y) * levelWidth, levelWidth, channels, filter, target->pixels + y * target->rowPitch);
+			if (level + 1 == mipLevels)
+				break;
+
+			UINT nextWidth = (std::max)(1u, levelWidth >> 1);
+			UINT nextHeight = (std::max)(1u, levelHeight >> 1);
+			next.resize(static_cast<size_t>(nextWidth) * nextHeight);
+			Downsample(current.data(), levelWidth, levelHeight, next.data(), nextWidth, nextHeight, normalize);
+			current.swap(next);
+			levelWidth = nextWidth;
+			levelHeight = nextHeight;
+		}
+	}
+
+	MipFilter MipGenerator::GetFilter(TextureType type)
+	{
+		switch (type)
+		{
+		case TextureType::Albedo: return MipFilter::Color;
+		case TextureType::Normal: return MipFilter::NormalMap;
+		default: return MipFilter::Linear;
+		}
+	}
+}
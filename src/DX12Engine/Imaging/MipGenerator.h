@@ -0,0 +1,27 @@
+#pragma once
+#include "../Resources/Texture.h"
+#include <DirectXTex.h>
+
+namespace DX12Engine
+{
+	enum class MipFilter
+	{
+		Linear,		// Every channel averaged as stored (masks, roughness, metallic, AO)
+		Color,		// RGB is sRGB encoded and averaged in linear space, alpha stays linear
+		NormalMap	// RGB (or RG with reconstructed Z) decoded to [-1, 1] and renormalized on every level
+	};
+
+	// Box filtered mip chains down to 1x1. Levels are built from the previous level kept in float, so rounding never
+	// accumulates down the chain
+	class MipGenerator
+	{
+	public:
+		// R8, R8G8 and R8G8B8A8 UNORM take the SSE path, other formats fall back to DirectXTex's box filter. sRGB is converted
+		// through lookup tables, one load per channel since SSE2 has no gather, the filtering is SIMD for every filter. On
+		// odd sizes the last row and column are folded into the last texel with a 3-tap filter. Throws std::runtime_error if
+		// the chain can't be allocated
+		static void Generate(const DirectX::ScratchImage& source, MipFilter filter, DirectX::ScratchImage& result);
+
+		static MipFilter GetFilter(TextureType type);
+	};
+}
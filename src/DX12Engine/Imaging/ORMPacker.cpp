@@ -0,0 +1,114 @@
+#include "ORMPacker.h"
+#include "../IO/ImageDecoder.h"
+#include <stdexcept>
+#include <algorithm>
+
+namespace DX12Engine
+{
+	struct ORMChannel
+	{
+		TextureType Type;
+		uint8_t Default;
+	};
+
+	// In output channel order
+	static const ORMChannel ORMChannels[] =
+	{
+		{ TextureType::AOMap, 255 },
+		{ TextureType::Roughness, 255 },
+		{ TextureType::Metallic, 0 },
+	};
+
+	bool ORMPacker::ExtractSources(std::unordered_map<TextureType, std::wstring>& paths, std::unordered_map<TextureType, std::wstring>& sources)
+	{
+		sources.clear();
+		for (const ORMChannel& channel : ORMChannels)
+		{
+			auto path = paths.find(channel.Type);
+			if (path == paths.end())
+				continue;
+			sources[channel.Type] = path->second;
+			paths.erase(path);
+		}
+		return !sources.empty();
+	}
+
+	bool ORMPacker::IsGltfLayout(const std::unordered_map<TextureType, std::wstring>& sources)
+	{
+		auto metallic = sources.find(TextureType::Metallic);
+		auto roughness = sources.find(TextureType::Roughness);
+		return metallic != sources.end() && roughness != sources.end() && metallic->second == roughness->second;
+	}
+
+	void ORMPacker::Pack(const std::unordered_map<TextureType, std::wstring>& sources, DirectX::ScratchImage& image)
+	{
+		// Every file is decoded once and brought to RGBA8 at the size of the largest map
+		std::unordered_map<std::wstring, DirectX::ScratchImage> decoded;
+		size_t width = 1, height = 1;
+		for (const auto& [type, path] : sources)
+		{
+			auto [file, inserted] = decoded.try_emplace(path);
+			if (!inserted)
+				continue;
+			ImageDecoder::Decode(path, file->second);
+			if (file->second.GetMetadata().format != DXGI_FORMAT_R8G8B8A8_UNORM)
+			{
+				DirectX::ScratchImage converted;
+				if (FAILED(DirectX::Convert(*file->second.GetImage(0, 0, 0), DXGI_FORMAT_R8G8B8A8_UNORM, DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT, converted)))
+					throw std::runtime_error("Failed to convert ORM source map");
+				file->second = std::move(converted);
+			}
+			width = (std::max)(width, file->second.GetMetadata().width);
+			height = (std::max)(height, file->second.GetMetadata().height);
+		}
+		for (auto& [path, file] : decoded)
+		{
+			if (file.GetMetadata().width == width && file.GetMetadata().height == height)
+				continue;
+			DirectX::ScratchImage resized;
+			if (FAILED(DirectX::Resize(*file.GetImage(0, 0, 0), width, height, DirectX::TEX_FILTER_LINEAR, resized)))
+				throw std::runtime_error("Failed to resize ORM source map");
+			file = std::move(resized);
+		}
+
+		if (FAILED(image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1)))
+			throw std::runtime_error("Failed to allocate ORM texture");
+		const DirectX::Image* target = image.GetImage(0, 0, 0);
+		const bool gltfLayout = IsGltfLayout(sources);
+		for (UINT output = 0; output < 4; output++)
+		{
+			const uint8_t* source = nullptr;
+			size_t sourcePitch = 0;
+			UINT sourceChannel = 0;
+			uint8_t value = 255;
+			if (output < 3)
+			{
+				auto path = sources.find(ORMChannels[output].Type);
+				value = ORMChannels[output].Default;
+				if (path != sources.end())
+				{
+					const DirectX::Image* sourceImage = decoded[path->second].GetImage(0, 0, 0);
+					source = sourceImage->pixels;
+					sourcePitch = sourceImage->rowPitch;
+					sourceChannel = gltfLayout && ORMChannels[output].Type != TextureType::AOMap ? output : 0;
+				}
+			}
+
+			for (size_t y = 0; y < height; y++)
+			{
+				uint8_t* row = target->pixels + y * target->rowPitch + output;
+				if (source)
+				{
+					const uint8_t* sourceRow = source + y * sourcePitch + sourceChannel;
+					for (size_t x = 0; x < width; x++)
+						row[x * 4] = sourceRow[x * 4];
+				}
+				else
+				{
+					for (size_t x = 0; x < width; x++)
+						row[x * 4] = value;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "../Resources/Texture.h"
+#include <DirectXTex.h>
+#include <unordered_map>
+#include <string>
+
+namespace DX12Engine
+{
+	// Merges a material's occlusion, roughness and metallic maps into one RGBA8 image laid out like glTF's packed maps:
+	// R occlusion, G roughness, B metallic. The material then binds one texture and samples it once instead of three times
+	class ORMPacker
+	{
+	public:
+		// Moves the AOMap, Roughness and Metallic entries out of a material's maps. Returns false if it had none of them
+		static bool ExtractSources(std::unordered_map<TextureType, std::wstring>& paths, std::unordered_map<TextureType, std::wstring>& sources);
+
+		// Metallic and roughness sharing a file is a glTF metallic-roughness texture and read from B and G, separate maps
+		// are read from R like the occlusion map
+		static bool IsGltfLayout(const std::unordered_map<TextureType, std::wstring>& sources);
+
+		// Missing channels are filled with no occlusion, full roughness and no metallic, materials use their constants for
+		// them instead. Maps of different sizes are resized to the largest. Throws std::runtime_error if a source can't be decoded
+		static void Pack(const std::unordered_map<TextureType, std::wstring>& sources, DirectX::ScratchImage& image);
+	};
+}
@@ -0,0 +1,266 @@
+#include "TextureCooker.h"
+#include "ORMPacker.h"
+#include "../IO/ImageDecoder.h"
+#include "../IO/MeshCache.h"
+#include "../IO/MappedFile.h"
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <cwctype>
+#include <algorithm>
+#include <cstring>
+
+namespace DX12Engine
+{
+	struct TextureSourceStamp
+	{
+		uint32_t Magic;
+		uint64_t SourceSize;
+		int64_t SourceWriteTime;
+		uint64_t SourceHash;
+	};
+
+	DXGI_FORMAT TextureCooker::GetCookedFormat(TextureType type)
+	{
+		switch (type)
+		{
+		case TextureType::Albedo: return DXGI_FORMAT_BC7_UNORM;
+		case TextureType::Normal: return DXGI_FORMAT_BC5_UNORM;
+		default: return DXGI_FORMAT_BC4_UNORM;
+		}
+	}
+
+	std::unordered_map<std::wstring, DXGI_FORMAT> TextureCooker::GetCookedFormats(const std::unordered_map<TextureType, std::wstring>& paths)
+	{
+		std::unordered_map<std::wstring, DXGI_FORMAT> formats;
+		for (const auto& [type, path] : paths)
+		{
+			auto [format, inserted] = formats.try_emplace(path, GetCookedFormat(type));
+			if (!inserted && format->second != GetCookedFormat(type))
+				format->second = DXGI_FORMAT_BC7_UNORM;
+		}
+		return formats;
+	}
+
+	std::wstring TextureCooker::GetCookedPath(const std::wstring& sourcePath, DXGI_FORMAT format)
+	{
+		const std::filesystem::path path(sourcePath);
+		return MakeCookedPath(path.parent_path().wstring(), path.stem().wstring(), HashSource(path), format);
+	}
+
+	uint64_t TextureCooker::HashSource(const std::filesystem::path& sourcePath)
+	{
+		TextureSourceStamp stamp = {};
+		stamp.Magic = TEXTURE_STAMP_MAGIC;
+		stamp.SourceSize = std::filesystem::file_size(sourcePath);
+		stamp.SourceWriteTime = std::filesystem::last_write_time(sourcePath).time_since_epoch().count();
+
+		// Matching size and write time is trusted, anything else hashes the content again
+		const std::filesystem::path stampPath = sourcePath.parent_path() / L"cooked" / (sourcePath.filename().wstring() + L".stamp");
+		TextureSourceStamp cached = {};
+		std::ifstream in(stampPath, std::ios::binary);
+		if (in.read(reinterpret_cast<char*>(&cached), sizeof(cached)) && cached.Magic == stamp.Magic
+			&& cached.SourceSize == stamp.SourceSize && cached.SourceWriteTime == stamp.SourceWriteTime)
+			return cached.SourceHash;
+		in.close();
+
+		// Written like the cooked files, a failed write only means hashing again next time
+		stamp.SourceHash = MeshCache::HashFile(sourcePath.string());
+		std::error_code error;
+		std::filesystem::create_directories(stampPath.parent_path(), error);
+		const std::filesystem::path tempPath = stampPath.wstring() + L".tmp";
+		{
+			std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+			out.write(reinterpret_cast<const char*>(&stamp), sizeof(stamp));
+			if (!out)
+				return stamp.SourceHash;
+		}
+		std::filesystem::rename(tempPath, stampPath, error);
+		if (error)
+			std::filesystem::remove(tempPath, error);
+		return stamp.SourceHash;
+	}
+
+	std::wstring TextureCooker::MakeCookedPath(const std::wstring& directory, const std::wstring& name, uint64_t contentHash, DXGI_FORMAT format)
+	{
+		// FNV-1a continued over the cook settings
+		uint64_t hash = (contentHash ^ static_cast<uint64_t>(format)) * 1099511628211ull;
+		hash = (hash ^ TEXTURE_COOK_VERSION) * 1099511628211ull;
+
+		wchar_t hashText[17];
+		swprintf(hashText, 17, L"%016llx", static_cast<unsigned long long>(hash));
+		return (std::filesystem::path(directory) / L"cooked" / (name + L"_" + hashText + L".dds")).wstring();
+	}
+
+	TextureLoadInfo TextureCooker::Load(const std::wstring& sourcePath, DXGI_FORMAT format, MipFilter filter, DirectX::ScratchImage& image, size_t streamSize)
+	{
+		std::wstring extension = std::filesystem::path(sourcePath).extension().wstring();
+		for (wchar_t& c : extension)
+			c = static_cast<wchar_t>(towlower(c));
+		if (extension == L".dds")
+		{
+			// Loaded whole, other tools' DDS files may need conversions that a partial read would skip
+			TextureLoadInfo info;
+			ImageDecoder::Decode(sourcePath, image);
+			info.Metadata = image.GetMetadata();
+			return info;
+		}
+
+		const std::wstring cookedPath = GetCookedPath(sourcePath, format);
+		TextureLoadInfo info;
+		if (LoadCooked(cookedPath, format, streamSize, image, info))
+			return info;
+
+		DirectX::ScratchImage decoded;
+		ImageDecoder::Decode(sourcePath, decoded);
+		return Cook(decoded, format, filter, cookedPath, streamSize, image);
+	}
+
+	TextureLoadInfo TextureCooker::LoadORM(const std::unordered_map<TextureType, std::wstring>& sources, DirectX::ScratchImage& image, size_t streamSize)
+	{
+		// Keyed by every source in channel order, so replacing one map of the material cooks a new file
+		uint64_t hash = 14695981039346656037ull;
+		std::wstring directory;
+		for (TextureType type : { TextureType::AOMap, TextureType::Roughness, TextureType::Metallic })
+		{
+			auto source = sources.find(type);
+			uint64_t sourceHash = 0;
+			if (source != sources.end())
+			{
+				sourceHash = HashSource(source->second);
+				if (directory.empty())
+					directory = std::filesystem::path(source->second).parent_path().wstring();
+			}
+			hash = (hash ^ sourceHash) * 1099511628211ull;
+		}
+		if (directory.empty())
+			throw std::runtime_error("ORM texture without any source map");
+		hash = (hash ^ (ORMPacker::IsGltfLayout(sources) ? 1 : 0)) * 1099511628211ull;
+
+		const std::wstring cookedPath = MakeCookedPath(directory, L"orm", hash, ORM_COOKED_FORMAT);
+		TextureLoadInfo info;
+		if (LoadCooked(cookedPath, ORM_COOKED_FORMAT, streamSize, image, info))
+			return info;
+
+		DirectX::ScratchImage packed;
+		ORMPacker::Pack(sources, packed);
+		return Cook(packed, ORM_COOKED_FORMAT, MipFilter::Linear, cookedPath, streamSize, image);
+	}
+
+	size_t TextureCooker::GetFirstMip(const DirectX::TexMetadata& metadata, size_t maxSize)
+	{
+		if (maxSize == 0 || metadata.dimension != DirectX::TEX_DIMENSION_TEXTURE2D || metadata.arraySize != 1)
+			return 0;
+		size_t mip = 0;
+		while (mip + 1 < metadata.mipLevels && (std::max)(metadata.width >> mip, metadata.height >> mip) > maxSize)
+			mip++;
+		return mip;
+	}
+
+	void TextureCooker::LoadMips(const std::wstring& cookedPath, size_t firstMip, DirectX::ScratchImage& image)
+	{
+		DirectX::TexMetadata metadata;
+		if (FAILED(DirectX::GetMetadataFromDDSFile(cookedPath.c_str(), DirectX::DDS_FLAGS_NONE, metadata))
+			|| metadata.dimension != DirectX::TEX_DIMENSION_TEXTURE2D || metadata.arraySize != 1 || firstMip >= metadata.mipLevels)
+			throw std::runtime_error("Cooked texture has no mips to stream");
+
+		DirectX::ScratchImage mips;
+		if (FAILED(mips.Initialize2D(metadata.format, (std::max)(metadata.width >> firstMip, size_t(1)), (std::max)(metadata.height >> firstMip, size_t(1)), 1, metadata.mipLevels - firstMip)))
+			throw std::runtime_error("Failed to allocate texture mips");
+
+		// Cooked files are written by DirectXTex, so the mips are packed largest first with the pitches of a ScratchImage
+		// and the pixel data ends the file. The requested mips are its last bytes and only their pages are read
+		MappedFile file(std::filesystem::path(cookedPath).string());
+		if (!file.IsOpen() || file.GetSize() < mips.GetPixelsSize())
+			throw std::runtime_error("Failed to read cooked texture mips");
+		memcpy(mips.GetPixels(), file.GetData() + file.GetSize() - mips.GetPixelsSize(), mips.GetPixelsSize());
+		image = std::move(mips);
+	}
+
+	bool TextureCooker::LoadCooked(const std::wstring& cookedPath, DXGI_FORMAT format, size_t streamSize, DirectX::ScratchImage& image, TextureLoadInfo& info)
+	{
+		// A cache file that fails to load or has another format is cooked again
+		if (!std::filesystem::exists(cookedPath)
+			|| FAILED(DirectX::GetMetadataFromDDSFile(cookedPath.c_str(), DirectX::DDS_FLAGS_NONE, info.Metadata))
+			|| info.Metadata.format != format)
+			return false;
+
+		const size_t firstMip = GetFirstMip(info.Metadata, streamSize);
+		if (firstMip == 0)
+		{
+			if (FAILED(DirectX::LoadFromDDSFile(cookedPath.c_str(), DirectX::DDS_FLAGS_NONE, nullptr, image)))
+				return false;
+		}
+		else
+		{
+			try
+			{
+				LoadMips(cookedPath, firstMip, image);
+			}
+			catch (const std::runtime_error&)
+			{
+				return false;
+			}
+			info.StreamPath = cookedPath;
+		}
+		info.FromCache = true;
+		return true;
+	}
+
+	TextureLoadInfo TextureCooker::Cook(DirectX::ScratchImage& decoded, DXGI_FORMAT format, MipFilter filter, const std::wstring& cookedPath, size_t streamSize, DirectX::ScratchImage& image)
+	{
+		DirectX::ScratchImage mips;
+		MipGenerator::Generate(decoded, filter, mips);
+		decoded.Release();
+
+		TextureLoadInfo info;
+		if (!CanCompress(mips.GetMetadata()))
+		{
+			image = std::move(mips);
+			info.Metadata = image.GetMetadata();
+			return info;
+		}
+		Compress(mips, format, image);
+		info.Metadata = image.GetMetadata();
+
+		// Once cached, a streamed texture keeps only its smallest mips like every later load of the file
+		TextureLoadInfo cached;
+		if (Write(cookedPath, image) && GetFirstMip(info.Metadata, streamSize) > 0 && LoadCooked(cookedPath, format, streamSize, image, cached))
+			info.StreamPath = cached.StreamPath;
+		return info;
+	}
+
+	bool TextureCooker::CanCompress(const DirectX::TexMetadata& metadata)
+	{
+		// D3D12 requires the top level of a block compressed texture to be whole blocks
+		return !DirectX::IsCompressed(metadata.format) && !DirectX::IsTypeless(metadata.format) && DirectX::BitsPerColor(metadata.format) <= 16
+			&& metadata.width % 4 == 0 && metadata.height % 4 == 0;
+	}
+
+	void TextureCooker::Compress(const DirectX::ScratchImage& source, DXGI_FORMAT format, DirectX::ScratchImage& result)
+	{
+		// Materials are compressed on the loader's worker threads, so DirectXTex's own parallel path stays off. BC7 is
+		// limited to its fast modes, the full mode search is an order of magnitude slower for little gain on materials
+		DirectX::TEX_COMPRESS_FLAGS flags = DirectX::TEX_COMPRESS_DEFAULT;
+		if (format == DXGI_FORMAT_BC7_UNORM || format == DXGI_FORMAT_BC7_UNORM_SRGB)
+			flags |= DirectX::TEX_COMPRESS_BC7_QUICK;
+		if (FAILED(DirectX::Compress(source.GetImages(), source.GetImageCount(), source.GetMetadata(), format, flags, DirectX::TEX_THRESHOLD_DEFAULT, result)))
+			throw std::runtime_error("Failed to block compress texture");
+	}
+
+	bool TextureCooker::Write(const std::wstring& cookedPath, const DirectX::ScratchImage& image)
+	{
+		// The cache is an optimization, a read-only asset directory just means cooking again next time. Written to a
+		// temporary file first so a crash mid-write never leaves a truncated DDS behind
+		std::error_code error;
+		std::filesystem::create_directories(std::filesystem::path(cookedPath).parent_path(), error);
+		const std::wstring tempPath = cookedPath + L".tmp";
+		if (FAILED(DirectX::SaveToDDSFile(image.GetImages(), image.GetImageCount(), image.GetMetadata(), DirectX::DDS_FLAGS_NONE, tempPath.c_str())))
+			return false;
+		std::filesystem::rename(tempPath, cookedPath, error);
+		if (!error)
+			return true;
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "MipGenerator.h"
+#include "../Resources/Texture.h"
+#include <DirectXTex.h>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+
+#define TEXTURE_COOK_VERSION 1
+#define TEXTURE_STAMP_MAGIC 0x504D5453 // "STMP"
+#define ORM_COOKED_FORMAT DXGI_FORMAT_BC7_UNORM
+
+namespace DX12Engine
+{
+	// A loaded texture. When only the smallest mips were read, Metadata describes the whole chain and StreamPath is the
+	// cooked file the remaining mips can be read from with LoadMips
+	struct TextureLoadInfo
+	{
+		DirectX::TexMetadata Metadata = {};
+		std::wstring StreamPath;
+		bool FromCache = false;
+	};
+
+	// Block compresses material images into DDS files that are cached in a "cooked" directory next to the source. The
+	// file name carries a hash of the source content, the target format and TEXTURE_COOK_VERSION, so editing an image or
+	// the cook settings simply produces a new file and later loads never decode the PNG again. The content hash is kept
+	// in a stamp file with the source's size and write time and only recomputed when those changed, like MeshCache
+	class TextureCooker
+	{
+	public:
+		// BC7 for color, BC5 for normal maps (the shader rebuilds Z) and BC4 for single channel masks. Values are stored
+		// as is, no sRGB view is applied
+		static DXGI_FORMAT GetCookedFormat(TextureType type);
+		// Per file of a material. A file shared by slots with different formats (e.g. glTF metallic-roughness) keeps every
+		// channel in BC7
+		static std::unordered_map<std::wstring, DXGI_FORMAT> GetCookedFormats(const std::unordered_map<TextureType, std::wstring>& paths);
+		static std::wstring GetCookedPath(const std::wstring& sourcePath, DXGI_FORMAT format);
+
+		// Loads the cooked mip chain of an image, cooking and caching it first when missing. DDS sources, float images
+		// and images whose size isn't a multiple of 4 come back uncompressed and are not cached. A cached texture larger
+		// than streamSize only has its smallest mips read (0 reads everything), see TextureLoadInfo. Throws
+		// std::runtime_error if the source can't be decoded or compressed
+		static TextureLoadInfo Load(const std::wstring& sourcePath, DXGI_FORMAT format, MipFilter filter, DirectX::ScratchImage& image, size_t streamSize = 0);
+		// Same for the occlusion-roughness-metallic map packed from a material's AOMap, Roughness and Metallic sources
+		static TextureLoadInfo LoadORM(const std::unordered_map<TextureType, std::wstring>& sources, DirectX::ScratchImage& image, size_t streamSize = 0);
+
+		// Most detailed mip no larger than maxSize. Only single 2D textures are split, everything else returns 0
+		static size_t GetFirstMip(const DirectX::TexMetadata& metadata, size_t maxSize);
+		// Reads mips [firstMip, mipLevels) of a cooked file without touching the larger ones
+		static void LoadMips(const std::wstring& cookedPath, size_t firstMip, DirectX::ScratchImage& image);
+
+		static bool CanCompress(const DirectX::TexMetadata& metadata);
+		static void Compress(const DirectX::ScratchImage& source, DXGI_FORMAT format, DirectX::ScratchImage& result);
+
+	private:
+		// Content hash of a source image, from its stamp when the size and write time still match
+		static uint64_t HashSource(const std::filesystem::path& sourcePath);
+		static std::wstring MakeCookedPath(const std::wstring& directory, const std::wstring& name, uint64_t contentHash, DXGI_FORMAT format);
+		static bool LoadCooked(const std::wstring& cookedPath, DXGI_FORMAT format, size_t streamSize, DirectX::ScratchImage& image, TextureLoadInfo& info);
+		// Builds the mip chain of a decoded image, compresses and caches it. Frees the decoded image
+		static TextureLoadInfo Cook(DirectX::ScratchImage& decoded, DXGI_FORMAT format, MipFilter filter, const std::wstring& cookedPath, size_t streamSize, DirectX::ScratchImage& image);
+		static bool Write(const std::wstring& cookedPath, const DirectX::ScratchImage& image);
+	};
+}
@@ -5,10 +5,10 @@
 namespace DX12Engine
 {
 	Camera::Camera(float aspectRatio, float zNear, float zFar)
-		: m_Position({ 0.0f, 0.0f, 0.0f }), m_Pitch(0.0f), m_Yaw(0.0f)
+		: m_Position({ 0.0f, 0.0f, 0.0f }), m_Pitch(0.0f), m_Yaw(0.0f), m_FieldOfView(DirectX::XMConvertToRadians(60.0f)), m_ZNear(zNear)
 	{
 		m_ProjectionMatrix = DirectX::XMMatrixPerspectiveFovLH(
-			DirectX::XMConvertToRadians(60.0f),
+			m_FieldOfView,
 			aspectRatio,
 			zNear,
 			zFar
@@ -83,6 +83,13 @@ namespace DX12Engine
 		}
 	}
 
+	float Camera::GetScreenSpaceError(float error, float distance, float viewportHeight) const
+	{
+		// Anything closer than the near plane is treated as lying on it
+		float projectionScale = viewportHeight / (2.0f * tanf(m_FieldOfView * 0.5f));
+		return error * projectionScale / max(distance, m_ZNear);
+	}
+
 	void Camera::SetPosition(DirectX::XMFLOAT3 position)
 	{
 		m_Position = position;
@@ -16,6 +16,10 @@ namespace DX12Engine
 		DirectX::XMMATRIX GetViewMatrix() const { return m_ViewMatrix; }
 		DirectX::XMMATRIX GetProjectionMatrix() const { return m_ProjectionMatrix; }
 		DirectX::XMFLOAT3 GetPosition() const { return m_Position; }
+		float GetFieldOfView() const { return m_FieldOfView; }
+
+		// Height in pixels of an object space error seen at the given distance
+		float GetScreenSpaceError(float error, float distance, float viewportHeight) const;
 
 		void SetPosition(DirectX::XMFLOAT3 position);
 		void SetRotation(float pitch, float yaw);
@@ -27,6 +31,8 @@ namespace DX12Engine
 		DirectX::XMFLOAT3 m_Position;
 		float m_Pitch;
 		float m_Yaw;
+		float m_FieldOfView; // Vertical, in radians
+		float m_ZNear;
 
 		DirectX::XMMATRIX m_ViewMatrix;
 		DirectX::XMMATRIX m_ProjectionMatrix;
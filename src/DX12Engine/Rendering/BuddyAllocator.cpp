@@ -0,0 +1,77 @@
+#include "BuddyAllocator.h"
+#include <stdexcept>
+
+namespace DX12Engine
+{
+	BuddyAllocator::BuddyAllocator(uint64_t capacity, uint64_t minBlockSize)
+		: m_Capacity(capacity), m_MinBlockSize(minBlockSize), m_UsedSize(0)
+	{
+		uint32_t maxOrder = 0;
+		while (GetBlockSize(maxOrder) < m_Capacity)
+			maxOrder++;
+		m_FreeBlocks.resize(maxOrder + 1);
+		m_FreeBlocks[maxOrder].insert(0);
+	}
+
+	bool BuddyAllocator::Allocate(uint64_t size, uint64_t alignment, uint64_t& offset)
+	{
+		if (size == 0 || size > m_Capacity || alignment > m_Capacity)
+			return false;
+
+		uint32_t order = 0;
+		while (GetBlockSize(order) < size || GetBlockSize(order) < alignment)
+			order++;
+
+		uint32_t freeOrder = order;
+		while (freeOrder < m_FreeBlocks.size() && m_FreeBlocks[freeOrder].empty())
+			freeOrder++;
+		if (freeOrder == m_FreeBlocks.size())
+			return false;
+
+		offset = *m_FreeBlocks[freeOrder].begin();
+		m_FreeBlocks[freeOrder].erase(m_FreeBlocks[freeOrder].begin());
+		// Keep the lower half, the upper halves stay free
+		while (freeOrder > order)
+		{
+			freeOrder--;
+			m_FreeBlocks[freeOrder].insert(offset + GetBlockSize(freeOrder));
+		}
+
+		m_AllocatedOrders[offset] = order;
+		m_UsedSize += GetBlockSize(order);
+		return true;
+	}
+
+	void BuddyAllocator::Free(uint64_t offset)
+	{
+		auto allocated = m_AllocatedOrders.find(offset);
+		if (allocated == m_AllocatedOrders.end())
+			throw std::runtime_error("Freed block was not allocated");
+
+		uint32_t order = allocated->second;
+		m_AllocatedOrders.erase(allocated);
+		m_UsedSize -= GetBlockSize(order);
+
+		while (order + 1 < m_FreeBlocks.size())
+		{
+			const uint64_t buddy = offset ^ GetBlockSize(order);
+			auto free = m_FreeBlocks[order].find(buddy);
+			if (free == m_FreeBlocks[order].end())
+				break;
+			m_FreeBlocks[order].erase(free);
+			offset = offset < buddy ? offset : buddy;
+			order++;
+		}
+		m_FreeBlocks[order].insert(offset);
+	}
+
+	uint64_t BuddyAllocator::GetLargestFreeBlock() const
+	{
+		for (size_t order = m_FreeBlocks.size(); order > 0; order--)
+		{
+			if (!m_FreeBlocks[order - 1].empty())
+				return GetBlockSize(static_cast<uint32_t>(order - 1));
+		}
+		return 0;
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace DX12Engine
+{
+	// Hands out power of two blocks of one range by splitting larger free blocks in halves, a freed block merges with
+	// its buddy (the other half of the block it was split from) whenever that is free too. Every block is aligned to its
+	// own size, so alignments up to the block size cost nothing extra, and requests are rounded up to a power of two,
+	// which is the internal fragmentation traded for constant time merging. The lowest free offset is always taken,
+	// packing allocations towards the start. Knows nothing about D3D12, so it can be exercised on the CPU
+	class BuddyAllocator
+	{
+	public:
+		// Both must be powers of two, capacity at least minBlockSize
+		BuddyAllocator(uint64_t capacity, uint64_t minBlockSize);
+
+		// Alignment must be a power of two. Returns false if no free block is large enough
+		bool Allocate(uint64_t size, uint64_t alignment, uint64_t& offset);
+		// Offset must come from Allocate
+		void Free(uint64_t offset);
+
+		uint64_t GetCapacity() const { return m_Capacity; }
+		// Rounded block sizes, so it includes internal fragmentation
+		uint64_t GetUsedSize() const { return m_UsedSize; }
+		uint64_t GetLargestFreeBlock() const;
+		bool IsEmpty() const { return m_AllocatedOrders.empty(); }
+
+	private:
+		uint64_t GetBlockSize(uint32_t order) const { return m_MinBlockSize << order; }
+
+		uint64_t m_Capacity;
+		uint64_t m_MinBlockSize;
+		uint64_t m_UsedSize;
+		std::vector<std::set<uint64_t>> m_FreeBlocks; // Offsets by order, order 0 is minBlockSize
+		std::unordered_map<uint64_t, uint32_t> m_AllocatedOrders;
+	};
+}
@@ -1,20 +1,35 @@
 #include "IndexBuffer.h"
+#include "../../Utils/EngineUtils.h"
 
 namespace DX12Engine
 {
-    IndexBuffer::IndexBuffer(ID3D12Resource* resource, D3D12_RESOURCE_STATES usageState, DXGI_FORMAT format, UINT bufferSize)
-		: GPUResource(resource, usageState)
+    IndexBuffer::IndexBuffer(ID3D12Resource* resource, D3D12_RESOURCE_STATES usageState, DXGI_FORMAT format, UINT indexCount)
+		: GPUResource(resource, usageState), m_IndexCount(indexCount), m_MappedBuffer(nullptr)
     {
 		m_GPUAddress = resource->GetGPUVirtualAddress();
 		m_IndexBufferView.BufferLocation = m_GPUAddress;
 		m_IndexBufferView.Format = format;
-		m_IndexBufferView.SizeInBytes = bufferSize;
+		m_IndexBufferView.SizeInBytes = GetIndexStride(format) * indexCount;
     }
 
     IndexBuffer::~IndexBuffer()
     {
+		if (m_MappedBuffer)
+			m_Resource->Unmap(0, nullptr);
+		m_MappedBuffer = nullptr;
 		m_IndexBufferView.BufferLocation = 0;
 		m_IndexBufferView.Format = (DXGI_FORMAT)NULL;
 		m_IndexBufferView.SizeInBytes = 0;
+		m_IndexCount = 0;
+    }
+
+    void* IndexBuffer::GetMappedData()
+    {
+		if (!m_MappedBuffer)
+		{
+			CD3DX12_RANGE readRange(0, 0);
+			EngineUtils::ThrowIfFailed(m_Resource->Map(0, &readRange, &m_MappedBuffer));
+		}
+		return m_MappedBuffer;
     }
 }
@@ -7,13 +7,20 @@ namespace DX12Engine
 	class IndexBuffer : public GPUResource
 	{
 	public:
-		IndexBuffer(ID3D12Resource* resource, D3D12_RESOURCE_STATES usageState, DXGI_FORMAT format, UINT bufferSize);
+		IndexBuffer(ID3D12Resource* resource, D3D12_RESOURCE_STATES usageState, DXGI_FORMAT format, UINT indexCount);
 		~IndexBuffer();
 
 		D3D12_INDEX_BUFFER_VIEW GetIndexBufferView() const { return m_IndexBufferView; }
+		UINT GetIndexCount() const { return m_IndexCount; }
+		// Persistently mapped pointer, only valid for index buffers living in an upload heap
+		void* GetMappedData();
+
+		static UINT GetIndexStride(DXGI_FORMAT format) { return format == DXGI_FORMAT_R16_UINT ? 2 : 4; }
 
 	private:
 		D3D12_INDEX_BUFFER_VIEW m_IndexBufferView;
+		UINT m_IndexCount;
+		void* m_MappedBuffer;
 	};
 }
 
@@ -0,0 +1,173 @@
+#include "GPUHeapAllocator.h"
+#include "d3dx12.h"
+#include "../Utils/EngineUtils.h"
+#include "GPUUploader.h"
+#include "Queues/CommandQueue.h"
+#include <stdexcept>
+
+namespace DX12Engine
+{
+	static const D3D12_HEAP_FLAGS PoolHeapFlags[] =
+	{
+		D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS,
+		D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES,
+		D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES,
+	};
+
+	GPUHeapAllocator::GPUHeapAllocator(ID3D12Device* device, UINT64 heapSize, CommandQueue& graphicsQueue, GPUUploader& uploader)
+		: m_Device(device), m_HeapSize(heapSize), m_GraphicsQueue(&graphicsQueue), m_Uploader(&uploader)
+	{
+	}
+
+	GPUHeapAllocator::~GPUHeapAllocator()
+	{
+		// Only reached with retired resources if Shutdown never ran, the GPU is done with them either way by now
+		for (const RetiredAllocation& retired : m_Retired)
+			retired.Resource->Release();
+	}
+
+	ID3D12Resource* GPUHeapAllocator::CreateResource(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue, GPUHeapAllocation& allocation, bool pageable)
+	{
+		const GPUHeapPool pool = GetPool(desc);
+		const size_t poolIndex = static_cast<size_t>(pool);
+		GPUHeapStatistics& statistics = m_Statistics[poolIndex];
+		allocation = {};
+
+		const D3D12_RESOURCE_ALLOCATION_INFO info = m_Device->GetResourceAllocationInfo(0, 1, &desc);
+		if (info.SizeInBytes == UINT64_MAX)
+			throw std::runtime_error("Invalid resource description");
+
+		ID3D12Resource* resource = nullptr;
+		if (pageable || info.SizeInBytes > m_HeapSize)
+		{
+			auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+			EngineUtils::ThrowIfFailed(m_Device->CreateCommittedResource(
+				&heapProps,
+				D3D12_HEAP_FLAG_NONE,
+				&desc,
+				initialState,
+				clearValue,
+				IID_PPV_ARGS(&resource)));
+			statistics.CommittedCount++;
+			return resource;
+		}
+
+		// First fit over the heaps, a new one only once all of them are too full. Ranges the GPU finished with count too
+		ReleaseRetired();
+		std::vector<Heap>& heaps = m_Heaps[poolIndex];
+		UINT heapIndex = 0;
+		UINT64 offset = 0;
+		UINT64 usedSize = 0;
+		for (; heapIndex < heaps.size(); heapIndex++)
+		{
+			usedSize = heaps[heapIndex].Allocator.GetUsedSize();
+			if (heaps[heapIndex].Allocator.Allocate(info.SizeInBytes, info.Alignment, offset))
+				break;
+		}
+		if (heapIndex == heaps.size())
+		{
+			AddHeap(pool);
+			usedSize = 0;
+			if (!heaps.back().Allocator.Allocate(info.SizeInBytes, info.Alignment, offset))
+				throw std::runtime_error("Resource doesn't fit an empty heap");
+		}
+
+		Heap& heap = heaps[heapIndex];
+		HRESULT result = m_Device->CreatePlacedResource(heap.Resource.Get(), offset, &desc, initialState, clearValue, IID_PPV_ARGS(&resource));
+		if (FAILED(result))
+		{
+			heap.Allocator.Free(offset);
+			EngineUtils::ThrowIfFailed(result);
+		}
+
+		allocation.Allocator = shared_from_this();
+		allocation.Pool = pool;
+		allocation.HeapIndex = heapIndex;
+		allocation.Offset = offset;
+		statistics.UsedBytes += heap.Allocator.GetUsedSize() - usedSize;
+		statistics.PlacedCount++;
+		return resource;
+	}
+
+	void GPUHeapAllocator::Free(ID3D12Resource* resource, const GPUHeapAllocation& allocation)
+	{
+		RetiredAllocation retired = { resource, allocation.Pool, allocation.HeapIndex, allocation.Offset, 0, 0 };
+		if (!m_Uploader)
+		{
+			Release(retired);
+			return;
+		}
+
+		// Copies still recorded for the resource signal the next copy fence, the open graphics list the next graphics one
+		retired.CopyFenceValue = m_Uploader->GetRecordedCopyFence();
+		retired.GraphicsFenceValue = m_GraphicsQueue->GetNextFenceValue();
+		m_Retired.push_back(retired);
+		m_Statistics[static_cast<size_t>(allocation.Pool)].RetiringCount++;
+		ReleaseRetired();
+	}
+
+	void GPUHeapAllocator::ReleaseRetired()
+	{
+		if (m_Retired.empty() || !m_Uploader)
+			return;
+
+		const UINT copyFence = m_Uploader->PollCopyFence();
+		const UINT graphicsFence = m_GraphicsQueue->PollCurrentFenceValue();
+		while (!m_Retired.empty() && m_Retired.front().CopyFenceValue <= copyFence && m_Retired.front().GraphicsFenceValue <= graphicsFence)
+		{
+			m_Statistics[static_cast<size_t>(m_Retired.front().Pool)].RetiringCount--;
+			Release(m_Retired.front());
+			m_Retired.pop_front();
+		}
+	}
+
+	void GPUHeapAllocator::Shutdown()
+	{
+		for (const RetiredAllocation& retired : m_Retired)
+		{
+			m_Statistics[static_cast<size_t>(retired.Pool)].RetiringCount--;
+			Release(retired);
+		}
+		m_Retired.clear();
+		m_GraphicsQueue = nullptr;
+		m_Uploader = nullptr;
+	}
+
+	void GPUHeapAllocator::Release(const RetiredAllocation& retired)
+	{
+		retired.Resource->Release();
+		GPUHeapStatistics& statistics = m_Statistics[static_cast<size_t>(retired.Pool)];
+		BuddyAllocator& allocator = m_Heaps[static_cast<size_t>(retired.Pool)][retired.HeapIndex].Allocator;
+		const UINT64 usedSize = allocator.GetUsedSize();
+		allocator.Free(retired.Offset);
+		statistics.UsedBytes -= usedSize - allocator.GetUsedSize();
+		statistics.PlacedCount--;
+	}
+
+	GPUHeapPool GPUHeapAllocator::GetPool(const D3D12_RESOURCE_DESC& desc)
+	{
+		if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+			return GPUHeapPool::Buffers;
+		if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+			return GPUHeapPool::RenderTargets;
+		return GPUHeapPool::Textures;
+	}
+
+	void GPUHeapAllocator::AddHeap(GPUHeapPool pool)
+	{
+		const size_t poolIndex = static_cast<size_t>(pool);
+
+		D3D12_HEAP_DESC heapDesc = {};
+		heapDesc.SizeInBytes = m_HeapSize;
+		heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+		// Multisampled targets need the larger placement alignment from the heap too
+		heapDesc.Alignment = pool == GPUHeapPool::RenderTargets ? D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT : D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+		heapDesc.Flags = PoolHeapFlags[poolIndex];
+
+		Microsoft::WRL::ComPtr<ID3D12Heap> heap;
+		EngineUtils::ThrowIfFailed(m_Device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap)));
+		m_Heaps[poolIndex].push_back({ heap, BuddyAllocator(m_HeapSize, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT) });
+		m_Statistics[poolIndex].HeapCount++;
+		m_Statistics[poolIndex].HeapBytes += m_HeapSize;
+	}
+}
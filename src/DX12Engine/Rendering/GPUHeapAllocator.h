@@ -0,0 +1,100 @@
+#pragma once
+#include <d3d12.h>
+#include <wrl.h>
+#include <array>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "BuddyAllocator.h"
+
+namespace DX12Engine
+{
+	// Resource heap tier 1 hardware can't mix these in one heap
+	enum class GPUHeapPool
+	{
+		Buffers,
+		Textures,
+		RenderTargets, // Render target and depth stencil textures
+		Count
+	};
+
+	struct GPUHeapStatistics
+	{
+		UINT HeapCount = 0;
+		UINT64 HeapBytes = 0;
+		UINT64 UsedBytes = 0; // Rounded to the allocator's blocks, including freed ranges the GPU may still use
+		UINT PlacedCount = 0;
+		UINT RetiringCount = 0; // Freed placed resources waiting for the GPU
+		UINT CommittedCount = 0; // Pageable resources and ones the pool's heaps couldn't take
+	};
+
+	class GPUHeapAllocator;
+	class CommandQueue;
+	class GPUUploader;
+
+	// Where a placed resource lives, the resource keeps the allocator alive. Committed resources have no allocator
+	struct GPUHeapAllocation
+	{
+		std::shared_ptr<GPUHeapAllocator> Allocator;
+		GPUHeapPool Pool = GPUHeapPool::Buffers;
+		UINT HeapIndex = 0;
+		UINT64 Offset = 0;
+	};
+
+	// Creates DEFAULT heap resources as placed resources in large heaps instead of giving each one an implicit heap of
+	// its own. Every pool grows by a heap whenever none of its heaps has room, ranges are handed out by a buddy allocator
+	// per heap and heaps are kept for the allocator's lifetime. Resources too large for a heap, and pageable ones, stay
+	// committed. A freed range isn't reused until the copies and graphics work submitted or recorded before the free
+	// finished, its placed resource is released with it. Not thread safe, resources are created on the render thread
+	class GPUHeapAllocator : public std::enable_shared_from_this<GPUHeapAllocator>
+	{
+	public:
+		GPUHeapAllocator(ID3D12Device* device, UINT64 heapSize, CommandQueue& graphicsQueue, GPUUploader& uploader);
+		~GPUHeapAllocator();
+
+		GPUHeapAllocator(const GPUHeapAllocator&) = delete;
+		GPUHeapAllocator& operator=(const GPUHeapAllocator&) = delete;
+
+		// The pool follows from the desc's dimension and flags. Placed render targets and depth maps start with undefined
+		// contents and have to be cleared before they are read. Pageable resources are always committed, residency works
+		// per heap and a placed resource can't be evicted without everything else in its heap
+		ID3D12Resource* CreateResource(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue, GPUHeapAllocation& allocation, bool pageable = false);
+		// Takes over the placed resource's reference, it is released and its range reused once the GPU is done with it
+		void Free(ID3D12Resource* resource, const GPUHeapAllocation& allocation);
+		// Returns the ranges of freed resources whose fences completed, creating a resource does this as well
+		void ReleaseRetired();
+		// Call while the queues still exist and are idle. Releases everything retired, later frees are immediate
+		void Shutdown();
+
+		const GPUHeapStatistics& GetStatistics(GPUHeapPool pool) const { return m_Statistics[static_cast<size_t>(pool)]; }
+
+	private:
+		struct Heap
+		{
+			Microsoft::WRL::ComPtr<ID3D12Heap> Resource;
+			BuddyAllocator Allocator;
+		};
+
+		struct RetiredAllocation
+		{
+			ID3D12Resource* Resource;
+			GPUHeapPool Pool;
+			UINT HeapIndex;
+			UINT64 Offset;
+			UINT CopyFenceValue;
+			UINT GraphicsFenceValue;
+		};
+
+		static GPUHeapPool GetPool(const D3D12_RESOURCE_DESC& desc);
+		void Release(const RetiredAllocation& retired);
+		void AddHeap(GPUHeapPool pool);
+
+		Microsoft::WRL::ComPtr<ID3D12Device> m_Device;
+		UINT64 m_HeapSize;
+		std::array<std::vector<Heap>, static_cast<size_t>(GPUHeapPool::Count)> m_Heaps;
+		std::array<GPUHeapStatistics, static_cast<size_t>(GPUHeapPool::Count)> m_Statistics;
+		CommandQueue* m_GraphicsQueue; // Both cleared by Shutdown
+		GPUUploader* m_Uploader;
+		std::deque<RetiredAllocation> m_Retired; // Fences increase, so oldest first
+	};
+}
@@ -2,78 +2,373 @@
 #include "../Utils/Constants.h"
 #include "./RenderContext.h"
 #include "Heaps/RenderPassDescriptorHeap.h"
+#include "../Utils/EngineUtils.h"
+#include <DirectXTex.h>
+#include <stdexcept>
+#include <cstring>
 
 namespace DX12Engine
 {
 	GPUUploader::GPUUploader(RenderContext& context)
-		: m_RenderContext(context), m_QueueManager(context.GetQueueManager()), m_RenderHeap(context.GetHeapManager().GetRenderPassHeap())
+		: m_RenderContext(context), m_QueueManager(context.GetQueueManager()), m_RenderHeap(context.GetHeapManager().GetRenderPassHeap()),
+		m_UploadRingAllocator(UPLOAD_RING_BUFFER_SIZE), m_UploadQueue(UPLOAD_FRAME_BYTE_BUDGET, UPLOAD_FRAME_TIME_BUDGET_MS)
 	{
 		m_GraphicsCommandList = m_QueueManager.GetGraphicsQueue().GetCommandList();
 		m_CopyCommandList = m_QueueManager.GetCopyQueue().GetCommandList();
+
+		auto uploadHeapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+		auto uploadDesc = CD3DX12_RESOURCE_DESC::Buffer(UPLOAD_RING_BUFFER_SIZE);
+		m_UploadRing = nullptr;
+		EngineUtils::ThrowIfFailed(m_RenderContext.GetDevice()->CreateCommittedResource(
+			&uploadHeapProps,
+			D3D12_HEAP_FLAG_NONE,
+			&uploadDesc,
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(&m_UploadRing)));
+		// The CPU never reads it back
+		CD3DX12_RANGE readRange(0, 0);
+		EngineUtils::ThrowIfFailed(m_UploadRing->Map(0, &readRange, reinterpret_cast<void**>(&m_UploadRingData)));
 	}
 
 	GPUUploader::~GPUUploader()
 	{
+		// The render context flushed the queues before destroying the uploader. Resources outliving it mustn't untrack
+		// themselves from it
+		UnlinkUntracked(m_Tracker.UntrackAll());
+		ReleaseDedicatedUploads(m_Recording.DedicatedUploads);
+		for (UploadBatch& batch : m_InFlight)
+			ReleaseDedicatedUploads(batch.DedicatedUploads);
+		m_UploadRing->Unmap(0, nullptr);
+		m_UploadRing->Release();
 	}
 
-	void GPUUploader::UploadTextureBatch(std::vector<Texture*> textures)
+	GPUUploader::UploadRegion GPUUploader::AllocateUpload(UINT64 size, UINT64 alignment, bool canFlush)
 	{
+		CommandQueue& copyQueue = m_QueueManager.GetCopyQueue();
+		m_UploadRingAllocator.Retire(copyQueue.PollCurrentFenceValue());
+
+		uint64_t offset = 0;
+		if (m_UploadRingAllocator.Allocate(size, alignment, offset))
+			return { m_UploadRing, offset, m_UploadRingData + offset };
+		if (canFlush && size <= UPLOAD_RING_BUFFER_SIZE)
+		{
+			// Only batches already on the GPU can free regions, so the recorded copies go first
+			ExecuteUpload();
+			for (const UploadBatch& batch : m_InFlight)
+			{
+				copyQueue.WaitForFenceCPUBlocking(batch.FenceValue);
+				m_UploadRingAllocator.Retire(batch.FenceValue);
+				if (m_UploadRingAllocator.Allocate(size, alignment, offset))
+					return { m_UploadRing, offset, m_UploadRingData + offset };
+			}
+		}
+
+		// Larger than the ring, or the ring is held by copies that can't be flushed from here
+		auto uploadHeapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+		auto uploadDesc = CD3DX12_RESOURCE_DESC::Buffer(size);
+		ID3D12Resource* uploadResource = nullptr;
+		EngineUtils::ThrowIfFailed(m_RenderContext.GetDevice()->CreateCommittedResource(
+			&uploadHeapProps,
+			D3D12_HEAP_FLAG_NONE,
+			&uploadDesc,
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(&uploadResource)));
+		m_Recording.DedicatedUploads.push_back(uploadResource);
+
+		uint8_t* data = nullptr;
+		CD3DX12_RANGE readRange(0, 0);
+		EngineUtils::ThrowIfFailed(uploadResource->Map(0, &readRange, reinterpret_cast<void**>(&data)));
+		return { uploadResource, 0, data };
+	}
+
+	void GPUUploader::OpenCopyList()
+	{
+		if (m_CopyListOpen)
+			return;
+		CommandQueue& copyQueue = m_QueueManager.GetCopyQueue();
+		if (copyQueue.IsFenceComplete(m_LastCopyFence))
+			copyQueue.ResetCommandAllocatorAndList();
+		else
+			copyQueue.ResetCommandList();
+		m_CopyListOpen = true;
+	}
+
+	void GPUUploader::ReleaseDedicatedUploads(std::vector<ID3D12Resource*>& uploads)
+	{
+		for (ID3D12Resource* uploadResource : uploads)
+			uploadResource->Release();
+		uploads.clear();
+	}
+
+	void GPUUploader::TrackUpload(GPUResource* resource, D3D12_RESOURCE_STATES state)
+	{
+		m_Tracker.Track(resource, state);
+		resource->SetUploadTracker(&m_Tracker);
+		m_Recording.CopyCount++;
+	}
+
+	void GPUUploader::UnlinkUntracked(const std::vector<GPUResource*>& resources)
+	{
+		for (GPUResource* resource : resources)
+		{
+			if (!m_Tracker.IsTracked(resource))
+				resource->SetUploadTracker(nullptr);
+		}
+	}
+
+	void GPUUploader::UploadTextureBatch(std::vector<Texture*> textures, UploadCallback onComplete)
+	{
+		if (textures.empty())
+		{
+			if (onComplete)
+				onComplete();
+			return;
+		}
+
 		DescriptorHeapHandle renderBlockStart = m_RenderHeap.GetHeapHandleBlock(textures.size());
-		D3D12_CPU_DESCRIPTOR_HANDLE currentCPUHandle = renderBlockStart.GetCPUHandle();
 		D3D12_GPU_DESCRIPTOR_HANDLE currentGPUHandle = renderBlockStart.GetGPUHandle();
-		UINT descriptorSize = m_RenderHeap.GetDescriptorSize();	
+		UINT descriptorSize = m_RenderHeap.GetDescriptorSize();
+		std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> sourceHandles;
 		for (Texture* texture : textures)
 		{
-			UpdateSubresources(m_CopyCommandList, texture->GetResource(), texture->m_UploadResource, 0, 0, static_cast<UINT>(texture->m_Data.size()), texture->m_Data.data());
-			auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(texture->m_MainResource,
-				D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-			m_GraphicsCommandList->ResourceBarrier(1, &barrier);
+			const UINT firstSubresource = texture->GetResidentMip();
+			const UINT subresourceCount = static_cast<UINT>(texture->m_Data.size());
+			const UINT64 uploadSize = GetRequiredIntermediateSize(texture->GetResource(), firstSubresource, subresourceCount);
+			UploadRegion region = AllocateUpload(uploadSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, true);
+			OpenCopyList();
+			UpdateSubresources(m_CopyCommandList, texture->GetResource(), region.Resource, region.Offset, firstSubresource, subresourceCount, texture->m_Data.data());
+			TrackUpload(texture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 
-			m_RenderContext.GetDevice()->CopyDescriptorsSimple(1, currentCPUHandle, texture->GetDescriptor()->GetCPUHandle(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+			sourceHandles.push_back(texture->GetDescriptor()->GetCPUHandle());
 			texture->GetDescriptor()->SetGPUHandle(currentGPUHandle);
 
-			texture->SetUsageState(D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-			texture->SetIsReady(true);
+			// The pixels are in the staging memory now, the decoded image is no longer needed
+			texture->ReleaseUploadData();
 
-			currentCPUHandle.ptr += descriptorSize;
 			currentGPUHandle.ptr += descriptorSize;
 		}
+
+		// The staging views are scattered over the staging heap, the block is contiguous, so one copy gathers them all
+		const D3D12_CPU_DESCRIPTOR_HANDLE destinationStart = renderBlockStart.GetCPUHandle();
+		const UINT descriptorCount = static_cast<UINT>(sourceHandles.size());
+		m_RenderContext.GetDevice()->CopyDescriptors(1, &destinationStart, &descriptorCount, descriptorCount, sourceHandles.data(), nullptr, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+		// Batches finish in order, so the last one holding any of the textures finishes after all of them
+		if (onComplete)
+			m_Recording.Callbacks.push_back(std::move(onComplete));
 		ExecuteUpload();
 	}
 
-	void GPUUploader::UploadResource(UploadResourceWrapper resourceWrapper)
+	void GPUUploader::QueueTextureMips(std::shared_ptr<Texture> texture, std::shared_ptr<DirectX::ScratchImage> image, UINT firstMip, UploadPriority priority, UploadCallback onComplete, UploadCallback onFailed)
 	{
-		UpdateSubresources(m_CopyCommandList, resourceWrapper.GPUResource->GetResource(), resourceWrapper.UploadResource, 0, 0, 1, &resourceWrapper.Data);
-		auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(resourceWrapper.GPUResource->GetResource(),
-			resourceWrapper.GPUResource->GetUsageState(), resourceWrapper.UploadState);
-		m_GraphicsCommandList->ResourceBarrier(1, &barrier);
-		resourceWrapper.GPUResource->SetUsageState(resourceWrapper.UploadState);
-		resourceWrapper.GPUResource->SetIsReady(true);
-		if (++m_UploadCount >= MAX_UPLOAD_BATCH_SIZE)
+		const UINT residentMip = texture->GetResidentMip();
+		const UINT64 bytes = firstMip < residentMip ? GetRequiredIntermediateSize(texture->GetResource(), firstMip, residentMip - firstMip) : 0;
+		m_UploadQueue.Enqueue(priority, bytes, [this, texture, image, firstMip, onComplete, onFailed]()
 		{
-			ExecuteUpload();
-			m_UploadCount = 0;
+			try
+			{
+				StageTextureMips(texture, *image, firstMip, onComplete);
+			}
+			catch (...)
+			{
+				// The scheduler drops the upload and rethrows
+				if (onFailed)
+					onFailed();
+				throw;
+			}
+		});
+	}
+
+	void GPUUploader::StageTextureMips(const std::shared_ptr<Texture>& texture, const DirectX::ScratchImage& image, UINT firstMip, UploadCallback onComplete)
+	{
+		StagedMipUpload staged;
+		staged.Target = texture;
+		staged.FirstMip = firstMip;
+		staged.LastMip = texture->GetResidentMip();
+		staged.OnComplete = std::move(onComplete);
+		if (staged.FirstMip >= staged.LastMip)
+		{
+			// An upload queued earlier already brought these mips in
+			m_StagedMips.push_back(std::move(staged));
+			return;
+		}
+
+		const UINT mipCount = staged.LastMip - staged.FirstMip;
+		D3D12_RESOURCE_DESC desc = texture->GetResource()->GetDesc();
+		std::vector<UINT> rowCounts(mipCount);
+		std::vector<UINT64> rowSizes(mipCount);
+		UINT64 uploadSize = 0;
+		staged.Layouts.resize(mipCount);
+		m_RenderContext.GetDevice()->GetCopyableFootprints(&desc, staged.FirstMip, mipCount, 0, staged.Layouts.data(), rowCounts.data(), rowSizes.data(), &uploadSize);
+
+		// Nothing can be flushed here, the copies are recorded on the graphics list once the frame's share is staged
+		UploadRegion region = AllocateUpload(uploadSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, false);
+		staged.Source = region.Resource;
+		for (UINT mip = 0; mip < mipCount; mip++)
+		{
+			D3D12_PLACED_SUBRESOURCE_FOOTPRINT& layout = staged.Layouts[mip];
+			const DirectX::Image* source = image.GetImage(mip, 0, 0);
+			D3D12_SUBRESOURCE_DATA sourceData = { source->pixels, static_cast<LONG_PTR>(source->rowPitch), static_cast<LONG_PTR>(source->slicePitch) };
+			D3D12_MEMCPY_DEST destination = { region.Data + layout.Offset, layout.Footprint.RowPitch, static_cast<SIZE_T>(layout.Footprint.RowPitch) * rowCounts[mip] };
+			MemcpySubresource(&destination, &sourceData, static_cast<SIZE_T>(rowSizes[mip]), rowCounts[mip], layout.Footprint.Depth);
+			layout.Offset += region.Offset;
 		}
+		m_StagedMips.push_back(std::move(staged));
+	}
+
+	void GPUUploader::ProcessUploadQueue()
+	{
+		if (m_UploadQueue.IsEmpty())
+			return;
+
+		// Recorded copies are submitted first, so the only open ring regions are the ones staged below
+		ExecuteUpload();
+		m_UploadQueue.RunFrame();
+		if (m_StagedMips.empty())
+			return;
+
+		// The textures are shader resources already, a state the copy queue can't transition out of. The graphics list
+		// was executed by the last frame, so it is reset here and closed again by the execute. Textures still waiting
+		// for their first transition get it before the barriers here read their state, merged with the one to copy dest
+		CommandQueue& graphicsQueue = m_QueueManager.GetGraphicsQueue();
+		graphicsQueue.ResetCommandAllocatorAndList();
+		ResourceBarrierBatch barriers;
+		RecordPendingTransitions(barriers);
+		for (const StagedMipUpload& staged : m_StagedMips)
+		{
+			// Evicted textures are paged back in before the copies write to them
+			staged.Target->MarkUsed();
+			if (staged.FirstMip < staged.LastMip)
+				barriers.Transition(staged.Target->GetResource(), staged.Target->GetUsageState(), D3D12_RESOURCE_STATE_COPY_DEST);
+		}
+		barriers.Flush(m_GraphicsCommandList);
+
+		for (const StagedMipUpload& staged : m_StagedMips)
+		{
+			for (UINT mip = staged.FirstMip; mip < staged.LastMip; mip++)
+			{
+				CD3DX12_TEXTURE_COPY_LOCATION destination(staged.Target->GetResource(), mip);
+				CD3DX12_TEXTURE_COPY_LOCATION source(staged.Source, staged.Layouts[mip - staged.FirstMip]);
+				m_GraphicsCommandList->CopyTextureRegion(&destination, 0, 0, 0, &source, nullptr);
+			}
+		}
+
+		for (const StagedMipUpload& staged : m_StagedMips)
+		{
+			if (staged.FirstMip < staged.LastMip)
+				barriers.Transition(staged.Target->GetResource(), D3D12_RESOURCE_STATE_COPY_DEST, staged.Target->GetUsageState());
+		}
+		barriers.Flush(m_GraphicsCommandList);
+
+		UINT fenceVal = graphicsQueue.ExecuteCommandList();
+		graphicsQueue.WaitForFenceCPUBlocking(fenceVal);
+		// The ring is ordered by copy fences. Tagging the regions with the newest one frees them no earlier than the
+		// copies submitted before them, which is late but safe, the graphics copies themselves are done
+		m_UploadRingAllocator.Submit(m_LastCopyFence);
+		ReleaseDedicatedUploads(m_Recording.DedicatedUploads);
+
+		// Callbacks run after the staging list is cleared, so they can queue new uploads
+		std::vector<StagedMipUpload> completed = std::move(m_StagedMips);
+		m_StagedMips.clear();
+		for (StagedMipUpload& staged : completed)
+		{
+			if (staged.OnComplete)
+				staged.OnComplete();
+		}
+	}
+
+	void GPUUploader::UploadResource(UploadResourceWrapper resourceWrapper, UploadCallback onComplete)
+	{
+		// Buffers are copied as one row, RowPitch is their size
+		const UINT64 uploadSize = static_cast<UINT64>(resourceWrapper.Data.RowPitch);
+		UploadRegion region = AllocateUpload(uploadSize, D3D12_STANDARD_MAXIMUM_ELEMENT_ALIGNMENT_BYTE_UNITS, true);
+		OpenCopyList();
+		memcpy(region.Data, resourceWrapper.Data.pData, uploadSize);
+		m_CopyCommandList->CopyBufferRegion(resourceWrapper.GPUResource->GetResource(), 0, region.Resource, region.Offset, uploadSize);
+		TrackUpload(resourceWrapper.GPUResource, resourceWrapper.UploadState);
+		if (onComplete)
+			m_Recording.Callbacks.push_back(std::move(onComplete));
+		if (m_Recording.CopyCount >= MAX_UPLOAD_BATCH_SIZE)
+			ExecuteUpload();
 	}
 
 	void GPUUploader::ExecuteUpload()
 	{
-		UINT copyFenceVal = m_QueueManager.GetCopyQueue().ExecuteCommandList();
-		m_QueueManager.GetCopyQueue().WaitForFenceCPUBlocking(copyFenceVal);
-		m_QueueManager.GetCopyQueue().ResetCommandList();
-		UINT graphicsFenceVal = m_QueueManager.GetGraphicsQueue().ExecuteCommandList();
-		m_QueueManager.GetGraphicsQueue().WaitForFenceCPUBlocking(graphicsFenceVal);
-		m_QueueManager.GetGraphicsQueue().ResetCommandList();
+		if (m_Recording.CopyCount == 0)
+			return;
+
+		m_LastCopyFence = m_QueueManager.GetCopyQueue().ExecuteCommandList();
+		m_CopyListOpen = false;
+		m_UploadRingAllocator.Submit(m_LastCopyFence);
+		m_Tracker.Submit(m_LastCopyFence);
+		m_Recording.FenceValue = m_LastCopyFence;
+		m_InFlight.push_back(std::move(m_Recording));
+		m_Recording = UploadBatch();
+	}
+
+	void GPUUploader::RecordPendingTransitions(ResourceBarrierBatch& barriers)
+	{
+		const std::vector<UploadTracker::Transition> transitions = m_Tracker.TakeTransitions();
+		if (transitions.empty())
+			return;
+
+		// Everything recorded after this on the graphics queue runs once the copies finished
+		m_QueueManager.GetGraphicsQueue().InsertWaitForQueueFence(&m_QueueManager.GetCopyQueue(), m_LastCopyFence);
+		std::vector<GPUResource*> resources;
+		for (const UploadTracker::Transition& transition : transitions)
+		{
+			barriers.Transition(transition.Resource->GetResource(), transition.Resource->GetUsageState(), transition.State);
+			transition.Resource->SetUsageState(transition.State);
+			resources.push_back(transition.Resource);
+		}
+		UnlinkUntracked(resources);
+	}
+
+	void GPUUploader::UploadAllPending()
+	{
+		ProcessCompletedUploads();
+		ExecuteUpload();
+		ResourceBarrierBatch barriers;
+		RecordPendingTransitions(barriers);
+		barriers.Flush(m_GraphicsCommandList);
 	}
 
-	bool GPUUploader::UploadAllPending()
+	void GPUUploader::ProcessCompletedUploads()
 	{
-		if (m_UploadCount > 0)
+		CommandQueue& copyQueue = m_QueueManager.GetCopyQueue();
+		const UINT completedFence = copyQueue.PollCurrentFenceValue();
+		m_UploadRingAllocator.Retire(completedFence);
+
+		const std::vector<GPUResource*> finished = m_Tracker.Retire(completedFence);
+		for (GPUResource* resource : finished)
+			resource->SetIsReady(true);
+		UnlinkUntracked(finished);
+
+		// Callbacks run after the batches are gone, so they can record new uploads
+		std::vector<UploadCallback> callbacks;
+		while (!m_InFlight.empty() && m_InFlight.front().FenceValue <= completedFence)
 		{
-			ExecuteUpload();
-			m_UploadCount = 0;
-			return true;
+			UploadBatch& batch = m_InFlight.front();
+			ReleaseDedicatedUploads(batch.DedicatedUploads);
+			for (UploadCallback& callback : batch.Callbacks)
+				callbacks.push_back(std::move(callback));
+			m_InFlight.pop_front();
 		}
-		return false;
+		for (UploadCallback& callback : callbacks)
+			callback();
+	}
+
+	UINT GPUUploader::GetRecordedCopyFence()
+	{
+		return m_Recording.CopyCount > 0 ? m_QueueManager.GetCopyQueue().GetNextFenceValue() : m_LastCopyFence;
+	}
+
+	void GPUUploader::WaitForUploads()
+	{
+		ExecuteUpload();
+		m_QueueManager.GetCopyQueue().WaitForFenceCPUBlocking(m_LastCopyFence);
+		ProcessCompletedUploads();
 	}
 }
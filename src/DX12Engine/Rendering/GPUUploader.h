@@ -2,25 +2,105 @@
 #include "Queues/CommandQueueManager.h"
 #include "../Resources/Texture.h"
 #include "../Resources/UploadResourceWrapper.h"
+#include "UploadRingAllocator.h"
+#include "ResourceBarrierBatch.h"
+#include "UploadScheduler.h"
+#include "UploadTracker.h"
+#include <deque>
+#include <functional>
 
 namespace DX12Engine
 {
 	class RenderContext;
 	class RenderPassDescriptorHeap;
 
+	typedef std::function<void()> UploadCallback;
+
+	// Copies resources to the GPU on the copy queue without blocking the CPU. Copies are recorded into batches that
+	// execute once full or when a render pass starts, the graphics queue waits for them on the GPU before it transitions
+	// the resources to their usage state. Resources are marked ready, and callbacks run, when a later poll observes the
+	// batch's fence. A resource destroyed while its batch is in flight is dropped from it. Not thread safe, uploads are
+	// recorded on the render thread
 	class GPUUploader
 	{
 	public:
 		GPUUploader(RenderContext& context);
 		~GPUUploader();
 
-		void UploadTextureBatch(std::vector<Texture*> textures);
-		void UploadResource(UploadResourceWrapper resourceWrapper);
+		// Owns the mapped upload ring, use the instance from the render context
+		GPUUploader(const GPUUploader&) = delete;
+		GPUUploader& operator=(const GPUUploader&) = delete;
+
+		// Submits the textures as one batch. The callback runs once all of them are ready
+		void UploadTextureBatch(std::vector<Texture*> textures, UploadCallback onComplete = nullptr);
+		// Adds mips to a texture that is already in use, image holds the chain from firstMip down. Queued with the given
+		// priority and uploaded by ProcessUploadQueue, the callback runs once the mips are on the GPU. Mips the texture
+		// already has by then are skipped. If staging throws the upload is dropped and onFailed runs instead
+		void QueueTextureMips(std::shared_ptr<Texture> texture, std::shared_ptr<DirectX::ScratchImage> image, UINT firstMip, UploadPriority priority, UploadCallback onComplete = nullptr, UploadCallback onFailed = nullptr);
+		// Call once per frame between frames. Stages this frame's share of the queue within the byte and time budget,
+		// then copies it on the graphics queue, which textures in use can be transitioned on, and blocks until it executed
+		void ProcessUploadQueue();
+		void SetUploadBudget(UINT64 bytes, double milliseconds) { m_UploadQueue.SetBudget(bytes, milliseconds); }
+		const UploadQueueStatistics& GetUploadQueueStatistics() const { return m_UploadQueue.GetStatistics(); }
+		// The data is copied before this returns. The callback runs once the resource is ready
+		void UploadResource(UploadResourceWrapper resourceWrapper, UploadCallback onComplete = nullptr);
 
+		// Submits the copies recorded so far without waiting for them
 		void ExecuteUpload();
-		bool UploadAllPending();
+		// Called by RenderContext::BeginCommandList at the start of every pass, with the graphics list reset. Submits the
+		// recorded copies and records the transitions of everything submitted since the last call, the graphics queue
+		// waits for the copies on the GPU
+		void UploadAllPending();
+		// Marks the resources of finished batches ready and runs their callbacks
+		void ProcessCompletedUploads();
+		// Blocks until every submitted copy finished, then processes them
+		void WaitForUploads();
+		// The copy fence that signals once everything recorded so far finished, including copies not submitted yet
+		UINT GetRecordedCopyFence();
+		UINT PollCopyFence() { return m_QueueManager.GetCopyQueue().PollCurrentFenceValue(); }
 
 	private:
+		struct UploadRegion
+		{
+			ID3D12Resource* Resource;
+			UINT64 Offset;
+			uint8_t* Data;
+		};
+
+		struct UploadBatch
+		{
+			UINT FenceValue = 0;
+			UINT CopyCount = 0; // Copies stay recorded even if their resource is destroyed before the submit
+			std::vector<UploadCallback> Callbacks;
+			std::vector<ID3D12Resource*> DedicatedUploads;
+		};
+
+		// Mips [FirstMip, LastMip) copied into staging memory, waiting for the graphics list
+		struct StagedMipUpload
+		{
+			std::shared_ptr<Texture> Target;
+			UINT FirstMip;
+			UINT LastMip;
+			ID3D12Resource* Source;
+			std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> Layouts; // Offsets into Source
+			UploadCallback OnComplete;
+		};
+
+		// Staging memory for one copy, suballocated from the ring. If the ring is full the recorded copies are submitted
+		// when canFlush is set and the CPU waits for older batches to free their regions. Uploads that still don't fit
+		// get a buffer of their own that lives as long as their batch
+		UploadRegion AllocateUpload(UINT64 size, UINT64 alignment, bool canFlush);
+		// The copy list stays closed after a submit until the next copy is recorded, its allocator is only reset once
+		// the copy queue went idle
+		void OpenCopyList();
+		// Adds the transitions of everything submitted since the last call, the caller flushes them
+		void RecordPendingTransitions(ResourceBarrierBatch& barriers);
+		void ReleaseDedicatedUploads(std::vector<ID3D12Resource*>& uploads);
+		void TrackUpload(GPUResource* resource, D3D12_RESOURCE_STATES state);
+		// Clears the link of resources the tracker let go of, so their destructor doesn't look for it
+		void UnlinkUntracked(const std::vector<GPUResource*>& resources);
+		// The CPU side of a queued mip upload, runs inside the scheduler so the copy counts against the time budget
+		void StageTextureMips(const std::shared_ptr<Texture>& texture, const DirectX::ScratchImage& image, UINT firstMip, UploadCallback onComplete);
 
 		CommandQueueManager& m_QueueManager;
 		RenderContext& m_RenderContext;
@@ -30,7 +110,18 @@ namespace DX12Engine
 
 		RenderPassDescriptorHeap& m_RenderHeap;
 
-		int m_UploadCount = 0;
+		ID3D12Resource* m_UploadRing;
+		uint8_t* m_UploadRingData; // Mapped for the uploader's whole lifetime
+		UploadRingAllocator m_UploadRingAllocator;
+
+		UploadBatch m_Recording;
+		std::deque<UploadBatch> m_InFlight; // Oldest first
+		UploadTracker m_Tracker;
+		UINT m_LastCopyFence = 0;
+		bool m_CopyListOpen = true;
+
+		UploadScheduler m_UploadQueue;
+		std::vector<StagedMipUpload> m_StagedMips;
 	};
 }
 
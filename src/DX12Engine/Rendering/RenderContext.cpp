@@ -26,6 +26,8 @@ namespace DX12Engine
 
 	RenderContext::~RenderContext()
 	{
+		// Freed placed resources wait for the GPU, the resource manager releases them all at once
+		m_QueueManager->WaitForAllIdle();
 		ResourceManager::Shutdown();
 		m_QueueManager.reset();
 		m_Device.Reset();
@@ -33,6 +35,12 @@ namespace DX12Engine
 		m_Uploader.reset();
 	}
 
+	void RenderContext::BeginCommandList()
+	{
+		m_QueueManager->GetGraphicsQueue().ResetCommandAllocatorAndList();
+		m_Uploader->UploadAllPending();
+	}
+
 	void RenderContext::InitDevice(HWND hwnd)
 	{
 		#if defined(_DEBUG)
@@ -30,6 +30,10 @@ namespace DX12Engine
 		bool						ProcessWindowMessages() const { return m_RenderWindow->ProcessWindowMessages(); }
 		void						PresentFrame() const { m_RenderWindow->PresentFrame(); }
 
+		// Call at the start of every pass. Resets the graphics list and submits pending uploads, the commands recorded after
+		// this wait for them on the GPU
+		void BeginCommandList();
+
 	private:
 		void InitDevice(HWND hwnd);
 
@@ -2,6 +2,7 @@
 #include "../../Resources/ResourceManager.h"
 #include "../RenderContext.h"
 #include "../../Entity/RenderComponent.h"
+#include "../../Utils/Constants.h"
 
 namespace DX12Engine
 {
@@ -32,8 +33,7 @@ namespace DX12Engine
 
     void GeometryRenderPass::Execute()
     {
-        if (!m_RenderContext.GetUploader().UploadAllPending()) // Upload any pending resources
-            m_QueueManager.GetGraphicsQueue().ResetCommandAllocatorAndList();
+        m_RenderContext.BeginCommandList();
 
 		m_CommandList.SetPipelineState(m_PipelineState.Get());
 		m_CommandList.SetGraphicsRootSignature(m_RootSignature.Get());
@@ -74,17 +74,32 @@ namespace DX12Engine
         auto srvHeap = m_RenderContext.GetHeapManager().GetRenderPassHeap().GetHeap();
         m_CommandList.SetDescriptorHeaps(1, &srvHeap);
 
+        VertexFormat boundFormat = VertexFormat::Full;
         for (RenderComponent* object : m_RenderObjects)
         {
+            if (object->GetVertexFormat() != boundFormat)
+            {
+                boundFormat = object->GetVertexFormat();
+                m_CommandList.SetPipelineState(boundFormat == VertexFormat::Compact ? m_CompactPipelineState.Get() : m_PipelineState.Get());
+            }
+
+            // Clusters outside the frustum or facing away are dropped before any index data reaches the GPU
+            const std::vector<IndexedDraw>& draws = object->PrepareCameraDraw();
+            if (draws.empty())
+                continue;
+
             m_CommandList.SetGraphicsRootConstantBufferView(0, object->GetCBVAddress());
-            int startIndex = 1;
-			object->GetMaterial()->Bind(&m_CommandList, &startIndex);
-
-            auto vertexBufferView = object->GetVertexBufferView();
-            auto indexBufferView = object->GetIndexBufferView();
-            m_CommandList.IASetVertexBuffers(0, 1, &vertexBufferView);
-            m_CommandList.IASetIndexBuffer(&indexBufferView);
-            m_CommandList.DrawIndexedInstanced(indexBufferView.SizeInBytes / 4, 1, 0, 0, 0);
+            D3D12_VERTEX_BUFFER_VIEW vertexBufferViews[2] = { object->GetPositionBufferView(), object->GetAttributeBufferView() };
+            m_CommandList.IASetVertexBuffers(0, 2, vertexBufferViews);
+            m_CommandList.IASetIndexBuffer(&draws.front().IndexBufferView);
+
+            // Submeshes share the geometry and only rebind their material
+            for (const IndexedDraw& draw : draws)
+            {
+                int startIndex = 1;
+                object->GetMaterial(draw.MaterialSlot)->Bind(&m_CommandList, &startIndex);
+                m_CommandList.DrawIndexedInstanced(draw.IndexCount, 1, draw.StartIndex, 0, 0);
+            }
         }
         for (int i = 0; i < m_RenderTargets.size(); i++)
         {
@@ -131,7 +146,7 @@ namespace DX12Engine
             .SetRenderTargets({ DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R16G16B16A16_FLOAT })
             .SetDepthStencilFormat(DXGI_FORMAT_D32_FLOAT);
 
-        DescriptorTableConfig config(m_RenderTargets.size(), D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 0);
+        DescriptorTableConfig config(PBR_MATERIAL_TEXTURE_COUNT, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 0);
         rootSignatureBuilder = rootSignatureBuilder.AddConstantBuffer(0)
             .AddConstantBuffer(1)
             .AddDescriptorTables({ config })
@@ -140,5 +155,9 @@ namespace DX12Engine
         m_RootSignature = ResourceManager::GetInstance().CreateRootSignature(rootSignatureBuilder.Build());
         pipelineStateBuilder = pipelineStateBuilder.SetRootSignature(m_RootSignature.Get());
         m_PipelineState = ResourceManager::GetInstance().CreatePipelineState(pipelineStateBuilder.Build());
+
+        pipelineStateBuilder = pipelineStateBuilder.AddInputLayout(VertexFormat::Compact)
+            .SetVertexShader(ResourceManager::GetInstance().GetShader("Geometry_VS_Compact"));
+        m_CompactPipelineState = ResourceManager::GetInstance().CreatePipelineState(pipelineStateBuilder.Build());
     }
 }
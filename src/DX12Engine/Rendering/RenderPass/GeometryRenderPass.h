@@ -22,6 +22,7 @@ namespace DX12Engine
 
 		Microsoft::WRL::ComPtr<ID3D12RootSignature> m_RootSignature;
 		Microsoft::WRL::ComPtr<ID3D12PipelineState> m_PipelineState;
+		Microsoft::WRL::ComPtr<ID3D12PipelineState> m_CompactPipelineState;
 	};
 }
 
@@ -41,8 +41,7 @@ namespace DX12Engine
 		UpdateSSRPassCB();
 		RenderTexture* renderTarget = m_RenderTargets[0].get();
 
-		if (!m_RenderContext.GetUploader().UploadAllPending()) // Upload any pending resources
-			m_QueueManager.GetGraphicsQueue().ResetCommandAllocatorAndList();
+		m_RenderContext.BeginCommandList();
 
 		m_CommandList.SetPipelineState(m_PipelineState.Get());
 		m_CommandList.SetGraphicsRootSignature(m_RootSignature.Get());
@@ -56,8 +56,7 @@ namespace DX12Engine
 	{
 		EngineUtils::Assert(lightIndex < shadowMap->GetTextureDescriptorCount());
 
-		if (!m_RenderContext.GetUploader().UploadAllPending()) // Upload any pending resources
-			m_QueueManager.GetGraphicsQueue().ResetCommandAllocatorAndList();
+		m_RenderContext.BeginCommandList();
 
 		m_CommandList.SetPipelineState(m_PipelineState.Get());
 		m_CommandList.SetGraphicsRootSignature(m_RootSignature.Get());
@@ -81,17 +80,20 @@ namespace DX12Engine
 
 		m_CommandList.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
+		VertexFormat boundFormat = VertexFormat::Full;
 		for (RenderComponent* object : m_RenderObjects)
 		{
+			// Shadows render both faces and ignore materials, so clusters are only culled against the light frustum and the
+			// submeshes merge into one draw
+			const std::vector<IndexedDraw>& draws = object->PrepareDraw(m_Lights[lightIndex]->GetViewProjMatrix(), nullptr, true);
+			if (draws.empty())
+				continue;
+			const IndexedDraw& draw = draws.front();
+
 			DirectX::XMMATRIX mvpMatrix = DirectX::XMMatrixMultiply(object->GetModelMatrix(), m_Lights[lightIndex]->GetViewProjMatrix());
 			m_ShadowMapData.LightMVPMatrix = mvpMatrix;
-
-			m_CommandList.SetGraphicsRoot32BitConstants(0, sizeof(ShadowMapData) / 4, &m_ShadowMapData, 0);
-			auto vertexBufferView = object->GetVertexBufferView();
-			auto indexBufferView = object->GetIndexBufferView();
-			m_CommandList.IASetVertexBuffers(0, 1, &vertexBufferView);
-			m_CommandList.IASetIndexBuffer(&indexBufferView);
-			m_CommandList.DrawIndexedInstanced(indexBufferView.SizeInBytes / 4, 1, 0, 0, 0);
+			BindObject(object, draw.IndexBufferView, boundFormat);
+			m_CommandList.DrawIndexedInstanced(draw.IndexCount, 1, draw.StartIndex, 0, 0);
 		}
 		barrier = CD3DX12_RESOURCE_BARRIER::Transition(
 			shadowMap->GetResource(),
@@ -124,8 +126,7 @@ namespace DX12Engine
 		{
 			DirectX::XMMATRIX lightViewProj = DirectX::XMMatrixMultiply(shadowTransforms[j], lightProj);
 
-			if (!m_RenderContext.GetUploader().UploadAllPending()) // Upload any pending resources
-				m_QueueManager.GetGraphicsQueue().ResetCommandAllocatorAndList();
+			m_RenderContext.BeginCommandList();
 
 			m_CommandList.SetPipelineState(m_PipelineState.Get());
 			m_CommandList.SetGraphicsRootSignature(m_RootSignature.Get());
@@ -149,19 +150,20 @@ namespace DX12Engine
 
 			m_CommandList.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
+			VertexFormat boundFormat = VertexFormat::Full;
 			for (RenderComponent* object : m_RenderObjects)
 			{
+				const std::vector<IndexedDraw>& draws = object->PrepareDraw(lightViewProj, nullptr, true);
+				if (draws.empty())
+					continue;
+				const IndexedDraw& draw = draws.front();
+
 				DirectX::XMMATRIX mvpMatrix = DirectX::XMMatrixMultiply(object->GetModelMatrix(), lightViewProj);
 				m_ShadowMapData.LightMVPMatrix = mvpMatrix;
 				m_ShadowMapData.ModelMatrix = object->GetModelMatrix();
 				m_ShadowMapData.LightPos = m_Lights[lightIndex]->GetLightData().Position;
-
-				m_CommandList.SetGraphicsRoot32BitConstants(0, sizeof(ShadowMapData) / 4, &m_ShadowMapData, 0);
-				auto vertexBufferView = object->GetVertexBufferView();
-				auto indexBufferView = object->GetIndexBufferView();
-				m_CommandList.IASetVertexBuffers(0, 1, &vertexBufferView);
-				m_CommandList.IASetIndexBuffer(&indexBufferView);
-				m_CommandList.DrawIndexedInstanced(indexBufferView.SizeInBytes / 4, 1, 0, 0, 0);
+				BindObject(object, draw.IndexBufferView, boundFormat);
+				m_CommandList.DrawIndexedInstanced(draw.IndexCount, 1, draw.StartIndex, 0, 0);
 			}
 			barrier = CD3DX12_RESOURCE_BARRIER::Transition(
 				shadowMap->GetResource(),
@@ -176,6 +178,24 @@ namespace DX12Engine
 		}
 	}
 
+	void ShadowMapRenderPass::BindObject(RenderComponent* object, const D3D12_INDEX_BUFFER_VIEW& indexBufferView, VertexFormat& boundFormat)
+	{
+		if (object->GetVertexFormat() != boundFormat)
+		{
+			boundFormat = object->GetVertexFormat();
+			m_CommandList.SetPipelineState(boundFormat == VertexFormat::Compact ? m_CompactPipelineState.Get() : m_PipelineState.Get());
+		}
+
+		const VertexQuantization& quantization = object->GetQuantization();
+		m_ShadowMapData.PositionScale = DirectX::XMFLOAT4(quantization.Scale.x, quantization.Scale.y, quantization.Scale.z, 0.0f);
+		m_ShadowMapData.PositionOffset = DirectX::XMFLOAT4(quantization.Offset.x, quantization.Offset.y, quantization.Offset.z, 0.0f);
+		m_CommandList.SetGraphicsRoot32BitConstants(0, sizeof(ShadowMapData) / 4, &m_ShadowMapData, 0);
+
+		auto vertexBufferView = object->GetPositionBufferView();
+		m_CommandList.IASetVertexBuffers(0, 1, &vertexBufferView);
+		m_CommandList.IASetIndexBuffer(&indexBufferView);
+	}
+
 	void ShadowMapRenderPass::CreateShadowMapPSO()
 	{
 		PipelineStateBuilder pipelineStateBuilder;
@@ -188,6 +208,7 @@ namespace DX12Engine
 		rasterizerDesc.CullMode = D3D12_CULL_MODE_NONE;
 
 		pipelineStateBuilder = pipelineStateBuilder.ConfigureFromDefault()
+			.AddInputLayout(VertexFormat::Full, true)
 			.SetRasterizerState(rasterizerDesc)
 			.SetRenderTargets({ DXGI_FORMAT_R8G8B8A8_UNORM })
 			.SetDepthStencilFormat(DXGI_FORMAT_D32_FLOAT);
@@ -210,5 +231,8 @@ namespace DX12Engine
 		m_RootSignature = ResourceManager::GetInstance().CreateRootSignature(rootSignatureBuilder.Build());
 		pipelineStateBuilder = pipelineStateBuilder.SetRootSignature(m_RootSignature.Get());
 		m_PipelineState = ResourceManager::GetInstance().CreatePipelineState(pipelineStateBuilder.Build());
+
+		pipelineStateBuilder = pipelineStateBuilder.AddInputLayout(VertexFormat::Compact, true);
+		m_CompactPipelineState = ResourceManager::GetInstance().CreatePipelineState(pipelineStateBuilder.Build());
 	}
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "RenderPass.h"
+#include "../../Resources/Mesh.h"
 #include <DirectXMath.h>
 
 namespace DX12Engine
@@ -10,6 +11,8 @@ namespace DX12Engine
 		DirectX::XMMATRIX ModelMatrix;
 		DirectX::XMFLOAT3 LightPos;
 		float FarPlane = 1.0f;
+		DirectX::XMFLOAT4 PositionScale;
+		DirectX::XMFLOAT4 PositionOffset;
 	};
 
 	class Light;
@@ -34,6 +37,7 @@ namespace DX12Engine
 		void RenderShadowMap(RenderTexture* shadowMap, int lightIndex);
 		void RenderShadowCubeMap(RenderTexture* shadowMap, int lightIndex);
 		void CreateShadowMapPSO();
+		void BindObject(RenderComponent* object, const D3D12_INDEX_BUFFER_VIEW& indexBufferView, VertexFormat& boundFormat);
 
 		int m_ShadowMapCount;
 		bool m_IsCubeMap;
@@ -42,6 +46,7 @@ namespace DX12Engine
 
 		Microsoft::WRL::ComPtr<ID3D12RootSignature> m_RootSignature;
 		Microsoft::WRL::ComPtr<ID3D12PipelineState> m_PipelineState;
+		Microsoft::WRL::ComPtr<ID3D12PipelineState> m_CompactPipelineState; // Same shaders, only the input layout differs
 	};
 }
 
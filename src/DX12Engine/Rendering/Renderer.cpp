@@ -42,8 +42,7 @@ namespace DX12Engine
 
 	void Renderer::PresentFrame(RenderTexture* finalRenderTarget)
 	{
-		if (!m_RenderContext->GetUploader().UploadAllPending()) // Upload any pending resources
-			m_QueueManager.GetGraphicsQueue().ResetCommandAllocatorAndList();
+		m_RenderContext->BeginCommandList();
 
 		m_CommandList->SetPipelineState(m_PipelineState.Get());
 		m_CommandList->SetGraphicsRootSignature(m_RootSignature.Get());
@@ -105,8 +104,11 @@ namespace DX12Engine
 
 	void Renderer::UpdateObjectList(std::vector<std::shared_ptr<GameObject>> objects)
 	{
+		const float viewportHeight = static_cast<float>(m_RenderContext->GetWindowSize().y);
 		for (std::shared_ptr<GameObject> obj : objects)
 		{
+			obj->GetComponent<RenderComponent>()->SelectLod(*m_Camera, viewportHeight);
+			obj->GetComponent<RenderComponent>()->RequestTextureDetail(*m_Camera, viewportHeight);
 			obj->GetComponent<RenderComponent>()->UpdateConstantBufferData(m_Camera->GetViewMatrix(), m_Camera->GetProjectionMatrix(), m_Camera->GetPosition());
 		}
 	}
@@ -119,6 +121,12 @@ namespace DX12Engine
 		}
 		RenderTexture* finalRenderTarget = pipeline.RenderPasses.back()->GetRenderTarget(DX12Engine::RenderTargetType::Composite);
 		PresentFrame(finalRenderTarget);
+
+		// PresentFrame waited for the GPU, so streamed mips can be copied and views rewritten, and nothing from this frame
+		// is still using an evicted texture
+		ResourceManager::GetInstance().GetTextureStreamer().Update();
+		m_RenderContext->GetUploader().ProcessUploadQueue();
+		ResourceManager::GetInstance().GetTextureResidency().EndFrame();
 	}
 
 	std::unique_ptr<std::vector<RenderTargetType>> Renderer::GetTargets(std::vector<RenderTargetType> targets)
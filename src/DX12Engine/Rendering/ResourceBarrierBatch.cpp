@@ -0,0 +1,31 @@
+#include "ResourceBarrierBatch.h"
+
+namespace DX12Engine
+{
+	void ResourceBarrierBatch::Transition(ID3D12Resource* resource, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after)
+	{
+		auto it = m_BarrierByResource.find(resource);
+		if (it != m_BarrierByResource.end())
+		{
+			// Nothing is recorded between the two, so the intermediate state is never observed
+			m_Barriers[it->second].Transition.StateAfter = after;
+			return;
+		}
+
+		D3D12_RESOURCE_BARRIER barrier = {};
+		barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+		barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+		barrier.Transition.pResource = resource;
+		barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+		barrier.Transition.StateBefore = before;
+		barrier.Transition.StateAfter = after;
+		m_BarrierByResource[resource] = m_Barriers.size();
+		m_Barriers.push_back(barrier);
+	}
+
+	void ResourceBarrierBatch::Clear()
+	{
+		m_Barriers.clear();
+		m_BarrierByResource.clear();
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <d3d12.h>
+#include <unordered_map>
+#include <vector>
+
+namespace DX12Engine
+{
+	// Collects transitions and records them with a single ResourceBarrier call. A resource transitioned more than once
+	// before the flush gets one barrier from its first state to its last, and none if the two match. Flush accepts any
+	// list with a ResourceBarrier method, so the calls can be counted through a recording shim on the CPU
+	class ResourceBarrierBatch
+	{
+	public:
+		// Transitions all subresources
+		void Transition(ID3D12Resource* resource, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after);
+
+		bool IsEmpty() const { return m_Barriers.empty(); }
+		void Clear();
+
+		template<typename CommandList>
+		void Flush(CommandList* commandList)
+		{
+			// Merged transitions that ended where they started are dropped here rather than when they merge, a later
+			// transition of the same resource still has to find its entry
+			std::vector<D3D12_RESOURCE_BARRIER> barriers;
+			barriers.reserve(m_Barriers.size());
+			for (const D3D12_RESOURCE_BARRIER& barrier : m_Barriers)
+			{
+				if (barrier.Transition.StateBefore != barrier.Transition.StateAfter)
+					barriers.push_back(barrier);
+			}
+			if (!barriers.empty())
+				commandList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+			Clear();
+		}
+
+	private:
+		std::vector<D3D12_RESOURCE_BARRIER> m_Barriers;
+		std::unordered_map<ID3D12Resource*, size_t> m_BarrierByResource;
+	};
+}
@@ -75,6 +75,7 @@ namespace DX12Engine
             D3D12_STATIC_SAMPLER_DESC staticSamplerDesc = {};
             staticSamplerDesc.Filter = filter;
             staticSamplerDesc.MaxAnisotropy = 16;
+            staticSamplerDesc.MaxLOD = D3D12_FLOAT32_MAX;
             staticSamplerDesc.AddressU = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
             staticSamplerDesc.AddressV = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
             staticSamplerDesc.AddressW = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
@@ -0,0 +1,51 @@
+#include "UploadRingAllocator.h"
+
+namespace DX12Engine
+{
+	UploadRingAllocator::UploadRingAllocator(uint64_t capacity)
+		: m_Capacity(capacity), m_Head(0), m_UsedSize(0), m_OpenSize(0)
+	{
+	}
+
+	bool UploadRingAllocator::Allocate(uint64_t size, uint64_t alignment, uint64_t& offset)
+	{
+		if (size == 0 || size > m_Capacity)
+			return false;
+
+		// An empty ring starts over at 0, which keeps large allocations from wrapping needlessly
+		if (m_UsedSize == 0)
+			m_Head = 0;
+
+		// A region that would run past the end starts at 0 instead, the skipped tail counts as used until it retires
+		// together with the allocation
+		uint64_t start = (m_Head + alignment - 1) & ~(alignment - 1);
+		if (start + size > m_Capacity)
+			start = 0;
+		const uint64_t consumed = start >= m_Head ? start + size - m_Head : m_Capacity - m_Head + start + size;
+		if (m_UsedSize + consumed > m_Capacity)
+			return false;
+
+		offset = start;
+		m_Head = start + size;
+		m_UsedSize += consumed;
+		m_OpenSize += consumed;
+		return true;
+	}
+
+	void UploadRingAllocator::Submit(uint64_t fenceValue)
+	{
+		if (m_OpenSize == 0)
+			return;
+		m_Submissions.push_back({ m_OpenSize, fenceValue });
+		m_OpenSize = 0;
+	}
+
+	void UploadRingAllocator::Retire(uint64_t completedFenceValue)
+	{
+		while (!m_Submissions.empty() && m_Submissions.front().FenceValue <= completedFenceValue)
+		{
+			m_UsedSize -= m_Submissions.front().Size;
+			m_Submissions.pop_front();
+		}
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+
+namespace DX12Engine
+{
+	// Offset bookkeeping of a ring buffer that uploads are staged in. Regions are handed out front to back and wrap to the
+	// start, allocations are grouped into submissions tagged with a fence value, and a submission's bytes become
+	// available again once that fence completed. Fences have to be submitted in increasing order. Knows nothing about
+	// D3D12, so the wraparound, alignment and retirement logic can be exercised on the CPU
+	class UploadRingAllocator
+	{
+	public:
+		UploadRingAllocator(uint64_t capacity);
+
+		// Alignment must be a power of two. Returns false if the ring has no room until older submissions retire, or if the
+		// size can never fit
+		bool Allocate(uint64_t size, uint64_t alignment, uint64_t& offset);
+		// Closes the allocations made since the last call, they are reclaimed once fenceValue completed
+		void Submit(uint64_t fenceValue);
+		// Reclaims every submission whose fence value is at most completedFenceValue
+		void Retire(uint64_t completedFenceValue);
+
+		uint64_t GetCapacity() const { return m_Capacity; }
+		// Including padding skipped for alignment and at the wrap
+		uint64_t GetUsedSize() const { return m_UsedSize; }
+		bool HasOpenAllocations() const { return m_OpenSize > 0; }
+
+	private:
+		struct Submission
+		{
+			uint64_t Size;
+			uint64_t FenceValue;
+		};
+
+		uint64_t m_Capacity;
+		uint64_t m_Head; // Where the next allocation starts looking
+		uint64_t m_UsedSize; // Bytes from the oldest live allocation up to the head
+		uint64_t m_OpenSize; // Part of m_UsedSize not submitted yet
+		std::deque<Submission> m_Submissions;
+	};
+}
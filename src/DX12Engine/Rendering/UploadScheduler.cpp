@@ -0,0 +1,68 @@
+#include "UploadScheduler.h"
+#include <chrono>
+
+namespace DX12Engine
+{
+	UploadScheduler::UploadScheduler(uint64_t byteBudget, double millisecondBudget, Clock clock)
+		: m_ByteBudget(byteBudget), m_MillisecondBudget(millisecondBudget), m_Clock(std::move(clock)), m_QueuedCount(0), m_QueuedBytes(0)
+	{
+		if (!m_Clock)
+		{
+			m_Clock = []()
+			{
+				return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+			};
+		}
+	}
+
+	void UploadScheduler::Enqueue(UploadPriority priority, uint64_t bytes, Upload upload)
+	{
+		m_Queues[static_cast<size_t>(priority)].push_back({ bytes, std::move(upload) });
+		m_QueuedCount++;
+		m_QueuedBytes += bytes;
+		m_Statistics.QueuedCount = m_QueuedCount;
+		m_Statistics.QueuedBytes = m_QueuedBytes;
+	}
+
+	void UploadScheduler::RunFrame()
+	{
+		const double start = m_Clock();
+		m_Statistics.UploadedBytes = 0;
+		m_Statistics.UploadedCount = 0;
+
+		bool budgetSpent = false;
+		for (std::deque<Entry>& queue : m_Queues)
+		{
+			while (!queue.empty() && !budgetSpent)
+			{
+				const bool overBytes = m_Statistics.UploadedBytes + queue.front().Bytes > m_ByteBudget;
+				const bool overTime = m_Clock() - start >= m_MillisecondBudget;
+				if (m_Statistics.UploadedCount > 0 && (overBytes || overTime))
+				{
+					// Lower priorities wait too, even if they would fit
+					budgetSpent = true;
+					break;
+				}
+
+				Entry entry = std::move(queue.front());
+				queue.pop_front();
+				m_QueuedCount--;
+				m_QueuedBytes -= entry.Bytes;
+				m_Statistics.UploadedBytes += entry.Bytes;
+				m_Statistics.UploadedCount++;
+				m_Statistics.TotalUploadedBytes += entry.Bytes;
+				m_Statistics.TotalUploadedCount++;
+				m_Statistics.QueuedCount = m_QueuedCount;
+				m_Statistics.QueuedBytes = m_QueuedBytes;
+				entry.Run();
+			}
+		}
+		m_Statistics.Milliseconds = m_Clock() - start;
+	}
+
+	void UploadScheduler::SetBudget(uint64_t byteBudget, double millisecondBudget)
+	{
+		m_ByteBudget = byteBudget;
+		m_MillisecondBudget = millisecondBudget;
+	}
+}
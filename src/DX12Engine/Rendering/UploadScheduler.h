@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+namespace DX12Engine
+{
+	enum class UploadPriority
+	{
+		High, // Visible or close to the camera
+		Low, // Prefetch, only runs once no high priority upload is waiting
+		Count
+	};
+
+	struct UploadQueueStatistics
+	{
+		uint64_t UploadedBytes = 0; // Last frame
+		uint32_t UploadedCount = 0;
+		double Milliseconds = 0.0;
+		uint32_t QueuedCount = 0; // Left for later frames
+		uint64_t QueuedBytes = 0;
+		uint64_t TotalUploadedBytes = 0; // Totals since creation
+		uint64_t TotalUploadedCount = 0;
+	};
+
+	// Spreads queued uploads over frames. Each frame runs them highest priority first, in submission order within a
+	// priority, until the next one would exceed the byte budget or the time budget is spent. The first upload of a frame
+	// always runs, so one larger than the whole budget still makes progress. Knows nothing about D3D12 and reads time
+	// through a replaceable clock, so budget enforcement can be exercised on the CPU with a simulated one
+	class UploadScheduler
+	{
+	public:
+		typedef std::function<double()> Clock; // Milliseconds
+		typedef std::function<void()> Upload;
+
+		UploadScheduler(uint64_t byteBudget, double millisecondBudget, Clock clock = nullptr); // nullptr = steady clock
+
+		void Enqueue(UploadPriority priority, uint64_t bytes, Upload upload);
+		// Runs this frame's share of the queue and records its statistics. An upload that throws is dropped, the
+		// exception propagates
+		void RunFrame();
+
+		void SetBudget(uint64_t byteBudget, double millisecondBudget);
+		bool IsEmpty() const { return m_QueuedCount == 0; }
+		const UploadQueueStatistics& GetStatistics() const { return m_Statistics; }
+
+	private:
+		struct Entry
+		{
+			uint64_t Bytes;
+			Upload Run;
+		};
+
+		uint64_t m_ByteBudget;
+		double m_MillisecondBudget;
+		Clock m_Clock;
+		std::deque<Entry> m_Queues[static_cast<size_t>(UploadPriority::Count)];
+		uint32_t m_QueuedCount;
+		uint64_t m_QueuedBytes;
+		UploadQueueStatistics m_Statistics;
+	};
+}
@@ -0,0 +1,82 @@
+#include "UploadTracker.h"
+#include <algorithm>
+
+namespace DX12Engine
+{
+	void UploadTracker::Track(GPUResource* resource, D3D12_RESOURCE_STATES state)
+	{
+		// A resource recorded twice into the same batch is only finished once
+		uint32_t& references = m_References[resource];
+		if (std::find(m_Open.begin(), m_Open.end(), resource) == m_Open.end())
+		{
+			m_Open.push_back(resource);
+			references++;
+		}
+		m_Transitions.push_back({ resource, state });
+		references++;
+	}
+
+	void UploadTracker::Release(GPUResource* resource)
+	{
+		auto references = m_References.find(resource);
+		if (--references->second == 0)
+			m_References.erase(references);
+	}
+
+	void UploadTracker::Submit(uint64_t fenceValue)
+	{
+		if (m_Open.empty())
+			return;
+		m_Submitted.push_back({ fenceValue, std::move(m_Open) });
+		m_Open.clear();
+	}
+
+	std::vector<GPUResource*> UploadTracker::Retire(uint64_t completedFenceValue)
+	{
+		std::vector<GPUResource*> finished;
+		while (!m_Submitted.empty() && m_Submitted.front().FenceValue <= completedFenceValue)
+		{
+			for (GPUResource* resource : m_Submitted.front().Resources)
+			{
+				Release(resource);
+				finished.push_back(resource);
+			}
+			m_Submitted.pop_front();
+		}
+		return finished;
+	}
+
+	std::vector<UploadTracker::Transition> UploadTracker::TakeTransitions()
+	{
+		std::vector<Transition> transitions = std::move(m_Transitions);
+		m_Transitions.clear();
+		for (const Transition& transition : transitions)
+			Release(transition.Resource);
+		return transitions;
+	}
+
+	void UploadTracker::Untrack(GPUResource* resource)
+	{
+		auto references = m_References.find(resource);
+		if (references == m_References.end())
+			return;
+		m_References.erase(references);
+
+		std::erase(m_Open, resource);
+		for (Batch& batch : m_Submitted)
+			std::erase(batch.Resources, resource);
+		std::erase_if(m_Transitions, [resource](const Transition& transition) { return transition.Resource == resource; });
+	}
+
+	std::vector<GPUResource*> UploadTracker::UntrackAll()
+	{
+		std::vector<GPUResource*> tracked;
+		for (const auto& [resource, references] : m_References)
+			tracked.push_back(resource);
+		m_References.clear();
+		m_Open.clear();
+		m_Submitted.clear();
+		m_Transitions.clear();
+		return tracked;
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <d3d12.h>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace DX12Engine
+{
+	class GPUResource;
+
+	// The resources of upload batches whose copies haven't finished, and the transitions to their usage state the graphics
+	// queue still has to record. Batches are tagged with the copy fence and have to be submitted in increasing order. A
+	// resource destroyed before its batch finished is untracked, so neither the batch nor its transition touch it
+	// afterwards. Never dereferences the resources, so the bookkeeping can be exercised on the CPU
+	class UploadTracker
+	{
+	public:
+		struct Transition
+		{
+			GPUResource* Resource;
+			D3D12_RESOURCE_STATES State;
+		};
+
+		// Adds the resource to the open batch, it transitions to state once the graphics queue picks it up
+		void Track(GPUResource* resource, D3D12_RESOURCE_STATES state);
+		// Closes the open batch, its resources finish once fenceValue completed
+		void Submit(uint64_t fenceValue);
+		// Removes every batch whose fence value is at most completedFenceValue and returns their resources
+		std::vector<GPUResource*> Retire(uint64_t completedFenceValue);
+		// Transitions of everything tracked since the last call, oldest first
+		std::vector<Transition> TakeTransitions();
+		// Drops the resource from every batch and pending transition
+		void Untrack(GPUResource* resource);
+		// Forgets everything and returns the resources that were still tracked
+		std::vector<GPUResource*> UntrackAll();
+
+		// Until the last batch holding the resource retired and its transitions were taken
+		bool IsTracked(GPUResource* resource) const { return m_References.count(resource) > 0; }
+		bool HasOpenBatch() const { return !m_Open.empty(); }
+
+	private:
+		struct Batch
+		{
+			uint64_t FenceValue;
+			std::vector<GPUResource*> Resources;
+		};
+
+		// Drops one reference, the resource is untracked once none are left
+		void Release(GPUResource* resource);
+
+		std::vector<GPUResource*> m_Open;
+		std::deque<Batch> m_Submitted; // Oldest first
+		std::vector<Transition> m_Transitions;
+		std::unordered_map<GPUResource*, uint32_t> m_References; // Batches and pending transitions holding the resource
+	};
+}
@@ -1,4 +1,5 @@
 #include "GPUResource.h"
+#include "../Rendering/UploadTracker.h"
 
 namespace DX12Engine
 {
@@ -32,6 +33,12 @@ namespace DX12Engine
 
 	GPUResource::~GPUResource()
 	{
-		m_Resource->Release();
+		if (m_UploadTracker)
+			m_UploadTracker->Untrack(this);
+		// The GPU may still copy to a placed resource, the allocator releases it with its range once it is done
+		if (m_HeapAllocation.Allocator)
+			m_HeapAllocation.Allocator->Free(m_Resource, m_HeapAllocation);
+		else
+			m_Resource->Release();
 	}
 }
@@ -1,9 +1,12 @@
 #pragma once
 #include "d3dx12.h"
 #include "../Rendering/Heaps/DescriptorHeapHandle.h"
+#include "../Rendering/GPUHeapAllocator.h"
 
 namespace DX12Engine
 {
+	class UploadTracker;
+
 	class GPUResource
 	{
 	public:
@@ -26,6 +29,13 @@ namespace DX12Engine
 
 		D3D12_SHADER_RESOURCE_VIEW_DESC GetSRVDesc() const { return m_SRVDesc; }
 
+		// Placed resources hand themselves and their range to the heap allocator once released
+		void SetHeapAllocation(const GPUHeapAllocation& allocation) { m_HeapAllocation = allocation; }
+		bool IsPlaced() const { return m_HeapAllocation.Allocator != nullptr; }
+
+		// Set by the uploader while the resource is in a batch, a resource destroyed before that finished untracks itself
+		void SetUploadTracker(UploadTracker* tracker) { m_UploadTracker = tracker; }
+
 	protected:
 		ID3D12Resource* m_Resource;
 		D3D12_GPU_VIRTUAL_ADDRESS m_GPUAddress;
@@ -33,6 +43,8 @@ namespace DX12Engine
 		std::unique_ptr<DescriptorHeapHandle> m_Descriptor;
 		D3D12_SHADER_RESOURCE_VIEW_DESC m_SRVDesc;
 		bool m_IsReady;
+		GPUHeapAllocation m_HeapAllocation;
+		UploadTracker* m_UploadTracker = nullptr;
 	};
 }
 
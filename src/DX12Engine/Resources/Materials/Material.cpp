@@ -5,7 +5,7 @@ namespace DX12Engine
 {
 	Material::Material()
 	{
-		m_ConstantBuffer = ResourceManager::GetInstance().CreateConstantBuffer(sizeof(MaterialData));
+		m_ConstantBuffer = ResourceManager::GetInstance().CreateConstantBuffer(sizeof(PBRMaterialData));
 	}
 
 	Material::~Material()
@@ -17,8 +17,17 @@ namespace DX12Engine
 		commandList->SetGraphicsRootConstantBufferView((*startIndex)++, GetCBVAddress());
 	}
 
-	void Material::UpdateConstantBufferData(MaterialData materialData)
+	void Material::RequestScreenSize(float pixels)
 	{
-		m_ConstantBuffer->Update(&materialData, sizeof(materialData));
+		for (TextureType type : { TextureType::Albedo, TextureType::Normal, TextureType::Metallic, TextureType::Roughness, TextureType::AOMap, TextureType::ORM })
+		{
+			if (Texture* texture = GetTexture(type))
+				texture->RequestScreenSize(pixels);
+		}
+	}
+
+	void Material::UpdateConstantBufferData(void* materialData, UINT size)
+	{
+		m_ConstantBuffer->Update(materialData, size);
 	}
 }
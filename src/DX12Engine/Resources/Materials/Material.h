@@ -24,6 +24,9 @@ namespace DX12Engine
 		virtual bool HasTexture(TextureType type) = 0;
 
 		virtual void Bind(ID3D12GraphicsCommandList* commandList, int* startIndex);
+		// Every object drawing with the material reports its on-screen size in pixels once per frame, the textures stream
+		// in the mips that size needs
+		void RequestScreenSize(float pixels);
 
 		virtual void SetAllTextures(std::unordered_map<TextureType, std::shared_ptr<Texture>> textures) = 0;
 
@@ -31,7 +34,8 @@ namespace DX12Engine
 		RootSignatureBuilder RootSignatureBuilder;
 
 	protected:
-		void UpdateConstantBufferData(MaterialData materialData);
+		// Takes the derived data, passing it as MaterialData would slice off the PBR fields
+		void UpdateConstantBufferData(void* materialData, UINT size);
 
 		std::unique_ptr<ConstantBuffer> m_ConstantBuffer;
 	};
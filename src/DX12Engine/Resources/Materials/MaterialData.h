@@ -6,7 +6,7 @@ namespace DX12Engine
 	struct MaterialData
 	{
 		DirectX::XMFLOAT4 BaseColor;
-		int HasTexture = 0;
+		int HasTexture = 0; // PBR materials set bit 1 << TextureType for every bound map
 	};
 
 	struct BasicMaterialData : MaterialData
@@ -20,7 +20,7 @@ namespace DX12Engine
 		float Metallic = 0.0f;
 		float Roughness = 0.1f;
 		float AO = 0.5f;
-		DirectX::XMFLOAT3 Emissive = { 0.0f, 0.0f, 0.0f };
 		float Padding;
+		DirectX::XMFLOAT3 Emissive = { 0.0f, 0.0f, 0.0f }; // Starts a new register like in the shader cbuffer
 	};
 }
@@ -6,6 +6,7 @@ namespace DX12Engine
 	PBRMaterial::PBRMaterial()
 		: Material()
 	{
+		OnTexturesChanged();
 	}
 
 	PBRMaterial::~PBRMaterial()
@@ -20,12 +21,8 @@ namespace DX12Engine
 			return m_AlbedoMap.get();
 		case TextureType::Normal:
 			return m_NormalMap.get();
-		case TextureType::Metallic:
-			return m_MetallicMap.get();
-		case TextureType::Roughness:
-			return m_RoughnessMap.get();
-		case TextureType::AOMap:
-			return m_AOMap.get();
+		case TextureType::ORM:
+			return m_ORMMap.get();
 		default:
 			return nullptr;
 		}
@@ -35,29 +32,48 @@ namespace DX12Engine
 	{
 		switch (type)
 		{
-		case TextureType::Albedo:
-			return m_AlbedoMap != nullptr;
-		case TextureType::Normal:
-			return m_NormalMap != nullptr;
 		case TextureType::Metallic:
-			return m_MetallicMap != nullptr;
 		case TextureType::Roughness:
-			return m_RoughnessMap != nullptr;
 		case TextureType::AOMap:
-			return m_AOMap != nullptr;
+			return m_ORMMap && (m_ORMChannels & (1 << type));
 		default:
-			return false;
+			return GetTexture(type) != nullptr;
 		}
 	}
+
 	void PBRMaterial::Bind(ID3D12GraphicsCommandList* commandList, int* startIndex)
 	{
 		Material::Bind(commandList, startIndex);
-		if (HasTexture(TextureType::Albedo))
-			commandList->SetGraphicsRootDescriptorTable((*startIndex)++, m_AlbedoMap->GetGPUHandle());
+		if (!m_DescriptorTable.IsValid())
+		{
+			m_DescriptorTable = ResourceManager::GetInstance().CreateSRVTable({ m_AlbedoMap.get(), m_NormalMap.get(), m_ORMMap.get() });
+			m_DescriptorTableViewVersion = GetTextureViewVersion();
+			m_DescriptorTableDirty = false;
+		}
+		else if (m_DescriptorTableDirty || m_DescriptorTableViewVersion != GetTextureViewVersion())
+		{
+			// The render pass heap never frees blocks, so the table is reused. Maps and views only change between frames,
+			// so no work in flight reads it
+			ResourceManager::GetInstance().WriteSRVTable(m_DescriptorTable, { m_AlbedoMap.get(), m_NormalMap.get(), m_ORMMap.get() });
+			m_DescriptorTableViewVersion = GetTextureViewVersion();
+			m_DescriptorTableDirty = false;
+		}
+		commandList->SetGraphicsRootDescriptorTable((*startIndex)++, m_DescriptorTable.GetGPUHandle());
+
+		for (Texture* texture : { m_AlbedoMap.get(), m_NormalMap.get(), m_ORMMap.get() })
+		{
+			if (texture)
+				texture->MarkUsed();
+		}
 	}
 
 	void PBRMaterial::SetAllTextures(std::unordered_map<TextureType, std::shared_ptr<Texture>> textures)
 	{
+		// The loaders put the ORM map in the slots of the channels it was packed from, without any it holds all three
+		int ormChannels = 0;
+		for (TextureType type : { TextureType::AOMap, TextureType::Roughness, TextureType::Metallic })
+			ormChannels |= textures.count(type) ? 1 << type : 0;
+
 		for (auto& texture : textures)
 		{
 			switch (texture.first)
@@ -68,46 +84,58 @@ namespace DX12Engine
 			case TextureType::Normal:
 				SetNormalMap(texture.second);
 				break;
-			case TextureType::Metallic:
-				SetMetallicMap(texture.second);
-				break;
-			case TextureType::Roughness:
-				SetRoughnessMap(texture.second);
-				break;
-			case TextureType::AOMap:
-				SetAOMap(texture.second);
+			case TextureType::ORM:
+				SetORMMap(texture.second, ormChannels ? ormChannels : ORMChannels);
 				break;
 			}
 		}
 	}
 
+	void PBRMaterial::OnTexturesChanged()
+	{
+		// The shader picks the constants for every map that is missing from this mask
+		m_MaterialData.HasTexture = 0;
+		for (TextureType type : { TextureType::Albedo, TextureType::Normal, TextureType::Metallic, TextureType::Roughness, TextureType::AOMap, TextureType::ORM })
+			m_MaterialData.HasTexture |= HasTexture(type) ? 1 << type : 0;
+		UpdateConstantBufferData(&m_MaterialData, sizeof(m_MaterialData));
+		m_DescriptorTableDirty = true;
+	}
+
+	UINT PBRMaterial::GetTextureViewVersion() const
+	{
+		UINT version = 0;
+		for (Texture* texture : { m_AlbedoMap.get(), m_NormalMap.get(), m_ORMMap.get() })
+			version += texture ? texture->GetViewVersion() : 0;
+		return version;
+	}
+
 	void PBRMaterial::SetAlbedo(DirectX::XMFLOAT3 albedo)
 	{
 		m_MaterialData.Albedo = albedo;
-		UpdateConstantBufferData(m_MaterialData);
+		UpdateConstantBufferData(&m_MaterialData, sizeof(m_MaterialData));
 	}
 
 	void PBRMaterial::SetMetallic(float metallic)
 	{
 		m_MaterialData.Metallic = metallic;
-		UpdateConstantBufferData(m_MaterialData);
+		UpdateConstantBufferData(&m_MaterialData, sizeof(m_MaterialData));
 	}
 
 	void PBRMaterial::SetRoughness(float roughness)
 	{
 		m_MaterialData.Roughness = roughness;
-		UpdateConstantBufferData(m_MaterialData);
+		UpdateConstantBufferData(&m_MaterialData, sizeof(m_MaterialData));
 	}
 
 	void PBRMaterial::SetAO(float ao)
 	{
 		m_MaterialData.AO = ao;
-		UpdateConstantBufferData(m_MaterialData);
+		UpdateConstantBufferData(&m_MaterialData, sizeof(m_MaterialData));
 	}
 
 	void PBRMaterial::SetEmissive(DirectX::XMFLOAT3 emissive)
 	{
 		m_MaterialData.Emissive = emissive;
-		UpdateConstantBufferData(m_MaterialData);
+		UpdateConstantBufferData(&m_MaterialData, sizeof(m_MaterialData));
 	}
 }
@@ -17,11 +17,12 @@ namespace DX12Engine
 
 		virtual void SetAllTextures(std::unordered_map<TextureType, std::shared_ptr<Texture>> textures) override;
 
-		void SetAlbedoMap(std::shared_ptr<Texture> albedoMap) { m_AlbedoMap = albedoMap; }
-		void SetNormalMap(std::shared_ptr<Texture> normalMap) { m_NormalMap = normalMap; }
-		void SetMetallicMap(std::shared_ptr<Texture> metallicMap) { m_MetallicMap = metallicMap; }
-		void SetRoughnessMap(std::shared_ptr<Texture> roughnessMap) { m_RoughnessMap = roughnessMap; }
-		void SetAOMap(std::shared_ptr<Texture> aoMap) { m_AOMap = aoMap; }
+		// Missing maps fall back to the constants below. Separate metallic, roughness and AO maps are not bound, they are
+		// packed into the ORM map at import. Channels the ORM map was packed without (bits 1 << TextureType of AOMap,
+		// Roughness and Metallic) fall back to the constants too
+		void SetAlbedoMap(std::shared_ptr<Texture> albedoMap) { m_AlbedoMap = albedoMap; OnTexturesChanged(); }
+		void SetNormalMap(std::shared_ptr<Texture> normalMap) { m_NormalMap = normalMap; OnTexturesChanged(); }
+		void SetORMMap(std::shared_ptr<Texture> ormMap, int channels = ORMChannels) { m_ORMMap = ormMap; m_ORMChannels = channels; OnTexturesChanged(); }
 
 		void SetAlbedo(DirectX::XMFLOAT3 albedo);
 		void SetMetallic(float metallic);
@@ -30,12 +31,22 @@ namespace DX12Engine
 		void SetEmissive(DirectX::XMFLOAT3 emissive);
 
 	private:
+		static constexpr int ORMChannels = (1 << TextureType::AOMap) | (1 << TextureType::Roughness) | (1 << TextureType::Metallic);
+
+		void OnTexturesChanged();
+		// Sum of the maps' view versions, which only grow, so any streamed mip changes it
+		UINT GetTextureViewVersion() const;
+
 		PBRMaterialData m_MaterialData;
 		std::shared_ptr<Texture> m_AlbedoMap;
 		std::shared_ptr<Texture> m_NormalMap;
-		std::shared_ptr<Texture> m_MetallicMap;
-		std::shared_ptr<Texture> m_RoughnessMap;
-		std::shared_ptr<Texture> m_AOMap;
+		std::shared_ptr<Texture> m_ORMMap;
+		int m_ORMChannels = ORMChannels;
+		// Albedo, normal and ORM views next to each other for the geometry pass table. Allocated on the first bind and
+		// rewritten in place on the next bind after a map or a map's view changed
+		DescriptorHeapHandle m_DescriptorTable;
+		bool m_DescriptorTableDirty = true;
+		UINT m_DescriptorTableViewVersion = 0;
 	};
 }
 
@@ -1,27 +1,130 @@
 #pragma once
 #include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <DirectXPackedVector.h>
 #include <vector>
+#include <cstring>
 #include <wrl.h>
 
 namespace DX12Engine
 {
+    // 0xFFFF is left out of the 16-bit range since it doubles as the strip cut value
+    inline bool FitsShortIndices(size_t vertexCount) { return vertexCount <= 0xFFFF; }
+
     struct Vertex 
     {
         DirectX::XMFLOAT3 Position;
         DirectX::XMFLOAT3 Normal;
         DirectX::XMFLOAT2 TexCoord;
-        DirectX::XMFLOAT3 Tangent;
+        DirectX::XMFLOAT4 Tangent; // w holds the bitangent handedness
+    };
+
+    enum class VertexFormat
+    {
+        Full,
+        Compact
+    };
+
+    // 20 byte vertex: position quantized to the mesh bounds (w holds the tangent handedness as 0 or 1), octahedral encoded
+    // normal and tangent, half precision UVs
+    struct CompactVertex
+    {
+        DirectX::PackedVector::XMUSHORTN4 Position;
+        DirectX::PackedVector::XMSHORTN2 Normal;
+        DirectX::PackedVector::XMSHORTN2 Tangent;
+        DirectX::PackedVector::XMHALF2 TexCoord;
+    };
+
+    // Vertices are uploaded as two streams: positions alone in slot 0 so depth-only passes fetch the minimum, and the
+    // remaining attributes in slot 1. Position comes first in both vertex structs, so splitting is a byte split
+    inline UINT GetVertexStride(VertexFormat format) { return format == VertexFormat::Compact ? sizeof(CompactVertex) : sizeof(Vertex); }
+    inline UINT GetPositionStride(VertexFormat format) { return format == VertexFormat::Compact ? sizeof(CompactVertex::Position) : sizeof(Vertex::Position); }
+    inline UINT GetAttributeStride(VertexFormat format) { return GetVertexStride(format) - GetPositionStride(format); }
+
+    inline void SplitVertexStreams(const void* vertices, size_t vertexCount, VertexFormat format, uint8_t* positions, uint8_t* attributes)
+    {
+        const UINT vertexStride = GetVertexStride(format);
+        const UINT positionStride = GetPositionStride(format);
+        const UINT attributeStride = vertexStride - positionStride;
+        const uint8_t* source = static_cast<const uint8_t*>(vertices);
+        for (size_t i = 0; i < vertexCount; i++, source += vertexStride)
+        {
+            memcpy(positions + i * positionStride, source, positionStride);
+            memcpy(attributes + i * attributeStride, source + positionStride, attributeStride);
+        }
+    }
+
+    // Object space position = quantized position * Scale + Offset
+    struct VertexQuantization
+    {
+        DirectX::XMFLOAT3 Scale = { 1.0f, 1.0f, 1.0f };
+        DirectX::XMFLOAT3 Offset = { 0.0f, 0.0f, 0.0f };
+    };
+
+    // Index range of one level of detail. All LODs share the vertex buffer and are stored back to back in the index buffer
+    struct MeshLod
+    {
+        UINT IndexOffset;
+        UINT IndexCount;
+        float Error; // Object space distance from LOD 0 (accumulated RMS quadric error)
+    };
+
+    // Index range drawn with one material. Every LOD stores one range per submesh, see Mesh::Submeshes
+    struct Submesh
+    {
+        UINT IndexOffset;
+        UINT IndexCount;
+        UINT MaterialSlot;
+        UINT MeshletOffset; // Meshlets of the range, LOD 0 only
+        UINT MeshletCount;
+    };
+
+    // Run of consecutive LOD 0 triangles referencing at most MESHLET_MAX_VERTICES vertices, the unit of CPU cluster culling.
+    // Bounds are in object space. The normal cone faces away from a viewer when
+    // dot(Center - viewer, ConeAxis) >= ConeCutoff * length(Center - viewer) + Radius, a cutoff of 1 disables the test
+    struct Meshlet
+    {
+        UINT IndexOffset;
+        UINT IndexCount;
+        UINT VertexCount;
+        float Radius;
+        DirectX::XMFLOAT3 Center;
+        float ConeCutoff;
+        DirectX::XMFLOAT3 ConeAxis;
+        float Padding;
     };
 
     struct Mesh 
     {
         std::vector<Vertex> Vertices;
         std::vector<UINT> Indices;
+        DirectX::BoundingBox Bounds;
+        std::vector<MeshLod> Lods; // LOD 0 is the full mesh, empty when no chain was generated
+        std::vector<Meshlet> Meshlets; // Partition of LOD 0, empty when clusters were not built
+        // GetSubmeshCount() ranges per LOD, LOD-major. Triangles never cross submeshes, every processing step works per range
+        std::vector<Submesh> Submeshes;
+
+        // Filled alongside Vertices when the mesh is imported with the compact layout
+        VertexFormat Format = VertexFormat::Full;
+        std::vector<CompactVertex> CompactVertices;
+        VertexQuantization Quantization;
+
+        const void* GetVertexData() const { return Format == VertexFormat::Compact ? static_cast<const void*>(CompactVertices.data()) : static_cast<const void*>(Vertices.data()); }
+
+        UINT GetSubmeshCount() const { return static_cast<UINT>(Lods.empty() ? Submeshes.size() : Submeshes.size() / Lods.size()); }
+        const Submesh* GetSubmeshes(UINT lod) const { return Submeshes.data() + static_cast<size_t>(lod) * GetSubmeshCount(); }
+
+        // Indices are always processed as 32-bit and narrowed when they are uploaded or cooked
+        bool UsesShortIndices() const { return FitsShortIndices(Vertices.size()); }
 
 		void Reset()
 		{
 			Vertices.clear();
 			Indices.clear();
+			Lods.clear();
+			Meshlets.clear();
+			Submeshes.clear();
+			CompactVertices.clear();
 		}
     };
 }
@@ -0,0 +1,82 @@
+#include "MeshAsset.h"
+#include "ResourceManager.h"
+
+namespace DX12Engine
+{
+	MeshAsset::MeshAsset(const Mesh& mesh)
+		: m_VertexFormat(mesh.Format), m_Quantization(mesh.Quantization), m_Bounds(mesh.Bounds), m_SubmeshCount(0), m_ClusterIndexCount(0)
+	{
+		const UINT vertexCount = static_cast<UINT>(mesh.Vertices.size());
+		std::vector<uint8_t> positions(static_cast<size_t>(GetPositionStride(mesh.Format)) * vertexCount);
+		std::vector<uint8_t> attributes(static_cast<size_t>(GetAttributeStride(mesh.Format)) * vertexCount);
+		SplitVertexStreams(mesh.GetVertexData(), vertexCount, mesh.Format, positions.data(), attributes.data());
+		m_PositionBuffer = ResourceManager::GetInstance().CreateVertexBuffer(positions.data(), vertexCount, GetPositionStride(mesh.Format));
+		m_AttributeBuffer = ResourceManager::GetInstance().CreateVertexBuffer(attributes.data(), vertexCount, GetAttributeStride(mesh.Format));
+		m_IndexBuffer = ResourceManager::GetInstance().CreateIndexBuffer(mesh.Indices);
+		m_IndexFormat = m_IndexBuffer->GetIndexBufferView().Format;
+
+		SetLods(mesh.Lods.data(), mesh.Lods.size(), static_cast<UINT>(mesh.Indices.size()));
+		if (m_IndexFormat == DXGI_FORMAT_R16_UINT)
+		{
+			std::vector<uint16_t> shortIndices(mesh.Indices.size());
+			for (size_t i = 0; i < shortIndices.size(); i++)
+				shortIndices[i] = static_cast<uint16_t>(mesh.Indices[i]);
+			SetMeshlets(mesh.Meshlets.data(), mesh.Meshlets.size(), shortIndices.data());
+		}
+		else
+		{
+			SetMeshlets(mesh.Meshlets.data(), mesh.Meshlets.size(), mesh.Indices.data());
+		}
+		SetSubmeshes(mesh.Submeshes.data(), mesh.Submeshes.size());
+	}
+
+	MeshAsset::MeshAsset(const CookedMesh& mesh)
+		: m_VertexFormat(mesh.GetVertexFormat()), m_Quantization(mesh.GetQuantization()), m_Bounds(mesh.GetBounds()), m_SubmeshCount(0), m_ClusterIndexCount(0)
+	{
+		// Uploaded straight from the mapped cache file
+		m_PositionBuffer = ResourceManager::GetInstance().CreateVertexBuffer(mesh.GetPositionData(), mesh.GetVertexCount(), GetPositionStride(m_VertexFormat));
+		m_AttributeBuffer = ResourceManager::GetInstance().CreateVertexBuffer(mesh.GetAttributeData(), mesh.GetVertexCount(), GetAttributeStride(m_VertexFormat));
+		m_IndexFormat = mesh.GetIndexStride() == sizeof(uint16_t) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+		m_IndexBuffer = ResourceManager::GetInstance().CreateIndexBuffer(mesh.GetIndexData(), mesh.GetIndexCount(), m_IndexFormat);
+
+		SetLods(mesh.GetLods(), mesh.GetLodCount(), mesh.GetIndexCount());
+		SetMeshlets(mesh.GetMeshlets(), mesh.GetMeshletCount(), mesh.GetIndexData());
+		SetSubmeshes(mesh.GetSubmeshes(), mesh.GetSubmeshCount());
+	}
+
+	void MeshAsset::SetLods(const MeshLod* lods, size_t lodCount, UINT indexCount)
+	{
+		if (lodCount > 0)
+			m_Lods.assign(lods, lods + lodCount);
+		else
+			m_Lods = { { 0, indexCount, 0.0f } };
+	}
+
+	void MeshAsset::SetMeshlets(const Meshlet* meshlets, size_t meshletCount, const void* indices)
+	{
+		m_Meshlets.assign(meshlets, meshlets + meshletCount);
+		if (m_Meshlets.empty())
+			return;
+
+		// The meshlets partition LOD 0 in order, so the last one ends where LOD 0 does
+		m_ClusterIndexCount = m_Meshlets.back().IndexOffset + m_Meshlets.back().IndexCount;
+		const size_t clusterIndexSize = static_cast<size_t>(IndexBuffer::GetIndexStride(m_IndexFormat)) * m_ClusterIndexCount;
+		const uint8_t* source = static_cast<const uint8_t*>(indices);
+		m_ClusterSourceIndices.assign(source, source + clusterIndexSize);
+	}
+
+	void MeshAsset::SetSubmeshes(const Submesh* submeshes, size_t submeshCount)
+	{
+		// Meshes without submeshes draw every LOD as one range with material slot 0. Must run after SetLods and SetMeshlets
+		if (submeshCount > 0)
+		{
+			m_Submeshes.assign(submeshes, submeshes + submeshCount);
+		}
+		else
+		{
+			for (const MeshLod& lod : m_Lods)
+				m_Submeshes.push_back({ lod.IndexOffset, lod.IndexCount, 0, 0, static_cast<UINT>(m_Meshlets.size()) });
+		}
+		m_SubmeshCount = static_cast<UINT>(m_Submeshes.size() / m_Lods.size());
+	}
+}
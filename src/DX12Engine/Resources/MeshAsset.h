@@ -0,0 +1,62 @@
+#pragma once
+#include "Mesh.h"
+#include "../IO/MeshCache.h"
+#include "../Rendering/Buffers/VertexBuffer.h"
+#include "../Rendering/Buffers/IndexBuffer.h"
+#include <vector>
+#include <memory>
+
+namespace DX12Engine
+{
+	// GPU buffers and draw metadata of one imported mesh, shared by every RenderComponent that draws it. The vertex and
+	// index data is uploaded by the constructor and not kept on the CPU, only LOD 0 indices stay for cluster culling
+	class MeshAsset
+	{
+	public:
+		MeshAsset(const Mesh& mesh);
+		MeshAsset(const CookedMesh& mesh);
+
+		MeshAsset(const MeshAsset&) = delete;
+		MeshAsset& operator=(const MeshAsset&) = delete;
+
+		// Slot 0 holds positions only, slot 1 the remaining attributes
+		D3D12_VERTEX_BUFFER_VIEW GetPositionBufferView() const { return m_PositionBuffer->GetVertexBufferView(); }
+		D3D12_VERTEX_BUFFER_VIEW GetAttributeBufferView() const { return m_AttributeBuffer->GetVertexBufferView(); }
+		D3D12_INDEX_BUFFER_VIEW GetIndexBufferView() const { return m_IndexBuffer->GetIndexBufferView(); }
+		VertexFormat GetVertexFormat() const { return m_VertexFormat; }
+		const VertexQuantization& GetQuantization() const { return m_Quantization; }
+		const DirectX::BoundingBox& GetBounds() const { return m_Bounds; }
+
+		// Always at least one LOD, meshes without a chain draw the whole index buffer
+		const std::vector<MeshLod>& GetLods() const { return m_Lods; }
+		// GetSubmeshCount() ranges per LOD, LOD-major like Mesh::Submeshes. Always at least one per LOD
+		const Submesh* GetSubmeshes(UINT lod) const { return m_Submeshes.data() + static_cast<size_t>(lod) * m_SubmeshCount; }
+		UINT GetSubmeshCount() const { return m_SubmeshCount; }
+
+		// Meshlets of LOD 0 with a CPU copy of its indices in the index buffer format
+		const std::vector<Meshlet>& GetMeshlets() const { return m_Meshlets; }
+		const uint8_t* GetClusterSourceIndices() const { return m_ClusterSourceIndices.data(); }
+		UINT GetClusterIndexCount() const { return m_ClusterIndexCount; }
+		DXGI_FORMAT GetIndexFormat() const { return m_IndexFormat; }
+
+	private:
+		void SetLods(const MeshLod* lods, size_t lodCount, UINT indexCount);
+		void SetMeshlets(const Meshlet* meshlets, size_t meshletCount, const void* indices);
+		void SetSubmeshes(const Submesh* submeshes, size_t submeshCount);
+
+		std::unique_ptr<VertexBuffer> m_PositionBuffer;
+		std::unique_ptr<VertexBuffer> m_AttributeBuffer;
+		std::unique_ptr<IndexBuffer> m_IndexBuffer;
+		VertexFormat m_VertexFormat;
+		VertexQuantization m_Quantization;
+		DirectX::BoundingBox m_Bounds;
+		DXGI_FORMAT m_IndexFormat;
+
+		std::vector<MeshLod> m_Lods;
+		std::vector<Submesh> m_Submeshes;
+		UINT m_SubmeshCount;
+		std::vector<Meshlet> m_Meshlets;
+		std::vector<uint8_t> m_ClusterSourceIndices;
+		UINT m_ClusterIndexCount;
+	};
+}
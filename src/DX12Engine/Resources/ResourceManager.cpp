@@ -3,6 +3,8 @@
 #include "../Utils/EngineUtils.h"
 #include "../Utils/Constants.h"
 #include "UploadResourceWrapper.h"
+#include <filesystem>
+#include <stdexcept>
 
 namespace DX12Engine
 {
@@ -18,6 +20,7 @@ namespace DX12Engine
 		m_Shaders.insert({ "ShadowCubeMap_VS", std::make_unique<Shader>(GetShaderPath("ShadowCubeMap_VS.hlsl"), "vertex") });
 		m_Shaders.insert({ "ShadowCubeMap_PS", std::make_unique<Shader>(GetShaderPath("ShadowCubeMap_PS.hlsl"), "pixel") });
 		m_Shaders.insert({ "Geometry_VS", std::make_unique<Shader>(GetShaderPath("Geometry_VS.hlsl"), "vertex") });
+		m_Shaders.insert({ "Geometry_VS_Compact", std::make_unique<Shader>(GetShaderPath("Geometry_VS.hlsl"), "vertex", std::vector<std::wstring>{ L"COMPACT_VERTEX" }) });
 		m_Shaders.insert({ "Geometry_PS", std::make_unique<Shader>(GetShaderPath("Geometry_PS.hlsl"), "pixel") });
 		m_Shaders.insert({ "RenderTriangle_VS", std::make_unique<Shader>(GetShaderPath("RenderTriangle_VS.hlsl"), "vertex") });
 		m_Shaders.insert({ "PBRLightingDeferred_PS", std::make_unique<Shader>(GetShaderPath("PBRLightingDeferred_PS.hlsl"), "pixel") });
@@ -27,6 +30,9 @@ namespace DX12Engine
 
 	ResourceManager::~ResourceManager()
 	{
+		// Placed resources outliving the manager are freed right away from here on
+		if (m_HeapAllocator)
+			m_HeapAllocator->Shutdown();
 	}
 
 	ResourceManager& ResourceManager::GetInstance()
@@ -49,44 +55,29 @@ namespace DX12Engine
 		m_GPUUploader = &(context.GetUploader());
 		m_PipelineStateCache = std::make_unique<PipelineStateCache>(m_Device.Get());
 		m_RootSignatureCache = std::make_unique<RootSignatureCache>(m_Device.Get());
+		m_HeapAllocator = std::make_shared<GPUHeapAllocator>(m_Device.Get(), GPU_HEAP_SIZE, context.GetQueueManager().GetGraphicsQueue(), *m_GPUUploader);
+		m_TextureResidency = std::make_unique<TextureResidencyManager>(std::make_unique<D3D12TextureResidencyAllocator>(m_Device.Get()), TEXTURE_RESIDENCY_BUDGET);
+		m_TextureStreamer = std::make_unique<TextureStreamer>(*m_GPUUploader);
 	}
 
-	std::unique_ptr<VertexBuffer> ResourceManager::CreateVertexBuffer(const std::vector<Vertex>& vertices)
+	std::unique_ptr<VertexBuffer> ResourceManager::CreateVertexBuffer(const void* vertices, UINT vertexCount, UINT vertexStride)
 	{
-		const UINT vertexBufferSize = sizeof(Vertex) * vertices.size();
+		const UINT vertexBufferSize = vertexStride * vertexCount;
 
-		ID3D12Resource* vertexBufferResource = nullptr;
-		auto mainHeapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+		GPUHeapAllocation allocation;
 		auto mainResourceDesc = CD3DX12_RESOURCE_DESC::Buffer(vertexBufferSize);
-		EngineUtils::ThrowIfFailed(m_Device->CreateCommittedResource(
-			&mainHeapProps,
-			D3D12_HEAP_FLAG_NONE,
-			&mainResourceDesc,
-			D3D12_RESOURCE_STATE_COPY_DEST,
-			nullptr,
-			IID_PPV_ARGS(&vertexBufferResource)));
+		ID3D12Resource* vertexBufferResource = m_HeapAllocator->CreateResource(mainResourceDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, allocation);
 
-		ID3D12Resource* uploadResource = nullptr;
-		auto uploadHeapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-		auto uploadResourceDesc = CD3DX12_RESOURCE_DESC::Buffer(vertexBufferSize);
-		EngineUtils::ThrowIfFailed(m_Device->CreateCommittedResource(
-			&uploadHeapProps,
-			D3D12_HEAP_FLAG_NONE,
-			&uploadResourceDesc,
-			D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER,
-			nullptr,
-			IID_PPV_ARGS(&uploadResource)));
-
-		auto vertexBuffer = std::make_unique<VertexBuffer>(vertexBufferResource, D3D12_RESOURCE_STATE_COPY_DEST, sizeof(Vertex), vertexBufferSize);
+		auto vertexBuffer = std::make_unique<VertexBuffer>(vertexBufferResource, D3D12_RESOURCE_STATE_COPY_DEST, vertexStride, vertexBufferSize);
+		vertexBuffer->SetHeapAllocation(allocation);
 
 		D3D12_SUBRESOURCE_DATA vertexData = {};
-		vertexData.pData = &vertices[0];
+		vertexData.pData = vertices;
 		vertexData.RowPitch = vertexBufferSize;
 		vertexData.SlicePitch = vertexData.RowPitch;
 
 		UploadResourceWrapper uploadResourceWrapper;
 		uploadResourceWrapper.GPUResource = vertexBuffer.get();
-		uploadResourceWrapper.UploadResource = uploadResource;
 		uploadResourceWrapper.UploadState = D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER;
 		uploadResourceWrapper.Data = vertexData;
 
@@ -95,42 +86,39 @@ namespace DX12Engine
 		return vertexBuffer;
 	}
 
-	std::unique_ptr<IndexBuffer> ResourceManager::CreateIndexBuffer(const std::vector<UINT>& indices)
+	std::unique_ptr<IndexBuffer> ResourceManager::CreateIndexBuffer(const UINT* indices, UINT indexCount)
 	{
-		const UINT indexBufferSize = sizeof(UINT) * indices.size();
+		UINT maxIndex = 0;
+		for (UINT i = 0; i < indexCount; i++)
+			maxIndex = (std::max)(maxIndex, indices[i]);
+		if (!FitsShortIndices(static_cast<size_t>(maxIndex) + 1))
+			return CreateIndexBuffer(indices, indexCount, DXGI_FORMAT_R32_UINT);
+
+		// The data is copied into the upload heap before this returns, so a temporary narrowed copy is enough
+		std::vector<uint16_t> shortIndices(indexCount);
+		for (UINT i = 0; i < indexCount; i++)
+			shortIndices[i] = static_cast<uint16_t>(indices[i]);
+		return CreateIndexBuffer(shortIndices.data(), indexCount);
+	}
 
-		ID3D12Resource* indexBufferResource = nullptr;
-		auto mainHeapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-		auto mainResourceDesc = CD3DX12_RESOURCE_DESC::Buffer(indexBufferSize);
-		EngineUtils::ThrowIfFailed(m_Device->CreateCommittedResource(
-			&mainHeapProps,
-			D3D12_HEAP_FLAG_NONE,
-			&mainResourceDesc,
-			D3D12_RESOURCE_STATE_COPY_DEST,
-			nullptr,
-			IID_PPV_ARGS(&indexBufferResource)));
+	std::unique_ptr<IndexBuffer> ResourceManager::CreateIndexBuffer(const void* indices, UINT indexCount, DXGI_FORMAT format)
+	{
+		const UINT indexBufferSize = IndexBuffer::GetIndexStride(format) * indexCount;
 
-		ID3D12Resource* uploadResource = nullptr;
-		auto uploadHeapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-		auto uploadResourceDesc = CD3DX12_RESOURCE_DESC::Buffer(indexBufferSize);
-		EngineUtils::ThrowIfFailed(m_Device->CreateCommittedResource(
-			&uploadHeapProps,
-			D3D12_HEAP_FLAG_NONE,
-			&uploadResourceDesc,
-			D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER,
-			nullptr,
-			IID_PPV_ARGS(&uploadResource)));
+		GPUHeapAllocation allocation;
+		auto mainResourceDesc = CD3DX12_RESOURCE_DESC::Buffer(indexBufferSize);
+		ID3D12Resource* indexBufferResource = m_HeapAllocator->CreateResource(mainResourceDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, allocation);
 
-		auto indexBuffer = std::make_unique<IndexBuffer>(indexBufferResource, D3D12_RESOURCE_STATE_COPY_DEST, DXGI_FORMAT_R32_UINT, indexBufferSize);
+		auto indexBuffer = std::make_unique<IndexBuffer>(indexBufferResource, D3D12_RESOURCE_STATE_COPY_DEST, format, indexCount);
+		indexBuffer->SetHeapAllocation(allocation);
 
 		D3D12_SUBRESOURCE_DATA indexData = {};
-		indexData.pData = &indices[0];
+		indexData.pData = indices;
 		indexData.RowPitch = indexBufferSize;
 		indexData.SlicePitch = indexData.RowPitch;
 
 		UploadResourceWrapper uploadResourceWrapper;
 		uploadResourceWrapper.GPUResource = indexBuffer.get();
-		uploadResourceWrapper.UploadResource = uploadResource;
 		uploadResourceWrapper.UploadState = D3D12_RESOURCE_STATE_INDEX_BUFFER;
 		uploadResourceWrapper.Data = indexData;
 
@@ -139,6 +127,66 @@ namespace DX12Engine
 		return indexBuffer;
 	}
 
+	std::unique_ptr<IndexBuffer> ResourceManager::CreateDynamicIndexBuffer(UINT indexCount, DXGI_FORMAT format)
+	{
+		ID3D12Resource* indexBufferResource = nullptr;
+		auto uploadHeapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+		auto resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(IndexBuffer::GetIndexStride(format) * indexCount);
+		EngineUtils::ThrowIfFailed(m_Device->CreateCommittedResource(
+			&uploadHeapProps,
+			D3D12_HEAP_FLAG_NONE,
+			&resourceDesc,
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(&indexBufferResource)));
+
+		auto indexBuffer = std::make_unique<IndexBuffer>(indexBufferResource, D3D12_RESOURCE_STATE_GENERIC_READ, format, indexCount);
+		indexBuffer->SetIsReady(true);
+		return indexBuffer;
+	}
+
+	std::shared_ptr<MeshAsset> ResourceManager::LoadMesh(const std::string& path, const ModelLoadOptions& options, UINT gltfMeshIndex)
+	{
+		std::string extension = std::filesystem::path(path).extension().string();
+		for (char& c : extension)
+			c = static_cast<char>(tolower(c));
+		const bool isGltf = extension == ".gltf" || extension == ".glb";
+
+		std::string key = std::filesystem::path(path).lexically_normal().generic_string() + "|" + std::to_string(options.GetHash());
+		if (isGltf)
+			key += "|" + std::to_string(gltfMeshIndex);
+		auto entry = m_Meshes.find(key);
+		if (entry != m_Meshes.end())
+		{
+			if (std::shared_ptr<MeshAsset> mesh = entry->second.lock())
+				return mesh;
+		}
+
+		// Released assets leave expired entries behind, a miss is rare enough to sweep them all
+		std::erase_if(m_Meshes, [](const auto& cached) { return cached.second.expired(); });
+
+		ModelLoader modelLoader;
+		std::shared_ptr<MeshAsset> mesh;
+		if (isGltf)
+		{
+			// glTF is imported every time, there is no cooked format for it yet
+			GltfModel model = modelLoader.LoadGltf(path, options);
+			if (gltfMeshIndex >= model.Meshes.size())
+				throw std::runtime_error("glTF file " + path + " has no mesh " + std::to_string(gltfMeshIndex));
+			if (model.Meshes[gltfMeshIndex].Geometry.Indices.empty())
+				throw std::runtime_error("glTF mesh " + std::to_string(gltfMeshIndex) + " of " + path + " has no triangles");
+			mesh = std::make_shared<MeshAsset>(model.Meshes[gltfMeshIndex].Geometry);
+		}
+		else
+		{
+			// The cooked file is only mapped while the buffers upload
+			std::unique_ptr<CookedMesh> cookedMesh = modelLoader.LoadObjCached(path, options);
+			mesh = std::make_shared<MeshAsset>(*cookedMesh);
+		}
+		m_Meshes[key] = mesh;
+		return mesh;
+	}
+
 	std::unique_ptr<ConstantBuffer> ResourceManager::CreateConstantBuffer(const UINT bufferSize)
 	{
 		ID3D12Resource* constantBufferResource = nullptr;
@@ -184,79 +232,65 @@ namespace DX12Engine
 		return constantBuffer;
 	}
 
-	std::unique_ptr<Texture> ResourceManager::CreateTexture(const DirectX::ScratchImage* imageData)
+	std::unique_ptr<Texture> ResourceManager::CreateTexture(std::unique_ptr<DirectX::ScratchImage> imageData)
+	{
+		const DirectX::TexMetadata metadata = imageData->GetMetadata();
+		return CreateTexture(metadata, std::move(imageData));
+	}
+
+	std::unique_ptr<Texture> ResourceManager::CreateTexture(const DirectX::TexMetadata& metadata, std::unique_ptr<DirectX::ScratchImage> imageData)
 	{
-		const DirectX::Image* image = imageData->GetImage(0, 0, 0);
+		// Image mip 0 is the texture's firstMip
+		if (imageData->GetMetadata().mipLevels > metadata.mipLevels)
+			throw std::runtime_error("Texture image has more mips than its metadata");
+		const size_t firstMip = metadata.mipLevels - imageData->GetMetadata().mipLevels;
 
 		D3D12_RESOURCE_DESC textureDesc{};
-		textureDesc.Format = image->format;
-		textureDesc.Width = image->width;
-		textureDesc.Height = image->height;
+		textureDesc.Format = metadata.format;
+		textureDesc.Width = metadata.width;
+		textureDesc.Height = static_cast<UINT>(metadata.height);
 		textureDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
 		textureDesc.DepthOrArraySize = 1;
-		textureDesc.MipLevels = 1;
+		textureDesc.MipLevels = static_cast<UINT16>(metadata.mipLevels);
 		textureDesc.SampleDesc.Count = 1;
 		textureDesc.SampleDesc.Quality = 0;
 		textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
 		textureDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
 		textureDesc.Alignment = 0;
 
-		D3D12_HEAP_PROPERTIES defaultProperties;
-		defaultProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
-		defaultProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-		defaultProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-		defaultProperties.CreationNodeMask = 0;
-		defaultProperties.VisibleNodeMask = 0;
-
-		ID3D12Resource* textureResource = nullptr;
-		EngineUtils::ThrowIfFailed(m_Device->CreateCommittedResource(
-			&defaultProperties,
-			D3D12_HEAP_FLAG_NONE,
-			&textureDesc,
-			D3D12_RESOURCE_STATE_COPY_DEST,
-			nullptr,
-			IID_PPV_ARGS(&textureResource)
-		));
-
-		D3D12_HEAP_PROPERTIES uploadHeapProperties;
-		uploadHeapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
-		uploadHeapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-		uploadHeapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-		uploadHeapProperties.CreationNodeMask = 0;
-		uploadHeapProperties.VisibleNodeMask = 0;
-
-		const UINT64 uploadBufferSize = GetRequiredIntermediateSize(textureResource, 0, 1);
-		ID3D12Resource* textureUploadResource = nullptr;
-		auto resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(uploadBufferSize);
-		EngineUtils::ThrowIfFailed(m_Device->CreateCommittedResource(
-			&uploadHeapProperties,
-			D3D12_HEAP_FLAG_NONE,
-			&resourceDesc,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-			nullptr,
-			IID_PPV_ARGS(&textureUploadResource)
-		));
+		// Material textures are the residency manager's eviction candidates, so they stay committed
+		GPUHeapAllocation allocation;
+		ID3D12Resource* textureResource = m_HeapAllocator->CreateResource(textureDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, allocation, true);
 
+		// One subresource per uploaded mip, all of them go through the uploader
 		std::vector<D3D12_SUBRESOURCE_DATA> textureData;
-		D3D12_SUBRESOURCE_DATA data = {};
-		data.pData = image->pixels;
-		data.RowPitch = image->rowPitch;
-		data.SlicePitch = image->slicePitch;
-		textureData.emplace_back(data);
+		for (size_t mip = firstMip; mip < metadata.mipLevels; mip++)
+		{
+			const DirectX::Image* image = imageData->GetImage(mip - firstMip, 0, 0);
+			D3D12_SUBRESOURCE_DATA data = {};
+			data.pData = image->pixels;
+			data.RowPitch = image->rowPitch;
+			data.SlicePitch = image->slicePitch;
+			textureData.emplace_back(data);
+		}
 
 		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
 		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 		srvDesc.Format = textureResource->GetDesc().Format;
 		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-		srvDesc.Texture2D.MipLevels = 1;
+		srvDesc.Texture2D.MostDetailedMip = static_cast<UINT>(firstMip);
+		srvDesc.Texture2D.MipLevels = static_cast<UINT>(metadata.mipLevels - firstMip);
 
 		DescriptorHeapHandle srvHandle = m_HeapManager->GetNewSRVDescriptorHeapHandle();
 		m_Device->CreateShaderResourceView(textureResource, &srvDesc, srvHandle.GetCPUHandle());
 
-		return std::make_unique<Texture>(textureResource, textureUploadResource, D3D12_RESOURCE_STATE_COPY_DEST, textureData, srvHandle, srvDesc, false);
+		auto texture = std::make_unique<Texture>(textureResource, D3D12_RESOURCE_STATE_COPY_DEST, textureData, srvHandle, srvDesc, false, std::move(imageData));
+		texture->SetHeapAllocation(allocation);
+		texture->SetResidency(m_TextureResidency.get());
+		return texture;
 	}
 
-	std::unique_ptr<Texture> ResourceManager::CreateCubeMap(const DirectX::ScratchImage* imageData)
+	std::unique_ptr<Texture> ResourceManager::CreateCubeMap(std::unique_ptr<DirectX::ScratchImage> imageData)
 	{
 		const DirectX::TexMetadata& metadata = imageData->GetMetadata();
 
@@ -271,41 +305,8 @@ namespace DX12Engine
 		textureDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
 		textureDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
 
-		D3D12_HEAP_PROPERTIES defaultProperties;
-		defaultProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
-		defaultProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-		defaultProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-		defaultProperties.CreationNodeMask = 0;
-		defaultProperties.VisibleNodeMask = 0;
-
-		ID3D12Resource* textureResource = nullptr;
-		EngineUtils::ThrowIfFailed(m_Device->CreateCommittedResource(
-			&defaultProperties,
-			D3D12_HEAP_FLAG_NONE,
-			&textureDesc,
-			D3D12_RESOURCE_STATE_COPY_DEST,
-			nullptr,
-			IID_PPV_ARGS(&textureResource)
-		));
-
-		D3D12_HEAP_PROPERTIES uploadHeapProperties;
-		uploadHeapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
-		uploadHeapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-		uploadHeapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-		uploadHeapProperties.CreationNodeMask = 0;
-		uploadHeapProperties.VisibleNodeMask = 0;
-
-		const UINT64 uploadBufferSize = GetRequiredIntermediateSize(textureResource, 0, metadata.mipLevels * metadata.arraySize);
-		ID3D12Resource* textureUploadResource = nullptr;
-		auto resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(uploadBufferSize);
-		EngineUtils::ThrowIfFailed(m_Device->CreateCommittedResource(
-			&uploadHeapProperties,
-			D3D12_HEAP_FLAG_NONE,
-			&resourceDesc,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-			nullptr,
-			IID_PPV_ARGS(&textureUploadResource)
-		));
+		GPUHeapAllocation allocation;
+		ID3D12Resource* textureResource = m_HeapAllocator->CreateResource(textureDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, allocation);
 
 		std::vector<D3D12_SUBRESOURCE_DATA> cubemapData;
 		DirectX::PrepareUpload(m_Device.Get(), imageData->GetImages(), imageData->GetImageCount(), metadata, cubemapData);
@@ -319,7 +320,10 @@ namespace DX12Engine
 		DescriptorHeapHandle srvHandle = m_HeapManager->GetNewSRVDescriptorHeapHandle();
 		m_Device->CreateShaderResourceView(textureResource, &srvDesc, srvHandle.GetCPUHandle());
 
-		return std::make_unique<Texture>(textureResource, textureUploadResource, D3D12_RESOURCE_STATE_COPY_DEST, cubemapData, srvHandle, srvDesc, true);
+		auto texture = std::make_unique<Texture>(textureResource, D3D12_RESOURCE_STATE_COPY_DEST, cubemapData, srvHandle, srvDesc, true, std::move(imageData));
+		texture->SetHeapAllocation(allocation);
+		texture->SetResidency(m_TextureResidency.get());
+		return texture;
 	}
 
 	std::unique_ptr<RenderTexture> ResourceManager::CreateDepthMap(DirectX::XMINT3 dimensions, DXGI_FORMAT dsvFormat, DXGI_FORMAT srvFormat, bool isCubeMap)
@@ -345,15 +349,8 @@ namespace DX12Engine
 		depthOptimizedClearValue.DepthStencil.Depth = 1.0f;
 		depthOptimizedClearValue.DepthStencil.Stencil = 0;
 
-		ID3D12Resource* depthMapResource = nullptr;
-		auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-		m_Device->CreateCommittedResource(
-			&heapProps,
-			D3D12_HEAP_FLAG_NONE,
-			&depthMapDesc,
-			D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-			&depthOptimizedClearValue,
-			IID_PPV_ARGS(&depthMapResource));
+		GPUHeapAllocation allocation;
+		ID3D12Resource* depthMapResource = m_HeapAllocator->CreateResource(depthMapDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, &depthOptimizedClearValue, allocation);
 
 		std::vector<DescriptorHeapHandle> dsvDescriptors;
 		if (isSingleMap)
@@ -391,7 +388,9 @@ namespace DX12Engine
 		srvDesc.Texture2D.MipLevels = 1;
 		if (!isSingleMap) srvDesc.Texture2DArray.ArraySize = arraySize;
 
-		return std::make_unique<RenderTexture>(depthMapResource, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, dsvDescriptors, srvDesc, isCubeMap);
+		auto depthMap = std::make_unique<RenderTexture>(depthMapResource, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, dsvDescriptors, srvDesc, isCubeMap);
+		depthMap->SetHeapAllocation(allocation);
+		return depthMap;
 	}
 
 	std::unique_ptr<RenderTexture> ResourceManager::CreateRenderTargetTexture(DirectX::XMINT2 dimensions, DXGI_FORMAT format, UINT mipLevels)
@@ -414,15 +413,8 @@ namespace DX12Engine
 		clearValue.Color[2] = 0.0f;
 		clearValue.Color[3] = 1.0f;
 
-		ID3D12Resource* renderTargetResource = nullptr;
-		auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-		m_Device->CreateCommittedResource(
-			&heapProps,
-			D3D12_HEAP_FLAG_NONE,
-			&textureDesc,
-			D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-			&clearValue,
-			IID_PPV_ARGS(&renderTargetResource));
+		GPUHeapAllocation allocation;
+		ID3D12Resource* renderTargetResource = m_HeapAllocator->CreateResource(textureDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, &clearValue, allocation);
 
 		std::vector<DescriptorHeapHandle> rtvDescriptors;
 		D3D12_RENDER_TARGET_VIEW_DESC rtvDesc = {};
@@ -439,7 +431,9 @@ namespace DX12Engine
 		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
 		srvDesc.Texture2D.MipLevels = mipLevels;
 
-		return std::make_unique<RenderTexture>(renderTargetResource, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, rtvDescriptors, srvDesc, false);
+		auto renderTarget = std::make_unique<RenderTexture>(renderTargetResource, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, rtvDescriptors, srvDesc, false);
+		renderTarget->SetHeapAllocation(allocation);
+		return renderTarget;
 	}
 
 	void ResourceManager::UpdateSRVDescriptors(std::vector<GPUResource*> resources)
@@ -463,6 +457,53 @@ namespace DX12Engine
 		}
 	}
 
+	DescriptorHeapHandle ResourceManager::CreateSRVTable(const std::vector<GPUResource*>& resources)
+	{
+		DescriptorHeapHandle tableStart = m_HeapManager->GetRenderHeapHandleBlock(static_cast<UINT>(resources.size()));
+		WriteSRVTable(tableStart, resources);
+		return tableStart;
+	}
+
+	void ResourceManager::WriteSRVTable(const DescriptorHeapHandle& table, const std::vector<GPUResource*>& resources)
+	{
+		D3D12_CPU_DESCRIPTOR_HANDLE currentCPUHandle = table.GetCPUHandle();
+		UINT descriptorSize = m_HeapManager->GetRenderPassHeap().GetDescriptorSize();
+		for (GPUResource* resource : resources)
+		{
+			D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+			if (resource)
+			{
+				srvDesc = resource->GetSRVDesc();
+			}
+			else
+			{
+				srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+				srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+				srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+				srvDesc.Texture2D.MipLevels = 1;
+			}
+			m_Device->CreateShaderResourceView(resource ? resource->GetResource() : nullptr, &srvDesc, currentCPUHandle);
+			currentCPUHandle.ptr += descriptorSize;
+		}
+	}
+
+	void ResourceManager::RefreshSRV(GPUResource* resource)
+	{
+		// The uploader copies a texture's view into the render pass heap and points its GPU handle there while the CPU
+		// handle keeps the original, both are rewritten so direct binds and later table copies see the new view
+		const D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = resource->GetSRVDesc();
+		DescriptorHeapHandle* descriptor = resource->GetDescriptor();
+		m_Device->CreateShaderResourceView(resource->GetResource(), &srvDesc, descriptor->GetCPUHandle());
+		if (!descriptor->IsReferencedByShader())
+			return;
+
+		RenderPassDescriptorHeap& renderHeap = m_HeapManager->GetRenderPassHeap();
+		D3D12_CPU_DESCRIPTOR_HANDLE shaderVisibleHandle = renderHeap.GetHeapCPUStart();
+		shaderVisibleHandle.ptr += descriptor->GetGPUHandle().ptr - renderHeap.GetHeapGPUStart().ptr;
+		if (shaderVisibleHandle.ptr != descriptor->GetCPUHandle().ptr)
+			m_Device->CreateShaderResourceView(resource->GetResource(), &srvDesc, shaderVisibleHandle);
+	}
+
 	Microsoft::WRL::ComPtr<ID3D12PipelineState> ResourceManager::CreatePipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
 	{
 		return m_PipelineStateCache->GetOrCreatePSO(desc);
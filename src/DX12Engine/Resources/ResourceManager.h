@@ -14,14 +14,19 @@
 #include "../Rendering/Buffers/IndexBuffer.h"
 #include "../Rendering/Buffers/ConstantBuffer.h"
 #include "../Resources/Mesh.h"
+#include "../Resources/MeshAsset.h"
 #include "../Resources/Texture.h"
+#include "../Resources/TextureResidency.h"
+#include "../Resources/TextureStreamer.h"
 #include "../Resources/RenderTexture.h"
 #include "../Rendering/Heaps/DescriptorHeapManager.h"
 #include "../Rendering/RenderContext.h"
 #include "../Rendering/GPUUploader.h"
+#include "../Rendering/GPUHeapAllocator.h"
 #include "../Rendering/PipelineStateCache.h"
 #include "../Rendering/RootSignatureCache.h"
 #include "../IO/TextureLoader.h"
+#include "../IO/ModelLoader.h"
 
 namespace DX12Engine
 {
@@ -40,20 +45,45 @@ namespace DX12Engine
 		~ResourceManager();
 
 	public:
-		std::unique_ptr<VertexBuffer> CreateVertexBuffer(const std::vector<Vertex>& vertices);
-		std::unique_ptr<IndexBuffer> CreateIndexBuffer(const std::vector<UINT>& indices);
+		std::unique_ptr<VertexBuffer> CreateVertexBuffer(const std::vector<Vertex>& vertices) { return CreateVertexBuffer(vertices.data(), static_cast<UINT>(vertices.size())); }
+		std::unique_ptr<VertexBuffer> CreateVertexBuffer(const Vertex* vertices, UINT vertexCount) { return CreateVertexBuffer(vertices, vertexCount, sizeof(Vertex)); }
+		std::unique_ptr<VertexBuffer> CreateVertexBuffer(const void* vertices, UINT vertexCount, UINT vertexStride);
+		std::unique_ptr<IndexBuffer> CreateIndexBuffer(const std::vector<UINT>& indices) { return CreateIndexBuffer(indices.data(), static_cast<UINT>(indices.size())); }
+		// Narrowed to a 16-bit index buffer when every index fits
+		std::unique_ptr<IndexBuffer> CreateIndexBuffer(const UINT* indices, UINT indexCount);
+		std::unique_ptr<IndexBuffer> CreateIndexBuffer(const uint16_t* indices, UINT indexCount) { return CreateIndexBuffer(indices, indexCount, DXGI_FORMAT_R16_UINT); }
+		std::unique_ptr<IndexBuffer> CreateIndexBuffer(const void* indices, UINT indexCount, DXGI_FORMAT format);
+		// Upload heap index buffer the CPU rewrites every frame, e.g. with the surviving clusters of a mesh
+		std::unique_ptr<IndexBuffer> CreateDynamicIndexBuffer(UINT indexCount, DXGI_FORMAT format);
 		std::unique_ptr<ConstantBuffer> CreateConstantBuffer(const UINT bufferSize);
-		std::unique_ptr<Texture> CreateTexture(const DirectX::ScratchImage* imageData);
-		std::unique_ptr<Texture> CreateCubeMap(const DirectX::ScratchImage* imageData);
+		// Imports (or loads the cooked) OBJ once per path and import options, every caller shares the same GPU buffers for
+		// as long as any of them keeps the asset alive. For .gltf and .glb files gltfMeshIndex picks the glTF mesh, its
+		// material slots map to materials through the GltfMesh::SlotMaterials of ModelLoader::LoadGltf
+		std::shared_ptr<MeshAsset> LoadMesh(const std::string& path, const ModelLoadOptions& options = {}, UINT gltfMeshIndex = 0);
+		// The texture keeps the image until its upload is recorded, then frees it
+		std::unique_ptr<Texture> CreateTexture(std::unique_ptr<DirectX::ScratchImage> imageData);
+		// Streamed texture, imageData only holds the smallest mips of the chain metadata describes. The resource is
+		// allocated for the whole chain and its view clamped to the uploaded mips until TextureStreamer adds the rest
+		std::unique_ptr<Texture> CreateTexture(const DirectX::TexMetadata& metadata, std::unique_ptr<DirectX::ScratchImage> imageData);
+		std::unique_ptr<Texture> CreateCubeMap(std::unique_ptr<DirectX::ScratchImage> imageData);
 		std::unique_ptr<RenderTexture> CreateDepthMap(DirectX::XMINT3 dimensions, DXGI_FORMAT dsvFormat, DXGI_FORMAT srvFormat, bool isCubeMap = false);
 		std::unique_ptr<RenderTexture> CreateRenderTargetTexture(DirectX::XMINT2 dimensions, DXGI_FORMAT format, UINT mipLevels = 1);
 
 		void UpdateSRVDescriptors(std::vector<GPUResource*> resources);
+		// Contiguous SRVs for a descriptor table, null entries get a null view that samples as zero
+		DescriptorHeapHandle CreateSRVTable(const std::vector<GPUResource*>& resources);
+		// Rewrites the views of a table in place, e.g. after one of the resources' SRV descriptions changed
+		void WriteSRVTable(const DescriptorHeapHandle& table, const std::vector<GPUResource*>& resources);
+		// Rewrites a resource's own view and its shader visible copy from its current SRV description
+		void RefreshSRV(GPUResource* resource);
 
 		Microsoft::WRL::ComPtr<ID3D12PipelineState> CreatePipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc);
 		Microsoft::WRL::ComPtr<ID3D12RootSignature> CreateRootSignature(const D3D12_ROOT_SIGNATURE_DESC& desc);
 
 		Shader* GetShader(const std::string& name) { return m_Shaders[name].get(); }
+		TextureResidencyManager& GetTextureResidency() { return *m_TextureResidency; }
+		TextureStreamer& GetTextureStreamer() { return *m_TextureStreamer; }
+		const GPUHeapAllocator& GetHeapAllocator() const { return *m_HeapAllocator; }
 
 		static std::wstring GetMaterialPath(std::string path) { return L"res/Materials/" + std::wstring(path.begin(), path.end()); }
 		static std::string GetModelPath(std::string path) { return "res/Models/" + path; }
@@ -65,7 +95,11 @@ namespace DX12Engine
 		GPUUploader* m_GPUUploader;
 		std::unique_ptr<PipelineStateCache> m_PipelineStateCache;
 		std::unique_ptr<RootSignatureCache> m_RootSignatureCache;
+		std::shared_ptr<GPUHeapAllocator> m_HeapAllocator; // Shared with the placed resources, which can outlive the manager
 		std::unordered_map<std::string, std::unique_ptr<Shader>> m_Shaders;
+		std::unordered_map<std::string, std::weak_ptr<MeshAsset>> m_Meshes; // Expired entries are dropped on every miss
+		std::unique_ptr<TextureResidencyManager> m_TextureResidency;
+		std::unique_ptr<TextureStreamer> m_TextureStreamer;
 	};
 }
 
@@ -3,9 +3,12 @@
 
 namespace DX12Engine
 {
-	Shader::Shader(std::string shaderPath, std::string shaderType)
+	Shader::Shader(std::string shaderPath, std::string shaderType, const std::vector<std::wstring>& defines)
 	{
 		std::wstring widestr = std::wstring(shaderPath.begin(), shaderPath.end());
+		std::vector<DxcDefine> dxcDefines;
+		for (const std::wstring& define : defines)
+			dxcDefines.push_back({ define.c_str(), L"1" });
 
 		IDxcCompiler* dxcCompiler = nullptr;
 		DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&dxcCompiler));
@@ -16,9 +19,9 @@ namespace DX12Engine
 		IDxcOperationResult* compileResult = nullptr;
 
 		if (shaderType == "vertex")
-			dxcCompiler->Compile(sourceBlob, widestr.c_str(), L"main", L"vs_6_0", nullptr, 0, nullptr, 0, nullptr, &compileResult);
+			dxcCompiler->Compile(sourceBlob, widestr.c_str(), L"main", L"vs_6_0", nullptr, 0, dxcDefines.data(), static_cast<UINT32>(dxcDefines.size()), nullptr, &compileResult);
 		else if (shaderType == "pixel")
-			dxcCompiler->Compile(sourceBlob, widestr.c_str(), L"main", L"ps_6_0", nullptr, 0, nullptr, 0, nullptr, &compileResult);
+			dxcCompiler->Compile(sourceBlob, widestr.c_str(), L"main", L"ps_6_0", nullptr, 0, dxcDefines.data(), static_cast<UINT32>(dxcDefines.size()), nullptr, &compileResult);
 
 		compileResult->GetResult(&m_Shader);
 	}
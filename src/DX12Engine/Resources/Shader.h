@@ -2,13 +2,15 @@
 #include <wrl.h>
 #include <dxcapi.h>
 #include <string>
+#include <vector>
 
 namespace DX12Engine
 {
 	class Shader
 	{
 	public:
-		Shader(std::string shaderPath, std::string shaderType);
+		// Each define is passed to the compiler with the value 1
+		Shader(std::string shaderPath, std::string shaderType, const std::vector<std::wstring>& defines = {});
 		~Shader();
 
 		const Microsoft::WRL::ComPtr<IDxcBlob> GetShader() { return m_Shader; }
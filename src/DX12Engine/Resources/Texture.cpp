@@ -1,17 +1,93 @@
 #include "Texture.h"
+#include "TextureResidency.h"
+#include "../Utils/Constants.h"
+#include <DirectXTex.h>
+#include <algorithm>
+#include <cmath>
 
 namespace DX12Engine
 {
-	Texture::Texture(ID3D12Resource* mainResource, ID3D12Resource* uploadResource, D3D12_RESOURCE_STATES usageState, std::vector<D3D12_SUBRESOURCE_DATA> data, DescriptorHeapHandle descriptor, D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc, bool isCubemap)
-		: GPUResource(mainResource, usageState, descriptor, srvDesc)
+	Texture::Texture(ID3D12Resource* mainResource, D3D12_RESOURCE_STATES usageState, std::vector<D3D12_SUBRESOURCE_DATA> data, DescriptorHeapHandle descriptor, D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc, bool isCubemap, std::unique_ptr<DirectX::ScratchImage> image)
+		: GPUResource(mainResource, usageState, descriptor, srvDesc), m_Image(std::move(image)), m_GPUSize(0), m_ViewVersion(0), m_RequestedScreenSize(0.0f), m_Residency(nullptr)
 	{
 		m_MainResource = mainResource;
-		m_UploadResource = uploadResource;
 		m_Data = data;
 		m_IsCubemap = isCubemap;
+
+		D3D12_RESOURCE_DESC desc = mainResource->GetDesc();
+		m_Size = (std::max)(desc.Width, static_cast<UINT64>(desc.Height));
+		m_MipCount = desc.MipLevels;
+
+		ID3D12Device* device = nullptr;
+		if (SUCCEEDED(mainResource->GetDevice(IID_PPV_ARGS(&device))))
+		{
+			m_GPUSize = device->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes;
+			device->Release();
+		}
 	}
 
 	Texture::~Texture()
 	{
+		if (m_Residency)
+			m_Residency->Untrack(this);
+	}
+
+	UINT64 Texture::GetCPUSize() const
+	{
+		return m_Image ? m_Image->GetPixelsSize() : 0;
+	}
+
+	UINT Texture::GetResidentMip() const
+	{
+		return m_IsCubemap ? m_SRVDesc.TextureCube.MostDetailedMip : m_SRVDesc.Texture2D.MostDetailedMip;
+	}
+
+	void Texture::RequestScreenSize(float pixels)
+	{
+		m_RequestedScreenSize = (std::max)(m_RequestedScreenSize, pixels);
+	}
+
+	UINT Texture::GetRequiredMip() const
+	{
+		if (m_RequestedScreenSize <= 0.0f)
+			return m_MipCount - 1;
+		// One texel per covered pixel, biased towards detail for textures that repeat across the object
+		const float mip = std::floor(std::log2(static_cast<float>(m_Size) / m_RequestedScreenSize)) - TEXTURE_STREAMING_MIP_BIAS;
+		return static_cast<UINT>(std::clamp(mip, 0.0f, static_cast<float>(m_MipCount - 1)));
+	}
+
+	void Texture::SetResidency(TextureResidencyManager* residency)
+	{
+		m_Residency = residency;
+		m_Residency->Track(this, m_GPUSize, GetCPUSize(), !IsPlaced());
+	}
+
+	void Texture::MarkUsed()
+	{
+		if (m_Residency)
+			m_Residency->Touch(this);
+	}
+
+	void Texture::SetResidentMip(UINT mip)
+	{
+		if (m_IsCubemap)
+		{
+			m_SRVDesc.TextureCube.MostDetailedMip = mip;
+			m_SRVDesc.TextureCube.MipLevels = m_MipCount - mip;
+		}
+		else
+		{
+			m_SRVDesc.Texture2D.MostDetailedMip = mip;
+			m_SRVDesc.Texture2D.MipLevels = m_MipCount - mip;
+		}
+		m_ViewVersion++;
+	}
+
+	void Texture::ReleaseUploadData()
+	{
+		m_Data.clear();
+		m_Image.reset();
+		if (m_Residency)
+			m_Residency->SetCPUBytes(this, 0);
 	}
 }
@@ -2,6 +2,12 @@
 #include <DirectXMath.h>
 #include "GPUResource.h"
 #include "../Rendering/Heaps/DescriptorHeapHandle.h"
+#include <memory>
+
+namespace DirectX
+{
+	class ScratchImage;
+}
 
 namespace DX12Engine
 {
@@ -11,24 +17,64 @@ namespace DX12Engine
 		Normal,
 		Metallic,
 		Roughness,
-		AOMap
+		AOMap,
+		ORM // Occlusion, roughness and metallic packed into R, G and B at import, the loaders put it in the slots of the channels it holds too
 	};
 
+	class TextureResidencyManager;
+	class TextureStreamer;
+
 	class Texture : public GPUResource
 	{
 	public:
 		friend class GPUUploader;
+		friend class TextureStreamer;
 
-		Texture(ID3D12Resource* mainResource, ID3D12Resource* uploadResource, D3D12_RESOURCE_STATES usageState, std::vector<D3D12_SUBRESOURCE_DATA> data, DescriptorHeapHandle descriptor, D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc, bool isCubemap);
+		// The image backs the subresource data and is kept until the upload finished
+		Texture(ID3D12Resource* mainResource, D3D12_RESOURCE_STATES usageState, std::vector<D3D12_SUBRESOURCE_DATA> data, DescriptorHeapHandle descriptor, D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc, bool isCubemap, std::unique_ptr<DirectX::ScratchImage> image = nullptr);
 		~Texture();
 
 		D3D12_GPU_DESCRIPTOR_HANDLE GetGPUHandle() { return GetDescriptor()->GetGPUHandle(); }
 		bool IsCubemap() { return m_IsCubemap; }
 
+		// Video memory of the texture and CPU memory still held for its upload (the decoded image)
+		UINT64 GetGPUSize() const { return m_GPUSize; }
+		UINT64 GetCPUSize() const;
+
+		UINT GetMipCount() const { return m_MipCount; }
+		// Most detailed mip the view exposes, streamed textures start at a smaller one (see TextureStreamer)
+		UINT GetResidentMip() const;
+		// Bumped whenever the view changes, descriptor tables copied from it are stale until rewritten
+		UINT GetViewVersion() const { return m_ViewVersion; }
+
+		// Collects the largest on-screen size in pixels of the objects using the texture during a frame
+		void RequestScreenSize(float pixels);
+		// Mip that size needs, assuming the texture is mapped once across the object. The coarsest mip if nothing asked
+		UINT GetRequiredMip() const;
+		float GetRequestedScreenSize() const { return m_RequestedScreenSize; }
+		void ClearScreenSizeRequest() { m_RequestedScreenSize = 0.0f; }
+
+		// Registers the texture with the residency manager, which is then told about uploads, binds and destruction. Set
+		// the heap allocation first, placed textures are never evicted
+		void SetResidency(TextureResidencyManager* residency);
+		// Called by materials whenever they bind the texture
+		void MarkUsed();
+
 	private:
+		// Frees the decoded image once its copies are in the staging memory
+		void ReleaseUploadData();
+		// Widens the view once mips up to the given one were uploaded
+		void SetResidentMip(UINT mip);
+
 		ID3D12Resource* m_MainResource;
-		ID3D12Resource* m_UploadResource;
 		std::vector<D3D12_SUBRESOURCE_DATA> m_Data;
+		std::unique_ptr<DirectX::ScratchImage> m_Image;
+		UINT64 m_GPUSize;
+		UINT64 m_Size; // Largest dimension of the top mip
+		UINT m_MipCount;
+		UINT m_ViewVersion;
+		float m_RequestedScreenSize;
+		TextureResidencyManager* m_Residency;
 		bool m_IsCubemap = false;
 	};
 }
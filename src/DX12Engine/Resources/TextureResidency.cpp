@@ -0,0 +1,125 @@
+#include "TextureResidency.h"
+#include "Texture.h"
+#include "../Utils/EngineUtils.h"
+
+namespace DX12Engine
+{
+	D3D12TextureResidencyAllocator::D3D12TextureResidencyAllocator(ID3D12Device* device)
+		: m_Device(device)
+	{
+	}
+
+	void D3D12TextureResidencyAllocator::Evict(Texture* texture)
+	{
+		ID3D12Pageable* pageable = texture->GetResource();
+		EngineUtils::ThrowIfFailed(m_Device->Evict(1, &pageable));
+	}
+
+	void D3D12TextureResidencyAllocator::MakeResident(Texture* texture)
+	{
+		ID3D12Pageable* pageable = texture->GetResource();
+		EngineUtils::ThrowIfFailed(m_Device->MakeResident(1, &pageable));
+	}
+
+	TextureResidencyManager::TextureResidencyManager(std::unique_ptr<TextureResidencyAllocator> allocator, UINT64 budgetBytes)
+		: m_Allocator(std::move(allocator)), m_Frame(0)
+	{
+		m_Statistics.BudgetBytes = budgetBytes;
+	}
+
+	void TextureResidencyManager::Track(Texture* texture, UINT64 gpuBytes, UINT64 cpuBytes, bool pageable)
+	{
+		if (m_EntryByTexture.count(texture))
+			return;
+
+		// New textures are in use by their upload, so they start as the most recently used
+		m_Entries.push_front({ texture, gpuBytes, cpuBytes, m_Frame, true, false, pageable });
+		m_EntryByTexture[texture] = m_Entries.begin();
+		m_Statistics.ResidentBytes += gpuBytes;
+		m_Statistics.CPUBytes += cpuBytes;
+		m_Statistics.TrackedCount++;
+	}
+
+	void TextureResidencyManager::Untrack(Texture* texture)
+	{
+		auto it = m_EntryByTexture.find(texture);
+		if (it == m_EntryByTexture.end())
+			return;
+
+		const Entry& entry = *it->second;
+		if (entry.Resident)
+		{
+			m_Statistics.ResidentBytes -= entry.GPUBytes;
+		}
+		else
+		{
+			m_Statistics.EvictedBytes -= entry.GPUBytes;
+			m_Statistics.EvictedCount--;
+		}
+		m_Statistics.CPUBytes -= entry.CPUBytes;
+		m_Statistics.TrackedCount--;
+		m_Entries.erase(it->second);
+		m_EntryByTexture.erase(it);
+	}
+
+	void TextureResidencyManager::SetCPUBytes(Texture* texture, UINT64 cpuBytes)
+	{
+		auto it = m_EntryByTexture.find(texture);
+		if (it == m_EntryByTexture.end())
+			return;
+		m_Statistics.CPUBytes = m_Statistics.CPUBytes - it->second->CPUBytes + cpuBytes;
+		it->second->CPUBytes = cpuBytes;
+	}
+
+	void TextureResidencyManager::Touch(Texture* texture)
+	{
+		auto it = m_EntryByTexture.find(texture);
+		if (it == m_EntryByTexture.end())
+			return;
+
+		Entry& entry = *it->second;
+		entry.LastUsedFrame = m_Frame;
+		entry.Evictable = entry.Pageable;
+		if (!entry.Resident)
+		{
+			m_Allocator->MakeResident(texture);
+			entry.Resident = true;
+			m_Statistics.ResidentBytes += entry.GPUBytes;
+			m_Statistics.EvictedBytes -= entry.GPUBytes;
+			m_Statistics.EvictedCount--;
+			m_Statistics.RestoreCount++;
+		}
+		m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+	}
+
+	void TextureResidencyManager::EndFrame()
+	{
+		EnforceBudget();
+		m_Frame++;
+	}
+
+	void TextureResidencyManager::SetBudget(UINT64 budgetBytes)
+	{
+		m_Statistics.BudgetBytes = budgetBytes;
+	}
+
+	void TextureResidencyManager::EnforceBudget()
+	{
+		// Walk from the least recently used end, stopping at the first texture the current frame still needs
+		for (auto it = m_Entries.rbegin(); it != m_Entries.rend() && m_Statistics.ResidentBytes > m_Statistics.BudgetBytes; ++it)
+		{
+			Entry& entry = *it;
+			if (entry.Evictable && entry.LastUsedFrame == m_Frame)
+				break;
+			if (!entry.Resident || !entry.Evictable)
+				continue;
+
+			m_Allocator->Evict(entry.Resource);
+			entry.Resident = false;
+			m_Statistics.ResidentBytes -= entry.GPUBytes;
+			m_Statistics.EvictedBytes += entry.GPUBytes;
+			m_Statistics.EvictedCount++;
+			m_Statistics.EvictionCount++;
+		}
+	}
+}
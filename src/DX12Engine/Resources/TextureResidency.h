@@ -0,0 +1,91 @@
+#pragma once
+#include <d3d12.h>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+namespace DX12Engine
+{
+	class Texture;
+
+	struct TextureResidencyStatistics
+	{
+		UINT64 BudgetBytes = 0;
+		UINT64 ResidentBytes = 0; // Video memory of every resident texture, can exceed the budget if it is all in use
+		UINT64 EvictedBytes = 0;
+		UINT64 CPUBytes = 0; // Decoded images that were not released yet
+		UINT TrackedCount = 0;
+		UINT EvictedCount = 0;
+		UINT64 EvictionCount = 0; // Totals since creation
+		UINT64 RestoreCount = 0;
+	};
+
+	// Pages textures out of and back into video memory. The manager never dereferences the textures itself, so tests can
+	// pass a fake that records the calls together with made up Texture pointers
+	class TextureResidencyAllocator
+	{
+	public:
+		virtual ~TextureResidencyAllocator() {}
+
+		virtual void Evict(Texture* texture) = 0;
+		virtual void MakeResident(Texture* texture) = 0;
+	};
+
+	// ID3D12Device::Evict/MakeResident, the resource and its views stay valid while evicted
+	class D3D12TextureResidencyAllocator : public TextureResidencyAllocator
+	{
+	public:
+		D3D12TextureResidencyAllocator(ID3D12Device* device);
+
+		void Evict(Texture* texture) override;
+		void MakeResident(Texture* texture) override;
+
+	private:
+		ID3D12Device* m_Device;
+	};
+
+	// Tracks the CPU and GPU bytes of every texture and keeps the resident ones within a video memory budget by evicting
+	// the least recently used. Textures only become eviction candidates once they are touched by a material bind, so
+	// textures owned by render passes (skybox, irradiance) are never evicted. Not thread safe, textures are created and
+	// bound on the render thread
+	class TextureResidencyManager
+	{
+	public:
+		TextureResidencyManager(std::unique_ptr<TextureResidencyAllocator> allocator, UINT64 budgetBytes);
+
+		// Textures that aren't pageable on their own, like ones placed in a shared heap, count towards the resident bytes
+		// but are never evicted
+		void Track(Texture* texture, UINT64 gpuBytes, UINT64 cpuBytes, bool pageable = true);
+		void Untrack(Texture* texture);
+		void SetCPUBytes(Texture* texture, UINT64 cpuBytes);
+
+		// Marks the texture as used by the current frame and pages it back in if it was evicted
+		void Touch(Texture* texture);
+		// Call once the GPU finished the frame. Evicts least recently used textures until the resident set fits the
+		// budget, textures touched during this frame are kept
+		void EndFrame();
+
+		void SetBudget(UINT64 budgetBytes);
+		const TextureResidencyStatistics& GetStatistics() const { return m_Statistics; }
+
+	private:
+		struct Entry
+		{
+			Texture* Resource;
+			UINT64 GPUBytes;
+			UINT64 CPUBytes;
+			UINT64 LastUsedFrame;
+			bool Resident;
+			bool Evictable;
+			bool Pageable;
+		};
+
+		void EnforceBudget();
+
+		std::unique_ptr<TextureResidencyAllocator> m_Allocator;
+		std::list<Entry> m_Entries; // Most recently used first
+		std::unordered_map<Texture*, std::list<Entry>::iterator> m_EntryByTexture;
+		UINT64 m_Frame;
+		TextureResidencyStatistics m_Statistics;
+	};
+}
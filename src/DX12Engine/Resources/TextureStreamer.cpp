@@ -0,0 +1,130 @@
+#include "TextureStreamer.h"
+#include "ResourceManager.h"
+#include "../Rendering/GPUUploader.h"
+#include "../Imaging/TextureCooker.h"
+#include <stdexcept>
+#include <chrono>
+#include <algorithm>
+
+namespace DX12Engine
+{
+	TextureStreamer::TextureStreamer(GPUUploader& uploader, UINT threadCount)
+		: m_Uploader(uploader), m_Pool(threadCount)
+	{
+	}
+
+	void TextureStreamer::Register(const std::shared_ptr<Texture>& texture, const std::wstring& cookedPath)
+	{
+		StreamedTexture streamed;
+		streamed.Target = texture;
+		streamed.CookedPath = cookedPath;
+		m_Textures.push_back(std::move(streamed));
+	}
+
+	void TextureStreamer::Update()
+	{
+		UINT pendingCount = 0;
+		for (const StreamedTexture& streamed : m_Textures)
+			pendingCount += streamed.Load.valid() ? 1 : 0;
+
+		for (size_t i = 0; i < m_Textures.size();)
+		{
+			StreamedTexture& streamed = m_Textures[i];
+			// A destroyed texture's load still runs to completion on the pool and is dropped with its future
+			std::shared_ptr<Texture> texture = streamed.Target.lock();
+			bool finished = !texture;
+			if (texture && streamed.QueuedMip != UINT_MAX && texture->GetResidentMip() <= streamed.QueuedMip)
+				streamed.QueuedMip = UINT_MAX;
+			if (texture && streamed.Load.valid())
+			{
+				if (streamed.Load.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+				{
+					pendingCount--;
+					try
+					{
+						std::shared_ptr<DirectX::ScratchImage> image = streamed.Load.get();
+						if (image->GetMetadata().mipLevels != texture->GetMipCount() - streamed.LoadMip)
+							throw std::runtime_error("Cooked texture changed while streaming");
+						QueueUpload(texture, std::move(image), streamed.LoadMip, streamed.CookedPath);
+						streamed.QueuedMip = streamed.LoadMip;
+						finished = streamed.LoadMip == 0;
+					}
+					catch (const std::runtime_error&)
+					{
+						// The texture keeps the mips it has
+						m_Statistics.FailedCount++;
+						finished = true;
+					}
+				}
+			}
+			else if (texture && pendingCount < TEXTURE_STREAMING_MAX_PENDING_LOADS)
+			{
+				// Every load reads down to the coarsest mip, the few resident bytes aren't worth a second file range
+				const UINT requiredMip = texture->GetRequiredMip();
+				if (requiredMip < (std::min)(texture->GetResidentMip(), streamed.QueuedMip))
+				{
+					const std::wstring cookedPath = streamed.CookedPath;
+					streamed.LoadMip = requiredMip;
+					streamed.Load = m_Pool.Submit([cookedPath, requiredMip]()
+					{
+						auto image = std::make_unique<DirectX::ScratchImage>();
+						TextureCooker::LoadMips(cookedPath, requiredMip, *image);
+						return image;
+					});
+					pendingCount++;
+				}
+			}
+
+			if (texture)
+				texture->ClearScreenSizeRequest();
+			if (finished)
+			{
+				m_Textures[i] = std::move(m_Textures.back());
+				m_Textures.pop_back();
+				continue;
+			}
+			i++;
+		}
+
+		m_Statistics.StreamingCount = static_cast<UINT>(m_Textures.size());
+		m_Statistics.PendingCount = pendingCount;
+	}
+
+	void TextureStreamer::QueueUpload(const std::shared_ptr<Texture>& texture, std::shared_ptr<DirectX::ScratchImage> image, UINT firstMip, const std::wstring& cookedPath)
+	{
+		// Textures something drew this frame go first, the rest were left behind by a camera that moved on
+		const UploadPriority priority = texture->GetRequestedScreenSize() > 0.0f ? UploadPriority::High : UploadPriority::Low;
+		Texture* target = texture.get();
+		m_Uploader.QueueTextureMips(texture, std::move(image), firstMip, priority, [this, target, firstMip]()
+		{
+			// A later upload may have brought in more already, the view never narrows
+			const UINT residentMip = target->GetResidentMip();
+			if (firstMip >= residentMip)
+				return;
+			m_Statistics.StreamedMipCount += residentMip - firstMip;
+			target->SetResidentMip(firstMip);
+			ResourceManager::GetInstance().RefreshSRV(target);
+		}, [this, weakTarget = std::weak_ptr<Texture>(texture), cookedPath]()
+		{
+			OnUploadFailed(weakTarget, cookedPath);
+		});
+	}
+
+	void TextureStreamer::OnUploadFailed(const std::weak_ptr<Texture>& target, const std::wstring& cookedPath)
+	{
+		m_Statistics.FailedCount++;
+		std::shared_ptr<Texture> texture = target.lock();
+		if (!texture)
+			return;
+
+		for (StreamedTexture& streamed : m_Textures)
+		{
+			if (!streamed.Target.owner_before(target) && !target.owner_before(streamed.Target))
+			{
+				streamed.QueuedMip = UINT_MAX;
+				return;
+			}
+		}
+		Register(texture, cookedPath);
+	}
+}
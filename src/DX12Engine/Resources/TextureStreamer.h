@@ -0,0 +1,61 @@
+#pragma once
+#include "Texture.h"
+#include "../Utils/ThreadPool.h"
+#include "../Utils/Constants.h"
+#include <DirectXTex.h>
+#include <string>
+#include <vector>
+#include <climits>
+
+namespace DX12Engine
+{
+	class GPUUploader;
+
+	struct TextureStreamingStatistics
+	{
+		UINT StreamingCount = 0; // Textures that still have mips on disk
+		UINT PendingCount = 0; // Loads in flight
+		UINT64 StreamedMipCount = 0; // Totals since creation
+		UINT64 FailedCount = 0;
+	};
+
+	// Streams the large mips of textures created from only their smallest ones. Objects report their on-screen size to
+	// their materials' textures every frame, and any texture whose view stops short of the mip that size needs has the
+	// missing mips read from its cooked file on a worker thread. Finished loads go to the uploader's budgeted queue, the
+	// textures that were drawn at high priority, and the view's MostDetailedMip is widened once their mips are uploaded.
+	// Mips are never dropped again, the residency manager pages out whole textures
+	class TextureStreamer
+	{
+	public:
+		TextureStreamer(GPUUploader& uploader, UINT threadCount = TEXTURE_STREAMING_THREAD_COUNT);
+
+		// cookedPath holds the texture's whole mip chain, see TextureCooker::LoadMips
+		void Register(const std::shared_ptr<Texture>& texture, const std::wstring& cookedPath);
+
+		// Call once per frame after the GPU finished it, before the uploader processes its queue. Queues the loads that
+		// completed, then starts loads for textures that need more detail and clears the collected screen sizes
+		void Update();
+
+		const TextureStreamingStatistics& GetStatistics() const { return m_Statistics; }
+
+	private:
+		struct StreamedTexture
+		{
+			std::weak_ptr<Texture> Target;
+			std::wstring CookedPath;
+			std::future<std::unique_ptr<DirectX::ScratchImage>> Load;
+			UINT LoadMip = 0; // Most detailed mip of the load in flight
+			UINT QueuedMip = UINT_MAX; // Most detailed mip waiting in the uploader's queue
+		};
+
+		void QueueUpload(const std::shared_ptr<Texture>& texture, std::shared_ptr<DirectX::ScratchImage> image, UINT firstMip, const std::wstring& cookedPath);
+		// The uploader dropped a queued upload. The texture can request the mips again, it is registered anew if its entry
+		// was already removed
+		void OnUploadFailed(const std::weak_ptr<Texture>& target, const std::wstring& cookedPath);
+
+		GPUUploader& m_Uploader;
+		ThreadPool m_Pool;
+		std::vector<StreamedTexture> m_Textures;
+		TextureStreamingStatistics m_Statistics;
+	};
+}
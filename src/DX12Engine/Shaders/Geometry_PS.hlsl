@@ -1,16 +1,25 @@
 Texture2D albedoMap : register(t0);
 Texture2D normalMap : register(t1);
-Texture2D metallicMap : register(t2);
-Texture2D roughnessMap : register(t3);
-Texture2D aoMap : register(t4);
+Texture2D ormMap : register(t2); // R occlusion, G roughness, B metallic
 SamplerState samp : register(s0);
 
+// Bits of HasTexture, 1 << TextureType
+#define TEXTURE_ALBEDO (1 << 0)
+#define TEXTURE_NORMAL (1 << 1)
+#define TEXTURE_METALLIC (1 << 2)
+#define TEXTURE_ROUGHNESS (1 << 3)
+#define TEXTURE_AO (1 << 4)
+#define TEXTURE_ORM (1 << 5)
+
 cbuffer MaterialData : register(b1)
 {
+    float4 BaseColor;
+    int HasTexture;
     float3 Albedo;
     float Metallic;
     float Roughness;
     float AO;
+    float Padding;
     float3 Emissive;
 };
 
@@ -37,11 +46,20 @@ PSOutput main(PSInput input)
 {
     PSOutput output;
 
-    float3 baseColor = albedoMap.Sample(samp, input.uv);
-    float metallic = metallicMap.Sample(samp, input.uv);
-    float roughness = roughnessMap.Sample(samp, input.uv);
-    float ao = aoMap.Sample(samp, input.uv);
-    float3 textureNormal = normalMap.Sample(samp, input.uv).rgb * 2.0 - 1.0;
+    // Maps the material doesn't have fall back to its constants
+    float3 baseColor = (HasTexture & TEXTURE_ALBEDO) ? albedoMap.Sample(samp, input.uv).rgb : Albedo;
+    // The ORM map is filled with defaults where it was packed without a source, those channels use the constants
+    float3 orm = (HasTexture & TEXTURE_ORM) ? ormMap.Sample(samp, input.uv).rgb : float3(AO, Roughness, Metallic);
+    float ao = (HasTexture & TEXTURE_AO) ? orm.r : AO;
+    float roughness = (HasTexture & TEXTURE_ROUGHNESS) ? orm.g : Roughness;
+    float metallic = (HasTexture & TEXTURE_METALLIC) ? orm.b : Metallic;
+    // Normal maps are cooked to BC5, so only XY is stored and Z is rebuilt
+    float3 textureNormal = float3(0.0, 0.0, 1.0);
+    if (HasTexture & TEXTURE_NORMAL)
+    {
+        textureNormal.xy = normalMap.Sample(samp, input.uv).rg * 2.0 - 1.0;
+        textureNormal.z = sqrt(saturate(1.0 - dot(textureNormal.xy, textureNormal.xy)));
+    }
     float3x3 TBN = float3x3(normalize(input.tangent), normalize(input.bitangent), normalize(input.normal));
     float3 worldNormal = normalize(mul(textureNormal, TBN));
 
@@ -8,15 +8,35 @@ cbuffer ConstantBuffer : register(b0)
     float4x4 InvViewMatrix;
     float4x4 InvProjectionMatrix;
     float3 CameraPosition;
+    float4 PositionScale;
+    float4 PositionOffset;
 };
 
+#ifdef COMPACT_VERTEX
+struct VSInput
+{
+    float4 position : POSITION; // Quantized to the mesh bounds, w holds the tangent handedness as 0 or 1
+    float2 normal : NORMAL; // Octahedral
+    float2 tangent : TANGENT; // Octahedral
+    float2 texCoord : TEXCOORD;
+};
+
+float3 DecodeOctahedral(float2 e)
+{
+    float3 n = float3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += n.xy >= 0.0 ? -t : t;
+    return normalize(n);
+}
+#else
 struct VSInput
 {
     float3 position : POSITION;
     float3 normal : NORMAL;
     float2 texCoord : TEXCOORD;
-    float3 tangent : TANGENT;
+    float4 tangent : TANGENT;
 };
+#endif
 
 struct VSOutput
 {
@@ -30,14 +50,23 @@ struct VSOutput
 
 VSOutput main(VSInput input)
 {
+#ifdef COMPACT_VERTEX
+    float3 position = input.position.xyz * PositionScale.xyz + PositionOffset.xyz;
+    float3 normal = DecodeOctahedral(input.normal);
+    float4 tangent = float4(DecodeOctahedral(input.tangent), input.position.w * 2.0 - 1.0);
+#else
+    float3 position = input.position;
+    float3 normal = input.normal;
+    float4 tangent = input.tangent;
+#endif
+
     VSOutput output;
-    float4 worldPosition = mul(ModelMatrix, float4(input.position, 1.0f));
-    output.position = mul(MVPMatrix, float4(input.position, 1.0f));
+    float4 worldPosition = mul(ModelMatrix, float4(position, 1.0f));
+    output.position = mul(MVPMatrix, float4(position, 1.0f));
     output.worldPos = worldPosition.xyz;
-    output.normal = normalize(mul(NormalMatrix, float4(input.normal, 0.0f)).xyz);
+    output.normal = normalize(mul(NormalMatrix, float4(normal, 0.0f)).xyz);
     output.uv = input.texCoord;
-    float4 tangent = normalize(mul(ModelMatrix, float4(input.tangent, 1.0)));
-    output.tangent = tangent.xyz / tangent.w;
-    output.bitangent = cross(output.tangent, output.normal);
+    output.tangent = normalize(mul(ModelMatrix, float4(tangent.xyz, 0.0)).xyz);
+    output.bitangent = cross(output.tangent, output.normal) * tangent.w;
     return output;
 }
\ No newline at end of file
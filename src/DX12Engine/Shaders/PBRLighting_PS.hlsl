@@ -45,9 +45,7 @@ cbuffer MaterialData : register(b1)
 // Sampled Textures
 Texture2D albedoMap : register(t0);
 Texture2D normalMap : register(t1);
-Texture2D metallicMap : register(t2);
-Texture2D roughnessMap : register(t3);
-Texture2D aoMap : register(t4);
+Texture2D ormMap : register(t2); // R occlusion, G roughness, B metallic
 TextureCube environmentMap : register(t5);
 TextureCube irradianceMap : register(t6);
 Texture2DArray shadowMaps : register(t7);
@@ -161,10 +159,14 @@ float4 main(PSInput input) : SV_TARGET
     float3 V = normalize(input.cameraPos - input.worldPos);
 
     float3 albedo = albedoMap.Sample(samp, input.texCoord).rgb;
-    float metallic = metallicMap.Sample(samp, input.texCoord).r;
-    float roughness = roughnessMap.Sample(samp, input.texCoord).r;
-    float ao = aoMap.Sample(samp, input.texCoord).r;
-    float3 textureNormal = normalMap.Sample(samp, input.texCoord).rgb * 2.0 - 1.0;
+    float3 orm = ormMap.Sample(samp, input.texCoord).rgb;
+    float ao = orm.r;
+    float roughness = orm.g;
+    float metallic = orm.b;
+    // Normal maps are cooked to BC5, so only XY is stored and Z is rebuilt
+    float3 textureNormal;
+    textureNormal.xy = normalMap.Sample(samp, input.texCoord).rg * 2.0 - 1.0;
+    textureNormal.z = sqrt(saturate(1.0 - dot(textureNormal.xy, textureNormal.xy)));
     float3x3 TBN = float3x3(normalize(input.tangent), normalize(input.bitangent), normalize(input.normal));
     float3 worldNormal = normalize(mul(textureNormal, TBN));
     
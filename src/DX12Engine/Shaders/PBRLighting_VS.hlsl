@@ -37,7 +37,7 @@ struct VSInput
     float3 position : POSITION;
     float3 normal : NORMAL;
     float2 texCoord : TEXCOORD;
-    float3 tangent : TANGENT;
+    float4 tangent : TANGENT;
 };
 
 struct PSInput
@@ -67,8 +67,7 @@ PSInput main(VSInput input)
     }
     output.normal = normalize(mul(NormalMatrix, float4(input.normal, 1.0))).xyz;
     output.texCoord = input.texCoord;
-    float4 tangent = normalize(mul(ModelMatrix, float4(input.tangent, 1.0)));
-    output.tangent = tangent.xyz / tangent.w;
-    output.bitangent = cross(output.tangent, output.normal);
+    output.tangent = normalize(mul(ModelMatrix, float4(input.tangent.xyz, 0.0)).xyz);
+    output.bitangent = cross(output.tangent, output.normal) * input.tangent.w;
     return output;
 }
@@ -4,6 +4,8 @@ cbuffer ShadowConstants : register(b0)
     matrix ModelMatrix;
     float3 LightPos;
     float FarPlane;
+    float4 PositionScale; // Identity for full vertices, the position semantic reads xyz of either layout
+    float4 PositionOffset;
 }
 
 struct VSInput
@@ -19,6 +21,6 @@ struct VSOutput
 VSOutput main(VSInput input)
 {
     VSOutput output;
-    output.Position = mul(LightMVPMatrix, float4(input.Position, 1.0));
+    output.Position = mul(LightMVPMatrix, float4(input.Position * PositionScale.xyz + PositionOffset.xyz, 1.0));
     return output;
 }
\ No newline at end of file
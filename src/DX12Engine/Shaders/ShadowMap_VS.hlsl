@@ -4,6 +4,8 @@ cbuffer ShadowConstants : register(b0)
     matrix ModelMatrix;
     float3 LightPos;
     float FarPlane;
+    float4 PositionScale; // Identity for full vertices, the position semantic reads xyz of either layout
+    float4 PositionOffset;
 }
 
 struct VSInput
@@ -19,7 +21,7 @@ struct VSOutput
 VSOutput main(VSInput input)
 {
     VSOutput output;
-    output.pos = mul(LightMVPMatrix, float4(input.pos, 1.0f));
+    output.pos = mul(LightMVPMatrix, float4(input.pos * PositionScale.xyz + PositionOffset.xyz, 1.0f));
     output.pos = output.pos / output.pos.w;
     output.pos.z = output.pos.z * 0.5 + 0.5;
     return output;
@@ -2,5 +2,28 @@
 
 #define MAX_TEXTURE_SUBRESOURCE_COUNT 8
 #define MAX_UPLOAD_BATCH_SIZE 64
+#define UPLOAD_RING_BUFFER_SIZE (64ull << 20) // Staging memory shared by all uploads, larger ones get their own buffer
+#define UPLOAD_FRAME_BYTE_BUDGET (16ull << 20) // Queued uploads per frame, see UploadScheduler
+#define UPLOAD_FRAME_TIME_BUDGET_MS 2.0
+#define PBR_MATERIAL_TEXTURE_COUNT 3 // Albedo, normal, ORM
+#define TEXTURE_RESIDENCY_BUDGET (512ull << 20)
+#define GPU_HEAP_SIZE (64ull << 20) // Placed resources are suballocated from heaps of this size, see GPUHeapAllocator
+#define TEXTURE_STREAMING_INITIAL_SIZE 256 // Mips larger than this are streamed in once an object needs them
+#define TEXTURE_STREAMING_MIP_BIAS 1.0f
+#define TEXTURE_STREAMING_MAX_PENDING_LOADS 8
+#define TEXTURE_STREAMING_THREAD_COUNT 2
 #define SHADOW_MAP_SIZE 1024
+#define OBJ_IMPORT_CHUNK_FACES 65536
+#define OBJ_STREAM_WINDOW_SIZE (4 << 20)
+#define IMPORT_PARALLEL_BLOCK_SIZE 16384 // Vertices or triangles per task in the parallel import passes
+#define MESH_OPTIMIZER_CACHE_SIZE 16
+#define MESH_OPTIMIZER_OVERDRAW_THRESHOLD 1.05f
 
+#define MAX_MESH_LODS 8
+#define MESH_LOD_COUNT 4
+#define MESH_LOD_REDUCTION 0.5f
+#define MESH_LOD_TARGET_ERROR 0.02f
+#define MESH_LOD_MIN_REDUCTION 0.9f
+#define LOD_SCREEN_SPACE_ERROR_PIXELS 1.0f
+#define MESHLET_MAX_VERTICES 64
+#define MESHLET_MAX_TRIANGLES 124
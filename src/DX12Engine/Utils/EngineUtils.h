@@ -1,5 +1,11 @@
 #include <stdexcept>
 #include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <algorithm>
 #include <comdef.h>
 
 namespace DX12Engine
@@ -31,6 +37,60 @@ namespace DX12Engine
 			return alignmentCount * placement;
 		}
 
+		// Runs func(i) for every i in [0, count) across threadCount threads (0 = hardware concurrency), the calling thread joins in
+		template<typename Func>
+		static void ParallelFor(size_t count, UINT threadCount, Func&& func)
+		{
+			if (threadCount == 0)
+				threadCount = (std::max)(1u, std::thread::hardware_concurrency());
+			threadCount = static_cast<UINT>((std::min)(static_cast<size_t>(threadCount), count));
+			if (threadCount <= 1)
+			{
+				for (size_t i = 0; i < count; i++)
+					func(i);
+				return;
+			}
+
+			std::atomic<size_t> nextIndex = 0;
+			std::exception_ptr error = nullptr;
+			std::mutex errorMutex;
+			auto worker = [&]()
+			{
+				try
+				{
+					for (size_t i = nextIndex++; i < count; i = nextIndex++)
+						func(i);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock(errorMutex);
+					if (!error)
+						error = std::current_exception();
+					nextIndex = count;
+				}
+			};
+
+			std::vector<std::thread> workers;
+			for (UINT i = 1; i < threadCount; i++)
+				workers.emplace_back(worker);
+			worker();
+			for (std::thread& thread : workers)
+				thread.join();
+
+			if (error)
+				std::rethrow_exception(error);
+		}
+
+		// ParallelFor over blocks of blockSize indices, func(first, last) gets one block per call
+		template<typename Func>
+		static void ParallelForBlocks(size_t count, size_t blockSize, UINT threadCount, Func&& func)
+		{
+			ParallelFor((count + blockSize - 1) / blockSize, threadCount, [&](size_t block)
+			{
+				func(block * blockSize, (std::min)(count, (block + 1) * blockSize));
+			});
+		}
+
 		template<typename T>
 		static std::vector<T*> VectorSharedPtrToPtrs(const std::vector<std::shared_ptr<T>>& vec)
 		{
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace DX12Engine
+{
+	// Fixed set of worker threads draining one FIFO queue. Destruction finishes the queued work before joining
+	class ThreadPool
+	{
+	public:
+		ThreadPool(uint32_t threadCount = 0); // 0 = hardware concurrency
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// Exceptions thrown by func are rethrown from the future's get()
+		template<typename Func>
+		auto Submit(Func&& func) -> std::future<decltype(func())>
+		{
+			using Result = decltype(func());
+			auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Func>(func));
+			std::future<Result> result = task->get_future();
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Tasks.emplace_back([task]() { (*task)(); });
+			}
+			m_Condition.notify_one();
+			return result;
+		}
+
+		uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_Workers.size()); }
+
+	private:
+		void WorkerLoop();
+
+		std::vector<std::thread> m_Workers;
+		std::deque<std::function<void()>> m_Tasks;
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+		bool m_Stopping;
+	};
+}
@@ -0,0 +1,48 @@
+#include "Benchmarks.h"
+#include <iostream>
+#include <stdexcept>
+
+using namespace DX12Engine;
+
+struct Benchmark
+{
+	const char* Name;
+	const char* Usage;
+	void (*Run)(const BenchmarkArgs& args);
+};
+
+static const Benchmark Benchmarks[] =
+{
+	{ "meshcache", "[model.obj] [iterations]  Cold import and cook against warm cached loads", RunMeshCacheBenchmark },
+	{ "weldmap", "[model.obj] [iterations]  VertexWeldMap against the string-keyed unordered_map it replaced", RunVertexWeldMapBenchmark },
+	{ "objimport", "[model.obj] [iterations] [max threads]  Streaming OBJ import from one thread up to all hardware threads", RunObjImportBenchmark },
+	{ "objmemory", "[model.obj] [streaming|tinyobj]  Peak working set growth of one OBJ import, run once per mode", RunObjMemoryBenchmark },
+	{ "tangents", "[model.obj] [iterations]  Batched tangent generation against a scalar loop", RunTangentBenchmark },
+	{ "materials", "[materials directory] [iterations] [max threads]  MaterialLoader decode time from one thread up to all hardware threads", RunMaterialLoaderBenchmark },
+	{ "buddy", "[heap MB] [rounds]  BuddyAllocator fragmentation and cost under placed resource churn", RunBuddyAllocatorBenchmark },
+};
+
+int main(int argc, char** argv)
+{
+	const std::string name = argc > 1 ? argv[1] : "";
+	for (const Benchmark& benchmark : Benchmarks)
+	{
+		if (name != benchmark.Name)
+			continue;
+		try
+		{
+			benchmark.Run(BenchmarkArgs(argv + 2, argv + argc));
+			return 0;
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << benchmark.Name << ": " << e.what() << std::endl;
+			return 1;
+		}
+	}
+
+	std::cerr << "Usage: DX12EngineBenchmarks <benchmark> [arguments]" << std::endl;
+	for (const Benchmark& benchmark : Benchmarks)
+		std::cerr << "  " << benchmark.Name << " " << benchmark.Usage << std::endl;
+	return 1;
+}
@@ -0,0 +1,65 @@
+#include "Benchmarks.h"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace DX12Engine
+{
+	unsigned int GetArgument(const BenchmarkArgs& args, size_t index, unsigned int fallback)
+	{
+		return index < args.size() ? static_cast<unsigned int>(std::stoul(args[index])) : fallback;
+	}
+
+	std::string GetArgument(const BenchmarkArgs& args, size_t index, const std::string& fallback)
+	{
+		return index < args.size() ? args[index] : fallback;
+	}
+
+	std::string WriteGridObj(const std::string& name, unsigned int gridSize, unsigned int materialCount)
+	{
+		const std::filesystem::path directory = std::filesystem::temp_directory_path() / "DX12EngineBenchmarks";
+		std::filesystem::create_directories(directory);
+		const std::filesystem::path objPath = directory / (name + ".obj");
+		const std::filesystem::path mtlPath = directory / (name + ".mtl");
+
+		std::ofstream mtl(mtlPath);
+		for (unsigned int material = 0; material < materialCount; material++)
+			mtl << "newmtl band" << material << "\nKd 1 1 1\n";
+
+		std::ofstream obj(objPath);
+		if (!obj || !mtl)
+			throw std::runtime_error("Failed to write " + objPath.string());
+		obj << "mtllib " << mtlPath.filename().string() << "\n";
+
+		// A gently rolling height field, so normals and tangents vary across the grid
+		const unsigned int rowSize = gridSize + 1;
+		for (unsigned int y = 0; y <= gridSize; y++)
+		{
+			for (unsigned int x = 0; x <= gridSize; x++)
+			{
+				const float u = static_cast<float>(x) / gridSize, v = static_cast<float>(y) / gridSize;
+				const float height = 0.05f * std::sin(u * 20.0f) * std::cos(v * 20.0f);
+				obj << "v " << u << " " << height << " " << v << "\n";
+				obj << "vt " << u << " " << v << "\n";
+				obj << "vn " << -std::cos(u * 20.0f) * std::cos(v * 20.0f) << " 1 " << std::sin(u * 20.0f) * std::sin(v * 20.0f) << "\n";
+			}
+		}
+
+		const unsigned int bandRows = (gridSize + materialCount - 1) / materialCount;
+		for (unsigned int y = 0; y < gridSize; y++)
+		{
+			if (y % bandRows == 0)
+				obj << "usemtl band" << y / bandRows << "\n";
+			for (unsigned int x = 0; x < gridSize; x++)
+			{
+				const unsigned int corners[4] = { y * rowSize + x + 1, y * rowSize + x + 2, (y + 1) * rowSize + x + 2, (y + 1) * rowSize + x + 1 };
+				obj << "f";
+				for (unsigned int corner : corners)
+					obj << " " << corner << "/" << corner << "/" << corner;
+				obj << "\n";
+			}
+		}
+		return objPath.string();
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace DX12Engine
+{
+	typedef std::vector<std::string> BenchmarkArgs;
+
+	// Every benchmark takes the arguments after its name and prints its own report
+	void RunMeshCacheBenchmark(const BenchmarkArgs& args);
+	void RunVertexWeldMapBenchmark(const BenchmarkArgs& args);
+	void RunObjImportBenchmark(const BenchmarkArgs& args);
+	void RunObjMemoryBenchmark(const BenchmarkArgs& args);
+	void RunTangentBenchmark(const BenchmarkArgs& args);
+	void RunMaterialLoaderBenchmark(const BenchmarkArgs& args);
+	void RunBuddyAllocatorBenchmark(const BenchmarkArgs& args);
+
+	template<typename Func>
+	double MeasureMilliseconds(Func&& func)
+	{
+		auto start = std::chrono::steady_clock::now();
+		func();
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// Argument index as a number, or fallback if it is missing
+	unsigned int GetArgument(const BenchmarkArgs& args, size_t index, unsigned int fallback);
+	std::string GetArgument(const BenchmarkArgs& args, size_t index, const std::string& fallback);
+
+	// Writes a gridSize x gridSize quad grid with positions, normals and UVs to the temp directory, split into materialCount
+	// bands of rows that each use their own material from a matching .mtl file. Returns the OBJ path
+	std::string WriteGridObj(const std::string& name, unsigned int gridSize, unsigned int materialCount = 1);
+}
@@ -0,0 +1,77 @@
+#include "Benchmarks.h"
+#include "DX12Engine/Rendering/BuddyAllocator.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+namespace DX12Engine
+{
+	// Churns one heap with placed-resource sized allocations the way streaming does: allocate until the heap refuses,
+	// then free random resources down to half the heap and repeat. Reports the internal fragmentation (rounding to
+	// blocks), how often a request failed although the free bytes would have held it (external fragmentation) and the
+	// cost per operation
+	void RunBuddyAllocatorBenchmark(const BenchmarkArgs& args)
+	{
+		const uint64_t heapSize = static_cast<uint64_t>((std::max)(1u, GetArgument(args, 0, 64u))) << 20;
+		const unsigned int rounds = (std::max)(1u, GetArgument(args, 1, 1000u));
+		const uint64_t blockSize = 64 << 10; // D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT
+
+		// Mip chains of square BC textures from 128 to 2048 and buffers of up to 2 MB, in 64 KB pages like the driver
+		// reports them
+		std::vector<uint64_t> sizes;
+		for (uint64_t width = 128; width <= 2048; width *= 2)
+			sizes.push_back(width * width * 4 / 3);
+		for (uint64_t size = 96 << 10; size <= (2 << 20); size += 160 << 10)
+			sizes.push_back(size);
+		for (uint64_t& size : sizes)
+			size = (size + blockSize - 1) / blockSize * blockSize;
+
+		BuddyAllocator allocator(heapSize, blockSize);
+		std::vector<std::pair<uint64_t, uint64_t>> live; // Offset and requested size
+		std::mt19937 random(1234);
+		uint64_t operations = 0, failures = 0, failuresWithRoom = 0, requestedBytes = 0;
+		double usedAtFailure = 0.0, requestedAtFailure = 0.0, largestFreeAtFailure = 0.0;
+
+		const double milliseconds = MeasureMilliseconds([&]()
+		{
+			for (unsigned int round = 0; round < rounds; round++)
+			{
+				for (;;)
+				{
+					const uint64_t size = sizes[random() % sizes.size()];
+					uint64_t offset = 0;
+					operations++;
+					if (!allocator.Allocate(size, blockSize, offset))
+					{
+						const uint64_t freeBytes = heapSize - allocator.GetUsedSize();
+						failures++;
+						failuresWithRoom += freeBytes >= size ? 1 : 0;
+						usedAtFailure += static_cast<double>(allocator.GetUsedSize());
+						requestedAtFailure += static_cast<double>(requestedBytes);
+						largestFreeAtFailure += freeBytes ? static_cast<double>(allocator.GetLargestFreeBlock()) / freeBytes : 1.0;
+						break;
+					}
+					live.push_back({ offset, size });
+					requestedBytes += size;
+				}
+				while (allocator.GetUsedSize() > heapSize / 2)
+				{
+					const size_t index = random() % live.size();
+					allocator.Free(live[index].first);
+					requestedBytes -= live[index].second;
+					live[index] = live.back();
+					live.pop_back();
+					operations++;
+				}
+			}
+		});
+
+		std::cout << (heapSize >> 20) << " MB heap, " << rounds << " fill and free rounds, " << operations << " operations in "
+			<< milliseconds << " ms (" << milliseconds * 1e6 / operations << " ns each)" << std::endl;
+		std::cout << "Full heap: " << 100.0 * usedAtFailure / failures / heapSize << "% in blocks, "
+			<< 100.0 * requestedAtFailure / failures / heapSize << "% requested, so "
+			<< 100.0 * (1.0 - requestedAtFailure / usedAtFailure) << "% of the used blocks is rounding" << std::endl;
+		std::cout << "Failed with enough free bytes: " << failuresWithRoom << " of " << failures << ", largest free block "
+			<< 100.0 * largestFreeAtFailure / failures << "% of the free bytes on average" << std::endl;
+	}
+}
@@ -0,0 +1,52 @@
+#include "Benchmarks.h"
+#include "DX12Engine/IO/MaterialLoader.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+namespace DX12Engine
+{
+	// Decodes every material directory below the given one with MaterialLoader over doubling thread counts, up to the
+	// hardware threads by default. An untimed pass cooks missing maps first, so every timed pass reads the same cooked
+	// images. Only the decode is timed, creating and uploading the textures needs a device. Best of the iterations
+	void RunMaterialLoaderBenchmark(const BenchmarkArgs& args)
+	{
+		const std::filesystem::path directory = GetArgument(args, 0, std::string("res/Materials"));
+		const unsigned int iterations = (std::max)(1u, GetArgument(args, 1, 3u));
+		const unsigned int maxThreads = (std::max)(1u, GetArgument(args, 2, std::thread::hardware_concurrency()));
+
+		std::vector<std::wstring> materials;
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory))
+		{
+			if (entry.is_directory())
+				materials.push_back(entry.path().wstring());
+		}
+		if (materials.empty())
+			throw std::runtime_error("No material directories in " + directory.string());
+
+		auto decodeAll = [&](unsigned int threadCount)
+		{
+			MaterialLoader loader(threadCount);
+			for (const std::wstring& material : materials)
+				loader.Request(material);
+			loader.WaitForDecodes();
+		};
+		std::cout << directory.string() << ": " << materials.size() << " materials, cooking pass " << MeasureMilliseconds([&]() { decodeAll(maxThreads); }) << " ms" << std::endl;
+
+		double serialBest = 0.0;
+		for (unsigned int threadCount = 1; ; threadCount = (std::min)(threadCount * 2, maxThreads))
+		{
+			double best = 1e30;
+			for (unsigned int i = 0; i < iterations; i++)
+				best = (std::min)(best, MeasureMilliseconds([&]() { decodeAll(threadCount); }));
+
+			if (threadCount == 1)
+				serialBest = best;
+			std::cout << threadCount << " threads: " << best << " ms (" << serialBest / best << "x)" << std::endl;
+			if (threadCount == maxThreads)
+				break;
+		}
+	}
+}
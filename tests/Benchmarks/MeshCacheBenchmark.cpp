@@ -0,0 +1,50 @@
+#include "Benchmarks.h"
+#include "DX12Engine/IO/ModelLoader.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace DX12Engine
+{
+	// Cold loads parse, process and cook the OBJ, warm loads validate and map the cooked file. Best of the iterations
+	void RunMeshCacheBenchmark(const BenchmarkArgs& args)
+	{
+		const std::string path = GetArgument(args, 0, std::string());
+		const std::string objPath = path.empty() ? WriteGridObj("meshcache", 512) : path;
+		const unsigned int iterations = (std::max)(1u, GetArgument(args, 1, 5u));
+		const std::string cachePath = MeshCache::GetCachePath(objPath);
+
+		ModelLoader loader;
+		double coldBest = 1e30, warmBest = 1e30;
+		UINT vertexCount = 0, indexCount = 0;
+		std::vector<uint8_t> staging;
+		for (unsigned int i = 0; i < iterations; i++)
+		{
+			std::filesystem::remove(cachePath);
+			coldBest = (std::min)(coldBest, MeasureMilliseconds([&]() { loader.LoadObjCached(objPath); }));
+		}
+		for (unsigned int i = 0; i < iterations; i++)
+		{
+			warmBest = (std::min)(warmBest, MeasureMilliseconds([&]()
+			{
+				// Mapping alone reads nothing, so copy the streams like the upload to staging memory does
+				std::unique_ptr<CookedMesh> mesh = loader.LoadObjCached(objPath);
+				vertexCount = mesh->GetVertexCount();
+				indexCount = mesh->GetIndexCount();
+				const size_t positionSize = static_cast<size_t>(GetPositionStride(mesh->GetVertexFormat())) * vertexCount;
+				const size_t attributeSize = static_cast<size_t>(GetAttributeStride(mesh->GetVertexFormat())) * vertexCount;
+				const size_t indexSize = static_cast<size_t>(mesh->GetIndexStride()) * indexCount;
+				staging.resize(positionSize + attributeSize + indexSize);
+				memcpy(staging.data(), mesh->GetPositionData(), positionSize);
+				memcpy(staging.data() + positionSize, mesh->GetAttributeData(), attributeSize);
+				memcpy(staging.data() + positionSize + attributeSize, mesh->GetIndexData(), indexSize);
+			}));
+		}
+
+		std::cout << objPath << ": " << vertexCount << " vertices, " << indexCount / 3 << " triangles (LOD chain included), cache "
+			<< (std::filesystem::file_size(cachePath) >> 10) << " KB" << std::endl;
+		std::cout << "cold (import + cook):      " << coldBest << " ms" << std::endl;
+		std::cout << "warm (map + stream copy):  " << warmBest << " ms, " << coldBest / warmBest << "x faster" << std::endl;
+	}
+}
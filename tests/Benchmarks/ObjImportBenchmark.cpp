@@ -0,0 +1,97 @@
+#include "Benchmarks.h"
+#include "DX12Engine/IO/ModelLoader.h"
+#include "DX12Engine/IO/ObjStreamReader.h"
+#include "DX12Engine/Geometry/TangentGenerator.h"
+#include "tiny_obj_loader.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <windows.h>
+#include <psapi.h>
+
+namespace DX12Engine
+{
+	// Streaming OBJ import with ParallelImport over doubling thread counts, up to the hardware threads by default. The
+	// parse and tangent passes are also timed on their own since the optimizer and simplifier stay serial. Best of the
+	// iterations
+	void RunObjImportBenchmark(const BenchmarkArgs& args)
+	{
+		const std::string path = GetArgument(args, 0, std::string());
+		const std::string objPath = path.empty() ? WriteGridObj("objimport", 512, 4) : path;
+		const unsigned int iterations = (std::max)(1u, GetArgument(args, 1, 3u));
+		const unsigned int maxThreads = (std::max)(1u, GetArgument(args, 2, std::thread::hardware_concurrency()));
+
+		ModelLoader loader;
+		double serialBest[3] = {};
+		for (unsigned int threadCount = 1; ; threadCount = (std::min)(threadCount * 2, maxThreads))
+		{
+			ModelLoadOptions options;
+			options.ParallelImport = threadCount > 1;
+			options.ThreadCount = threadCount;
+
+			double best[3] = { 1e30, 1e30, 1e30 };
+			Mesh mesh;
+			for (unsigned int i = 0; i < iterations; i++)
+			{
+				best[0] = (std::min)(best[0], MeasureMilliseconds([&]() { mesh = ObjStreamReader(threadCount).Read(objPath); }));
+				best[1] = (std::min)(best[1], MeasureMilliseconds([&]() { TangentGenerator::Generate(mesh, threadCount); }));
+				best[2] = (std::min)(best[2], MeasureMilliseconds([&]() { loader.LoadObj(objPath, options); }));
+			}
+
+			if (threadCount == 1)
+			{
+				std::copy_n(best, 3, serialBest);
+				std::cout << objPath << ": " << mesh.Indices.size() / 3 << " triangles, " << mesh.Vertices.size() << " vertices" << std::endl;
+			}
+			std::cout << threadCount << " threads: parse " << best[0] << " ms (" << serialBest[0] / best[0] << "x), tangents "
+				<< best[1] << " ms (" << serialBest[1] / best[1] << "x), full import " << best[2] << " ms (" << serialBest[2] / best[2] << "x)" << std::endl;
+			if (threadCount == maxThreads)
+				break;
+		}
+	}
+
+	static size_t GetPeakWorkingSet()
+	{
+		PROCESS_MEMORY_COUNTERS counters = {};
+		counters.cb = sizeof(counters);
+		GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+		return counters.PeakWorkingSetSize;
+	}
+
+	// Peak working set growth of parsing an OBJ, and of the whole serial LoadObj after it, against the file and mesh sizes.
+	// The peak only ever grows, so each import mode needs its own process run
+	void RunObjMemoryBenchmark(const BenchmarkArgs& args)
+	{
+		const std::string path = GetArgument(args, 0, std::string());
+		const std::string objPath = path.empty() ? WriteGridObj("objmemory", 1024, 4) : path;
+		const std::string mode = GetArgument(args, 1, std::string("streaming"));
+		if (mode != "streaming" && mode != "tinyobj")
+			throw std::runtime_error("Unknown import mode " + mode + ", expected streaming or tinyobj");
+
+		const size_t peakBefore = GetPeakWorkingSet();
+		if (mode == "streaming")
+		{
+			ObjStreamReader().Read(objPath);
+		}
+		else
+		{
+			tinyobj::ObjReader reader;
+			if (!reader.ParseFromFile(objPath))
+				throw std::runtime_error("Failed to parse " + objPath);
+		}
+		const size_t peakParsed = GetPeakWorkingSet();
+
+		ModelLoadOptions options;
+		options.StreamingImport = mode == "streaming";
+		Mesh mesh = ModelLoader().LoadObj(objPath, options);
+		const size_t peakImported = GetPeakWorkingSet();
+
+		const double megabyte = 1024.0 * 1024.0;
+		const size_t meshSize = mesh.Vertices.size() * sizeof(Vertex) + mesh.Indices.size() * sizeof(UINT);
+		std::cout << objPath << ": " << std::filesystem::file_size(objPath) / megabyte << " MB file, " << meshSize / megabyte << " MB mesh" << std::endl;
+		std::cout << mode << ": peak working set grew by " << (peakParsed - peakBefore) / megabyte << " MB parsing and by "
+			<< (peakImported - peakBefore) / megabyte << " MB with the whole import" << std::endl;
+	}
+}
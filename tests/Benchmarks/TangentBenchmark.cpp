@@ -0,0 +1,82 @@
+#include "Benchmarks.h"
+#include "DX12Engine/IO/ObjStreamReader.h"
+#include "DX12Engine/Geometry/TangentGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace DX12Engine
+{
+	// The same frames computed one triangle and one vertex at a time, as a baseline for the batched passes
+	static void GenerateScalar(Mesh& mesh)
+	{
+		std::vector<DirectX::XMFLOAT3> tangents(mesh.Vertices.size()), bitangents(mesh.Vertices.size());
+		for (size_t i = 0; i + 2 < mesh.Indices.size(); i += 3)
+		{
+			const Vertex& a = mesh.Vertices[mesh.Indices[i]];
+			const Vertex& b = mesh.Vertices[mesh.Indices[i + 1]];
+			const Vertex& c = mesh.Vertices[mesh.Indices[i + 2]];
+			const float x1 = b.Position.x - a.Position.x, x2 = c.Position.x - a.Position.x;
+			const float y1 = b.Position.y - a.Position.y, y2 = c.Position.y - a.Position.y;
+			const float z1 = b.Position.z - a.Position.z, z2 = c.Position.z - a.Position.z;
+			const float s1 = b.TexCoord.x - a.TexCoord.x, s2 = c.TexCoord.x - a.TexCoord.x;
+			const float t1 = b.TexCoord.y - a.TexCoord.y, t2 = c.TexCoord.y - a.TexCoord.y;
+			const float det = s1 * t2 - s2 * t1;
+			if (std::fabs(det) <= 1e-20f)
+				continue;
+
+			const float sx = t2 * x1 - t1 * x2, sy = t2 * y1 - t1 * y2, sz = t2 * z1 - t1 * z2;
+			const float tx = s1 * x2 - s2 * x1, ty = s1 * y2 - s2 * y1, tz = s1 * z2 - s2 * z1;
+			const float sLength = std::sqrt(sx * sx + sy * sy + sz * sz), tLength = std::sqrt(tx * tx + ty * ty + tz * tz);
+			if (sLength <= 0.0f || tLength <= 0.0f)
+				continue;
+			const float cx = y1 * z2 - z1 * y2, cy = z1 * x2 - x1 * z2, cz = x1 * y2 - y1 * x2;
+			const float area = (det < 0.0f ? -0.5f : 0.5f) * std::sqrt(cx * cx + cy * cy + cz * cz);
+			for (size_t corner = 0; corner < 3; corner++)
+			{
+				DirectX::XMFLOAT3& tangent = tangents[mesh.Indices[i + corner]];
+				DirectX::XMFLOAT3& bitangent = bitangents[mesh.Indices[i + corner]];
+				tangent = { tangent.x + sx * area / sLength, tangent.y + sy * area / sLength, tangent.z + sz * area / sLength };
+				bitangent = { bitangent.x + tx * area / tLength, bitangent.y + ty * area / tLength, bitangent.z + tz * area / tLength };
+			}
+		}
+
+		for (size_t v = 0; v < mesh.Vertices.size(); v++)
+		{
+			const DirectX::XMVECTOR n = DirectX::XMLoadFloat3(&mesh.Vertices[v].Normal);
+			DirectX::XMVECTOR t = DirectX::XMLoadFloat3(&tangents[v]);
+			t = DirectX::XMVector3Normalize(DirectX::XMVectorSubtract(t, DirectX::XMVectorScale(n, DirectX::XMVectorGetX(DirectX::XMVector3Dot(n, t)))));
+			const float w = DirectX::XMVectorGetX(DirectX::XMVector3Dot(DirectX::XMVector3Cross(n, t), DirectX::XMLoadFloat3(&bitangents[v]))) < 0.0f ? -1.0f : 1.0f;
+			DirectX::XMStoreFloat4(&mesh.Vertices[v].Tangent, DirectX::XMVectorSetW(t, w));
+		}
+	}
+
+	// Batched TangentGenerator on one thread against the scalar baseline, best of the iterations
+	void RunTangentBenchmark(const BenchmarkArgs& args)
+	{
+		const std::string path = GetArgument(args, 0, std::string());
+		const std::string objPath = path.empty() ? WriteGridObj("tangents", 1024) : path;
+		const unsigned int iterations = (std::max)(1u, GetArgument(args, 1, 5u));
+		Mesh mesh = ObjStreamReader().Read(objPath);
+		Mesh scalarMesh = mesh;
+
+		double best = 1e30, scalarBest = 1e30;
+		for (unsigned int i = 0; i < iterations; i++)
+		{
+			best = (std::min)(best, MeasureMilliseconds([&]() { TangentGenerator::Generate(mesh); }));
+			scalarBest = (std::min)(scalarBest, MeasureMilliseconds([&]() { GenerateScalar(scalarMesh); }));
+		}
+
+		float maxDifference = 0.0f;
+		for (size_t v = 0; v < mesh.Vertices.size(); v++)
+		{
+			const DirectX::XMFLOAT4& a = mesh.Vertices[v].Tangent;
+			const DirectX::XMFLOAT4& b = scalarMesh.Vertices[v].Tangent;
+			maxDifference = (std::max)({ maxDifference, std::fabs(a.x - b.x), std::fabs(a.y - b.y), std::fabs(a.z - b.z), std::fabs(a.w - b.w) });
+		}
+
+		std::cout << objPath << ": " << mesh.Indices.size() / 3 << " triangles, " << mesh.Vertices.size() << " vertices, max difference " << maxDifference << std::endl;
+		std::cout << "scalar:            " << scalarBest << " ms" << std::endl;
+		std::cout << "TangentGenerator:  " << best << " ms, " << scalarBest / best << "x faster" << std::endl;
+	}
+}
@@ -0,0 +1,106 @@
+#include "Benchmarks.h"
+#include "DX12Engine/IO/VertexWeldMap.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace DX12Engine
+{
+	// Triangle corners of every face in the OBJ, fan triangulated and with relative indices resolved like the loaders do
+	static std::vector<VertexKey> ReadCornerKeys(const std::string& path)
+	{
+		std::ifstream file(path);
+		if (!file)
+			throw std::runtime_error("Failed to open " + path);
+
+		std::vector<VertexKey> keys, face;
+		int32_t counts[3] = {};
+		std::string line, corner;
+		while (std::getline(file, line))
+		{
+			if (line.compare(0, 2, "v ") == 0)
+				counts[0]++;
+			else if (line.compare(0, 3, "vn ") == 0)
+				counts[1]++;
+			else if (line.compare(0, 3, "vt ") == 0)
+				counts[2]++;
+			if (line.compare(0, 2, "f ") != 0)
+				continue;
+
+			face.clear();
+			std::istringstream stream(line.substr(2));
+			while (stream >> corner)
+			{
+				// v, v/vt, v//vn or v/vt/vn, stored as position, normal, texcoord with -1 for a missing one
+				int32_t indices[3] = { 0, 0, 0 };
+				size_t start = 0;
+				for (int component = 0; component < 3 && start <= corner.size(); component++)
+				{
+					const size_t end = (std::min)(corner.find('/', start), corner.size());
+					if (end > start)
+						indices[component] = std::stoi(corner.substr(start, end - start));
+					start = end + 1;
+				}
+				const int32_t position = indices[0], texCoord = indices[1], normal = indices[2];
+				face.push_back({
+					position < 0 ? counts[0] + position : position - 1,
+					normal < 0 ? counts[1] + normal : normal - 1,
+					texCoord < 0 ? counts[2] + texCoord : texCoord - 1 });
+			}
+			for (size_t i = 2; i < face.size(); i++)
+				keys.insert(keys.end(), { face[0], face[i - 1], face[i] });
+		}
+		return keys;
+	}
+
+	// Welds the corners of an OBJ with VertexWeldMap and with the string-keyed unordered_map it replaced, and checks
+	// that both produce the same index buffer. Best of the iterations
+	void RunVertexWeldMapBenchmark(const BenchmarkArgs& args)
+	{
+		const std::string path = GetArgument(args, 0, std::string());
+		const std::string objPath = path.empty() ? WriteGridObj("weldmap", 1024) : path;
+		const unsigned int iterations = (std::max)(1u, GetArgument(args, 1, 5u));
+		const std::vector<VertexKey> keys = ReadCornerKeys(objPath);
+
+		std::vector<uint32_t> indices(keys.size()), legacyIndices(keys.size());
+		uint32_t vertexCount = 0, legacyVertexCount = 0;
+		double best = 1e30, legacyBest = 1e30;
+		for (unsigned int i = 0; i < iterations; i++)
+		{
+			best = (std::min)(best, MeasureMilliseconds([&]()
+			{
+				VertexWeldMap map(keys.size());
+				vertexCount = 0;
+				for (size_t corner = 0; corner < keys.size(); corner++)
+				{
+					bool inserted = false;
+					indices[corner] = map.FindOrInsert(keys[corner], vertexCount, inserted);
+					vertexCount += inserted;
+				}
+			}));
+			legacyBest = (std::min)(legacyBest, MeasureMilliseconds([&]()
+			{
+				std::unordered_map<std::string, uint32_t> map;
+				legacyVertexCount = 0;
+				for (size_t corner = 0; corner < keys.size(); corner++)
+				{
+					const VertexKey& key = keys[corner];
+					std::string text = std::to_string(key.Position) + "/" + std::to_string(key.Normal) + "/" + std::to_string(key.TexCoord);
+					if (map.find(text) == map.end())
+						map[text] = legacyVertexCount++;
+					legacyIndices[corner] = map[text];
+				}
+			}));
+		}
+
+		if (vertexCount != legacyVertexCount || indices != legacyIndices)
+			throw std::runtime_error("VertexWeldMap output differs from the unordered_map weld");
+
+		std::cout << objPath << ": " << keys.size() / 3 << " triangles, " << vertexCount << " welded vertices, identical output" << std::endl;
+		std::cout << "unordered_map<string>:  " << legacyBest << " ms" << std::endl;
+		std::cout << "VertexWeldMap:          " << best << " ms, " << legacyBest / best << "x faster" << std::endl;
+	}
+}
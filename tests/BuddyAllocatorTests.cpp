@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "DX12Engine/Rendering/BuddyAllocator.h"
+#include <map>
+#include <random>
+#include <stdexcept>
+
+using namespace DX12Engine;
+
+static uint64_t AllocateAt(BuddyAllocator& allocator, uint64_t size, uint64_t alignment = 1)
+{
+	uint64_t offset = ~0ull;
+	EXPECT_TRUE(allocator.Allocate(size, alignment, offset)) << size << " bytes";
+	return offset;
+}
+
+TEST(BuddyAllocator, RoundsToBlocksAndTakesTheLowestOffset)
+{
+	BuddyAllocator allocator(1024, 64);
+	EXPECT_EQ(AllocateAt(allocator, 100), 0u);
+	EXPECT_EQ(allocator.GetUsedSize(), 128u);
+	EXPECT_EQ(AllocateAt(allocator, 1), 128u);
+	EXPECT_EQ(AllocateAt(allocator, 64), 192u);
+	EXPECT_EQ(AllocateAt(allocator, 200), 256u);
+	EXPECT_EQ(allocator.GetUsedSize(), 512u);
+	EXPECT_EQ(allocator.GetLargestFreeBlock(), 512u);
+
+	uint64_t offset = 0;
+	EXPECT_FALSE(allocator.Allocate(0, 1, offset));
+	EXPECT_FALSE(allocator.Allocate(1025, 1, offset));
+	EXPECT_FALSE(allocator.Allocate(1, 2048, offset));
+	EXPECT_EQ(allocator.GetUsedSize(), 512u);
+}
+
+TEST(BuddyAllocator, AlignmentPicksTheBlockSize)
+{
+	BuddyAllocator allocator(4096, 64);
+	EXPECT_EQ(AllocateAt(allocator, 64), 0u);
+
+	// A small allocation with a large alignment takes a whole block of that size
+	const uint64_t aligned = AllocateAt(allocator, 64, 1024);
+	EXPECT_EQ(aligned, 1024u);
+	EXPECT_EQ(allocator.GetUsedSize(), 64u + 1024u);
+
+	// The halves split off for the first allocation are still there for small ones
+	EXPECT_EQ(AllocateAt(allocator, 64, 64), 64u);
+	EXPECT_EQ(AllocateAt(allocator, 128, 128), 128u);
+}
+
+TEST(BuddyAllocator, FreeMergesBuddies)
+{
+	BuddyAllocator allocator(1024, 64);
+	const uint64_t blocks[4] = { AllocateAt(allocator, 256), AllocateAt(allocator, 256), AllocateAt(allocator, 256), AllocateAt(allocator, 256) };
+	uint64_t offset = 0;
+	EXPECT_FALSE(allocator.Allocate(64, 1, offset));
+	EXPECT_EQ(allocator.GetLargestFreeBlock(), 0u);
+
+	// 256 and 512 are neighbours but not buddies, they stay separate blocks
+	allocator.Free(blocks[1]);
+	allocator.Free(blocks[2]);
+	EXPECT_EQ(allocator.GetLargestFreeBlock(), 256u);
+	EXPECT_FALSE(allocator.Allocate(512, 1, offset));
+
+	allocator.Free(blocks[0]);
+	EXPECT_EQ(allocator.GetLargestFreeBlock(), 512u);
+	EXPECT_EQ(AllocateAt(allocator, 512), 0u);
+	allocator.Free(0);
+
+	allocator.Free(blocks[3]);
+	EXPECT_TRUE(allocator.IsEmpty());
+	EXPECT_EQ(allocator.GetUsedSize(), 0u);
+	EXPECT_EQ(allocator.GetLargestFreeBlock(), 1024u);
+	EXPECT_EQ(AllocateAt(allocator, 1024), 0u);
+}
+
+TEST(BuddyAllocator, FreeingAnUnknownOffsetThrows)
+{
+	BuddyAllocator allocator(1024, 64);
+	const uint64_t offset = AllocateAt(allocator, 128);
+	EXPECT_THROW(allocator.Free(offset + 64), std::runtime_error);
+	allocator.Free(offset);
+	EXPECT_THROW(allocator.Free(offset), std::runtime_error);
+}
+
+TEST(BuddyAllocator, RandomChurnNeverOverlaps)
+{
+	const uint64_t capacity = 1 << 20, minBlockSize = 256;
+	BuddyAllocator allocator(capacity, minBlockSize);
+	std::map<uint64_t, uint64_t> live; // Offset to rounded block size
+	std::mt19937 random(1234);
+
+	for (int step = 0; step < 20000; step++)
+	{
+		if (live.empty() || random() % 3 != 0)
+		{
+			const uint64_t size = 1 + random() % (capacity / 16);
+			const uint64_t alignment = minBlockSize << (random() % 4);
+			uint64_t offset = 0;
+			if (!allocator.Allocate(size, alignment, offset))
+				continue;
+
+			uint64_t block = minBlockSize;
+			while (block < size || block < alignment)
+				block *= 2;
+			ASSERT_EQ(offset % block, 0u);
+			ASSERT_LE(offset + block, capacity);
+			auto next = live.lower_bound(offset);
+			ASSERT_TRUE(next == live.end() || next->first >= offset + block) << "overlaps the next block";
+			ASSERT_TRUE(next == live.begin() || std::prev(next)->first + std::prev(next)->second <= offset) << "overlaps the previous block";
+			live[offset] = block;
+		}
+		else
+		{
+			auto it = std::next(live.begin(), random() % live.size());
+			allocator.Free(it->first);
+			live.erase(it);
+		}
+
+		uint64_t used = 0;
+		for (const auto& [offset, block] : live)
+			used += block;
+		ASSERT_EQ(allocator.GetUsedSize(), used);
+	}
+
+	for (const auto& [offset, block] : live)
+		allocator.Free(offset);
+	EXPECT_TRUE(allocator.IsEmpty());
+	EXPECT_EQ(allocator.GetLargestFreeBlock(), capacity);
+}
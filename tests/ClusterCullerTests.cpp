@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include "DX12Engine/Geometry/ClusterCuller.h"
+#include "DX12Engine/Geometry/MeshletBuilder.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+using namespace DX12Engine;
+
+// Camera at the origin looking down +Z with a 90 degree field of view, near 1 and far 100
+static DirectX::XMMATRIX ObjectToClip(const DirectX::XMFLOAT3& objectPosition)
+{
+	return DirectX::XMMatrixMultiply(DirectX::XMMatrixTranslation(objectPosition.x, objectPosition.y, objectPosition.z),
+		DirectX::XMMatrixPerspectiveFovLH(DirectX::XM_PIDIV2, 1.0f, 1.0f, 100.0f));
+}
+
+static Meshlet MakeSphere(const DirectX::XMFLOAT3& center, float radius)
+{
+	Meshlet meshlet = {};
+	meshlet.Center = center;
+	meshlet.Radius = radius;
+	meshlet.ConeCutoff = 1.0f;
+	return meshlet;
+}
+
+static bool IsVisible(const Meshlet& meshlet, const DirectX::XMFLOAT3* viewPosition = nullptr)
+{
+	DirectX::XMFLOAT4 planes[6];
+	ClusterCuller::ExtractFrustumPlanes(ObjectToClip({ 0.0f, 0.0f, 0.0f }), planes);
+	return ClusterCuller::IsVisible(meshlet, planes, viewPosition);
+}
+
+TEST(ClusterCuller, FrustumPlanesAreNormalizedDistances)
+{
+	DirectX::XMFLOAT4 planes[6];
+	ClusterCuller::ExtractFrustumPlanes(ObjectToClip({ 0.0f, 0.0f, 0.0f }), planes);
+
+	// Near and far planes at z = 1 and z = 100, so a point at z = 10 is 9 and 90 units inside
+	EXPECT_NEAR(planes[4].z * 10.0f + planes[4].w, 9.0f, 1e-3f);
+	EXPECT_NEAR(planes[5].z * 10.0f + planes[5].w, 90.0f, 1e-3f);
+
+	// Side planes of a 90 degree frustum are at 45 degrees, (0, 0, 10) is 10 / sqrt(2) from each
+	for (int i = 0; i < 4; i++)
+		EXPECT_NEAR(planes[i].z * 10.0f + planes[i].w, 10.0f / std::sqrt(2.0f), 1e-3f) << "plane " << i;
+}
+
+TEST(ClusterCuller, SpheresAgainstTheFrustum)
+{
+	EXPECT_TRUE(IsVisible(MakeSphere({ 0.0f, 0.0f, 10.0f }, 1.0f)));
+	EXPECT_FALSE(IsVisible(MakeSphere({ 0.0f, 0.0f, -10.0f }, 1.0f)));
+	EXPECT_FALSE(IsVisible(MakeSphere({ 0.0f, 0.0f, 110.0f }, 1.0f)));
+	EXPECT_FALSE(IsVisible(MakeSphere({ -20.0f, 0.0f, 10.0f }, 1.0f)));
+	EXPECT_FALSE(IsVisible(MakeSphere({ 0.0f, 20.0f, 10.0f }, 1.0f)));
+
+	// Centers outside a plane stay visible while the sphere still reaches into the frustum
+	EXPECT_TRUE(IsVisible(MakeSphere({ -11.0f, 0.0f, 10.0f }, 1.0f)));
+	EXPECT_TRUE(IsVisible(MakeSphere({ 0.0f, 0.0f, 0.5f }, 1.0f)));
+	EXPECT_TRUE(IsVisible(MakeSphere({ 0.0f, 0.0f, 100.5f }, 1.0f)));
+}
+
+TEST(ClusterCuller, CullUsesTheObjectTransform)
+{
+	const Meshlet meshlets[] = { MakeSphere({ 0.0f, 0.0f, 0.0f }, 1.0f), MakeSphere({ 0.0f, 0.0f, -20.0f }, 1.0f), MakeSphere({ 50.0f, 0.0f, 0.0f }, 1.0f) };
+	std::vector<UINT> visible;
+	ClusterCuller::Cull(meshlets, 3, ObjectToClip({ 0.0f, 0.0f, 30.0f }), nullptr, visible);
+	EXPECT_EQ(visible, (std::vector<UINT>{ 0, 1 }));
+}
+
+TEST(ClusterCuller, ConeRejectsMeshletsFacingAway)
+{
+	// Two triangles in the z = 10 plane whose winding faces -Z, back at the camera
+	const std::vector<DirectX::XMFLOAT3> positions = { { 0.0f, 0.0f, 10.0f }, { 0.0f, 1.0f, 10.0f }, { 1.0f, 0.0f, 10.0f }, { 1.0f, 1.0f, 10.0f } };
+	const std::vector<UINT> indices = { 0, 1, 2, 2, 1, 3 };
+	const std::vector<Meshlet> meshlets = MeshletBuilder::Build(positions.data(), sizeof(DirectX::XMFLOAT3), positions.size(),
+		indices.data(), indices.size(), 64, 124);
+	ASSERT_EQ(meshlets.size(), 1u);
+	const Meshlet& meshlet = meshlets[0];
+	EXPECT_NEAR(meshlet.ConeAxis.z, -1.0f, 1e-6f);
+	EXPECT_NEAR(meshlet.ConeCutoff, 0.0f, 1e-3f);
+
+	const DirectX::XMFLOAT3 inFront = { 0.5f, 0.5f, 0.0f }, behind = { 0.5f, 0.5f, 20.0f }, edgeOn = { 30.0f, 0.5f, 10.0f };
+	EXPECT_TRUE(IsVisible(meshlet, &inFront));
+	EXPECT_FALSE(IsVisible(meshlet, &behind));
+	EXPECT_TRUE(IsVisible(meshlet, &edgeOn));
+	EXPECT_TRUE(IsVisible(meshlet, nullptr));
+
+	// A disabled cone never culls
+	Meshlet disabled = meshlet;
+	disabled.ConeCutoff = 1.0f;
+	EXPECT_TRUE(IsVisible(disabled, &behind));
+}
+
+TEST(ClusterCuller, WideConesAreDisabled)
+{
+	// A pair of triangles folded almost flat onto each other, with normals 170 degrees apart
+	const std::vector<DirectX::XMFLOAT3> positions = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.9848f, 0.0f, -0.1736f } };
+	const std::vector<UINT> indices = { 0, 1, 2, 0, 3, 1 };
+	const std::vector<Meshlet> meshlets = MeshletBuilder::Build(positions.data(), sizeof(DirectX::XMFLOAT3), positions.size(),
+		indices.data(), indices.size(), 64, 124);
+	ASSERT_EQ(meshlets.size(), 1u);
+	EXPECT_EQ(meshlets[0].ConeCutoff, 1.0f);
+}
+
+static std::vector<Meshlet> MakeRuns(const std::vector<UINT>& indexCounts)
+{
+	std::vector<Meshlet> meshlets;
+	UINT offset = 0;
+	for (UINT count : indexCounts)
+	{
+		Meshlet meshlet = {};
+		meshlet.IndexOffset = offset;
+		meshlet.IndexCount = count;
+		meshlets.push_back(meshlet);
+		offset += count;
+	}
+	return meshlets;
+}
+
+TEST(ClusterCuller, GatherIndicesCopiesVisibleRunsInOrder)
+{
+	const std::vector<Meshlet> meshlets = MakeRuns({ 3, 6, 3, 9, 3 });
+	std::vector<UINT> source(24);
+	for (UINT i = 0; i < source.size(); i++)
+		source[i] = 100 + i;
+
+	// 1 and 2 merge into one run, 4 is a run of its own
+	const UINT visible[] = { 1, 2, 4 };
+	std::vector<UINT> destination(source.size(), 0);
+	const UINT indexCount = ClusterCuller::GatherIndices(meshlets.data(), visible, 3, source.data(), sizeof(UINT), destination.data());
+
+	std::vector<UINT> expected;
+	for (UINT m : visible)
+		expected.insert(expected.end(), source.begin() + meshlets[m].IndexOffset, source.begin() + meshlets[m].IndexOffset + meshlets[m].IndexCount);
+	ASSERT_EQ(indexCount, expected.size());
+	destination.resize(indexCount);
+	EXPECT_EQ(destination, expected);
+}
+
+TEST(ClusterCuller, GatherIndicesHandles16BitIndices)
+{
+	const std::vector<Meshlet> meshlets = MakeRuns({ 3, 3, 3 });
+	const uint16_t source[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+	const UINT visible[] = { 0, 2 };
+	uint16_t destination[9] = {};
+	EXPECT_EQ(ClusterCuller::GatherIndices(meshlets.data(), visible, 2, source, sizeof(uint16_t), destination), 6u);
+	const uint16_t expected[] = { 0, 1, 2, 6, 7, 8 };
+	EXPECT_EQ(memcmp(destination, expected, sizeof(expected)), 0);
+	EXPECT_EQ(destination[6], 0);
+
+	EXPECT_EQ(ClusterCuller::GatherIndices(meshlets.data(), visible, 0, source, sizeof(uint16_t), destination), 0u);
+}
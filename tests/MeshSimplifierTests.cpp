@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "DX12Engine/Geometry/MeshSimplifier.h"
+#include <cmath>
+#include <set>
+
+using namespace DX12Engine;
+
+static const int GridSize = 16;
+static const int SeamColumn = 8;
+
+struct Grid
+{
+	std::vector<DirectX::XMFLOAT3> Positions;
+	std::vector<UINT> Indices;
+	std::vector<bool> RightSide; // Vertex belongs to the right of the seam, corners on the seam column count as left unless duplicated
+};
+
+// Square grid in the XY plane, optionally folded into a ridge along the seam column. With a seam the vertices of the seam
+// column are duplicated and the quads right of it use the copies, like a UV seam
+static Grid MakeGrid(bool seam, float ridgeHeight = 0.0f)
+{
+	Grid grid;
+	const int rowSize = GridSize + 1;
+	for (int y = 0; y <= GridSize; y++)
+	{
+		for (int x = 0; x <= GridSize; x++)
+		{
+			grid.Positions.push_back({ (float)x, (float)y, ridgeHeight * (SeamColumn - std::abs(x - SeamColumn)) });
+			grid.RightSide.push_back(x > SeamColumn);
+		}
+	}
+	const UINT seamBase = static_cast<UINT>(grid.Positions.size());
+	if (seam)
+	{
+		for (int y = 0; y <= GridSize; y++)
+		{
+			grid.Positions.push_back(grid.Positions[y * rowSize + SeamColumn]);
+			grid.RightSide.push_back(true);
+		}
+	}
+
+	auto vertex = [&](int x, int y, bool right) -> UINT
+	{
+		return seam && right && x == SeamColumn ? seamBase + y : static_cast<UINT>(y * rowSize + x);
+	};
+	for (int y = 0; y < GridSize; y++)
+	{
+		for (int x = 0; x < GridSize; x++)
+		{
+			const bool right = x >= SeamColumn;
+			const UINT quad[4] = { vertex(x, y, right), vertex(x + 1, y, right), vertex(x + 1, y + 1, right), vertex(x, y + 1, right) };
+			grid.Indices.insert(grid.Indices.end(), { quad[0], quad[1], quad[2], quad[0], quad[2], quad[3] });
+		}
+	}
+	return grid;
+}
+
+static std::vector<UINT> Simplify(const Grid& grid, size_t targetIndexCount, float targetError, float* resultError = nullptr)
+{
+	return MeshSimplifier::Simplify(grid.Positions.data(), sizeof(DirectX::XMFLOAT3), grid.Positions.size(),
+		grid.Indices.data(), grid.Indices.size(), targetIndexCount, targetError, resultError);
+}
+
+// Area of the XY projection, which stays the grid area as long as no triangle flips or a hole opens
+static float ProjectedArea(const Grid& grid, const std::vector<UINT>& indices)
+{
+	float area = 0.0f;
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		const DirectX::XMFLOAT3& a = grid.Positions[indices[i]], & b = grid.Positions[indices[i + 1]], & c = grid.Positions[indices[i + 2]];
+		area += 0.5f * ((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y));
+	}
+	return area;
+}
+
+TEST(MeshSimplifier, FlatGridCollapsesToItsBorder)
+{
+	const Grid grid = MakeGrid(false);
+	float error = -1.0f;
+	const std::vector<UINT> indices = Simplify(grid, 0, 1.0f, &error);
+
+	EXPECT_LT(indices.size(), grid.Indices.size() / 4);
+	EXPECT_FLOAT_EQ(ProjectedArea(grid, indices), (float)(GridSize * GridSize));
+	EXPECT_NEAR(error, 0.0f, 1e-3f);
+	for (UINT index : indices)
+	{
+		const DirectX::XMFLOAT3& p = grid.Positions[index];
+		EXPECT_TRUE(p.x == 0.0f || p.y == 0.0f || p.x == GridSize || p.y == GridSize) << "interior vertex " << index << " survived";
+	}
+}
+
+TEST(MeshSimplifier, SeamVerticesCollapseAlongTheSeam)
+{
+	const Grid grid = MakeGrid(true);
+	const std::vector<UINT> indices = Simplify(grid, 0, 1.0f);
+
+	EXPECT_LT(indices.size(), grid.Indices.size() / 4);
+	EXPECT_FLOAT_EQ(ProjectedArea(grid, indices), (float)(GridSize * GridSize));
+
+	// Each triangle keeps the attributes of one side, and the seam itself lost its interior vertices
+	std::set<float> seamRows;
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		const bool right = grid.RightSide[indices[i]] || grid.RightSide[indices[i + 1]] || grid.RightSide[indices[i + 2]];
+		for (UINT corner = 0; corner < 3; corner++)
+		{
+			const UINT index = indices[i + corner];
+			const DirectX::XMFLOAT3& p = grid.Positions[index];
+			if (p.x == SeamColumn)
+			{
+				EXPECT_EQ(grid.RightSide[index], right) << "triangle " << i / 3 << " crosses the seam";
+				seamRows.insert(p.y);
+			}
+			else
+			{
+				EXPECT_EQ(p.x > SeamColumn, right) << "triangle " << i / 3 << " crosses the seam";
+			}
+		}
+	}
+	EXPECT_LT(seamRows.size(), (size_t)GridSize / 2);
+}
+
+TEST(MeshSimplifier, SeamMatchesTheSimplificationWithoutIt)
+{
+	// Welding the seam for collapses means it no longer holds the surface back
+	const std::vector<UINT> welded = Simplify(MakeGrid(false), 0, 1.0f);
+	const std::vector<UINT> seam = Simplify(MakeGrid(true), 0, 1.0f);
+	EXPECT_LE(seam.size(), welded.size() + 12);
+}
+
+TEST(MeshSimplifier, TargetErrorKeepsTheRidge)
+{
+	const Grid grid = MakeGrid(false, 0.25f);
+	float error = -1.0f;
+	const std::vector<UINT> indices = Simplify(grid, 0, 1e-3f, &error);
+
+	EXPECT_LT(indices.size(), grid.Indices.size() / 2);
+	EXPECT_LE(error, 1e-3f);
+	EXPECT_FLOAT_EQ(ProjectedArea(grid, indices), (float)(GridSize * GridSize));
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		const float x[3] = { grid.Positions[indices[i]].x, grid.Positions[indices[i + 1]].x, grid.Positions[indices[i + 2]].x };
+		EXPECT_FALSE((std::min)({ x[0], x[1], x[2] }) < SeamColumn && (std::max)({ x[0], x[1], x[2] }) > SeamColumn) << "triangle " << i / 3 << " cuts the ridge";
+	}
+}
+
+TEST(MeshSimplifier, StopsAtTheTargetIndexCount)
+{
+	const Grid grid = MakeGrid(true);
+	const size_t target = grid.Indices.size() / 2;
+	const std::vector<UINT> indices = Simplify(grid, target, 1.0f);
+	EXPECT_LE(indices.size(), target);
+	EXPECT_GE(indices.size(), target - 6);
+}
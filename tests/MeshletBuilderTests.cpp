@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "DX12Engine/Geometry/MeshletBuilder.h"
+#include <cmath>
+#include <random>
+#include <set>
+
+using namespace DX12Engine;
+
+// Random triangles over a small vertex pool, so meshlets hit the vertex limit as well as the triangle limit
+static void MakeRandomTriangles(size_t vertexCount, size_t triangleCount, uint32_t seed, std::vector<DirectX::XMFLOAT3>& positions, std::vector<UINT>& indices)
+{
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+	std::uniform_int_distribution<UINT> vertex(0, static_cast<UINT>(vertexCount - 1));
+	positions.resize(vertexCount);
+	for (DirectX::XMFLOAT3& p : positions)
+		p = { value(random), value(random), value(random) };
+	indices.resize(triangleCount * 3);
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		// Neighbouring triangles share a corner like an optimized index buffer would
+		indices[t * 3] = t > 0 ? indices[t * 3 - 1] : vertex(random);
+		indices[t * 3 + 1] = vertex(random);
+		indices[t * 3 + 2] = vertex(random);
+	}
+}
+
+TEST(MeshletBuilder, MeshletsRespectLimitsAndCoverTheIndexBuffer)
+{
+	std::vector<DirectX::XMFLOAT3> positions;
+	std::vector<UINT> indices;
+	MakeRandomTriangles(5000, 20000, 1, positions, indices);
+
+	for (auto [maxVertices, maxTriangles] : { std::pair<UINT, UINT>{ 64, 124 }, { 128, 32 }, { 3, 1 } })
+	{
+		const std::vector<Meshlet> meshlets = MeshletBuilder::Build(positions.data(), sizeof(DirectX::XMFLOAT3), positions.size(),
+			indices.data(), indices.size(), maxVertices, maxTriangles);
+
+		UINT nextIndex = 0;
+		for (const Meshlet& meshlet : meshlets)
+		{
+			ASSERT_EQ(meshlet.IndexOffset, nextIndex);
+			ASSERT_GT(meshlet.IndexCount, 0u);
+			EXPECT_EQ(meshlet.IndexCount % 3, 0u);
+			EXPECT_LE(meshlet.IndexCount / 3, maxTriangles);
+
+			const std::set<UINT> unique(indices.begin() + meshlet.IndexOffset, indices.begin() + meshlet.IndexOffset + meshlet.IndexCount);
+			EXPECT_EQ(meshlet.VertexCount, unique.size());
+			EXPECT_LE(meshlet.VertexCount, maxVertices);
+			nextIndex += meshlet.IndexCount;
+		}
+		EXPECT_EQ(nextIndex, indices.size());
+	}
+}
+
+TEST(MeshletBuilder, DegenerateTrianglesCountVerticesOnce)
+{
+	const std::vector<DirectX::XMFLOAT3> positions = { { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } };
+	const std::vector<UINT> indices = { 0, 0, 0, 1, 1, 2, 0, 1, 2 };
+	const std::vector<Meshlet> meshlets = MeshletBuilder::Build(positions.data(), sizeof(DirectX::XMFLOAT3), positions.size(),
+		indices.data(), indices.size(), 3, 8);
+	ASSERT_EQ(meshlets.size(), 1u);
+	EXPECT_EQ(meshlets[0].VertexCount, 3u);
+}
+
+TEST(MeshletBuilder, MeshletsStayInsideTheirSubmesh)
+{
+	Mesh mesh;
+	std::vector<DirectX::XMFLOAT3> positions;
+	MakeRandomTriangles(1000, 3000, 2, positions, mesh.Indices);
+	for (const DirectX::XMFLOAT3& p : positions)
+		mesh.Vertices.push_back({ p, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f, 1.0f } });
+	mesh.Submeshes = { { 0, 999, 0, 0, 0 }, { 999, 6000, 1, 0, 0 }, { 6999, 2001, 2, 0, 0 } };
+
+	MeshletBuilder::Build(mesh, 64, 124, 3);
+	UINT meshletOffset = 0;
+	for (const Submesh& submesh : mesh.Submeshes)
+	{
+		EXPECT_EQ(submesh.MeshletOffset, meshletOffset);
+		UINT indexCount = 0;
+		for (UINT m = submesh.MeshletOffset; m < submesh.MeshletOffset + submesh.MeshletCount; m++)
+		{
+			EXPECT_EQ(mesh.Meshlets[m].IndexOffset, submesh.IndexOffset + indexCount);
+			indexCount += mesh.Meshlets[m].IndexCount;
+		}
+		EXPECT_EQ(indexCount, submesh.IndexCount);
+		meshletOffset += submesh.MeshletCount;
+	}
+	EXPECT_EQ(meshletOffset, mesh.Meshlets.size());
+}
+
+TEST(MeshletBuilder, BoundsContainEveryVertex)
+{
+	std::vector<DirectX::XMFLOAT3> positions;
+	std::vector<UINT> indices;
+	MakeRandomTriangles(2000, 4000, 3, positions, indices);
+	const std::vector<Meshlet> meshlets = MeshletBuilder::Build(positions.data(), sizeof(DirectX::XMFLOAT3), positions.size(),
+		indices.data(), indices.size(), 64, 124);
+	for (const Meshlet& meshlet : meshlets)
+	{
+		for (UINT i = meshlet.IndexOffset; i < meshlet.IndexOffset + meshlet.IndexCount; i++)
+		{
+			const DirectX::XMFLOAT3& p = positions[indices[i]];
+			const float dx = p.x - meshlet.Center.x, dy = p.y - meshlet.Center.y, dz = p.z - meshlet.Center.z;
+			EXPECT_LE(std::sqrt(dx * dx + dy * dy + dz * dz), meshlet.Radius * (1.0f + 1e-6f));
+		}
+	}
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "DX12Engine/Imaging/MipGenerator.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace DX12Engine;
+
+static DirectX::ScratchImage MakeImage(DXGI_FORMAT format, UINT width, UINT height, UINT channels, const std::vector<uint8_t>& pixels)
+{
+	DirectX::ScratchImage image;
+	EXPECT_FALSE(FAILED(image.Initialize2D(format, width, height, 1, 1)));
+	const DirectX::Image* level = image.GetImage(0, 0, 0);
+	for (UINT y = 0; y < height; y++)
+		memcpy(level->pixels + y * level->rowPitch, pixels.data() + static_cast<size_t>(y) * width * channels, static_cast<size_t>(width) * channels);
+	return image;
+}
+
+static uint8_t GetTexel(const DirectX::ScratchImage& image, size_t mip, UINT x, UINT y, UINT channels, UINT channel = 0)
+{
+	const DirectX::Image* level = image.GetImage(mip, 0, 0);
+	return level->pixels[y * level->rowPitch + static_cast<size_t>(x) * channels + channel];
+}
+
+static float SrgbToLinear(uint8_t value)
+{
+	float c = value / 255.0f;
+	return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static uint8_t LinearToSrgb(float value)
+{
+	float srgb = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+	return static_cast<uint8_t>(srgb * 255.0f + 0.5f);
+}
+
+TEST(MipGenerator, EvenSizesAverageTwoByTwo)
+{
+	const std::vector<uint8_t> pixels = { 0, 40, 80, 120, 200, 240, 160, 40 };
+	DirectX::ScratchImage result;
+	MipGenerator::Generate(MakeImage(DXGI_FORMAT_R8_UNORM, 4, 2, 1, pixels), MipFilter::Linear, result);
+	ASSERT_EQ(result.GetMetadata().mipLevels, 3u);
+	EXPECT_EQ(GetTexel(result, 0, 3, 1, 1), 40);
+	EXPECT_EQ(GetTexel(result, 1, 0, 0, 1), 120); // (0 + 40 + 200 + 240) / 4
+	EXPECT_EQ(GetTexel(result, 1, 1, 0, 1), 100); // (80 + 120 + 160 + 40) / 4
+	EXPECT_EQ(GetTexel(result, 2, 0, 0, 1), 110);
+}
+
+TEST(MipGenerator, OddSizesKeepTheLastRowAndColumn)
+{
+	// Only the last column and row are set, a 2x2 filter that drops them would give black everywhere
+	std::vector<uint8_t> pixels(5 * 3, 0);
+	for (UINT y = 0; y < 3; y++)
+		pixels[y * 5 + 4] = 90;
+	for (UINT x = 0; x < 5; x++)
+		pixels[2 * 5 + x] = 90;
+	DirectX::ScratchImage result;
+	MipGenerator::Generate(MakeImage(DXGI_FORMAT_R8_UNORM, 5, 3, 1, pixels), MipFilter::Linear, result);
+	ASSERT_EQ(result.GetMetadata().mipLevels, 3u);
+
+	// Level 1 is 2x1, each texel covers three rows, the last one three columns as well
+	EXPECT_EQ(GetTexel(result, 1, 0, 0, 1), 30); // 2 of 6 texels set
+	EXPECT_EQ(GetTexel(result, 1, 1, 0, 1), 50); // 5 of 9 texels set
+	EXPECT_EQ(GetTexel(result, 2, 0, 0, 1), 40);
+}
+
+TEST(MipGenerator, OddWidthOfThreeFoldsIntoOneTexel)
+{
+	DirectX::ScratchImage result;
+	MipGenerator::Generate(MakeImage(DXGI_FORMAT_R8_UNORM, 3, 1, 1, { 0, 0, 255 }), MipFilter::Linear, result);
+	ASSERT_EQ(result.GetMetadata().mipLevels, 2u);
+	EXPECT_EQ(GetTexel(result, 1, 0, 0, 1), 85);
+}
+
+TEST(MipGenerator, ColorAveragesInLinearSpace)
+{
+	// Wide enough for the four pixel path and a scalar tail, alpha stays linear
+	const UINT width = 6;
+	std::vector<uint8_t> pixels;
+	const uint8_t top[2] = { 10, 250 }, bottom[2] = { 128, 64 };
+	for (UINT y = 0; y < 2; y++)
+	{
+		for (UINT x = 0; x < width; x++)
+		{
+			const uint8_t value = y == 0 ? top[x & 1] : bottom[x & 1];
+			pixels.insert(pixels.end(), { value, static_cast<uint8_t>(255 - value), value, static_cast<uint8_t>(x * 40) });
+		}
+	}
+	DirectX::ScratchImage result;
+	MipGenerator::Generate(MakeImage(DXGI_FORMAT_R8G8B8A8_UNORM, width, 2, 4, pixels), MipFilter::Color, result);
+
+	const uint8_t red = LinearToSrgb((SrgbToLinear(10) + SrgbToLinear(250) + SrgbToLinear(128) + SrgbToLinear(64)) / 4.0f);
+	const uint8_t green = LinearToSrgb((SrgbToLinear(245) + SrgbToLinear(5) + SrgbToLinear(127) + SrgbToLinear(191)) / 4.0f);
+	for (UINT x = 0; x < width / 2; x++)
+	{
+		EXPECT_NEAR(GetTexel(result, 1, x, 0, 4, 0), red, 1) << x;
+		EXPECT_NEAR(GetTexel(result, 1, x, 0, 4, 1), green, 1) << x;
+		EXPECT_NEAR(GetTexel(result, 1, x, 0, 4, 2), red, 1) << x;
+		EXPECT_EQ(GetTexel(result, 1, x, 0, 4, 3), x * 80 + 20) << x;
+	}
+}
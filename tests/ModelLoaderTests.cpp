@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+#include "DX12Engine/IO/ModelLoader.h"
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using namespace DX12Engine;
+
+// Height-field grid in four material bands with quads, negative indices, a comment and no final newline, large enough
+// to span several parallel ranges and import blocks
+static std::string WriteTestObj(const std::string& name, unsigned int gridSize)
+{
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / (name + ".obj");
+	std::ofstream(std::filesystem::path(path).replace_extension(".mtl")) << "newmtl band0\nnewmtl band1\nnewmtl band2\nnewmtl band3\n";
+	std::ofstream obj(path, std::ios::binary);
+	obj << "mtllib " << name << ".mtl\n";
+	const unsigned int rowSize = gridSize + 1;
+	for (unsigned int y = 0; y <= gridSize; y++)
+	{
+		for (unsigned int x = 0; x <= gridSize; x++)
+		{
+			const float u = static_cast<float>(x) / gridSize, v = static_cast<float>(y) / gridSize;
+			obj << "v " << u << " " << 0.1f * std::sin(u * 9.0f) * std::cos(v * 7.0f) << " " << v << "\r\n";
+			obj << "vt " << u << " " << v << "\n";
+		}
+	}
+	obj << "vn 0 1 0\n# normals are shared\n";
+	for (unsigned int y = 0; y < gridSize; y++)
+	{
+		if (y % (gridSize / 4) == 0)
+			obj << "usemtl band" << (3 - y / (gridSize / 4)) << "\n";
+		for (unsigned int x = 0; x < gridSize; x++)
+		{
+			const unsigned int a = y * rowSize + x + 1, b = a + 1, c = a + rowSize + 1, d = a + rowSize;
+			if ((x + y) % 7 == 0)
+				obj << "f " << a << "/" << a << "/-1 " << b << "/" << b << "/1 " << c << "/" << c << "/1 " << d << "/" << d << "/1\n";
+			else
+				obj << "f " << a << "/" << a << "/1 " << b << "/" << b << "/1 " << c << "/" << c << "/1\n" << "f " << a << "//1 " << c << "//1 " << d << "//1\n";
+		}
+	}
+	obj << "f 1 2 " << rowSize + 1;
+	return path.string();
+}
+
+template<typename T>
+static void ExpectSameBytes(const std::vector<T>& a, const std::vector<T>& b)
+{
+	ASSERT_EQ(a.size(), b.size());
+	EXPECT_TRUE(a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+TEST(ModelLoader, ParallelStreamingImportMatchesSerial)
+{
+	const std::string path = WriteTestObj("ModelLoaderParallel", 128);
+	ModelLoadOptions options;
+	options.CompactVertices = true;
+	ModelLoader loader;
+	const Mesh serial = loader.LoadObj(path, options);
+
+	for (UINT threadCount : { 2u, 3u, 8u })
+	{
+		options.ParallelImport = true;
+		options.ThreadCount = threadCount;
+		const Mesh parallel = loader.LoadObj(path, options);
+
+		ExpectSameBytes(serial.Vertices, parallel.Vertices);
+		ExpectSameBytes(serial.CompactVertices, parallel.CompactVertices);
+		ExpectSameBytes(serial.Indices, parallel.Indices);
+		ExpectSameBytes(serial.Submeshes, parallel.Submeshes);
+		ExpectSameBytes(serial.Lods, parallel.Lods);
+		ExpectSameBytes(serial.Meshlets, parallel.Meshlets);
+		EXPECT_EQ(memcmp(&serial.Bounds, &parallel.Bounds, sizeof(serial.Bounds)), 0);
+	}
+	// One submesh per material band in every LOD
+	EXPECT_EQ(serial.Submeshes.size(), 4u * serial.Lods.size());
+	EXPECT_GT(serial.Lods.size(), 1u);
+	EXPECT_FALSE(serial.Meshlets.empty());
+}
+
+TEST(ModelLoader, ParallelImportHashMatchesSerialForStreaming)
+{
+	ModelLoadOptions serial, parallel;
+	parallel.ParallelImport = true;
+	EXPECT_EQ(serial.GetHash(), parallel.GetHash());
+
+	serial.StreamingImport = parallel.StreamingImport = false;
+	EXPECT_NE(serial.GetHash(), parallel.GetHash());
+}
+
+TEST(ModelLoader, StreamingImportReportsLineOfBadFace)
+{
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "ModelLoaderBadFace.obj";
+	{
+		std::ofstream obj(path);
+		for (int i = 0; i < 1000; i++)
+			obj << "v 0 0 " << i << "\n";
+		obj << "f 1 2 1001\n";
+	}
+	for (UINT threadCount : { 1u, 4u })
+	{
+		ModelLoadOptions options;
+		options.ParallelImport = true;
+		options.ThreadCount = threadCount;
+		try
+		{
+			ModelLoader().LoadObj(path.string(), options);
+			FAIL() << "the out of range index was accepted";
+		}
+		catch (const std::runtime_error& e)
+		{
+			EXPECT_NE(std::string(e.what()).find("line 1001"), std::string::npos) << e.what();
+		}
+	}
+}
+
+// One triangle per usemtl line, in the order given, behind an optional first triangle without a material
+static Mesh LoadMaterialTestObj(const std::string& name, const std::string& mtl, const std::vector<std::string>& statements)
+{
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / (name + ".obj");
+	std::ofstream(std::filesystem::path(path).replace_extension(".mtl")) << mtl;
+	{
+		std::ofstream obj(path);
+		obj << "v 0 0 0\nv 1 0 0\nv 0 1 0\n";
+		for (const std::string& statement : statements)
+			obj << statement << "\n" << (statement.rfind("mtllib", 0) == 0 ? "" : "f 1 2 3\n");
+	}
+
+	ModelLoadOptions options;
+	options.OptimizeMesh = false;
+	options.LodCount = 1;
+	options.BuildMeshlets = false;
+	return ModelLoader().LoadObj(path.string(), options);
+}
+
+static std::vector<std::pair<UINT, UINT>> GetSlotTriangles(const Mesh& mesh)
+{
+	std::vector<std::pair<UINT, UINT>> slots;
+	for (const Submesh& submesh : mesh.Submeshes)
+		slots.push_back({ submesh.MaterialSlot, submesh.IndexCount / 3 });
+	return slots;
+}
+
+TEST(ModelLoader, StreamingImportSlotsFollowMtlDeclarationOrder)
+{
+	// Slots are the .mtl indices like tinyobj's material ids, not the order the OBJ first uses them in
+	const Mesh mesh = LoadMaterialTestObj("ModelLoaderMaterialOrder", "newmtl stone\r\nKd 1 1 1\n  newmtl wood\nnewmtl metal\n",
+		{ "mtllib ModelLoaderMaterialOrder.mtl", "usemtl metal", "usemtl stone", "usemtl metal" });
+	EXPECT_EQ(GetSlotTriangles(mesh), (std::vector<std::pair<UINT, UINT>>{ { 0, 1 }, { 2, 2 } }));
+}
+
+TEST(ModelLoader, StreamingImportUnknownMaterialsUseSlotZero)
+{
+	// Unknown names and names used before their library is loaded fall back to slot 0
+	const Mesh mesh = LoadMaterialTestObj("ModelLoaderUnknownMaterial", "newmtl first\nnewmtl second\n",
+		{ "usemtl second", "mtllib missing.mtl ModelLoaderUnknownMaterial.mtl", "usemtl second", "usemtl none", "usemtl first" });
+	EXPECT_EQ(GetSlotTriangles(mesh), (std::vector<std::pair<UINT, UINT>>{ { 0, 3 }, { 1, 1 } }));
+}
+
+TEST(ModelLoader, StreamingImportWithoutLibraryHasOneSlot)
+{
+	const Mesh mesh = LoadMaterialTestObj("ModelLoaderNoLibrary", "", { "usemtl a", "usemtl b" });
+	EXPECT_EQ(GetSlotTriangles(mesh), (std::vector<std::pair<UINT, UINT>>{ { 0, 2 } }));
+}
+
+// A quad whose fourth position, fourth UV and second triangle only exist through sparse accessors. The dense positions
+// hold a wrong fourth vertex, the UVs have no buffer view at all and the dense indices repeat the first triangle
+static std::string WriteSparseGltf(const std::string& name)
+{
+	std::vector<uint8_t> bin(100, 0);
+	auto put = [&](size_t offset, const auto& value) { memcpy(bin.data() + offset, &value, sizeof(value)); };
+	const float positions[12] = { 0, 0, 0, 1, 0, 0, 0, 1, 0, 9, 9, 9 };
+	put(0, positions);
+	const uint16_t indices[6] = { 0, 1, 2, 2, 1, 0 };
+	put(48, indices);
+	put(60, uint16_t(3));
+	const float position[3] = { 1, 1, 0 };
+	put(64, position);
+	const uint8_t indexTargets[3] = { 3, 4, 5 };
+	put(76, indexTargets);
+	const uint16_t indexValues[3] = { 1, 3, 2 };
+	put(80, indexValues);
+	put(88, uint8_t(3));
+	const float texCoord[2] = { 1, 1 };
+	put(92, texCoord);
+
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / (name + ".gltf");
+	std::ofstream(std::filesystem::path(path).replace_extension(".bin"), std::ios::binary).write(reinterpret_cast<const char*>(bin.data()), bin.size());
+	std::ofstream(path) << R"({
+		"asset": { "version": "2.0" },
+		"buffers": [ { "uri": ")" << name << R"(.bin", "byteLength": 100 } ],
+		"bufferViews": [
+			{ "buffer": 0, "byteOffset": 0, "byteLength": 48 },
+			{ "buffer": 0, "byteOffset": 48, "byteLength": 12 },
+			{ "buffer": 0, "byteOffset": 60, "byteLength": 2 },
+			{ "buffer": 0, "byteOffset": 64, "byteLength": 12 },
+			{ "buffer": 0, "byteOffset": 76, "byteLength": 3 },
+			{ "buffer": 0, "byteOffset": 80, "byteLength": 6 },
+			{ "buffer": 0, "byteOffset": 88, "byteLength": 1 },
+			{ "buffer": 0, "byteOffset": 92, "byteLength": 8 }
+		],
+		"accessors": [
+			{ "bufferView": 0, "componentType": 5126, "count": 4, "type": "VEC3", "min": [ 0, 0, 0 ], "max": [ 1, 1, 0 ],
+				"sparse": { "count": 1, "indices": { "bufferView": 2, "componentType": 5123 }, "values": { "bufferView": 3 } } },
+			{ "bufferView": 1, "componentType": 5123, "count": 6, "type": "SCALAR",
+				"sparse": { "count": 3, "indices": { "bufferView": 4, "componentType": 5121 }, "values": { "bufferView": 5 } } },
+			{ "componentType": 5126, "count": 4, "type": "VEC2",
+				"sparse": { "count": 1, "indices": { "bufferView": 6, "componentType": 5121 }, "values": { "bufferView": 7 } } }
+		],
+		"meshes": [ { "primitives": [ { "attributes": { "POSITION": 0, "TEXCOORD_0": 2 }, "indices": 1 } ] } ]
+	})";
+	return path.string();
+}
+
+TEST(ModelLoader, GltfSparseAccessorsAreApplied)
+{
+	ModelLoadOptions options;
+	options.OptimizeMesh = false;
+	options.LodCount = 1;
+	options.BuildMeshlets = false;
+	const GltfModel model = ModelLoader().LoadGltf(WriteSparseGltf("ModelLoaderSparse"), options);
+	ASSERT_EQ(model.Meshes.size(), 1u);
+	const Mesh& mesh = model.Meshes[0].Geometry;
+
+	ASSERT_EQ(mesh.Vertices.size(), 4u);
+	const float expectedPositions[4][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 1, 1, 0 } };
+	for (size_t v = 0; v < 4; v++)
+	{
+		EXPECT_EQ(mesh.Vertices[v].Position.x, expectedPositions[v][0]) << "vertex " << v;
+		EXPECT_EQ(mesh.Vertices[v].Position.y, expectedPositions[v][1]) << "vertex " << v;
+		EXPECT_EQ(mesh.Vertices[v].Position.z, expectedPositions[v][2]) << "vertex " << v;
+		// Sparse values on top of an accessor without a buffer view, which reads as zeros
+		EXPECT_EQ(mesh.Vertices[v].TexCoord.x, v == 3 ? 1.0f : 0.0f) << "vertex " << v;
+		EXPECT_EQ(mesh.Vertices[v].TexCoord.y, v == 3 ? 1.0f : 0.0f) << "vertex " << v;
+	}
+
+	ASSERT_GE(mesh.Indices.size(), 6u);
+	EXPECT_EQ(std::vector<UINT>(mesh.Indices.begin(), mesh.Indices.begin() + 6), (std::vector<UINT>{ 0, 1, 2, 1, 3, 2 }));
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "DX12Engine/Rendering/ResourceBarrierBatch.h"
+#include <cstdint>
+#include <vector>
+
+using namespace DX12Engine;
+
+// Stands in for ID3D12GraphicsCommandList, Flush only needs ResourceBarrier
+struct RecordingCommandList
+{
+	void ResourceBarrier(UINT count, const D3D12_RESOURCE_BARRIER* barriers)
+	{
+		CallCount++;
+		Barriers.insert(Barriers.end(), barriers, barriers + count);
+	}
+
+	UINT CallCount = 0;
+	std::vector<D3D12_RESOURCE_BARRIER> Barriers;
+};
+
+// Never dereferenced by the batch
+static ID3D12Resource* FakeResource(uintptr_t id)
+{
+	return reinterpret_cast<ID3D12Resource*>(id * 256);
+}
+
+static void ExpectTransition(const D3D12_RESOURCE_BARRIER& barrier, ID3D12Resource* resource, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after)
+{
+	EXPECT_EQ(barrier.Type, D3D12_RESOURCE_BARRIER_TYPE_TRANSITION);
+	EXPECT_EQ(barrier.Transition.pResource, resource);
+	EXPECT_EQ(barrier.Transition.Subresource, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+	EXPECT_EQ(barrier.Transition.StateBefore, before);
+	EXPECT_EQ(barrier.Transition.StateAfter, after);
+}
+
+TEST(ResourceBarrierBatch, FlushesAllTransitionsInOneCall)
+{
+	ResourceBarrierBatch batch;
+	ID3D12Resource* a = FakeResource(1), * b = FakeResource(2), * c = FakeResource(3);
+	batch.Transition(a, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	batch.Transition(b, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+	batch.Transition(c, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_INDEX_BUFFER);
+
+	RecordingCommandList commandList;
+	batch.Flush(&commandList);
+	EXPECT_EQ(commandList.CallCount, 1u);
+	ASSERT_EQ(commandList.Barriers.size(), 3u);
+	ExpectTransition(commandList.Barriers[0], a, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	ExpectTransition(commandList.Barriers[1], b, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+	ExpectTransition(commandList.Barriers[2], c, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_INDEX_BUFFER);
+	EXPECT_TRUE(batch.IsEmpty());
+}
+
+TEST(ResourceBarrierBatch, MergesTransitionsOfTheSameResource)
+{
+	ResourceBarrierBatch batch;
+	ID3D12Resource* a = FakeResource(1), * b = FakeResource(2);
+	batch.Transition(a, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST);
+	batch.Transition(b, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	batch.Transition(a, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+	RecordingCommandList commandList;
+	batch.Flush(&commandList);
+	EXPECT_EQ(commandList.CallCount, 1u);
+	ASSERT_EQ(commandList.Barriers.size(), 2u);
+	ExpectTransition(commandList.Barriers[0], a, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	ExpectTransition(commandList.Barriers[1], b, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+}
+
+TEST(ResourceBarrierBatch, RoundTripsAreDropped)
+{
+	ResourceBarrierBatch batch;
+	ID3D12Resource* a = FakeResource(1), * b = FakeResource(2);
+	batch.Transition(a, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_RENDER_TARGET);
+	batch.Transition(a, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+	// A flush with nothing left to record doesn't call the list
+	RecordingCommandList commandList;
+	batch.Flush(&commandList);
+	EXPECT_EQ(commandList.CallCount, 0u);
+	EXPECT_TRUE(batch.IsEmpty());
+
+	// A round trip that leaves again still finds its entry and keeps the original before state
+	batch.Transition(b, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST);
+	batch.Transition(b, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COMMON);
+	batch.Transition(b, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_GENERIC_READ);
+	batch.Flush(&commandList);
+	EXPECT_EQ(commandList.CallCount, 1u);
+	ASSERT_EQ(commandList.Barriers.size(), 1u);
+	ExpectTransition(commandList.Barriers[0], b, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_GENERIC_READ);
+}
+
+TEST(ResourceBarrierBatch, ClearForgetsPendingTransitions)
+{
+	ResourceBarrierBatch batch;
+	ID3D12Resource* a = FakeResource(1);
+	batch.Transition(a, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST);
+	EXPECT_FALSE(batch.IsEmpty());
+	batch.Clear();
+	EXPECT_TRUE(batch.IsEmpty());
+
+	// After a clear the next transition of the resource starts a new barrier instead of merging
+	batch.Transition(a, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	RecordingCommandList commandList;
+	batch.Flush(&commandList);
+	ASSERT_EQ(commandList.Barriers.size(), 1u);
+	ExpectTransition(commandList.Barriers[0], a, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+}
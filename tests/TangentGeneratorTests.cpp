@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include "DX12Engine/Geometry/TangentGenerator.h"
+#include <cmath>
+#include <cstring>
+#include <random>
+
+using namespace DX12Engine;
+
+static Mesh MakeMesh(const std::vector<DirectX::XMFLOAT3>& positions, const std::vector<DirectX::XMFLOAT2>& texCoords,
+	const DirectX::XMFLOAT3& normal, const std::vector<UINT>& indices)
+{
+	Mesh mesh;
+	for (size_t i = 0; i < positions.size(); i++)
+	{
+		Vertex vertex = {};
+		vertex.Position = positions[i];
+		vertex.Normal = normal;
+		vertex.TexCoord = texCoords[i];
+		mesh.Vertices.push_back(vertex);
+	}
+	mesh.Indices = indices;
+	return mesh;
+}
+
+// Unit quad in the XY plane facing +Z, two triangles
+static Mesh MakeQuad(const std::vector<DirectX::XMFLOAT2>& texCoords, const DirectX::XMFLOAT3& normal = { 0.0f, 0.0f, 1.0f })
+{
+	return MakeMesh({ { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } }, texCoords, normal, { 0, 1, 2, 0, 2, 3 });
+}
+
+static void ExpectTangents(const Mesh& mesh, const DirectX::XMFLOAT4& expected)
+{
+	for (const Vertex& vertex : mesh.Vertices)
+	{
+		EXPECT_NEAR(vertex.Tangent.x, expected.x, 1e-6f);
+		EXPECT_NEAR(vertex.Tangent.y, expected.y, 1e-6f);
+		EXPECT_NEAR(vertex.Tangent.z, expected.z, 1e-6f);
+		EXPECT_EQ(vertex.Tangent.w, expected.w);
+	}
+}
+
+TEST(TangentGenerator, AlignedUVsFollowTheUAxis)
+{
+	Mesh mesh = MakeQuad({ { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } });
+	TangentGenerator::Generate(mesh);
+	ExpectTangents(mesh, { 1.0f, 0.0f, 0.0f, 1.0f });
+}
+
+TEST(TangentGenerator, MirroredUVsFlipHandedness)
+{
+	Mesh mesh = MakeQuad({ { 1.0f, 0.0f }, { 0.0f, 0.0f }, { 0.0f, 1.0f }, { 1.0f, 1.0f } });
+	TangentGenerator::Generate(mesh);
+	ExpectTangents(mesh, { -1.0f, 0.0f, 0.0f, -1.0f });
+}
+
+TEST(TangentGenerator, SwappedUVAxes)
+{
+	Mesh mesh = MakeQuad({ { 0.0f, 0.0f }, { 0.0f, 1.0f }, { 1.0f, 1.0f }, { 1.0f, 0.0f } });
+	TangentGenerator::Generate(mesh);
+	ExpectTangents(mesh, { 0.0f, 1.0f, 0.0f, -1.0f });
+}
+
+TEST(TangentGenerator, UVScaleDoesNotChangeTheResult)
+{
+	Mesh mesh = MakeQuad({ { 0.0f, 0.0f }, { 8.0f, 0.0f }, { 8.0f, 0.25f }, { 0.0f, 0.25f } });
+	TangentGenerator::Generate(mesh);
+	ExpectTangents(mesh, { 1.0f, 0.0f, 0.0f, 1.0f });
+}
+
+TEST(TangentGenerator, OrthogonalizesAgainstTheNormal)
+{
+	Mesh mesh = MakeQuad({ { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } }, { 0.6f, 0.0f, 0.8f });
+	TangentGenerator::Generate(mesh);
+	ExpectTangents(mesh, { 0.8f, 0.0f, -0.6f, 1.0f });
+}
+
+TEST(TangentGenerator, DegenerateUVsFallBackToPerpendicular)
+{
+	Mesh mesh = MakeQuad({ { 0.5f, 0.5f }, { 0.5f, 0.5f }, { 0.5f, 0.5f }, { 0.5f, 0.5f } });
+	TangentGenerator::Generate(mesh);
+	ExpectTangents(mesh, { 1.0f, 0.0f, 0.0f, 1.0f });
+}
+
+TEST(TangentGenerator, SharedVertexIsWeightedByArea)
+{
+	// Triangle A (area 2) pulls vertex 0 along +X, triangle B (area 1) along +Y
+	Mesh mesh = MakeMesh(
+		{ { 0.0f, 0.0f, 0.0f }, { 2.0f, 0.0f, 0.0f }, { 0.0f, 2.0f, 0.0f }, { -2.0f, 0.0f, 0.0f }, { 0.0f, -1.0f, 0.0f } },
+		{ { 0.0f, 0.0f }, { 2.0f, 0.0f }, { 0.0f, 2.0f }, { 0.0f, 2.0f }, { -1.0f, 0.0f } },
+		{ 0.0f, 0.0f, 1.0f }, { 0, 1, 2, 0, 3, 4 });
+	TangentGenerator::Generate(mesh);
+
+	const float inverseLength = 1.0f / std::sqrt(5.0f);
+	EXPECT_NEAR(mesh.Vertices[0].Tangent.x, 2.0f * inverseLength, 1e-6f);
+	EXPECT_NEAR(mesh.Vertices[0].Tangent.y, inverseLength, 1e-6f);
+	EXPECT_NEAR(mesh.Vertices[0].Tangent.z, 0.0f, 1e-6f);
+	EXPECT_EQ(mesh.Vertices[0].Tangent.w, 1.0f);
+	EXPECT_NEAR(mesh.Vertices[4].Tangent.y, 1.0f, 1e-6f);
+}
+
+// Random triangle soup with an odd vertex and triangle count, so batches end in partial lanes
+static Mesh MakeRandomMesh(size_t vertexCount, size_t triangleCount, uint32_t seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+	std::uniform_int_distribution<UINT> vertex(0, static_cast<UINT>(vertexCount - 1));
+	Mesh mesh;
+	mesh.Vertices.resize(vertexCount);
+	for (Vertex& v : mesh.Vertices)
+	{
+		v.Position = { value(random), value(random), value(random) };
+		DirectX::XMStoreFloat3(&v.Normal, DirectX::XMVector3Normalize(DirectX::XMVectorSet(value(random), value(random), value(random), 0.0f)));
+		v.TexCoord = { value(random), value(random) };
+	}
+	for (size_t i = 0; i < triangleCount * 3; i++)
+		mesh.Indices.push_back(vertex(random));
+	return mesh;
+}
+
+TEST(TangentGenerator, TangentsAreUnitAndPerpendicular)
+{
+	Mesh mesh = MakeRandomMesh(1001, 2999, 3);
+	TangentGenerator::Generate(mesh);
+	for (const Vertex& v : mesh.Vertices)
+	{
+		const float length = std::sqrt(v.Tangent.x * v.Tangent.x + v.Tangent.y * v.Tangent.y + v.Tangent.z * v.Tangent.z);
+		EXPECT_NEAR(length, 1.0f, 1e-5f);
+		EXPECT_NEAR(v.Tangent.x * v.Normal.x + v.Tangent.y * v.Normal.y + v.Tangent.z * v.Normal.z, 0.0f, 1e-5f);
+		EXPECT_TRUE(v.Tangent.w == 1.0f || v.Tangent.w == -1.0f);
+	}
+}
+
+TEST(TangentGenerator, ThreadCountDoesNotChangeTheResult)
+{
+	const Mesh source = MakeRandomMesh(70001, 150001, 4);
+	Mesh serial = source;
+	TangentGenerator::Generate(serial);
+	for (UINT threadCount : { 2u, 3u, 8u })
+	{
+		Mesh parallel = source;
+		TangentGenerator::Generate(parallel, threadCount);
+		EXPECT_EQ(memcmp(serial.Vertices.data(), parallel.Vertices.data(), serial.Vertices.size() * sizeof(Vertex)), 0) << threadCount << " threads";
+	}
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include "DX12Engine/Resources/TextureResidency.h"
+#include <cstdint>
+#include <vector>
+
+using namespace DX12Engine;
+
+// Records the paging calls, the manager never dereferences the textures
+class FakeResidencyAllocator : public TextureResidencyAllocator
+{
+public:
+	void Evict(Texture* texture) override { Evicted.push_back(texture); }
+	void MakeResident(Texture* texture) override { Restored.push_back(texture); }
+
+	std::vector<Texture*> Evicted;
+	std::vector<Texture*> Restored;
+};
+
+static Texture* FakeTexture(uintptr_t id)
+{
+	return reinterpret_cast<Texture*>(id * 256);
+}
+
+struct Residency
+{
+	Residency(UINT64 budgetBytes)
+		: Allocator(new FakeResidencyAllocator()), Manager(std::unique_ptr<TextureResidencyAllocator>(Allocator), budgetBytes)
+	{
+	}
+
+	FakeResidencyAllocator* Allocator;
+	TextureResidencyManager Manager;
+};
+
+static const UINT64 TextureSize = 100;
+
+TEST(TextureResidency, EvictsLeastRecentlyUsedFirst)
+{
+	Residency residency(3 * TextureSize);
+	Texture* a = FakeTexture(1), * b = FakeTexture(2), * c = FakeTexture(3), * d = FakeTexture(4);
+	for (Texture* texture : { a, b, c })
+	{
+		residency.Manager.Track(texture, TextureSize, 0);
+		residency.Manager.Touch(texture);
+	}
+	residency.Manager.EndFrame();
+	EXPECT_TRUE(residency.Allocator->Evicted.empty());
+
+	// Going over the budget by one texture evicts the one bound longest ago
+	residency.Manager.Track(d, TextureSize, 0);
+	residency.Manager.Touch(c);
+	residency.Manager.Touch(d);
+	residency.Manager.EndFrame();
+	EXPECT_EQ(residency.Allocator->Evicted, (std::vector<Texture*>{ a }));
+
+	// A smaller budget keeps walking from the least recently used end, D stays the most recently used
+	residency.Manager.SetBudget(TextureSize);
+	residency.Manager.EndFrame();
+	EXPECT_EQ(residency.Allocator->Evicted, (std::vector<Texture*>{ a, b, c }));
+
+	const TextureResidencyStatistics& statistics = residency.Manager.GetStatistics();
+	EXPECT_EQ(statistics.ResidentBytes, TextureSize);
+	EXPECT_EQ(statistics.EvictedBytes, 3 * TextureSize);
+	EXPECT_EQ(statistics.EvictedCount, 3u);
+	EXPECT_EQ(statistics.EvictionCount, 3u);
+	EXPECT_EQ(statistics.TrackedCount, 4u);
+}
+
+TEST(TextureResidency, TouchRestoresEvictedTextures)
+{
+	Residency residency(TextureSize);
+	Texture* a = FakeTexture(1), * b = FakeTexture(2);
+	for (Texture* texture : { a, b })
+	{
+		residency.Manager.Track(texture, TextureSize, 0);
+		residency.Manager.Touch(texture);
+	}
+	residency.Manager.EndFrame();
+	residency.Manager.EndFrame();
+	ASSERT_EQ(residency.Allocator->Evicted, (std::vector<Texture*>{ a }));
+
+	// Binding A pages it back in and makes B the least recently used
+	residency.Manager.Touch(a);
+	EXPECT_EQ(residency.Allocator->Restored, (std::vector<Texture*>{ a }));
+	EXPECT_EQ(residency.Manager.GetStatistics().RestoreCount, 1u);
+	EXPECT_EQ(residency.Manager.GetStatistics().ResidentBytes, 2 * TextureSize);
+	EXPECT_EQ(residency.Manager.GetStatistics().EvictedCount, 0u);
+
+	// Touching a resident texture doesn't page anything
+	residency.Manager.Touch(a);
+	EXPECT_EQ(residency.Allocator->Restored.size(), 1u);
+
+	residency.Manager.EndFrame();
+	EXPECT_EQ(residency.Allocator->Evicted, (std::vector<Texture*>{ a, b }));
+	EXPECT_EQ(residency.Manager.GetStatistics().ResidentBytes, TextureSize);
+}
+
+TEST(TextureResidency, TexturesTouchedThisFrameAreKept)
+{
+	Residency residency(TextureSize);
+	Texture* a = FakeTexture(1), * b = FakeTexture(2);
+	for (Texture* texture : { a, b })
+	{
+		residency.Manager.Track(texture, TextureSize, 0);
+		residency.Manager.Touch(texture);
+	}
+
+	// Both are in use by the frame, so the resident set stays over the budget
+	residency.Manager.EndFrame();
+	EXPECT_TRUE(residency.Allocator->Evicted.empty());
+	EXPECT_EQ(residency.Manager.GetStatistics().ResidentBytes, 2 * TextureSize);
+
+	residency.Manager.Touch(a);
+	residency.Manager.EndFrame();
+	EXPECT_EQ(residency.Allocator->Evicted, (std::vector<Texture*>{ b }));
+}
+
+TEST(TextureResidency, UnboundAndUnpageableTexturesStayResident)
+{
+	Residency residency(0);
+	Texture* renderPass = FakeTexture(1), * placed = FakeTexture(2), * material = FakeTexture(3);
+	residency.Manager.Track(renderPass, TextureSize, 0);
+	residency.Manager.Track(placed, TextureSize, 0, false);
+	residency.Manager.Track(material, TextureSize, 0);
+	residency.Manager.Touch(placed);
+	residency.Manager.Touch(material);
+	residency.Manager.EndFrame();
+	residency.Manager.EndFrame();
+
+	EXPECT_EQ(residency.Allocator->Evicted, (std::vector<Texture*>{ material }));
+	EXPECT_EQ(residency.Manager.GetStatistics().ResidentBytes, 2 * TextureSize);
+}
+
+TEST(TextureResidency, UntrackRemovesTheBytes)
+{
+	Residency residency(TextureSize);
+	Texture* a = FakeTexture(1), * b = FakeTexture(2);
+	residency.Manager.Track(a, TextureSize, 40);
+	residency.Manager.Track(b, TextureSize, 60);
+	residency.Manager.Touch(a);
+	residency.Manager.EndFrame();
+	residency.Manager.EndFrame();
+	ASSERT_EQ(residency.Allocator->Evicted, (std::vector<Texture*>{ a }));
+
+	residency.Manager.SetCPUBytes(b, 0);
+	residency.Manager.Untrack(a);
+	residency.Manager.Untrack(b);
+	residency.Manager.Untrack(b);
+	const TextureResidencyStatistics& statistics = residency.Manager.GetStatistics();
+	EXPECT_EQ(statistics.ResidentBytes, 0u);
+	EXPECT_EQ(statistics.EvictedBytes, 0u);
+	EXPECT_EQ(statistics.CPUBytes, 0u);
+	EXPECT_EQ(statistics.TrackedCount, 0u);
+	EXPECT_EQ(statistics.EvictedCount, 0u);
+
+	// Calls for untracked textures are ignored
+	residency.Manager.Touch(a);
+	EXPECT_TRUE(residency.Allocator->Restored.empty());
+}
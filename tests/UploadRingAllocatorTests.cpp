@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "DX12Engine/Rendering/UploadRingAllocator.h"
+
+using namespace DX12Engine;
+
+static uint64_t AllocateAt(UploadRingAllocator& ring, uint64_t size, uint64_t alignment = 1)
+{
+	uint64_t offset = ~0ull;
+	EXPECT_TRUE(ring.Allocate(size, alignment, offset)) << size << " bytes";
+	return offset;
+}
+
+TEST(UploadRingAllocator, AlignsOffsetsAndCountsThePadding)
+{
+	UploadRingAllocator ring(1024);
+	EXPECT_EQ(AllocateAt(ring, 10), 0u);
+	EXPECT_EQ(AllocateAt(ring, 16, 256), 256u);
+	EXPECT_EQ(AllocateAt(ring, 4, 4), 272u);
+	EXPECT_EQ(ring.GetUsedSize(), 276u);
+	EXPECT_TRUE(ring.HasOpenAllocations());
+
+	uint64_t offset = 0;
+	EXPECT_FALSE(ring.Allocate(0, 1, offset));
+	EXPECT_FALSE(ring.Allocate(1025, 1, offset));
+	EXPECT_EQ(ring.GetUsedSize(), 276u);
+}
+
+TEST(UploadRingAllocator, WrapSkipsTheTailUntilItRetires)
+{
+	UploadRingAllocator ring(1000);
+	EXPECT_EQ(AllocateAt(ring, 600), 0u);
+	ring.Submit(1);
+	EXPECT_FALSE(ring.HasOpenAllocations());
+	EXPECT_EQ(AllocateAt(ring, 300), 600u);
+	ring.Submit(2);
+	ring.Retire(1);
+	EXPECT_EQ(ring.GetUsedSize(), 300u);
+
+	// 200 bytes don't fit behind 900, so the region starts at 0 and the last 100 bytes are padding
+	EXPECT_EQ(AllocateAt(ring, 200), 0u);
+	EXPECT_EQ(ring.GetUsedSize(), 600u);
+	ring.Submit(3);
+
+	// The padding belongs to the wrapping submission and only comes back with it
+	ring.Retire(2);
+	EXPECT_EQ(ring.GetUsedSize(), 300u);
+	ring.Retire(3);
+	EXPECT_EQ(ring.GetUsedSize(), 0u);
+}
+
+TEST(UploadRingAllocator, AlignmentPaddingCanWrap)
+{
+	UploadRingAllocator ring(1024);
+	EXPECT_EQ(AllocateAt(ring, 900), 0u);
+	ring.Submit(1);
+	ring.Retire(1);
+
+	// The empty ring starts over at 0 instead of wrapping
+	EXPECT_EQ(AllocateAt(ring, 900), 0u);
+	ring.Submit(2);
+	EXPECT_EQ(AllocateAt(ring, 64, 64), 960u);
+	ring.Submit(3);
+	ring.Retire(2);
+
+	// Aligning 1024 would be at the end, the next aligned region starts at 0
+	EXPECT_EQ(AllocateAt(ring, 512, 512), 0u);
+	EXPECT_EQ(ring.GetUsedSize(), 60u + 64u + 512u); // The 64 byte region still holds its alignment padding
+}
+
+TEST(UploadRingAllocator, FullRingWaitsForRetirementInOrder)
+{
+	UploadRingAllocator ring(1000);
+	EXPECT_EQ(AllocateAt(ring, 400), 0u);
+	ring.Submit(1);
+	EXPECT_EQ(AllocateAt(ring, 400), 400u);
+	ring.Submit(2);
+
+	uint64_t offset = 0;
+	EXPECT_FALSE(ring.Allocate(400, 1, offset));
+	ring.Retire(0);
+	EXPECT_FALSE(ring.Allocate(400, 1, offset));
+	EXPECT_EQ(ring.GetUsedSize(), 800u);
+
+	// Retiring the first submission frees the start, the wrap pads out the 200 bytes behind the second
+	ring.Retire(1);
+	EXPECT_EQ(ring.GetUsedSize(), 400u);
+	EXPECT_EQ(AllocateAt(ring, 400), 0u);
+	EXPECT_EQ(ring.GetUsedSize(), 1000u);
+	ring.Submit(3);
+
+	// Submissions retire front to back, a completed fence frees everything up to it
+	ring.Retire(3);
+	EXPECT_EQ(ring.GetUsedSize(), 0u);
+	EXPECT_EQ(AllocateAt(ring, 1000), 0u);
+}
+
+TEST(UploadRingAllocator, EmptySubmitsAreIgnored)
+{
+	UploadRingAllocator ring(100);
+	ring.Submit(1);
+	EXPECT_EQ(AllocateAt(ring, 100), 0u);
+	ring.Submit(2);
+	ring.Retire(1);
+	EXPECT_EQ(ring.GetUsedSize(), 100u);
+	ring.Retire(2);
+	EXPECT_EQ(ring.GetUsedSize(), 0u);
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "DX12Engine/Rendering/UploadScheduler.h"
+#include <stdexcept>
+#include <vector>
+
+using namespace DX12Engine;
+
+// Uploads advance a simulated clock by a fixed cost and record their order
+struct SimulatedUploads
+{
+	UploadScheduler::Clock GetClock()
+	{
+		return [this]() { return Now; };
+	}
+
+	UploadScheduler::Upload Make(int id, double milliseconds = 0.0)
+	{
+		return [this, id, milliseconds]()
+		{
+			Order.push_back(id);
+			Now += milliseconds;
+		};
+	}
+
+	double Now = 0.0;
+	std::vector<int> Order;
+};
+
+TEST(UploadScheduler, StopsAtTheByteBudget)
+{
+	SimulatedUploads uploads;
+	UploadScheduler scheduler(100, 1000.0, uploads.GetClock());
+	for (int i = 0; i < 4; i++)
+		scheduler.Enqueue(UploadPriority::High, 40, uploads.Make(i));
+
+	scheduler.RunFrame();
+	EXPECT_EQ(uploads.Order, (std::vector<int>{ 0, 1 }));
+	EXPECT_EQ(scheduler.GetStatistics().UploadedBytes, 80u);
+	EXPECT_EQ(scheduler.GetStatistics().UploadedCount, 2u);
+	EXPECT_EQ(scheduler.GetStatistics().QueuedCount, 2u);
+	EXPECT_EQ(scheduler.GetStatistics().QueuedBytes, 80u);
+
+	scheduler.RunFrame();
+	EXPECT_EQ(uploads.Order, (std::vector<int>{ 0, 1, 2, 3 }));
+	EXPECT_TRUE(scheduler.IsEmpty());
+	EXPECT_EQ(scheduler.GetStatistics().TotalUploadedBytes, 160u);
+	EXPECT_EQ(scheduler.GetStatistics().TotalUploadedCount, 4u);
+}
+
+TEST(UploadScheduler, StopsOnceTheTimeBudgetIsSpent)
+{
+	SimulatedUploads uploads;
+	UploadScheduler scheduler(1000, 5.0, uploads.GetClock());
+	for (int i = 0; i < 5; i++)
+		scheduler.Enqueue(UploadPriority::High, 1, uploads.Make(i, 3.0));
+
+	// The second upload starts 3 ms in, the third would start after the 5 ms budget
+	scheduler.RunFrame();
+	EXPECT_EQ(uploads.Order, (std::vector<int>{ 0, 1 }));
+	EXPECT_DOUBLE_EQ(scheduler.GetStatistics().Milliseconds, 6.0);
+
+	scheduler.SetBudget(1000, 100.0);
+	scheduler.RunFrame();
+	EXPECT_EQ(uploads.Order, (std::vector<int>{ 0, 1, 2, 3, 4 }));
+	EXPECT_DOUBLE_EQ(scheduler.GetStatistics().Milliseconds, 9.0);
+}
+
+TEST(UploadScheduler, HighPriorityRunsFirst)
+{
+	SimulatedUploads uploads;
+	UploadScheduler scheduler(100, 1000.0, uploads.GetClock());
+	scheduler.Enqueue(UploadPriority::Low, 10, uploads.Make(0));
+	scheduler.Enqueue(UploadPriority::High, 50, uploads.Make(1));
+	scheduler.Enqueue(UploadPriority::Low, 10, uploads.Make(2));
+	scheduler.Enqueue(UploadPriority::High, 50, uploads.Make(3));
+	scheduler.Enqueue(UploadPriority::High, 50, uploads.Make(4));
+
+	// The low priority uploads would fit after the first two high ones, but wait behind the third
+	scheduler.RunFrame();
+	EXPECT_EQ(uploads.Order, (std::vector<int>{ 1, 3 }));
+
+	// Once the high priority queue drains, low priority fills the rest of the frame in submission order
+	scheduler.RunFrame();
+	EXPECT_EQ(uploads.Order, (std::vector<int>{ 1, 3, 4, 0, 2 }));
+	EXPECT_TRUE(scheduler.IsEmpty());
+}
+
+TEST(UploadScheduler, FirstUploadOfAFrameAlwaysRuns)
+{
+	SimulatedUploads uploads;
+	UploadScheduler scheduler(10, 0.0, uploads.GetClock());
+	scheduler.Enqueue(UploadPriority::Low, 50, uploads.Make(0));
+	scheduler.Enqueue(UploadPriority::Low, 1, uploads.Make(1));
+
+	// Larger than the byte budget and with no time budget at all, but still one upload per frame
+	scheduler.RunFrame();
+	EXPECT_EQ(uploads.Order, (std::vector<int>{ 0 }));
+	EXPECT_EQ(scheduler.GetStatistics().UploadedBytes, 50u);
+	scheduler.RunFrame();
+	EXPECT_EQ(uploads.Order, (std::vector<int>{ 0, 1 }));
+
+	// An empty frame resets the last frame's statistics
+	scheduler.RunFrame();
+	EXPECT_EQ(scheduler.GetStatistics().UploadedCount, 0u);
+	EXPECT_EQ(scheduler.GetStatistics().UploadedBytes, 0u);
+}
+
+TEST(UploadScheduler, ThrowingUploadsAreDropped)
+{
+	SimulatedUploads uploads;
+	UploadScheduler scheduler(100, 1000.0, uploads.GetClock());
+	scheduler.Enqueue(UploadPriority::High, 10, []() { throw std::runtime_error("upload failed"); });
+	scheduler.Enqueue(UploadPriority::High, 10, uploads.Make(1));
+
+	EXPECT_THROW(scheduler.RunFrame(), std::runtime_error);
+	EXPECT_EQ(scheduler.GetStatistics().QueuedCount, 1u);
+	scheduler.RunFrame();
+	EXPECT_EQ(uploads.Order, (std::vector<int>{ 1 }));
+	EXPECT_TRUE(scheduler.IsEmpty());
+}
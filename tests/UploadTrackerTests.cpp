@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include "DX12Engine/Rendering/UploadTracker.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+using namespace DX12Engine;
+
+// Never dereferenced by the tracker
+static GPUResource* FakeResource(uintptr_t id)
+{
+	return reinterpret_cast<GPUResource*>(id * 256);
+}
+
+TEST(UploadTracker, BatchesRetireInFenceOrder)
+{
+	UploadTracker tracker;
+	GPUResource* a = FakeResource(1), * b = FakeResource(2), * c = FakeResource(3);
+	tracker.Track(a, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	tracker.Track(b, D3D12_RESOURCE_STATE_INDEX_BUFFER);
+	tracker.Submit(1);
+	tracker.Track(c, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	EXPECT_TRUE(tracker.HasOpenBatch());
+	tracker.Submit(2);
+	EXPECT_FALSE(tracker.HasOpenBatch());
+
+	EXPECT_TRUE(tracker.Retire(0).empty());
+	EXPECT_EQ(tracker.Retire(1), (std::vector<GPUResource*>{ a, b }));
+	EXPECT_EQ(tracker.Retire(5), (std::vector<GPUResource*>{ c }));
+
+	// The transitions weren't taken yet, so the resources are still tracked
+	EXPECT_TRUE(tracker.IsTracked(a));
+	const std::vector<UploadTracker::Transition> transitions = tracker.TakeTransitions();
+	ASSERT_EQ(transitions.size(), 3u);
+	EXPECT_EQ(transitions[1].Resource, b);
+	EXPECT_EQ(transitions[1].State, D3D12_RESOURCE_STATE_INDEX_BUFFER);
+	EXPECT_FALSE(tracker.IsTracked(a));
+	EXPECT_FALSE(tracker.IsTracked(c));
+}
+
+TEST(UploadTracker, ResourceInSeveralBatchesStaysTrackedUntilTheLast)
+{
+	UploadTracker tracker;
+	GPUResource* a = FakeResource(1);
+	tracker.Track(a, D3D12_RESOURCE_STATE_COPY_DEST);
+	tracker.Track(a, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	tracker.Submit(1);
+	tracker.Track(a, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	tracker.Submit(2);
+	EXPECT_EQ(tracker.TakeTransitions().size(), 3u);
+
+	// Recorded twice into the first batch but finished once
+	EXPECT_EQ(tracker.Retire(1), (std::vector<GPUResource*>{ a }));
+	EXPECT_TRUE(tracker.IsTracked(a));
+	EXPECT_EQ(tracker.Retire(2), (std::vector<GPUResource*>{ a }));
+	EXPECT_FALSE(tracker.IsTracked(a));
+}
+
+TEST(UploadTracker, ResourceDestroyedInFlightIsDropped)
+{
+	UploadTracker tracker;
+	GPUResource* a = FakeResource(1), * b = FakeResource(2);
+	tracker.Track(a, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	tracker.Track(b, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	tracker.Submit(1);
+	tracker.Track(a, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+	// What ~GPUResource does while the batch is still on the copy queue and another one is recording
+	tracker.Untrack(a);
+	EXPECT_FALSE(tracker.IsTracked(a));
+	EXPECT_FALSE(tracker.HasOpenBatch());
+	tracker.Submit(2);
+
+	const std::vector<UploadTracker::Transition> transitions = tracker.TakeTransitions();
+	ASSERT_EQ(transitions.size(), 1u);
+	EXPECT_EQ(transitions[0].Resource, b);
+	EXPECT_EQ(tracker.Retire(2), (std::vector<GPUResource*>{ b }));
+
+	// Untracking something unknown or gone is a no-op
+	tracker.Untrack(a);
+	tracker.Untrack(FakeResource(3));
+	EXPECT_FALSE(tracker.IsTracked(b));
+}
+
+TEST(UploadTracker, UntrackAllReturnsWhatWasLeft)
+{
+	UploadTracker tracker;
+	GPUResource* a = FakeResource(1), * b = FakeResource(2);
+	tracker.Track(a, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	tracker.Submit(1);
+	tracker.Track(b, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+	std::vector<GPUResource*> left = tracker.UntrackAll();
+	std::sort(left.begin(), left.end());
+	EXPECT_EQ(left, (std::vector<GPUResource*>{ a, b }));
+	EXPECT_FALSE(tracker.HasOpenBatch());
+	EXPECT_TRUE(tracker.Retire(1).empty());
+	EXPECT_TRUE(tracker.TakeTransitions().empty());
+}
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include "DX12Engine/Geometry/VertexCompression.h"
+#include <cmath>
+#include <random>
+
+using namespace DX12Engine;
+using namespace DirectX::PackedVector;
+
+// Measured worst case of the 16-bit encoding is about 1.3e-4 radians (0.0072 degrees), mostly in the folded hemisphere
+static const float OctahedralMaxError = 1.5e-4f;
+
+static DirectX::XMFLOAT3 RandomDirection(std::mt19937& random)
+{
+	std::normal_distribution<float> value(0.0f, 1.0f);
+	DirectX::XMFLOAT3 direction;
+	DirectX::XMStoreFloat3(&direction, DirectX::XMVector3Normalize(DirectX::XMVectorSet(value(random), value(random), value(random), 0.0f)));
+	return direction;
+}
+
+static float AngleBetween(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+{
+	const float dot = a.x * b.x + a.y * b.y + a.z * b.z;
+	const DirectX::XMFLOAT3 cross = { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+	return std::atan2(std::sqrt(cross.x * cross.x + cross.y * cross.y + cross.z * cross.z), dot);
+}
+
+static DirectX::XMFLOAT3 DecodeQuantized(const XMSHORTN2& quantized)
+{
+	DirectX::XMFLOAT2 encoded;
+	DirectX::XMStoreFloat2(&encoded, XMLoadShortN2(&quantized));
+	return VertexCompression::DecodeOctahedral(encoded);
+}
+
+TEST(VertexCompression, OctahedralRoundTripIsExactBeforeQuantization)
+{
+	std::mt19937 random(1);
+	for (int i = 0; i < 10000; i++)
+	{
+		const DirectX::XMFLOAT3 direction = RandomDirection(random);
+		EXPECT_LT(AngleBetween(VertexCompression::DecodeOctahedral(VertexCompression::EncodeOctahedral(direction)), direction), 1e-6f);
+	}
+}
+
+TEST(VertexCompression, QuantizedOctahedralErrorIsBounded)
+{
+	std::mt19937 random(2);
+	float maxError = 0.0f;
+	for (int i = 0; i < 100000; i++)
+	{
+		const DirectX::XMFLOAT3 direction = RandomDirection(random);
+		maxError = (std::max)(maxError, AngleBetween(DecodeQuantized(VertexCompression::QuantizeOctahedral(direction)), direction));
+	}
+	EXPECT_LT(maxError, OctahedralMaxError);
+}
+
+TEST(VertexCompression, QuantizedOctahedralKeepsAxesExact)
+{
+	const DirectX::XMFLOAT3 directions[] =
+	{
+		{ 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f },
+		{ 0.6f, 0.0f, -0.8f },
+	};
+	for (const DirectX::XMFLOAT3& direction : directions)
+		EXPECT_LT(AngleBetween(DecodeQuantized(VertexCompression::QuantizeOctahedral(direction)), direction), 1e-6f);
+}
+
+TEST(VertexCompression, PositionErrorIsHalfAStepOfTheBounds)
+{
+	DirectX::BoundingBox bounds;
+	bounds.Center = { 10.0f, -2.0f, 0.5f };
+	bounds.Extents = { 50.0f, 0.25f, 3.0f };
+	const VertexQuantization quantization = VertexCompression::ComputeQuantization(bounds);
+
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	for (int i = 0; i < 10000; i++)
+	{
+		Vertex vertex = {};
+		vertex.Position = {
+			quantization.Offset.x + unit(random) * quantization.Scale.x,
+			quantization.Offset.y + unit(random) * quantization.Scale.y,
+			quantization.Offset.z + unit(random) * quantization.Scale.z };
+		vertex.Normal = { 0.0f, 1.0f, 0.0f };
+		vertex.Tangent = { 1.0f, 0.0f, 0.0f, 1.0f };
+		const Vertex decoded = VertexCompression::Decode(VertexCompression::Encode(vertex, quantization), quantization);
+
+		// Half a 16-bit step plus float rounding of the dequantization
+		EXPECT_LE(std::fabs(decoded.Position.x - vertex.Position.x), quantization.Scale.x * (0.5f / 65535.0f + 1e-6f));
+		EXPECT_LE(std::fabs(decoded.Position.y - vertex.Position.y), quantization.Scale.y * (0.5f / 65535.0f + 1e-6f));
+		EXPECT_LE(std::fabs(decoded.Position.z - vertex.Position.z), quantization.Scale.z * (0.5f / 65535.0f + 1e-6f));
+	}
+}
+
+TEST(VertexCompression, FlatAxisDecodesToTheOffset)
+{
+	DirectX::BoundingBox bounds;
+	bounds.Center = { 0.0f, 3.0f, 0.0f };
+	bounds.Extents = { 1.0f, 0.0f, 1.0f };
+	const VertexQuantization quantization = VertexCompression::ComputeQuantization(bounds);
+
+	Vertex vertex = {};
+	vertex.Position = { 0.25f, 3.0f, -0.5f };
+	vertex.Normal = { 0.0f, 1.0f, 0.0f };
+	vertex.Tangent = { 1.0f, 0.0f, 0.0f, 1.0f };
+	EXPECT_EQ(VertexCompression::Decode(VertexCompression::Encode(vertex, quantization), quantization).Position.y, 3.0f);
+}
+
+TEST(VertexCompression, HalfTexCoordErrorIsHalfAnUlp)
+{
+	std::mt19937 random(4);
+	std::uniform_real_distribution<float> value(-4.0f, 4.0f);
+	VertexQuantization quantization;
+	for (int i = 0; i < 10000; i++)
+	{
+		Vertex vertex = {};
+		vertex.TexCoord = { value(random), value(random) };
+		vertex.Normal = { 0.0f, 0.0f, 1.0f };
+		vertex.Tangent = { 1.0f, 0.0f, 0.0f, 1.0f };
+		const Vertex decoded = VertexCompression::Decode(VertexCompression::Encode(vertex, quantization), quantization);
+
+		// 10 stored mantissa bits round to within 2^-11 relative, smaller values are bounded by the subnormal step
+		EXPECT_LE(std::fabs(decoded.TexCoord.x - vertex.TexCoord.x), (std::max)(std::fabs(vertex.TexCoord.x) * 0x1p-11f, 0x1p-25f));
+		EXPECT_LE(std::fabs(decoded.TexCoord.y - vertex.TexCoord.y), (std::max)(std::fabs(vertex.TexCoord.y) * 0x1p-11f, 0x1p-25f));
+	}
+}
+
+TEST(VertexCompression, FullVertexRoundTripKeepsHandedness)
+{
+	DirectX::BoundingBox bounds;
+	bounds.Extents = { 1.0f, 1.0f, 1.0f };
+	const VertexQuantization quantization = VertexCompression::ComputeQuantization(bounds);
+
+	std::mt19937 random(5);
+	for (int i = 0; i < 1000; i++)
+	{
+		Vertex vertex = {};
+		vertex.Normal = RandomDirection(random);
+		const DirectX::XMFLOAT3 tangent = RandomDirection(random);
+		vertex.Tangent = { tangent.x, tangent.y, tangent.z, i % 2 ? -1.0f : 1.0f };
+		const Vertex decoded = VertexCompression::Decode(VertexCompression::Encode(vertex, quantization), quantization);
+
+		EXPECT_LT(AngleBetween(decoded.Normal, vertex.Normal), OctahedralMaxError);
+		EXPECT_LT(AngleBetween({ decoded.Tangent.x, decoded.Tangent.y, decoded.Tangent.z }, tangent), OctahedralMaxError);
+		EXPECT_EQ(decoded.Tangent.w, vertex.Tangent.w);
+	}
+}
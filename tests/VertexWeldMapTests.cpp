@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include "DX12Engine/IO/VertexWeldMap.h"
+#include <random>
+#include <string>
+#include <unordered_map>
+
+using namespace DX12Engine;
+
+// The string-keyed map LoadObj used before VertexWeldMap, with the same lookups
+static uint32_t FindOrInsertLegacy(std::unordered_map<std::string, uint32_t>& map, const VertexKey& key, uint32_t newIndex, bool& inserted)
+{
+	std::string text = std::to_string(key.Position) + "/" + std::to_string(key.Normal) + "/" + std::to_string(key.TexCoord);
+	inserted = map.find(text) == map.end();
+	if (inserted)
+		map[text] = newIndex;
+	return map[text];
+}
+
+static void ExpectSameAsLegacy(size_t expectedCount, const std::vector<VertexKey>& keys)
+{
+	VertexWeldMap map(expectedCount);
+	std::unordered_map<std::string, uint32_t> legacy;
+	uint32_t vertexCount = 0, legacyVertexCount = 0;
+	for (size_t i = 0; i < keys.size(); i++)
+	{
+		bool inserted = false, legacyInserted = false;
+		const uint32_t index = map.FindOrInsert(keys[i], vertexCount, inserted);
+		const uint32_t legacyIndex = FindOrInsertLegacy(legacy, keys[i], legacyVertexCount, legacyInserted);
+		ASSERT_EQ(index, legacyIndex) << "corner " << i;
+		ASSERT_EQ(inserted, legacyInserted) << "corner " << i;
+		vertexCount += inserted;
+		legacyVertexCount += legacyInserted;
+	}
+	EXPECT_EQ(map.Size(), legacy.size());
+}
+
+static std::vector<VertexKey> RandomKeys(size_t count, int32_t range, uint32_t seed)
+{
+	// A small range repeats keys often, -1 is a missing normal or texcoord
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<int32_t> index(-1, range);
+	std::vector<VertexKey> keys(count);
+	for (VertexKey& key : keys)
+		key = { index(random) + 1, index(random), index(random) };
+	return keys;
+}
+
+TEST(VertexWeldMap, MatchesLegacyMapWhenSizedUpFront)
+{
+	const std::vector<VertexKey> keys = RandomKeys(200000, 40, 1);
+	ExpectSameAsLegacy(keys.size(), keys);
+}
+
+TEST(VertexWeldMap, MatchesLegacyMapWhileGrowing)
+{
+	// Starting from the minimum capacity rehashes many times on the way
+	const std::vector<VertexKey> keys = RandomKeys(200000, 60, 2);
+	ExpectSameAsLegacy(0, keys);
+}
+
+TEST(VertexWeldMap, MatchesLegacyMapOnGridCorners)
+{
+	// Triangulated quad grid with shared position, normal and texcoord indices, like the benchmark OBJ
+	const int32_t gridSize = 64, rowSize = gridSize + 1;
+	std::vector<VertexKey> keys;
+	for (int32_t y = 0; y < gridSize; y++)
+	{
+		for (int32_t x = 0; x < gridSize; x++)
+		{
+			const int32_t quad[4] = { y * rowSize + x, y * rowSize + x + 1, (y + 1) * rowSize + x + 1, (y + 1) * rowSize + x };
+			for (int32_t corner : { quad[0], quad[1], quad[2], quad[0], quad[2], quad[3] })
+				keys.push_back({ corner, corner, corner });
+		}
+	}
+	ExpectSameAsLegacy(keys.size(), keys);
+}
+
+TEST(VertexWeldMap, MissingAttributesAreDistinctFromIndexZero)
+{
+	VertexWeldMap map(4);
+	bool inserted = false;
+	EXPECT_EQ(map.FindOrInsert({ 0, -1, -1 }, 0, inserted), 0u);
+	EXPECT_TRUE(inserted);
+	EXPECT_EQ(map.FindOrInsert({ 0, 0, -1 }, 1, inserted), 1u);
+	EXPECT_TRUE(inserted);
+	EXPECT_EQ(map.FindOrInsert({ 0, -1, 0 }, 2, inserted), 2u);
+	EXPECT_TRUE(inserted);
+	EXPECT_EQ(map.FindOrInsert({ 0, -1, -1 }, 3, inserted), 0u);
+	EXPECT_FALSE(inserted);
+	EXPECT_EQ(map.Size(), 3u);
+}
+
+TEST(VertexWeldMap, GrowKeepsStoredIndices)
+{
+	VertexWeldMap map(1);
+	bool inserted = false;
+	for (uint32_t i = 0; i < 10000; i++)
+		map.FindOrInsert({ static_cast<int32_t>(i), static_cast<int32_t>(i * 7), -1 }, i, inserted);
+	for (uint32_t i = 0; i < 10000; i++)
+	{
+		EXPECT_EQ(map.FindOrInsert({ static_cast<int32_t>(i), static_cast<int32_t>(i * 7), -1 }, 0xDEAD, inserted), i);
+		EXPECT_FALSE(inserted);
+	}
+	EXPECT_EQ(map.Size(), 10000u);
+}